@@ -146,6 +146,9 @@ static char *id_string="$Id: alloc.c,v 3.9 1995/02/08 11:11:14 sander Exp $";
  * free_all_lists	gives all temporary memory free.
  * reinit_all_lists     reinitialize all memory lists. This is done if the
  *			memory is given free: all lists are set to NULL.
+ * print_arena_statistics  print the counters of the arenas.
+ * arena_counters	gives the counters of one arena.
+ * core_memory_bytes	gives the bytes allocated by myalloc.
  ***************************************************************************/
 
 
@@ -157,6 +160,7 @@ static char *id_string="$Id: alloc.c,v 3.9 1995/02/08 11:11:14 sander Exp $";
 #include "options.h"
 #include "alloc.h"
 #include "folding.h"
+#include "spatial.h"
 
 #undef DEBUG
 #undef debugmessage
@@ -171,9 +175,14 @@ static char *id_string="$Id: alloc.c,v 3.9 1995/02/08 11:11:14 sander Exp $";
  * ----------
  */
 
-static GNODE internal_nodealloc	_PP((void));
+typedef struct arena ARENA;
+
+static char *arena_alloc	_PP((ARENA *a));
+static void arena_reset		_PP((ARENA *a));
+static void arena_init		_PP((ARENA *a));
+static GNODE internal_nodealloc	_PP((int temporary));
 static void free_nodelists	_PP((void));
-static GEDGE internal_edgealloc	_PP((void));
+static GEDGE internal_edgealloc	_PP((int temporary));
 static void free_tmpedges	_PP((void));
 static ADJEDGE  edgelist_alloc	_PP((void));
 static void free_edgelists	_PP((void));
@@ -194,6 +203,7 @@ static long act_alloc_nodes = 0;
 #endif
 
 static long node_refnum = 0L;	/* reference counter for REFNUM	of nodes */
+static long core_bytes  = 0L;	/* bytes allocated by myalloc		 */
 
 
 /*   Core Memory allocation
@@ -214,6 +224,7 @@ int 	x;
 	act_alloc_size += x;
 	PRINTF("Alloc Summary: %ld Bytes allocated\n",act_alloc_size);
 #endif
+	core_bytes += x;
 	return(ParseMalloc(x));
 }
 
@@ -238,11 +249,221 @@ void 	free_memory()
 	FreeHash();
 	ParseFree();
 	node_refnum = 0L;	
+	core_bytes  = 0L;
 	reinit_all_lists();
 }
 
 /*--------------------------------------------------------------------*/
 
+/*  Arenas for temporary objects
+ *  ============================
+ */
+
+/*  The temporary objects (dummy nodes, label nodes, their edges,
+ *  adjacency lists, etc.) are needed for exactly one layout. Each
+ *  relayout gives all of them free at once. Thus, we allocate each
+ *  type of temporary object by incrementing a pointer in an arena of
+ *  chunks, and give the whole arena free by resetting this pointer to
+ *  the first chunk. This starts a new epoch of the arena. The chunks
+ *  are kept and reused in the next epoch. They come from the core
+ *  memory, and are given free by free_memory.
+ *
+ *  The chunks are aligned at cache lines. Objects are packed densely
+ *  into the chunks in allocation order, which is mostly the order in
+ *  which the layout phases traverse them.
+ */
+
+#define ARENA_ALIGN	64		/* size of a cache line         */
+#define ARENA_CHUNK	(32*1024)	/* usable bytes of one chunk    */
+
+/* object size, aligned for doubles and pointers */
+#define ARENA_OBJSIZE(t) ((int)((sizeof(t)+sizeof(double)-1) \
+				& ~(sizeof(double)-1)))
+
+typedef struct arena_chunk {
+	struct arena_chunk *next;	/* next chunk of the arena      */
+	char	*base;			/* first aligned byte           */
+	char	*end;			/* end of the usable bytes      */
+} ARENA_CHUNK_T;
+
+struct arena {
+	char	*name;			/* name for the statistics      */
+	int	objsize;		/* object size, aligned         */
+	ARENA_CHUNK_T *first;		/* list of all chunks           */
+	ARENA_CHUNK_T *act;		/* chunk used at the moment     */
+	char	*top;			/* next free byte in act        */
+	long	objects;		/* objects of the actual epoch  */
+	long	peak;			/* max. objects of an epoch     */
+	long	chunks;			/* number of chunks             */
+	long	epochs;			/* number of resets             */
+};
+
+static ARENA node_arena    = { "GNODE",   ARENA_OBJSIZE(struct gnode)   };
+static ARENA edge_arena    = { "GEDGE",   ARENA_OBJSIZE(struct gedge)   };
+static ARENA ncons_arena   = { "GNLIST",  ARENA_OBJSIZE(struct gnlist)  };
+static ARENA econs_arena   = { "ADJEDGE", ARENA_OBJSIZE(struct adjedge) };
+static ARENA connect_arena = { "CONNECT", ARENA_OBJSIZE(struct connect) };
+
+static ARENA *arenas[] = {
+	&node_arena, &edge_arena, &ncons_arena, &econs_arena, &connect_arena,
+	NULL
+};
+
+
+/*  Allocate an object from an arena
+ *  --------------------------------
+ *  If the actual chunk is full, we continue with the next chunk that
+ *  was used in an earlier epoch, or allocate a new chunk.
+ */
+
+#ifdef ANSI_C
+static char *arena_alloc(ARENA *a)
+#else
+static char *arena_alloc(a)
+ARENA *a;
+#endif
+{
+	ARENA_CHUNK_T *c;
+	char	*h;
+
+	if ((a->act==NULL) || (a->top + a->objsize > a->act->end)) {
+		if (a->act && a->act->next) c = a->act->next;
+		else if (!a->act && a->first) c = a->first;
+		else {
+			c = (ARENA_CHUNK_T *)myalloc(sizeof(ARENA_CHUNK_T));
+			c->base = myalloc(ARENA_CHUNK+ARENA_ALIGN);
+			c->base += (ARENA_ALIGN - (size_t)c->base % ARENA_ALIGN)
+				   % ARENA_ALIGN;
+			c->end  = c->base + ARENA_CHUNK;
+			c->next = NULL;
+			if (a->act) a->act->next = c;
+			else	    a->first = c;
+			a->chunks++;
+		}
+		a->act = c;
+		a->top = c->base;
+	}
+	h = a->top;
+	a->top += a->objsize;
+	a->objects++;
+	if (a->objects > a->peak) a->peak = a->objects;
+	return(h);
+}
+
+
+/*  Give all objects of an arena free
+ *  ---------------------------------
+ *  This is O(1): the chunks are not touched.
+ */
+
+#ifdef ANSI_C
+static void arena_reset(ARENA *a)
+#else
+static void arena_reset(a)
+ARENA *a;
+#endif
+{
+	a->act     = NULL;
+	a->top     = NULL;
+	a->objects = 0;
+	a->epochs++;
+}
+
+
+/*  Initialize an arena
+ *  -------------------
+ *  This is done if the core memory is given free, i.e. the chunks
+ *  don't exist anymore.
+ */
+
+#ifdef ANSI_C
+static void arena_init(ARENA *a)
+#else
+static void arena_init(a)
+ARENA *a;
+#endif
+{
+	a->first   = NULL;
+	a->act     = NULL;
+	a->top     = NULL;
+	a->objects = 0;
+	a->peak    = 0;
+	a->chunks  = 0;
+	a->epochs  = 0;
+}
+
+
+/*  Print the arena counters
+ *  ------------------------
+ *  For each arena: the objects of the actual epoch and their bytes,
+ *  the max. number of objects of an epoch, the bytes of the chunks,
+ *  and the number of epochs since the last free_memory.
+ */
+
+#ifdef ANSI_C
+void print_arena_statistics(void)
+#else
+void print_arena_statistics()
+#endif
+{
+	ARENA **a;
+
+	for (a = arenas; *a; a++) {
+		PRINTF("Arena %-8s %8ld objects %10ld bytes, ",
+			(*a)->name, (*a)->objects,
+			(*a)->objects * (long)(*a)->objsize);
+		PRINTF("peak %8ld objects, reserved %10ld bytes, %ld epochs\n",
+			(*a)->peak, (*a)->chunks * (long)ARENA_CHUNK, (*a)->epochs);
+	}
+}
+
+
+/*  Counters of one arena
+ *  ---------------------
+ *  For the profile (see profile.c): the name of arena i, the objects of
+ *  the actual epoch and their bytes, the max. number of objects of an
+ *  epoch, and the bytes of the chunks. Returns 0 if there is no arena i.
+ */
+
+#ifdef ANSI_C
+int arena_counters(int i, char **name, long *objects, long *bytes,
+			long *peak, long *reserved)
+#else
+int arena_counters(i, name, objects, bytes, peak, reserved)
+int	i;
+char	**name;
+long	*objects, *bytes, *peak, *reserved;
+#endif
+{
+	ARENA *a;
+
+	if ((i<0) || (i >= (int)(sizeof(arenas)/sizeof(arenas[0])) - 1))
+		return(0);
+	a = arenas[i];
+	*name     = a->name;
+	*objects  = a->objects;
+	*bytes    = a->objects * (long)a->objsize;
+	*peak     = a->peak;
+	*reserved = a->chunks * (long)ARENA_CHUNK;
+	return(1);
+}
+
+
+/*  Bytes allocated by myalloc since the last free_memory
+ *  -----------------------------------------------------
+ */
+
+#ifdef ANSI_C
+long core_memory_bytes(void)
+#else
+long core_memory_bytes()
+#endif
+{
+	return(core_bytes);
+}
+
+/*--------------------------------------------------------------------*/
+
 /*  Memory Management for Nodes 
  *  ===========================
  */
@@ -278,25 +499,33 @@ GNODE dummylist    = NULL;     /* List of other dummy nodes           */
 GNODE tmpnodelist   = NULL;     /* list of allocated temoprary nodes */
 static GNODE node_freelist = NULL;     /* list of free GNODE objects */
 
+/*  Temporary GNODE objects come from the node_arena instead of the
+ *  node_freelist. They are still linked into the tmpnodelist, because
+ *  the layout phases traverse this list.
+ */
+
 
 
 /*  Allocate a GNODE object
  *  -----------------------
- *  First, we look in the free list, if we have a free node. Otherwise,
+ *  Temporary nodes come from the node arena. For other nodes, we
+ *  look in the free list, if we have a free node. Otherwise,
  *  we allocate a node from the core memory.
  *  We also set some default values.
  */
 
 #ifdef ANSI_C
-static GNODE internal_nodealloc(void)
+static GNODE internal_nodealloc(int temporary)
 #else
-static GNODE internal_nodealloc()
+static GNODE internal_nodealloc(temporary)
+int temporary;
 #endif
 {
 	GNODE   h;
 
 	debugmessage("internal_nodealloc","");
-	if (node_freelist) {
+	if (temporary) h = (GNODE) arena_alloc(&node_arena);
+	else if (node_freelist) {
 		h = node_freelist;
 		node_freelist = NINTERN(node_freelist);
 	}
@@ -310,6 +539,7 @@ static GNODE internal_nodealloc()
 
 	NREFNUM(h)	= node_refnum++;
 	NTITLE(h) 	= NULL;
+	NTITLEID(h) 	= -1L;
 	NLABEL(h) 	= NULL;
 	NINFO1(h)	= NULL;
 	NINFO2(h)	= NULL;
@@ -330,6 +560,11 @@ static GNODE internal_nodealloc()
 	NINVISIBLE(h)	= 0;
 	NTIEFE(h)    	= -1;
 	NPOS(h)      	= -1;   
+	NSLOT(h)	= -1;
+	NOLDLEVEL(h)	= -1;
+	NOLDPOS(h)	= -1;
+	NOLDSTAMP(h)	= 0;
+	NWARM(h)	= -1;
 	NWEIGHTS(h)     = 0L;
 	NWEIGHTP(h)	= 0L;
 	NMARK(h)     	= 0; 
@@ -373,7 +608,7 @@ GNODE refnode;
 	GNODE h;
 
 	debugmessage("nodealloc","");
-	h = internal_nodealloc();
+	h = internal_nodealloc(0);
 	copy_nodeattributes(refnode, h);
 	NBEFORE(h)      = nodelistend;
 	if (nodelistend) NNEXT(nodelistend) = h;
@@ -398,6 +633,7 @@ GNODE node;
 	debugmessage("nodedefaults","");
 
 	NTITLE(node)	= G_title;
+	NTITLEID(node)	= -1L;
 	NLABEL(node)	= NULL;
 	NLEVEL(node)	= -1;
 	NSHAPE(node)	= BOX;
@@ -435,6 +671,7 @@ GNODE node;
 	debugmessage("foldnodedefaults","");
 
 	NTITLE(node)	= NULL;
+	NTITLEID(node)	= -1L;
 	NLABEL(node)	= NULL;
 	NLEVEL(node)	= -1;
 	NSHAPE(node)	= -1;
@@ -507,6 +744,7 @@ GNODE x, y;
 #endif
 {
 	NTITLE(y)	= NTITLE(x);
+	NTITLEID(y)	= NTITLEID(x);
 	NLABEL(y)	= NLABEL(x);
 	NLEVEL(y)	= NLEVEL(x);
 	NSHAPE(y)	= NSHAPE(x);
@@ -548,7 +786,7 @@ GNODE refnode;
 	GNODE   h;
 
 	debugmessage("graphalloc","");
-	h = internal_nodealloc();
+	h = internal_nodealloc(0);
 	copy_nodeattributes(refnode, h);
 	NFOLDING(h)	= -1;
 	NINLIST(h)	= 0;
@@ -592,7 +830,7 @@ int     shrink,stretch,horder;
 	GNODE	h;
 
 	debugmessage("tmpnodealloc","");
-	h = internal_nodealloc();
+	h = internal_nodealloc(1);
 
 	NHORDER(h)	= horder;
         NTEXTMODE(h)    = textm;
@@ -627,16 +865,9 @@ void free_tmpnodes(void)
 void free_tmpnodes()
 #endif
 {
-	GNODE	h;
-
 	debugmessage("free_tmpnodes","");
-	h = tmpnodelist;
-	if (h) {
-		while (NINTERN(h)) h = NINTERN(h);
-		NINTERN(h) = node_freelist;
-		node_freelist = tmpnodelist;
-		tmpnodelist = NULL;
-	}
+	arena_reset(&node_arena);
+	tmpnodelist = NULL;
 	labellist    = NULL;  
 	labellistend = NULL;  
 	dummylist = NULL;
@@ -671,6 +902,7 @@ GNODE h;
  *  -----------------------------------------------
  *  This is used in the menues after selecting a node. 
  *  At this time point, all visible nodes are in the node list.
+ *  The candidates are taken from the spatial index (see spatial.c).
  */
 
 #ifdef ANSI_C
@@ -684,6 +916,7 @@ long	x,y;
 	int	width, height;
 	long	xpos, ypos;
 
+	if ((G_stretch>0)&&(G_shrink>0)) return(spatial_xy_node(x,y));
 	v = nodelist;
 	while (v) {
 		xpos = (NX(v)*G_stretch)/G_shrink - V_xmin;
@@ -748,7 +981,6 @@ void check_graph_consistency()
  */
 
 
-static GNLIST tmpnconslist   = NULL;  /* list of allocated cons cells */
 static GNLIST foldnconslist   = NULL; /* list of all. fold cons cells */
 static GNLIST ncons_freelist = NULL;  /* list of free cons cells      */
 
@@ -782,11 +1014,9 @@ GNODE v;
 
 /*  Allocate a temporary GNLIST object
  *  ----------------------------------
- *  First, we look in the free list, if we have a free node. Otherwise,
- *  we allocate a node from the core memory.
+ *  These node lists are temporary, thus we allocate them from the
+ *  ncons_arena, to give them free later.
  *  We also set some default values.
- *  These node lists are temporary, thus we store them in the
- *  tmpnconslist, to give them free later.
  */
 
 #ifdef ANSI_C
@@ -798,15 +1028,10 @@ GNLIST  tmpnodelist_alloc()
 	GNLIST	h;
 
 	debugmessage("tmpnodelist_alloc","");
-	if (ncons_freelist) {
-		h = ncons_freelist;
-		ncons_freelist = GNINTERN(ncons_freelist);
-	}
-	else    h = (GNLIST)myalloc(sizeof(struct gnlist));
-	GNINTERN(h) = tmpnconslist;
+	h = (GNLIST)arena_alloc(&ncons_arena);
+	GNINTERN(h) = NULL;
 	GNNODE(h)   = NULL;
 	GNNEXT(h)   = NULL;
-	tmpnconslist = h;
 	return(h);
 }
 
@@ -854,16 +1079,8 @@ static void free_nodelists(void)
 static void free_nodelists()
 #endif
 {
-	GNLIST	h;
-
 	debugmessage("free_nodelists","");
-	h = tmpnconslist;
-	if (h) {
-		while(GNINTERN(h)) h = GNINTERN(h);
-		GNINTERN(h) = ncons_freelist;
-		ncons_freelist = tmpnconslist;
-		tmpnconslist = NULL;
-	}
+	arena_reset(&ncons_arena);
 }
 
 
@@ -944,24 +1161,31 @@ GEDGE edgelistend  = NULL;     /* End of this list                    */
 GEDGE tmpedgelist   = NULL;     /* list of allocated temporary edges */
 static GEDGE edge_freelist = NULL;     /* list of free GEDGE objects        */
 
+/*  Temporary GEDGE objects come from the edge_arena. As with nodes,
+ *  they are still linked into the tmpedgelist.
+ */
+
 
 /*  Allocate a GEDGE object
  *  -----------------------
- *  First, we look in the free list, if we have a free edge. Otherwise,
+ *  Temporary edges come from the edge arena. For other edges, we
+ *  look in the free list, if we have a free edge. Otherwise,
  *  we allocate an edge from the core memory.
  *  We also set some default values.
  */
 
 #ifdef ANSI_C
-static GEDGE internal_edgealloc(void)
+static GEDGE internal_edgealloc(int temporary)
 #else
-static GEDGE internal_edgealloc()
+static GEDGE internal_edgealloc(temporary)
+int temporary;
 #endif
 {
 	GEDGE   h;
 
 	debugmessage("internal_edgealloc","");
-	if (edge_freelist) {
+	if (temporary) h = (GEDGE) arena_alloc(&edge_arena);
+	else if (edge_freelist) {
 		h = edge_freelist;
 		edge_freelist = EINTERN(edge_freelist);
 	}
@@ -1016,7 +1240,7 @@ GEDGE refedge;
 	GEDGE   h;
  
 	debugmessage("edgealloc","");
-	h = internal_edgealloc();
+	h = internal_edgealloc(0);
 	copy_edgeattributes(refedge, h);
 	EBEFORE(h)	= edgelistend;
 	if (edgelistend) ENEXT(edgelistend) = h;
@@ -1177,7 +1401,7 @@ int	lstyle,thick,xclass,prio,ecolor,elcol,arrows,
 	GEDGE	h;
 
 	debugmessage("tmpedgealloc","");
-	h = internal_edgealloc();
+	h = internal_edgealloc(1);
 
 	ELSTYLE(h)    	= lstyle;
 	ETHICKNESS(h)	= thick;
@@ -1212,16 +1436,9 @@ static void free_tmpedges(void)
 static void free_tmpedges()
 #endif
 {
-	GEDGE	h;
-
 	debugmessage("free_tmpedges","");
-	h = tmpedgelist;
-	if (h) {
-		while (EINTERN(h)) h = EINTERN(h);
-		EINTERN(h) = edge_freelist;
-		edge_freelist = tmpedgelist;
-		tmpedgelist = NULL;
-	}
+	arena_reset(&edge_arena);
+	tmpedgelist = NULL;
 }
 
 
@@ -1234,7 +1451,7 @@ static void free_tmpedges()
 /*  Lists of GEDGE objects are used in adjacency lists.
  *  We use special cons-cells, i.e. ADJEDGE objects, whose 
  *  heads are GEDGE objects. Because these cons-cells are temporary, 
- *  we use a similar memory management as for temporary GNODE objects.
+ *  we allocate them from the econs_arena as temporary GNODE objects.
  *
  *  Further, we have one nontemporary list of edges that contains the
  *  default connections as specified by `near_edge'. This is the
@@ -1250,16 +1467,11 @@ ADJEDGE near_edge_list = NULL;	    /* list of default connections */
 ADJEDGE bent_near_edge_list = NULL; /* list of bent near edges     */
 ADJEDGE back_edge_list = NULL;	    /* list of back edges          */
 
-/* for temporaries: */
-
-static ADJEDGE tmpeconslist   = NULL;  /* list of allocated cons cells */
-static ADJEDGE econs_freelist = NULL;  /* list of free cons cells      */
 
 
 /*  Insert a near edge into near_edge_list
  *  --------------------------------------
- *  First, we look in the free list, if we have a free cell. Otherwise,
- *  we allocate a cell from the core memory.
+ *  The cell is allocated from the core memory, because it is stable.
  */
 
 #ifdef ANSI_C
@@ -1272,11 +1484,7 @@ GEDGE e;
 	ADJEDGE	h;
 
 	debugmessage("near_edge_insert","");
-	if (econs_freelist) {
-		h = econs_freelist;
-		econs_freelist = AINTERN(econs_freelist);
-	}
-	else    h = (ADJEDGE)myalloc(sizeof(struct adjedge));
+	h = (ADJEDGE)myalloc(sizeof(struct adjedge));
 	AKANTE(h) = e;
 	ANEXT(h) = AINTERN(h) = near_edge_list;
 	near_edge_list = h;
@@ -1285,8 +1493,7 @@ GEDGE e;
 
 /*  Insert a bent near edge into bent_near_edge_list
  *  ------------------------------------------------
- *  First, we look in the free list, if we have a free cell. Otherwise,
- *  we allocate a cell from the core memory.
+ *  The cell is allocated from the core memory, because it is stable.
  */
 
 #ifdef ANSI_C
@@ -1299,11 +1506,7 @@ GEDGE e;
 	ADJEDGE	h;
 
 	debugmessage("bentnear_edge_insert","");
-	if (econs_freelist) {
-		h = econs_freelist;
-		econs_freelist = AINTERN(econs_freelist);
-	}
-	else    h = (ADJEDGE)myalloc(sizeof(struct adjedge));
+	h = (ADJEDGE)myalloc(sizeof(struct adjedge));
 	AKANTE(h) = e;
 	ANEXT(h) = AINTERN(h) = bent_near_edge_list;
 	bent_near_edge_list = h;
@@ -1313,8 +1516,7 @@ GEDGE e;
 
 /*  Insert a back edge into back_edge_list
  *  --------------------------------------
- *  First, we look in the free list, if we have a free cell. Otherwise,
- *  we allocate a cell from the core memory.
+ *  The cell is allocated from the core memory, because it is stable.
  */
 
 #ifdef ANSI_C
@@ -1327,11 +1529,7 @@ GEDGE e;
 	ADJEDGE	h;
 
 	debugmessage("back_edge_insert","");
-	if (econs_freelist) {
-		h = econs_freelist;
-		econs_freelist = AINTERN(econs_freelist);
-	}
-	else    h = (ADJEDGE)myalloc(sizeof(struct adjedge));
+	h = (ADJEDGE)myalloc(sizeof(struct adjedge));
 	AKANTE(h) = e;
 	ANEXT(h) = AINTERN(h) = back_edge_list;
 	back_edge_list = h;
@@ -1341,8 +1539,7 @@ GEDGE e;
 
 /*  Allocate a ADJEDGE object
  *  -------------------------
- *  First, we look in the free list, if we have a free cell. Otherwise,
- *  we allocate a cell from the core memory.
+ *  The cell is allocated from the econs arena.
  */
 
 #ifdef ANSI_C
@@ -1354,13 +1551,8 @@ static ADJEDGE  edgelist_alloc()
 	ADJEDGE	h;
 
 	debugmessage("edgelist_alloc","");
-	if (econs_freelist) {
-		h = econs_freelist;
-		econs_freelist = AINTERN(econs_freelist);
-	}
-	else    h = (ADJEDGE)myalloc(sizeof(struct adjedge));
-	AINTERN(h) = tmpeconslist;
-	tmpeconslist = h;
+	h = (ADJEDGE)arena_alloc(&econs_arena);
+	AINTERN(h) = NULL;
 	return(h);
 }
 
@@ -1421,16 +1613,8 @@ static void free_edgelists(void)
 static void free_edgelists()
 #endif
 {
-	ADJEDGE	h;
-
 	debugmessage("free_edgelists","");
-	h = tmpeconslist;
-	if (h) {
-		while(AINTERN(h)) h = AINTERN(h);
-		AINTERN(h) = econs_freelist;
-		econs_freelist = tmpeconslist;
-		tmpeconslist = NULL;
-	}
+	arena_reset(&econs_arena);
 }
 
 
@@ -1449,14 +1633,9 @@ static void free_edgelists()
  *         A<----B---->C     one node B. The connections of B are A and C.
  */
 
-static CONNECT 	connectlist      = NULL;   /* list of alloc. connect cells */
-static CONNECT 	connect_freelist = NULL;   /* list of free   connect cells */
-
-
 /*  Allocate a CONNECT object
  *  -------------------------
- *  First, we look in the free list, if we have a free cell. Otherwise,
- *  we allocate a cell from the core memory.
+ *  The cell is allocated from the connect arena.
  *  The new connect node is inserted into the connection field of the 
  *  GNODE node.
  */
@@ -1471,17 +1650,12 @@ GNODE	node;
 	CONNECT	h;
 
 	debugmessage("connectalloc","");
-	if (connect_freelist) {
-		h = connect_freelist;
-		connect_freelist = CINTERN(connect_freelist);
-	}
-	else 	h = (CONNECT)myalloc(sizeof(struct connect));
+	h = (CONNECT)arena_alloc(&connect_arena);
 	CTARGET(h) 	= NULL;
 	CEDGE(h)	= NULL;
 	CTARGET2(h)	= NULL;
 	CEDGE2(h)	= NULL;
-	CINTERN(h) 	= connectlist;
-	connectlist	= h;
+	CINTERN(h) 	= NULL;
 	NCONNECT(node) 	= h;
 	return(h);
 }
@@ -1497,16 +1671,8 @@ static void free_connect(void)
 static void free_connect()
 #endif
 {
-	CONNECT	h;
-		
 	debugmessage("free_connect","");
-	h = connectlist;
-	if (h) {
-		while(CINTERN(h)) h = CINTERN(h);
-		CINTERN(h) = connect_freelist;
-		connect_freelist = connectlist;
-		connectlist = NULL;
-	}
+	arena_reset(&connect_arena);
 }
 
 
@@ -1610,6 +1776,8 @@ DLLIST x;
 
 /*  Deallocation of all temporary lists 
  *  ===================================
+ *  Each arena starts a new epoch. The temporary objects are not
+ *  traversed.
  */
 
 
@@ -1619,6 +1787,7 @@ void	free_all_lists(void)
 void	free_all_lists()
 #endif
 {
+	invalidate_spatial_index();
 	free_tmpnodes();
 	free_tmpedges();
         free_nodelists();
@@ -1637,6 +1806,8 @@ void    reinit_all_lists(void)
 void    reinit_all_lists()
 #endif
 {
+	ARENA **a;
+
 	ufoldstart  = NULL;
         foldstart   = NULL;
         foldstops   = NULL;
@@ -1656,7 +1827,7 @@ void    reinit_all_lists()
 	tmpnodelist	 = NULL;
 	node_freelist    = NULL;
 
-	tmpnconslist     = NULL;
+	foldnconslist    = NULL;
 	ncons_freelist   = NULL;
 
 	edgeanz 	 = 0;
@@ -1668,13 +1839,10 @@ void    reinit_all_lists()
 	near_edge_list      = NULL;
 	back_edge_list      = NULL;
 	bent_near_edge_list = NULL;
-	tmpeconslist        = NULL;
-	econs_freelist      = NULL;
-
-	connectlist	 = NULL;
-	connect_freelist = NULL;
 
 	dllist_freelist	 = NULL;
+
+	for (a = arenas; *a; a++) arena_init(*a);
 }
 
 
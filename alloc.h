@@ -367,6 +367,7 @@ typedef struct gnode {
 	/* These attributes come directly from the specification */
 
 	char 	*title;
+	long	titleid;	/* number of the title string, or -1 */
 	char	*label;
 	char	*info1;
 	char	*info2;
@@ -421,6 +422,11 @@ typedef struct gnode {
 	int	tiefe;		    /* the number (deepth) of the layer */
 	int	position;           /* the position in the layer        */
 	float	bary;               /* the weight of the bary centering */
+	int	slot;               /* index in the layer data of step2 */
+	int	oldlevel;           /* level in the previous layout     */
+	int	oldpos;             /* position in the previous layout  */
+	int	oldstamp;           /* number of the previous layout    */
+	int	warmnode;           /* node of the warm start, or -1    */
 
 	/* The following two fields have sev. purposes: they are the layout
          * weights nws and nwp of the layout algorithm, and on drawing
@@ -485,6 +491,7 @@ typedef struct gnode {
 
 #define	NREFNUM(x)	((x)->refnum)
 #define	NTITLE(x)	((x)->title)
+#define	NTITLEID(x)	((x)->titleid)
 #define	NLABEL(x)	((x)->label)
 #define	NINFO1(x)	((x)->info1)
 #define	NINFO2(x)	((x)->info2)
@@ -522,6 +529,11 @@ typedef struct gnode {
 #define	NREVERT(x)	((x)->revert)
 #define	NANCHORNODE(x)	((x)->anchordummy)
 #define	NBARY(x)	((x)->bary)
+#define	NSLOT(x)	((x)->slot)
+#define	NOLDLEVEL(x)	((x)->oldlevel)
+#define	NOLDPOS(x)	((x)->oldpos)
+#define	NOLDSTAMP(x)	((x)->oldstamp)
+#define	NWARM(x)	((x)->warmnode)
 #define	NLOWPT(x)	((x)->weights)
 #define	NOPENSCC(x)	((x)->weightp)
 #define	NWEIGHTS(x)	((x)->weights)
@@ -898,6 +910,10 @@ void    dllist_free_all	_PP((DLLIST x));
 
 void	free_all_lists 	 _PP((void));
 void    reinit_all_lists _PP((void));
+void    print_arena_statistics _PP((void));
+int	arena_counters	 _PP((int i, char **name, long *objects, long *bytes,
+				long *peak, long *reserved));
+long	core_memory_bytes _PP((void));
 
 /*--------------------------------------------------------------------*/
 
@@ -0,0 +1,816 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         bkplace.c                                          */
+/*   description:  Linear time coordinate assignment (part of step 3) */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * Step 3 calculates the x coordinates of the nodes by the pendulum
+ * method (medium shifts) and the rubberband method (center shifts).
+ * Both iterate until the layout is stable or the maximal number of
+ * iterations is reached, and each iteration touches all nodes and
+ * edges. On large flow charts, this dominates the layout time.
+ *
+ * With option -coord bk, the x coordinates are calculated instead
+ * in time O(V+E) by the method of Brandes and Koepf ("Fast and simple
+ * horizontal coordinate assignment", Graph Drawing 2001, LNCS 2265):
+ *
+ *   1) Edges between an inner segment (both end points are dummy
+ *	nodes) and a crossing non-inner segment are marked. Marked
+ *	edges are not aligned, thus long edges stay straight.
+ *   2) For each of the four directions (top-down or bottom-up, left
+ *	or right), each node is aligned with one of its median
+ *	neighbours in the previous layer, if this does not cross an
+ *	alignment made before. The aligned nodes form blocks that get
+ *	the same x coordinate.
+ *   3) The blocks are placed as compact as possible: each block is
+ *	placed next to the blocks of the left neighbours of its nodes
+ *	that belong to the same class, i.e. that were compacted towards
+ *	the same leftmost block (the sink). Then the classes are shifted
+ *	towards each other. This follows the corrected version of the
+ *	compaction (Brandes, Walter and Zink, "Erratum: Fast and simple
+ *	horizontal coordinate assignment", 2020).
+ *   4) The four layouts are aligned to the narrowest one, and each
+ *	node gets the average of its two median coordinates.
+ *
+ * All coordinates are centers of nodes. The distances are the same
+ * as in the iterative methods: G_xspace between nodes, and G_dspace
+ * if one of them is a dummy node. To avoid rounding, the centers are
+ * doubled during the calculation.
+ *
+ * The order of nodes inside the layers is not changed, and the result
+ * is aligned to the raster like the result of the iterative methods.
+ * Thus step 4 can route the edges as usual.
+ *
+ * Since the blocks cannot bend, the layout is wider than the layout
+ * of the iterative methods, but long edges are straight. The width is
+ * not a matter of the compaction: a block with nodes in many layers
+ * must be right of the left neighbours of all of them, and these
+ * constraints add up over the crossing edges. On the sample flow
+ * charts, the width is 2.4 to 4.6 times the width of the iterative
+ * methods; nearly all nodes belong to one class there, such that the
+ * class shifts do not change it.
+ *
+ * The nodes are numbered by NDFS in order of the layers; NDFS is not
+ * used by step 3 if the iterative methods are skipped.
+ *
+ * This file provides the following function:
+ *
+ * bk_coordinates	calculate the x coordinates of all nodes of
+ *			the layers.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "steps.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+
+/* Prototypes
+ * ==========
+ */
+
+static int	node_index	_PP((GNODE v));
+static int	collect_nodes	_PP((void));
+static void	build_neighbours _PP((void));
+static void	mark_conflicts	_PP((void));
+static void	vertical_alignment _PP((int vdir, int hdir));
+static int	neighbour	_PP((int v, int side));
+static void	place_blocks	_PP((int hdir));
+static void	shift_classes	_PP((int vdir, int hdir));
+static void	horizontal_compaction _PP((int vdir, int hdir, long *xs));
+static void	balance		_PP((void));
+static void	set_coordinates	_PP((void));
+static void	free_bk		_PP((void));
+
+
+/* Global variables
+ * ================
+ */
+
+static GNODE	*bk_node    = NULL;	/* the nodes in order of the layers  */
+static int	*bk_layer   = NULL;	/* level of each node                */
+static int	bk_nnodes   = 0;	/* number of nodes                   */
+static int	*bk_lstart  = NULL;	/* first node of each layer          */
+static int	bk_nlayers  = 0;	/* number of layers                  */
+
+static int	*bk_estart  = NULL;	/* upper node of each edge           */
+static int	*bk_eend    = NULL;	/* lower node of each edge           */
+static char	*bk_mark    = NULL;	/* marked edges (type 1 conflicts)   */
+static int	bk_nedges   = 0;	/* number of edges                   */
+
+static int	*bk_upstart = NULL;	/* upper neighbours of each node     */
+static int	*bk_up      = NULL;	/* sorted by position, and the edge  */
+static int	*bk_upedge  = NULL;	/* to each of them                   */
+static int	*bk_dnstart = NULL;	/* lower neighbours of each node     */
+static int	*bk_dn      = NULL;
+static int	*bk_dnedge  = NULL;
+
+static long	*bk_sep     = NULL;	/* doubled minimal distance of the   */
+					/* centers to the left neighbour     */
+static int	*bk_root    = NULL;	/* root of the block of each node    */
+static int	*bk_align   = NULL;	/* next node of the block (cyclic)   */
+static int	*bk_sink    = NULL;	/* sink of the class of each block   */
+static long	*bk_shift   = NULL;	/* shift of each class, by its sink  */
+static int	*bk_next    = NULL;	/* next node of each block to place  */
+static int	*bk_stack   = NULL;	/* blocks being placed               */
+static long	*bk_x       = NULL;	/* doubled center of each block      */
+static long	*bk_xs[4];		/* doubled centers of four layouts   */
+
+#define xralign(a)  ((((a)+G_xraster-1)/G_xraster)*G_xraster)
+#define dxralign(a) ((((a)+G_dxraster-1)/G_dxraster)*G_dxraster)
+
+#define IS_DUMMY(v) ((NWIDTH(v)==0)&&(NHEIGHT(v)==0))
+
+/* Doubled minimal distance of the centers of the neighbours v and w
+ */
+
+#define SEPARATION(v,w) ((long)NWIDTH(v)+(long)NWIDTH(w)+ \
+	(((NWIDTH(v)==0)||(NWIDTH(w)==0)) ? 2L*G_dspace : 2L*G_xspace))
+
+/* The same for the neighbours with the numbers v and w
+ */
+
+#define BK_SEP(v,w) ((v)<(w) ? bk_sep[w] : bk_sep[v])
+
+/* Shift of a class that has no constraint yet
+ */
+
+#define NO_SHIFT LONG_MAX
+
+
+/*--------------------------------------------------------------------*/
+/*  Coordinate assignment                                             */
+/*--------------------------------------------------------------------*/
+
+/*  Driver
+ *  ------
+ *  The layers must be complete and sorted (step 2), and the sizes of
+ *  the nodes must be calculated. The y coordinates are not touched.
+ */
+
+#ifdef ANSI_C
+void bk_coordinates(void)
+#else
+void bk_coordinates()
+#endif
+{
+	int	vdir, hdir;
+
+	debugmessage("bk_coordinates","");
+	gs_wait_message('m');
+
+	if (!collect_nodes()) return;
+	build_neighbours();
+	mark_conflicts();
+
+	for (vdir=0; vdir<2; vdir++)
+		for (hdir=0; hdir<2; hdir++) {
+			vertical_alignment(vdir,hdir);
+			horizontal_compaction(vdir,hdir,bk_xs[2*vdir+hdir]);
+		}
+
+	balance();
+	set_coordinates();
+	free_bk();
+}
+
+
+/*  Release the memory
+ *  ------------------
+ */
+
+#ifdef ANSI_C
+static void free_bk(void)
+#else
+static void free_bk()
+#endif
+{
+	int i;
+
+	if (bk_node)    free(bk_node);
+	if (bk_layer)   free(bk_layer);
+	if (bk_lstart)  free(bk_lstart);
+	if (bk_estart)  free(bk_estart);
+	if (bk_eend)    free(bk_eend);
+	if (bk_mark)    free(bk_mark);
+	if (bk_upstart) free(bk_upstart);
+	if (bk_up)      free(bk_up);
+	if (bk_upedge)  free(bk_upedge);
+	if (bk_dnstart) free(bk_dnstart);
+	if (bk_dn)      free(bk_dn);
+	if (bk_dnedge)  free(bk_dnedge);
+	if (bk_sep)     free(bk_sep);
+	if (bk_root)    free(bk_root);
+	if (bk_align)   free(bk_align);
+	if (bk_sink)    free(bk_sink);
+	if (bk_shift)   free(bk_shift);
+	if (bk_next)    free(bk_next);
+	if (bk_stack)   free(bk_stack);
+	if (bk_x)       free(bk_x);
+	for (i=0; i<4; i++) {
+		if (bk_xs[i]) free(bk_xs[i]);
+		bk_xs[i] = NULL;
+	}
+	bk_node  = NULL;
+	bk_layer = bk_lstart = bk_estart = bk_eend = NULL;
+	bk_upstart = bk_up = bk_upedge = NULL;
+	bk_dnstart = bk_dn = bk_dnedge = NULL;
+	bk_root  = bk_align = bk_sink = bk_next = bk_stack = NULL;
+	bk_mark  = NULL;
+	bk_sep   = bk_shift = bk_x = NULL;
+	bk_nnodes = bk_nlayers = bk_nedges = 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  The layered graph                                                 */
+/*--------------------------------------------------------------------*/
+
+/*  Index of a node
+ *  ---------------
+ *  returns -1, if the node is not in the layers.
+ */
+
+#ifdef ANSI_C
+static int node_index(GNODE v)
+#else
+static int node_index(v)
+GNODE	v;
+#endif
+{
+	long i;
+
+	if (!v) return(-1);
+	i = NDFS(v);
+	if ((i<0)||(i>=bk_nnodes)||(bk_node[i]!=v)) return(-1);
+	return((int)i);
+}
+
+
+/*  Collect the nodes
+ *  -----------------
+ *  in order of the layers, and number them by NDFS.
+ *  Returns 0 if there is nothing to do.
+ */
+
+#ifdef ANSI_C
+static int collect_nodes(void)
+#else
+static int collect_nodes()
+#endif
+{
+	GNLIST	li;
+	int	n, i, k;
+
+	n = 0;
+	for (i=0; i<=maxdepth+1; i++)
+		for (li=TSUCC(layer[i]); li; li=GNNEXT(li)) n++;
+	if (n<1) return(0);
+
+	bk_nlayers = maxdepth+2;
+	bk_node   = (GNODE *)malloc(n*sizeof(GNODE));
+	bk_layer  = (int *)malloc(n*sizeof(int));
+	bk_lstart = (int *)malloc((bk_nlayers+1)*sizeof(int));
+	bk_sep    = (long *)malloc(n*sizeof(long));
+	bk_root   = (int *)malloc(n*sizeof(int));
+	bk_align  = (int *)malloc(n*sizeof(int));
+	bk_sink   = (int *)malloc(n*sizeof(int));
+	bk_shift  = (long *)malloc(n*sizeof(long));
+	bk_next   = (int *)malloc(n*sizeof(int));
+	bk_stack  = (int *)malloc(n*sizeof(int));
+	bk_x      = (long *)malloc(n*sizeof(long));
+	if (  (!bk_node)||(!bk_layer)||(!bk_lstart)||(!bk_sep)
+	    ||(!bk_root)||(!bk_align)||(!bk_sink)||(!bk_shift)
+	    ||(!bk_next)||(!bk_stack)||(!bk_x))
+		Fatal_error("memory exhausted","");
+	for (i=0; i<4; i++) {
+		bk_xs[i] = (long *)malloc(n*sizeof(long));
+		if (!bk_xs[i]) Fatal_error("memory exhausted","");
+	}
+
+	k = 0;
+	for (i=0; i<bk_nlayers; i++) {
+		bk_lstart[i] = k;
+		for (li=TSUCC(layer[i]); li; li=GNNEXT(li)) {
+			bk_node[k]  = GNNODE(li);
+			bk_layer[k] = i;
+			if (k>bk_lstart[i])
+				bk_sep[k] = SEPARATION(bk_node[k-1],bk_node[k]);
+			else	bk_sep[k] = 0L;
+			k++;
+		}
+	}
+	bk_lstart[bk_nlayers] = k;
+	bk_nnodes = n;
+	for (i=0; i<n; i++) NDFS(bk_node[i]) = i;
+	return(1);
+}
+
+
+/*  Build the lists of neighbours
+ *  -----------------------------
+ *  Only edges between adjacent layers are used, independent of
+ *  their direction. Each edge gets a number, and the lists of upper
+ *  and lower neighbours of each node are sorted by position. Sorting
+ *  is done by two counting sorts, because the numbers of the nodes
+ *  are in order of the positions.
+ */
+
+#ifdef ANSI_C
+static void build_neighbours(void)
+#else
+static void build_neighbours()
+#endif
+{
+	ADJEDGE	a;
+	GNODE	v;
+	int	i, k, u, n, m, *order, *cnt;
+
+	n = bk_nnodes;
+
+	/* count the edges: for each node, the edges to the layer above */
+
+	m = 0;
+	for (i=0; i<n; i++) {
+		v = bk_node[i];
+		for (a=NPRED(v); a; a=ANEXT(a)) {
+			u = node_index(ESTART(AKANTE(a)));
+			if ((u>=0)&&(bk_layer[u]==bk_layer[i]-1)) m++;
+		}
+		for (a=NSUCC(v); a; a=ANEXT(a)) {
+			u = node_index(EEND(AKANTE(a)));
+			if ((u>=0)&&(bk_layer[u]==bk_layer[i]-1)) m++;
+		}
+	}
+
+	bk_nedges  = m;
+	bk_estart  = (int *)malloc((m+1)*sizeof(int));
+	bk_eend    = (int *)malloc((m+1)*sizeof(int));
+	bk_mark    = (char *)calloc(m+1,sizeof(char));
+	bk_upstart = (int *)calloc(n+1,sizeof(int));
+	bk_up      = (int *)malloc((m+1)*sizeof(int));
+	bk_upedge  = (int *)malloc((m+1)*sizeof(int));
+	bk_dnstart = (int *)calloc(n+1,sizeof(int));
+	bk_dn      = (int *)malloc((m+1)*sizeof(int));
+	bk_dnedge  = (int *)malloc((m+1)*sizeof(int));
+	order      = (int *)malloc((m+1)*sizeof(int));
+	cnt        = (int *)malloc((n+1)*sizeof(int));
+	if (  (!bk_estart)||(!bk_eend)||(!bk_mark)||(!bk_upstart)
+	    ||(!bk_up)||(!bk_upedge)||(!bk_dnstart)||(!bk_dn)
+	    ||(!bk_dnedge)||(!order)||(!cnt))
+		Fatal_error("memory exhausted","");
+
+	m = 0;
+	for (i=0; i<n; i++) {
+		v = bk_node[i];
+		for (a=NPRED(v); a; a=ANEXT(a)) {
+			u = node_index(ESTART(AKANTE(a)));
+			if ((u>=0)&&(bk_layer[u]==bk_layer[i]-1)) {
+				bk_estart[m] = u;
+				bk_eend[m++] = i;
+			}
+		}
+		for (a=NSUCC(v); a; a=ANEXT(a)) {
+			u = node_index(EEND(AKANTE(a)));
+			if ((u>=0)&&(bk_layer[u]==bk_layer[i]-1)) {
+				bk_estart[m] = u;
+				bk_eend[m++] = i;
+			}
+		}
+	}
+
+	/* The edges are already grouped by the lower node, in order of
+	 * the lower node. Thus, the lower neighbours are sorted, if we
+	 * distribute the edges in this order.
+	 */
+
+	for (k=0; k<m; k++) bk_dnstart[bk_estart[k]+1]++;
+	for (i=0; i<n; i++) bk_dnstart[i+1] += bk_dnstart[i];
+	for (i=0; i<n; i++) cnt[i] = bk_dnstart[i];
+	for (k=0; k<m; k++) {
+		u = bk_estart[k];
+		bk_dn[cnt[u]] = bk_eend[k];
+		bk_dnedge[cnt[u]++] = k;
+	}
+
+	/* Traversing the lower neighbours gives the edges in order of
+	 * the upper node.
+	 */
+
+	k = 0;
+	for (i=0; i<n; i++)
+		for (u=bk_dnstart[i]; u<bk_dnstart[i+1]; u++)
+			order[k++] = bk_dnedge[u];
+
+	for (k=0; k<m; k++) bk_upstart[bk_eend[k]+1]++;
+	for (i=0; i<n; i++) bk_upstart[i+1] += bk_upstart[i];
+	for (i=0; i<n; i++) cnt[i] = bk_upstart[i];
+	for (k=0; k<m; k++) {
+		u = bk_eend[order[k]];
+		bk_up[cnt[u]] = bk_estart[order[k]];
+		bk_upedge[cnt[u]++] = order[k];
+	}
+
+	free(order);
+	free(cnt);
+}
+
+
+/*  Mark type 1 conflicts
+ *  ---------------------
+ *  A type 1 conflict is a crossing between an inner segment and a
+ *  non-inner segment. We mark the non-inner segment, such that the
+ *  inner segments are aligned preferably. This is Alg. 1 of Brandes
+ *  and Koepf. For each layer, the inner segments are found from left
+ *  to right, and all segments between two inner segments that leave
+ *  the range of the upper end points of both are marked.
+ */
+
+#ifdef ANSI_C
+static void mark_conflicts(void)
+#else
+static void mark_conflicts()
+#endif
+{
+	int	i, v, w, vv, k, u, k0, k1, scan, first, last, upper;
+
+	for (i=1; i<bk_nlayers; i++) {
+		first = bk_lstart[i];
+		last  = bk_lstart[i+1]-1;
+		upper = bk_lstart[i-1];
+		k0    = 0;
+		scan  = first;
+		for (v=first; v<=last; v++) {
+			w = -1;
+			if (IS_DUMMY(bk_node[v])) {
+				for (k=bk_upstart[v]; k<bk_upstart[v+1]; k++)
+					if (IS_DUMMY(bk_node[bk_up[k]])) {
+						w = bk_up[k];
+						break;
+					}
+			}
+			if ((w<0)&&(v!=last)) continue;
+			if (w>=0) k1 = w - upper;
+			else	  k1 = first - upper;
+			for (vv=scan; vv<=v; vv++) {
+				for (k=bk_upstart[vv]; k<bk_upstart[vv+1]; k++) {
+					u = bk_up[k] - upper;
+					if (((u<k0)||(k1<u))
+					    && !(  IS_DUMMY(bk_node[bk_up[k]])
+						 &&IS_DUMMY(bk_node[vv])))
+						bk_mark[bk_upedge[k]] = 1;
+				}
+			}
+			scan = v+1;
+			k0 = k1;
+		}
+	}
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Alignment and compaction                                          */
+/*--------------------------------------------------------------------*/
+
+/*  Vertical alignment
+ *  ------------------
+ *  vdir = 0: top-down, i.e. align with the upper neighbours,
+ *  vdir = 1: bottom-up, i.e. align with the lower neighbours.
+ *  hdir = 0: from left to right, hdir = 1: from right to left.
+ *  Each node is aligned with one of its medians, if the edge is not
+ *  marked and if it does not cross the previous alignment of this
+ *  layer. This is Alg. 2 of Brandes and Koepf.
+ */
+
+#ifdef ANSI_C
+static void vertical_alignment(int vdir, int hdir)
+#else
+static void vertical_alignment(vdir, hdir)
+int	vdir;
+int	hdir;
+#endif
+{
+	int	i, l, j, v, w, d, m, idx, key, prev;
+	int	*nstart, *nb, *nbedge;
+
+	for (v=0; v<bk_nnodes; v++) bk_root[v] = bk_align[v] = v;
+
+	if (vdir==0) { nstart = bk_upstart; nb = bk_up; nbedge = bk_upedge; }
+	else	     { nstart = bk_dnstart; nb = bk_dn; nbedge = bk_dnedge; }
+
+	for (l=0; l<bk_nlayers; l++) {
+		i = (vdir==0) ? l : bk_nlayers-1-l;
+		prev = -bk_nnodes-1;
+		for (j=bk_lstart[i]; j<bk_lstart[i+1]; j++) {
+			v = (hdir==0) ? j : bk_lstart[i]+bk_lstart[i+1]-1-j;
+			d = nstart[v+1]-nstart[v];
+			if (d==0) continue;
+
+			/* the lower and the upper median */
+
+			for (m=(d-1)/2; m<=d/2; m++) {
+				if (bk_align[v]!=v) break;
+				idx = (hdir==0) ? nstart[v]+m : nstart[v+1]-1-m;
+				w   = nb[idx];
+				key = (hdir==0) ? w : -w;
+				if ((prev<key)&&(!bk_mark[nbedge[idx]])) {
+					bk_align[w] = v;
+					bk_root[v]  = bk_root[w];
+					bk_align[v] = bk_root[v];
+					prev = key;
+				}
+			}
+		}
+	}
+}
+
+
+/*  Neighbour in the layer
+ *  ----------------------
+ *  side = 0: the left neighbour of v, side = 1: the right neighbour.
+ *  Returns -1 if there is none.
+ */
+
+#ifdef ANSI_C
+static int neighbour(int v, int side)
+#else
+static int neighbour(v, side)
+int	v;
+int	side;
+#endif
+{
+	if (side==0) {
+		if (v==bk_lstart[bk_layer[v]]) return(-1);
+		return(v-1);
+	}
+	if (v==bk_lstart[bk_layer[v]+1]-1) return(-1);
+	return(v+1);
+}
+
+
+/*  Placement of the blocks
+ *  -----------------------
+ *  hdir = 0: the blocks are compacted to the left, hdir = 1: to the
+ *  right. In the following, left means the side hdir.
+ *  Each block is placed right of the blocks of the left neighbours
+ *  of its nodes, if they are in the same class. The class of a block
+ *  is the class of the first left neighbour of its nodes; a block
+ *  without left neighbours is the sink of a new class. The doubled
+ *  centers of the blocks relative to their sinks are stored into bk_x,
+ *  at the roots. This is place_block of Alg. 3 of Brandes and Koepf,
+ *  but with an explicit stack: the recursion could be as deep as the
+ *  number of blocks.
+ */
+
+#ifdef ANSI_C
+static void place_blocks(int hdir)
+#else
+static void place_blocks(hdir)
+int	hdir;
+#endif
+{
+	int	n, r, v, w, u, sp;
+	long	h;
+
+	n = bk_nnodes;
+	for (v=0; v<n; v++) {
+		bk_sink[v]  = v;
+		bk_shift[v] = NO_SHIFT;
+		bk_next[v]  = -1;
+	}
+
+	for (r=0; r<n; r++) {
+		if ((bk_root[r]!=r)||(bk_next[r]>=0)) continue;
+		bk_x[r]     = 0L;
+		bk_next[r]  = r;
+		sp = 0;
+		bk_stack[sp++] = r;
+		while (sp>0) {
+			v = bk_stack[sp-1];
+			w = bk_next[v];
+			u = neighbour(w,hdir);
+			if (u>=0) {
+				if (bk_next[bk_root[u]]<0) {
+
+					/* place the left block first, then
+					 * come back to w
+					 */
+
+					u = bk_root[u];
+					bk_x[u]    = 0L;
+					bk_next[u] = u;
+					bk_stack[sp++] = u;
+					continue;
+				}
+				h = bk_x[bk_root[u]] + BK_SEP(u,w);
+				u = bk_root[u];
+				if (bk_sink[v]==v) bk_sink[v] = bk_sink[u];
+				if ((bk_sink[v]==bk_sink[u])&&(h>bk_x[v]))
+					bk_x[v] = h;
+			}
+			w = bk_align[w];
+			if (w==v) sp--;
+			else	  bk_next[v] = w;
+		}
+	}
+}
+
+
+/*  Shifts of the classes
+ *  ---------------------
+ *  The layers are scanned in direction vdir. If the first node of a
+ *  layer (on the side hdir) is the sink of a class, the class gets the
+ *  shift 0 unless it has a shift already. Then we walk along the
+ *  border of the class: down each block to its last node, and right
+ *  to the next node of this layer as long as it is in the same class.
+ *  Each class left of a node on this way is shifted left far enough.
+ *  This is the second part of the corrected Alg. 3.
+ */
+
+#ifdef ANSI_C
+static void shift_classes(int vdir, int hdir)
+#else
+static void shift_classes(vdir, hdir)
+int	vdir;
+int	hdir;
+#endif
+{
+	int	l, i, v, w, u, s;
+	long	h;
+
+	for (l=0; l<bk_nlayers; l++) {
+		i = (vdir==0) ? l : bk_nlayers-1-l;
+		if (bk_lstart[i]==bk_lstart[i+1]) continue;
+		v = (hdir==0) ? bk_lstart[i] : bk_lstart[i+1]-1;
+		if ((bk_root[v]!=v)||(bk_sink[v]!=v)) continue;
+		if (bk_shift[v]==NO_SHIFT) bk_shift[v] = 0L;
+
+		w = v;
+		for (;;) {
+			while (bk_align[w]!=bk_root[w]) {
+				w = bk_align[w];
+				u = neighbour(w,hdir);
+				if (u<0) continue;
+				s = bk_sink[bk_root[u]];
+				h = bk_shift[bk_sink[bk_root[w]]] + bk_x[bk_root[w]]
+				    - bk_x[bk_root[u]] - BK_SEP(u,w);
+				if (h<bk_shift[s]) bk_shift[s] = h;
+			}
+			u = neighbour(w,1-hdir);
+			if (u<0) break;
+			if (bk_sink[bk_root[u]]!=bk_sink[bk_root[w]]) break;
+			w = u;
+		}
+	}
+}
+
+
+/*  Horizontal compaction
+ *  ---------------------
+ *  All nodes of a block get the position of the root of the block,
+ *  plus the shift of its class. The resulting doubled centers are
+ *  stored into xs.
+ */
+
+#ifdef ANSI_C
+static void horizontal_compaction(int vdir, int hdir, long *xs)
+#else
+static void horizontal_compaction(vdir, hdir, xs)
+int	vdir;
+int	hdir;
+long	*xs;
+#endif
+{
+	int	v, r;
+	long	h;
+
+	place_blocks(hdir);
+	shift_classes(vdir,hdir);
+
+	for (v=0; v<bk_nnodes; v++) {
+		r = bk_root[v];
+		h = bk_x[r];
+		if (bk_shift[bk_sink[r]]!=NO_SHIFT) h += bk_shift[bk_sink[r]];
+		if (hdir==0) xs[v] =  h;
+		else	     xs[v] = -h;
+	}
+}
+
+
+/*  Balancing
+ *  ---------
+ *  The four layouts are shifted such that the left-aligned ones have
+ *  the same minimum, and the right-aligned ones the same maximum as
+ *  the narrowest layout. Then each node gets the average of its two
+ *  median positions. The result is in bk_x, as doubled center.
+ */
+
+#ifdef ANSI_C
+static void balance(void)
+#else
+static void balance()
+#endif
+{
+	long	minx[4], maxx[4], c[4], h;
+	int	k, j, v, best;
+
+	for (k=0; k<4; k++) {
+		minx[k] = maxx[k] = bk_xs[k][0];
+		for (v=0; v<bk_nnodes; v++) {
+			h = bk_xs[k][v] - NWIDTH(bk_node[v]);
+			if (h<minx[k]) minx[k] = h;
+			h = bk_xs[k][v] + NWIDTH(bk_node[v]);
+			if (h>maxx[k]) maxx[k] = h;
+		}
+	}
+	best = 0;
+	for (k=1; k<4; k++)
+		if (maxx[k]-minx[k]<maxx[best]-minx[best]) best = k;
+
+	for (k=0; k<4; k++) {
+		if ((k&1)==0) h = minx[best]-minx[k];
+		else	      h = maxx[best]-maxx[k];
+		if (h==0L) continue;
+		for (v=0; v<bk_nnodes; v++) bk_xs[k][v] += h;
+	}
+
+	for (v=0; v<bk_nnodes; v++) {
+		for (k=0; k<4; k++) {
+			h = bk_xs[k][v];
+			for (j=k; (j>0)&&(c[j-1]>h); j--) c[j] = c[j-1];
+			c[j] = h;
+		}
+		bk_x[v] = (c[1]+c[2])/2;
+	}
+}
+
+
+/*  Set the coordinates
+ *  -------------------
+ *  The leftmost node is placed at G_xbase, and the nodes are aligned
+ *  to the raster. Rounding may violate the minimal distances; thus
+ *  we move each node to the right if it is too near to its left
+ *  neighbour.
+ */
+
+#ifdef ANSI_C
+static void set_coordinates(void)
+#else
+static void set_coordinates()
+#endif
+{
+	GNODE	v, w;
+	long	minx, h;
+	int	i, j, x;
+
+	minx = bk_x[0]-NWIDTH(bk_node[0]);
+	for (j=1; j<bk_nnodes; j++)
+		if (bk_x[j]-NWIDTH(bk_node[j])<minx)
+			minx = bk_x[j]-NWIDTH(bk_node[j]);
+
+	for (i=0; i<bk_nlayers; i++) {
+		w = NULL;
+		for (j=bk_lstart[i]; j<bk_lstart[i+1]; j++) {
+			v = bk_node[j];
+			h = (bk_x[j]-NWIDTH(v)-minx)/2;
+			x = G_xbase + (int)h;
+			if (w) {
+				if ((NWIDTH(v)==0)||(NWIDTH(w)==0)) {
+					if (x<NX(w)+NWIDTH(w)+G_dspace)
+						x = NX(w)+NWIDTH(w)+G_dspace;
+				}
+				else if (x<NX(w)+NWIDTH(w)+G_xspace)
+					x = NX(w)+NWIDTH(w)+G_xspace;
+			}
+			if (IS_DUMMY(v)) NX(v) = dxralign(x+NWIDTH(v)/2)-NWIDTH(v)/2;
+			else		 NX(v) = xralign(x+NWIDTH(v)/2)-NWIDTH(v)/2;
+			w = v;
+		}
+	}
+}
+
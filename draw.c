@@ -134,6 +134,7 @@ static char *id_string="$Id: draw.c,v 3.8 1995/02/08 11:11:14 sander Exp $";
 #include "drawstr.h"
 #include "drawlib.h"
 #include "draw.h"
+#include "spatial.h"
 #include "timing.h"
 
 
@@ -143,6 +144,9 @@ static char *id_string="$Id: draw.c,v 3.8 1995/02/08 11:11:14 sander Exp $";
 
 static	void	draw_nodes	_PP((void));
 static	void	draw_edges	_PP((void));
+static	void	draw_window_nodes _PP((void));
+static	void	draw_window_edges _PP((void));
+static	void	draw_one_edge	_PP((GEDGE e));
 
 /*--------------------------------------------------------------------*/
 /*   Draw main routine						      */
@@ -182,6 +186,7 @@ static	void	draw_nodes()
 	debugmessage("draw_nodes","");
 	
 	if (supress_nodes) return;
+	if (window_culling(0)) { draw_window_nodes(); return; }
 	v = nodelist;
 	while (v) {
 		if (NWIDTH(v)==0) { v = NNEXT(v); continue; }
@@ -190,7 +195,7 @@ static	void	draw_nodes()
 		gs_setto(NX(v) * G_stretch / G_shrink,
 			 NY(v) * G_stretch / G_shrink );
 
-		draw_one_node(v);
+		if (!gs_lodnode(v,1)) draw_one_node(v);
 		v = NNEXT(v);
 	}
 	
@@ -201,7 +206,7 @@ static	void	draw_nodes()
 			     G_shrink  * NSHRINK(v)  );
 		gs_setto(NX(v) * G_stretch / G_shrink,
 			 NY(v) * G_stretch / G_shrink );
-		gs_stringbox(v);
+		if (!gs_lodnode(v,0)) gs_stringbox(v);
 		v = NNEXT(v);
 	}
 #undef DEBUGDUMMY
@@ -235,6 +240,41 @@ static	void	draw_nodes()
 	}
 }
 
+/* Draw the nodes of the visible window
+ * ------------------------------------
+ * The same as draw_nodes, but only for the nodes that the spatial
+ * index finds in the visible window. The order is the same.
+ */
+
+#ifdef ANSI_C
+static	void	draw_window_nodes(void)
+#else
+static	void	draw_window_nodes()
+#endif
+{
+	GNODE v;
+	GNODE *vl;
+	char  *cl;
+	int   i, n;
+
+	debugmessage("draw_window_nodes","");
+
+	n = window_nodes(&vl, &cl);
+	for (i=0; i<n; i++) {
+		v = vl[i];
+		if (cl[i]==SP_ANCHOR) { gs_anchornode(v); continue; }
+		if (NWIDTH(v)==0) continue;
+		gs_setshrink(G_stretch * NSTRETCH(v),
+			     G_shrink  * NSHRINK(v)  );
+		gs_setto(NX(v) * G_stretch / G_shrink,
+			 NY(v) * G_stretch / G_shrink );
+		if (gs_lodnode(v, cl[i]==SP_NODE)) continue;
+		if (cl[i]==SP_NODE) draw_one_node(v);
+		else		    gs_stringbox(v);
+	}
+}
+
+
 /* Draw one node
  * -------------
  * at actual postion with actual scaling.
@@ -310,6 +350,7 @@ static	void	draw_edges()
 	debugmessage("draw_edges","");
 
 	if (supress_edges) return;
+	if (window_culling(1)) { draw_window_edges(); return; }
 	v = nodelist;
 	while (v) {
 		c = NCONNECT(v);
@@ -452,3 +493,48 @@ static	void	draw_edges()
 
 
 
+
+/* Draw the edges of the visible window
+ * ------------------------------------
+ * The same as draw_edges, but only for the edges that the spatial
+ * index finds in the visible window. The order is the same.
+ */
+
+#ifdef ANSI_C
+static	void	draw_window_edges(void)
+#else
+static	void	draw_window_edges()
+#endif
+{
+	GEDGE *el;
+	int   i, n;
+
+	debugmessage("draw_window_edges","");
+
+	n = window_edges(&el);
+	for (i=0; i<n; i++) draw_one_edge(el[i]);
+}
+
+
+/* Draw one edge
+ * -------------
+ */
+
+#ifdef ANSI_C
+static	void	draw_one_edge(GEDGE e)
+#else
+static	void	draw_one_edge(e)
+GEDGE e;
+#endif
+{
+	switch (ELSTYLE(e)) {
+	case SOLID:  gs_solidarrow(e);
+		     break;
+	case DASHED: gs_dashedarrow(e);
+		     break;
+	case DOTTED: gs_dottedarrow(e);
+		     break;
+	case UNVISIBLE: break;
+	}
+}
+
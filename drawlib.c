@@ -126,6 +126,8 @@ static char *id_string="$Id: drawlib.c,v 3.13 1995/02/08 11:11:14 sander Exp $";
  *    gs_solidarrow   	      draw solid  edge e with global scaling.
  *    gs_dashedarrow	      draw dashed edge e with global scaling.
  *    gs_dottedarrow	      draw dotted edge e with global scaling.
+ *    gs_lodnode(v,f)	      draw a small node v as filled rectangle.
+ *    gs_lodedge(e)	      draw edge e with small arrows as plain line.
  *
  * One important remark: string and texbox output is done with the
  * scaling factor we have set by gs_setshrink. The global values
@@ -244,6 +246,12 @@ static void check_special_dummy   _PP((GNODE node, GNODE sn, int x1, int y1));
 static void check_border_points   _PP((GNODE v,int x1,int y1));
 static void check_spline_point    _PP((int kx,int ky,int x1,int y1));
 
+static void fe_corners2 _PP((int x,int y,int w,int h,
+			     int *x1,int *y1,int *x2,int *y2));
+static void fe_corners4 _PP((int x,int y,int w,int h,
+			     int *x1,int *y1,int *x2,int *y2,
+			     int *x3,int *y3,int *x4,int *y4));
+
 
 #ifndef INCLUDE_DRAW
 #ifdef X11
@@ -292,6 +300,61 @@ static int	yoffset[51] =
 
 
 
+/*--------------------------------------------------------------------*/
+/*   Corners of nodes in the fisheye views			      */
+/*--------------------------------------------------------------------*/
+
+/* The node drawing routines check the size of the node on the screen
+ * before they draw it. The corners are transformed together by
+ * fe_g_to_s_n: fe_corners2 gives the top left and the bottom right
+ * corner, fe_corners4 all corners counterclockwise from the top left.
+ */
+
+#ifdef ANSI_C
+static void fe_corners2(int x,int y,int w,int h,
+			int *x1,int *y1,int *x2,int *y2)
+#else
+static void fe_corners2(x,y,w,h,x1,y1,x2,y2)
+int x,y,w,h;
+int *x1,*y1,*x2,*y2;
+#endif
+{
+	long gx[2], gy[2];
+	int  sx[2], sy[2];
+
+	gx[0] = x;   gy[0] = y;
+	gx[1] = x+w; gy[1] = y+h;
+	fe_g_to_s_n(gx,gy,sx,sy,2);
+	*x1 = sx[0]; *y1 = sy[0];
+	*x2 = sx[1]; *y2 = sy[1];
+}
+
+
+#ifdef ANSI_C
+static void fe_corners4(int x,int y,int w,int h,
+			int *x1,int *y1,int *x2,int *y2,
+			int *x3,int *y3,int *x4,int *y4)
+#else
+static void fe_corners4(x,y,w,h,x1,y1,x2,y2,x3,y3,x4,y4)
+int x,y,w,h;
+int *x1,*y1,*x2,*y2,*x3,*y3,*x4,*y4;
+#endif
+{
+	long gx[4], gy[4];
+	int  sx[4], sy[4];
+
+	gx[0] = x;   gy[0] = y;
+	gx[1] = x;   gy[1] = y+h;
+	gx[2] = x+w; gy[2] = y+h;
+	gx[3] = x+w; gy[3] = y;
+	fe_g_to_s_n(gx,gy,sx,sy,4);
+	*x1 = sx[0]; *y1 = sy[0];
+	*x2 = sx[1]; *y2 = sy[1];
+	*x3 = sx[2]; *y3 = sy[2];
+	*x4 = sx[3]; *y4 = sy[3];
+}
+
+
 /*--------------------------------------------------------------------*/
 /*   Testbox drawing						      */
 /*--------------------------------------------------------------------*/
@@ -383,8 +446,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -400,10 +462,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -520,8 +579,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -537,10 +595,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -659,8 +714,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -676,10 +730,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -791,8 +842,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (colored) gs_rectangle(x,y,w,h,NCOLOR(v));
@@ -802,10 +852,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -906,8 +953,7 @@ GEDGE	e;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (colored) gs_rectangle(x,y,w,h,G_color);
@@ -917,10 +963,7 @@ GEDGE	e;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -1097,8 +1140,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-		fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -1114,10 +1156,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -1255,8 +1294,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -1272,10 +1310,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -1412,8 +1447,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -1429,10 +1463,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -1641,8 +1672,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -1658,10 +1688,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -1836,8 +1863,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -1853,10 +1879,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -2031,8 +2054,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -2048,10 +2070,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -2322,8 +2341,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -2339,10 +2357,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -2459,8 +2474,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-		fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -2476,10 +2490,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -2596,8 +2607,7 @@ GNODE	v;
 		break;
 	case CSCF_VIEW:
 	case FCSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x+w, y+h, &x2, &y2);
+		fe_corners2(x,y,w,h,&x1,&y1,&x2,&y2);
 		if ((x2-x1<=0) || (y2-y1<=0)) return;
 		if ((x2-x1<=3) || (y2-y1<=3)) {
 			if (NBORDERW(v)==0) {
@@ -2613,10 +2623,7 @@ GNODE	v;
 		break;
 	case PSCF_VIEW:
 	case FPSCF_VIEW:
-	 	fe_g_to_s(x,   y,   &x1, &y1);
-		fe_g_to_s(x,   y+h, &x2, &y2);
-		fe_g_to_s(x+w, y+h, &x3, &y3);
-		fe_g_to_s(x+w, y,   &x4, &y4);
+		fe_corners4(x,y,w,h,&x1,&y1,&x2,&y2,&x3,&y3,&x4,&y4);
 		if (  ((y2-y1<=0)&&(y3-y4<=0))
 		    ||((x4-x1<=0)&&(x3-x2<=0))) return;
 		if (  ((y2-y1<=3)&&(y3-y4<=3))
@@ -3175,6 +3182,129 @@ GEDGE e;
 #endif /* X11 */
 #endif /* not INCLUDE_DRAW */
 
+/*--------------------------------------------------------------------*/
+/*   Level of detail						      */
+/*--------------------------------------------------------------------*/
+
+/*  Draw a small node with less detail
+ *  ----------------------------------
+ *  If the width or the height of node v is smaller than lod_pixels at
+ *  the actual scaling, it is drawn as a filled rectangle
+ *  without border and text, like the very small nodes in gs_textbox.
+ *  If fill is 0, nothing is drawn (label nodes consist only of text).
+ *  Returns 1 if the node is done, and 0 if it must be drawn with full
+ *  detail.
+ */
+
+#ifdef ANSI_C
+int	gs_lodnode(GNODE v, int fill)
+#else
+int	gs_lodnode(v, fill)
+GNODE	v;
+int	fill;
+#endif
+{
+	int	x,y,w,h;
+
+	if ((lod_pixels<=0) || (fisheye_view!=0)) return(0);
+	h = NHEIGHT(v)*G_stretch/G_shrink;
+	w = NWIDTH(v) *G_stretch/G_shrink;
+	if ((w>=lod_pixels) && (h>=lod_pixels)) return(0);
+	if (!fill) return(1);
+
+	x = myxpos;
+	y = myypos;
+
+	/* check visibility */
+	if (x	>=V_xmax)    return(1);
+	if (y	>=V_ymax)    return(1);
+	if (x+w < V_xmin)    return(1);
+	if (y+h < V_ymin)    return(1);
+
+	if (x	< V_xmin)    { w = x+w-V_xmin; x = V_xmin; }
+	if (x+w >=V_xmax)    w = V_xmax-x-1;
+	if (y	< V_ymin)    { h = y+h-V_ymin; y = V_ymin; }
+	if (y+h >=V_ymax)    h = V_ymax-y-1;
+
+	if (NBORDERW(v)==0) {
+		if (colored) gs_rectangle(x,y,w,h,NCOLOR(v));
+		else         gs_rectangle(x,y,w,h,WHITE);
+	}
+	else {
+		if (colored) gs_rectangle(x,y,w,h,NBCOLOR(v));
+		else         gs_rectangle(x,y,w,h,BLACK);
+	}
+	return(1);
+}
+
+
+/*  Draw an edge with less detail
+ *  -----------------------------
+ *  If the arrowheads of e are smaller than lod_pixels at the actual
+ *  scaling, the edge is drawn as a solid line without arrowheads and
+ *  labels. Collinear parts of the line start - top bend - bottom
+ *  bend - end are merged into one segment. Returns 1 if the edge is
+ *  done, and 0 if it must be drawn with full detail.
+ *  Anchor edges are always drawn with full detail, because their
+ *  lines start at the anchor points of the node.
+ */
+
+#ifdef ANSI_C
+int	gs_lodedge(GEDGE e)
+#else
+int	gs_lodedge(e)
+GEDGE	e;
+#endif
+{
+	int	px[4], py[4];
+	int	i, n, t, c;
+
+	if ((lod_pixels<=0) || (fisheye_view!=0)) return(0);
+	if (EANCHOR(e)==66) return(0);
+	if (EARROWSIZE(e) *G_stretch/G_shrink >= lod_pixels) return(0);
+	if (EARROWBSIZE(e)*G_stretch/G_shrink >= lod_pixels) return(0);
+
+	t  = (ETHICKNESS(e)*G_stretch)/G_shrink;
+	if ( t==0 )	t = 1;
+	c  = ECOLOR(e);
+	if (!colored) c = BLACK;
+
+	px[0] = ESTARTX(e) * G_stretch/G_shrink;
+	py[0] = ESTARTY(e) * G_stretch/G_shrink;
+	n = 1;
+	for (i=1; i<4; i++) {
+		switch (i) {
+		case 1: px[n] = ETBENDX(e) * G_stretch/G_shrink;
+			py[n] = ETBENDY(e) * G_stretch/G_shrink;
+			break;
+		case 2: px[n] = EBBENDX(e) * G_stretch/G_shrink;
+			py[n] = EBBENDY(e) * G_stretch/G_shrink;
+			break;
+		case 3: px[n] = EENDX(e) * G_stretch/G_shrink;
+			py[n] = EENDY(e) * G_stretch/G_shrink;
+			break;
+		}
+		/* drop points that are equal to the previous one */
+		if ((px[n]==px[n-1]) && (py[n]==py[n-1])) continue;
+		/* drop the previous point if it is on the line and the
+		 * line does not turn back
+		 */
+		if ((n>=2) && ((long)(px[n-1]-px[n-2])*(long)(py[n]-py[n-1])
+			    == (long)(py[n-1]-py[n-2])*(long)(px[n]-px[n-1]))
+		    && ((long)(px[n-1]-px[n-2])*(long)(px[n]-px[n-1])
+			+ (long)(py[n-1]-py[n-2])*(long)(py[n]-py[n-1]) > 0)) {
+			px[n-1] = px[n];
+			py[n-1] = py[n];
+			continue;
+		}
+		n++;
+	}
+	for (i=1; i<n; i++)
+		gs_mysolidline(px[i-1],py[i-1],px[i],py[i],t,c);
+	return(1);
+}
+
+
 /*--------------------------------------------------------------------*/
 /*   Solid arrow drawing					      */
 /*--------------------------------------------------------------------*/
@@ -3196,6 +3326,7 @@ GEDGE	e;
 	int	x1, x2, y1, y2, x3, y3, x4, y4, c;
 	int	t,topbend,botbend;
 
+	if (gs_lodedge(e)) return;
 	if (G_spline) { draw_spline(e,1); return; }
 
 	gbl_x1 = x1 = ESTARTX(e) * G_stretch/G_shrink;
@@ -3633,6 +3764,7 @@ GEDGE	e;
 	int	x1, x2, y1, y2, x3, y3, x4, y4, c;
 	int	t,topbend,botbend;
 
+	if (gs_lodedge(e)) return;
 	if (G_spline) { draw_spline(e,1); return; }
 
 	gbl_x1 = x1 = ESTARTX(e) * G_stretch/G_shrink;
@@ -4385,6 +4517,7 @@ GEDGE	e;
 	int	x1, x2, y1, y2, x3, y3, x4, y4, c;
 	int	t,topbend,botbend;
 
+	if (gs_lodedge(e)) return;
 	if (G_spline) { draw_spline(e,1); return; }
 
 	gbl_x1 = x1 = ESTARTX(e) * G_stretch/G_shrink;
@@ -138,6 +138,8 @@ void 	gs_anchornode		_PP((GNODE v));
 void	gs_solidarrow		_PP((GEDGE e));
 void	gs_dashedarrow		_PP((GEDGE e));
 void	gs_dottedarrow		_PP((GEDGE e));
+int	gs_lodnode		_PP((GNODE v, int fill));
+int	gs_lodedge		_PP((GEDGE e));
 
 #ifndef INCLUDE_DRAW
 #ifdef X11
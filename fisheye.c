@@ -77,12 +77,26 @@ static char *id_string="$Id: fisheye.c,v 1.3 1995/02/08 16:29:00 sander Exp $";
  * The carthesian fisheyes do not preserve angles, while the polar
  * fisheyes preserves at least the angle between rays starting at the
  * focus point.
+ *
+ * fe_g_to_s transforms one point. fe_g_to_s_n transforms an array of
+ * points, e.g. all corners of a node or all points of an edge segment,
+ * with the same results. For the polar fisheyes, it calculates 2
+ * (SSE2) or 4 (AVX) points at once, if the compiler supports it. The
+ * carthesian fisheyes mostly look up the coordinate hash tables.
  ***************************************************************************/
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef __AVX__
+#define FE_AVX
+#include <immintrin.h>
+#endif
 #include "globals.h"
 #include "grammar.h"
 #include "main.h"
@@ -114,6 +128,7 @@ static void normalize_fe_parameters _PP((void));
 static int  change_pscf_sfocus  _PP((void));
 static int  change_pscf_gfocus  _PP((long gfx, long gfy));
 static void pscf_g_to_s _PP((long x, long y, int *resx, int *resy));
+static void pscf_g_to_s_n _PP((long *x, long *y, int *resx, int *resy, int n));
 
 
 /* Global Variables
@@ -1444,6 +1459,104 @@ static void pscf_g_to_s(x, y, resx, resy)
 
 
 
+/*  Translate n x,y-coordinates of the graph into x,y-coordinates of the screen
+ *  ---------------------------------------------------------------------------
+ *  The same operations as pscf_g_to_s in the same order, thus the
+ *  results are identical. The packed double operations of SSE2 and
+ *  AVX are rounded as the scalar ones, and convert by truncation.
+ */
+
+#ifdef ANSI_C
+static void pscf_g_to_s_n(long *x, long *y, int *resx, int *resy, int n)
+#else
+static void pscf_g_to_s_n(x, y, resx, resy, n)
+	long *x, *y;
+	int *resx, *resy;
+	int n;
+#endif
+{
+	int i;
+#ifdef FE_AVX
+	__m256d ap, as, ahund, apoint1, azero, axd, ayd, ad1, ad2, ah, am;
+	__m128i arx, ary, asx, asy;
+#endif
+#ifdef FE_SSE2
+	__m128d p, sc, hund, point1, zero, xd, yd, d1, d2, h, m;
+	__m128i rx, ry, sx, sy;
+	int r[4];
+#endif
+
+	i = 0;
+
+#ifdef FE_AVX
+	ap      = _mm256_set1_pd(par_p);
+	as      = _mm256_set1_pd((double)fe_scaling);
+	ahund   = _mm256_set1_pd(100.0);
+	apoint1 = _mm256_set1_pd(0.1);
+	azero   = _mm256_setzero_pd();
+	asx     = _mm_set1_epi32(sfocus_x);
+	asy     = _mm_set1_epi32(sfocus_y);
+	for (; i+4<=n; i+=4) {
+		axd = _mm256_set_pd((double)(x[i+3]-gfocus_x),
+				    (double)(x[i+2]-gfocus_x),
+				    (double)(x[i+1]-gfocus_x),
+				    (double)(x[i]  -gfocus_x));
+		ayd = _mm256_set_pd((double)(y[i+3]-gfocus_y),
+				    (double)(y[i+2]-gfocus_y),
+				    (double)(y[i+1]-gfocus_y),
+				    (double)(y[i]  -gfocus_y));
+		ad1 = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(axd,axd),
+						   _mm256_mul_pd(ayd,ayd)));
+		ah  = _mm256_add_pd(_mm256_mul_pd(ap,ad1), ahund);
+		am  = _mm256_cmp_pd(ah, azero, _CMP_LE_OQ);
+		ah  = _mm256_blendv_pd(ah, apoint1, am);
+		ad2 = _mm256_div_pd(_mm256_mul_pd(as,ad1), ah);
+		am  = _mm256_cmp_pd(ad1, azero, _CMP_NEQ_UQ);
+		ad2 = _mm256_blendv_pd(ad2, _mm256_div_pd(ad2,ad1), am);
+		arx = _mm_add_epi32(asx,
+			_mm256_cvttpd_epi32(_mm256_mul_pd(axd,ad2)));
+		ary = _mm_add_epi32(asy,
+			_mm256_cvttpd_epi32(_mm256_mul_pd(ayd,ad2)));
+		_mm_storeu_si128((__m128i *)(resx+i), arx);
+		_mm_storeu_si128((__m128i *)(resy+i), ary);
+	}
+#endif
+
+#ifdef FE_SSE2
+	p      = _mm_set1_pd(par_p);
+	sc     = _mm_set1_pd((double)fe_scaling);
+	hund   = _mm_set1_pd(100.0);
+	point1 = _mm_set1_pd(0.1);
+	zero   = _mm_setzero_pd();
+	sx     = _mm_set1_epi32(sfocus_x);
+	sy     = _mm_set1_epi32(sfocus_y);
+	for (; i+2<=n; i+=2) {
+		xd = _mm_set_pd((double)(x[i+1]-gfocus_x),
+				(double)(x[i]  -gfocus_x));
+		yd = _mm_set_pd((double)(y[i+1]-gfocus_y),
+				(double)(y[i]  -gfocus_y));
+		d1 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xd,xd),
+					    _mm_mul_pd(yd,yd)));
+		h  = _mm_add_pd(_mm_mul_pd(p,d1), hund);
+		m  = _mm_cmple_pd(h, zero);
+		h  = _mm_or_pd(_mm_and_pd(m,point1), _mm_andnot_pd(m,h));
+		d2 = _mm_div_pd(_mm_mul_pd(sc,d1), h);
+		m  = _mm_cmpneq_pd(d1, zero);
+		d2 = _mm_or_pd(_mm_and_pd(m,_mm_div_pd(d2,d1)),
+			       _mm_andnot_pd(m,d2));
+		rx = _mm_add_epi32(sx, _mm_cvttpd_epi32(_mm_mul_pd(xd,d2)));
+		ry = _mm_add_epi32(sy, _mm_cvttpd_epi32(_mm_mul_pd(yd,d2)));
+		_mm_storeu_si128((__m128i *)r, _mm_unpacklo_epi64(rx,ry));
+		resx[i] = r[0]; resx[i+1] = r[1];
+		resy[i] = r[2]; resy[i+1] = r[3];
+	}
+#endif
+
+	for (; i<n; i++) pscf_g_to_s(x[i],y[i],&(resx[i]),&(resy[i]));
+}
+
+
+
 /*  Translate a x,y-coordinate of the screen into a x,y-coordinate of the graph
  *  ---------------------------------------------------------------------------
  */
@@ -1861,6 +1974,46 @@ void fe_g_to_s(x, y, resx, resy)
 }
 
 
+/*  Translate n x,y-coords. of the graph into x,y-coords. of the screen
+ *  -------------------------------------------------------------------
+ *  The point (x[i],y[i]) becomes (resx[i],resy[i]), as by fe_g_to_s.
+ */
+
+#ifdef ANSI_C
+void fe_g_to_s_n(long *x, long *y, int *resx, int *resy, int n)
+#else
+void fe_g_to_s_n(x, y, resx, resy, n)
+	long *x, *y;
+	int *resx, *resy;
+	int n;
+#endif
+{
+	int i;
+
+	switch (fisheye_view) {
+	case FPSCF_VIEW:
+	case PSCF_VIEW:
+		if ((xcoord_hash) && (xhashmin<=xhashmax)) break;
+		if ((ycoord_hash) && (yhashmin<=yhashmax)) break;
+		pscf_g_to_s_n(x,y,resx,resy,n);
+		return;
+	case FCSCF_VIEW:
+	case CSCF_VIEW:
+		if ((!xcoord_hash) || (!ycoord_hash)) break;
+		for (i=0; i<n; i++) {
+			if (   (x[i]>=xhashmin) && (x[i]<=xhashmax)
+			    && (y[i]>=yhashmin) && (y[i]<=yhashmax)) {
+				resx[i] = (int)xcoord_hash[x[i]];
+				resy[i] = (int)ycoord_hash[y[i]];
+			}
+			else fe_g_to_s(x[i],y[i],&(resx[i]),&(resy[i]));
+		}
+		return;
+	}
+	for (i=0; i<n; i++) fe_g_to_s(x[i],y[i],&(resx[i]),&(resy[i]));
+}
+
+
 /*  Translate a x,y-coord. of the screen into a x,y-coord. of the graph
  *  -------------------------------------------------------------------
  */
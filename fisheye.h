@@ -94,6 +94,7 @@ int incr_fe_focus      _PP((long dfx, long dfy));
 int  change_fe_winsize _PP((int sxmin, int sxmax, int symin, int symax));
 int  set_gfishdist     _PP((long gd));
 void fe_g_to_s 	       _PP((long x, long y, int  *resx, int  *resy));
+void fe_g_to_s_n       _PP((long *x, long *y, int *resx, int *resy, int n));
 void fe_s_to_g         _PP((int  x, int  y, long *resx, long *resy));
 
 /*--------------------------------------------------------------------*/
@@ -0,0 +1,233 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         gdlmap.c                                           */
+/*   description:  Input file in memory for the scanner               */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * Usually, the scanner reads the specification through stdio into its
+ * own buffer of 16 KB, and copies the rest of a partial token to the
+ * front of the buffer each time it is refilled.
+ *
+ * Here, a regular input file is mapped into memory as a whole, and
+ * the scanner works directly on the mapped file (see init_lex_mapped
+ * in grammar.l). The tokens are scanned in place; the strings are
+ * interned by the scanner anyway (HashInsert), i.e. each title or
+ * label is copied once into the string heap.
+ *
+ * The scanner needs two NUL characters behind the input, and it
+ * writes a NUL behind each token temporarily. Thus the mapping is
+ * private (copy on write), and we reserve one page more if the
+ * file ends at a page boundary. Where mmap is not available
+ * (Windows), the file is read by one fread into a buffer instead,
+ * which is scanned in place as well.
+ * Input from stdin or from pipes is scanned through stdio as before.
+ *
+ * This file provides the following functions:
+ *
+ * map_input_file	map the file and set up the scanner to read it.
+ *			Returns 0 if the stdio path must be used.
+ * unmap_input_file	release the mapping after parsing.
+ * mapped_input		the contents of the input file, as long as
+ *			it is mapped and not yet parsed.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+#include "globals.h"
+#include "grammar.h"
+#include "main.h"
+#include "gdlmap.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+#ifndef _WIN32
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+#endif
+
+
+/* Global variables
+ * ================
+ */
+
+#define MAP_NONE  0	/* nothing mapped                       */
+#define MAP_MMAP  1	/* the file is mapped by mmap           */
+#define MAP_COPY  2	/* the file is read into a malloc block */
+
+static int    map_kind = MAP_NONE;
+static char  *map_base = NULL;	/* the input, followed by two NULs */
+static long   map_size = 0L;	/* the number of characters        */
+static size_t map_len  = 0;	/* the length of the mmap region   */
+
+
+/*--------------------------------------------------------------------*/
+/*  Mapping of the input                                              */
+/*--------------------------------------------------------------------*/
+
+/*  Read the file by one fread
+ *  --------------------------
+ *  This is the fallback if the file cannot be mapped.
+ */
+
+#ifdef ANSI_C
+static int copy_input_file(FILE *f, long size)
+#else
+static int copy_input_file(f, size)
+FILE *f;
+long size;
+#endif
+{
+	char *b;
+
+	b = (char *)malloc((size_t)size+2);
+	if (!b) return(0);
+	if (fread(b,1,(size_t)size,f)!=(size_t)size) {
+		free(b);
+		(void)fseek(f,0L,SEEK_SET);
+		return(0);
+	}
+	(void)fseek(f,0L,SEEK_SET);
+	b[size] = b[size+1] = 0;
+	map_base = b;
+	map_kind = MAP_COPY;
+	return(1);
+}
+
+
+/*  Map the file
+ *  ------------
+ *  f is the opened input file, positioned at its start.
+ */
+
+#ifdef ANSI_C
+int map_input_file(FILE *f)
+#else
+int map_input_file(f)
+FILE *f;
+#endif
+{
+	long size;
+#ifndef _WIN32
+	struct stat st;
+	long page;
+	char *b;
+	int fd;
+#endif
+
+	debugmessage("map_input_file","");
+	unmap_input_file();
+	if ((!f)||(f==stdin)) return(0);
+
+#ifdef _WIN32
+	if (fseek(f,0L,SEEK_END)!=0) return(0);
+	size = ftell(f);
+	if (fseek(f,0L,SEEK_SET)!=0) return(0);
+	if ((size<=0)||(size>INT_MAX-2)) return(0);
+	if (!copy_input_file(f,size)) return(0);
+#else
+	fd = fileno(f);
+	if (fstat(fd,&st)!=0) return(0);
+	if (!S_ISREG(st.st_mode)) return(0);
+	if ((st.st_size<=0)||(st.st_size>INT_MAX-2)) return(0);
+	size = (long)st.st_size;
+
+	/* Reserve zero pages for the input and the two NULs,
+	 * then map the file over the first of them.
+	 */
+
+	page = sysconf(_SC_PAGESIZE);
+	if (page<=0) page = 4096;
+	map_len = (size_t)(((size+2+page-1)/page)*page);
+	b = (char *)mmap(NULL,map_len,PROT_READ|PROT_WRITE,
+			 MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	if (b==(char *)MAP_FAILED) {
+		if (!copy_input_file(f,size)) return(0);
+	}
+	else if (mmap(b,(size_t)size,PROT_READ|PROT_WRITE,
+		      MAP_PRIVATE|MAP_FIXED|MAP_POPULATE,fd,0)==MAP_FAILED) {
+		(void)munmap(b,map_len);
+		if (!copy_input_file(f,size)) return(0);
+	}
+	else {
+		map_base = b;
+		map_kind = MAP_MMAP;
+	}
+#endif
+
+	map_size = size;
+	init_lex_mapped(map_base,map_size);
+	return(1);
+}
+
+
+/*  Release the mapping
+ *  -------------------
+ */
+
+#ifdef ANSI_C
+void unmap_input_file(void)
+#else
+void unmap_input_file()
+#endif
+{
+	debugmessage("unmap_input_file","");
+	if (map_kind==MAP_NONE) return;
+	exit_lex_mapped();
+#ifndef _WIN32
+	if (map_kind==MAP_MMAP) (void)munmap(map_base,map_len);
+#endif
+	if (map_kind==MAP_COPY) free(map_base);
+	map_kind = MAP_NONE;
+	map_base = NULL;
+	map_size = 0L;
+	map_len  = 0;
+}
+
+
+/*  Contents of the input
+ *  ---------------------
+ *  returns the mapped input and its size, or NULL if nothing is mapped.
+ *  The contents are unchanged only until the parser starts.
+ */
+
+#ifdef ANSI_C
+char *mapped_input(long *size)
+#else
+char *mapped_input(size)
+long *size;
+#endif
+{
+	*size = map_size;
+	return(map_base);
+}
+
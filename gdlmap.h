@@ -0,0 +1,35 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         gdlmap.h                                           */
+/*   description:  Input file in memory for the scanner               */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+#ifndef GDLMAP_H
+#define GDLMAP_H
+
+/*--------------------------------------------------------------------*/
+
+/* Prototypes
+ * ----------
+ * See gdlmap.c for more information.
+ */
+
+int	map_input_file		_PP((FILE *f));
+void	unmap_input_file	_PP((void));
+char   *mapped_input		_PP((long *size));
+
+/*--------------------------------------------------------------------*/
+
+#endif /* GDLMAP_H */
@@ -20,8 +20,12 @@ extern int pos_nr;
 
 #ifdef ANSI_C
 void init_lex(void);
+void init_lex_mapped(char *base, long size);
+void exit_lex_mapped(void);
 #else
 void init_lex();
+void init_lex_mapped();
+void exit_lex_mapped();
 #endif
 
 #ifndef yysyntaxtree
@@ -781,11 +785,13 @@ void StringHeapFree();
 #ifdef ANSI_C
 void FreeHash(void);
 long HashInsert(register char *s);
+long HashLookup(register char *s);
 long HashTableSize(void);
 char *Decode(long x);
 #else
 void FreeHash();
 long HashInsert();
+long HashLookup();
 long HashTableSize();
 char *Decode();
 #endif /* ANSI_C */
@@ -99,6 +99,8 @@ static char *id_string="$Id: grprint.c,v 3.8 1995/02/08 11:11:14 sander Exp $";
  *  This file here provides the following functions:
  *    print_graph	      prints the full graph in ASCII form to a
  *			      file
+ *    print_graph_binary      prints the nodes and edge routes in a
+ *			      compact binary form to a file
  *    color_text	      converts a color into a text
  *    textmode_text	      converts a textmode into a text
  *    linestyle_text	      converts a linestyle into a text
@@ -115,6 +117,7 @@ static char *id_string="$Id: grprint.c,v 3.8 1995/02/08 11:11:14 sander Exp $";
 #include "steps.h"
 #include "fisheye.h"
 #include "grprint.h"
+#include "outbuf.h"
 
 /*  Prototypes
  *  ----------
@@ -125,6 +128,7 @@ static void print_node	_PP(( FILE *f, GNODE v));
 static void bbend_node  _PP(( FILE *f, GEDGE e, int k));
 static void tbend_node  _PP(( FILE *f, GEDGE e, int k));
 static void print_edge  _PP(( FILE *f, GEDGE e));
+static void edge_bends  _PP(( GEDGE e, int *topbend, int *botbend));
 
 
 /* For indentation */
@@ -135,10 +139,11 @@ static int actindent;
 /*   Print all nodes and edges		         		      */
 /*--------------------------------------------------------------------*/
 
-/* Macro for indentation */
+/* Macro for indentation. All output goes through the buffered writer
+ * of outbuf.c, which is opened on the file f.
+ */
 
-#define INDPRINT(f,fmt,arg) {{ int i;\
- for (i=0; i<actindent; i++) FPRINTF(f,"  "); FPRINTF(f,fmt,arg); }}
+#define INDPRINT(f,fmt,arg) { ob_indent(actindent); ob_printf(fmt,arg); }
 
 /* Macro to detect backward connections */
 
@@ -157,6 +162,7 @@ char *fname;
 	ADJEDGE li;
 	CONNECT c;
 	FILE *f;
+	int ok;
 
 	actindent = 0;
 
@@ -166,6 +172,7 @@ char *fname;
 	f = fopen(fname,"w");
 	if (f==NULL) return(0);
 
+	ob_open(f);
 	open_graph(f);
 	v = nodelist;
 	while (v) { print_node(f,v); v = NNEXT(v); }
@@ -228,9 +235,10 @@ char *fname;
 
 	actindent--;
 	INDPRINT(f,"}%s\n","");
-	if (f) fclose(f);
+	ok = ob_close();
+	if (fclose(f)) ok = 0;
 
-	return(1);
+	return(ok);
 }
 
 
@@ -391,7 +399,7 @@ FILE *f;
 		for (k=0; k<3; k++) {
 			if (info_names[k]) {
 				INDPRINT(f,"infoname %d : ", k+1 );
-				FPRINTF(f,"\"%s\"\n", info_names[k]);
+				ob_printf("\"%s\"\n", info_names[k]);
 			}
 		}
 	}
@@ -402,14 +410,14 @@ FILE *f;
 	}
 	for (k=0; k<cmap_size-1; k++) {
 			INDPRINT(f,"colorentry %d : ", k);
-			FPRINTF( f," %d %d %d\n",
+			ob_printf(" %d %d %d\n",
 				redmap[k], greenmap[k], bluemap[k]);
 	}
 	if (class_name_available) {
 		for (k=0; k<max_nr_classes; k++) {
 			if (class_names[k]) {
 				INDPRINT(f,"classname %d : ", k+1);
-				FPRINTF(f,"\"%s\"\n", class_names[k]);
+				ob_printf("\"%s\"\n", class_names[k]);
 			}
 		}
 	}
@@ -469,7 +477,7 @@ int k;
 	INDPRINT(f,"node: {%s\n","");
 	actindent++;
         INDPRINT(f,"title: \"_inttbend%d",k);
-        FPRINTF(f,"_%ld\"\n",(long)e);
+        ob_printf("_%ld\"\n",(long)e);
         INDPRINT(f,"label: \"%s\"\n","");
 	INDPRINT(f,"color: %s\n",      color_text(ECOLOR(e)));
 	INDPRINT(f,"width: %d\n", 0);
@@ -494,7 +502,7 @@ int k;
 	INDPRINT(f,"node: {%s\n","");
 	actindent++;
         INDPRINT(f,"title: \"_intbbend%d",k);
-        FPRINTF(f,"_%ld\"\n",(long)e);
+        ob_printf("_%ld\"\n",(long)e);
         INDPRINT(f,"label: \"%s\"\n","");
 	INDPRINT(f,"color: %s\n",      color_text(ECOLOR(e)));
 	INDPRINT(f,"width: %d\n", 0);
@@ -522,9 +530,8 @@ GEDGE e;
 #endif
 {
 	GNODE vs,ve;
-	char  topbend;
-	char  botbend;
-	int   x1,x2,x3,x4,y1,y2,y3,y4,s;
+	int   topbend;
+	int   botbend;
 	char *lasttitle;
 	char *nexttitle;
 	int  anchored;
@@ -537,29 +544,7 @@ GEDGE e;
 	}
 	ve = EEND(e);
 
-	x1 = ESTARTX(e);
-	y1 = ESTARTY(e);
-	x2 = EENDX(e);
-	y2 = EENDY(e);
-	x3 = ETBENDX(e);
-	y3 = ETBENDY(e);
-	x4 = EBBENDX(e);
-	y4 = EBBENDY(e);
-	s  = EARROWSIZE(e);
-
-	topbend = 0;
-	if ((y3!=y1)||(x3!=x1)) topbend = 1;
-	if ((x1<x3) && (x1+s*8/10>x3)) topbend = 0;
-	if ((x1>x3) && (x1-s*8/10<x3)) topbend = 0;
-	if ((y1<y3) && (y1+s*8/10>y3)) topbend = 0;
-	if ((y1>y3) && (y1-s*8/10<y3)) topbend = 0;
-	botbend = 0;
-	if ((y4!=y2)||(x4!=x2)) botbend = 1;
-	if ((x2<x4) && (x2+s*8/10>x4)) botbend = 0;
-	if ((x2>x4) && (x2-s*8/10<x4)) botbend = 0;
-	if ((y2<y4) && (y2+s*8/10>y4)) botbend = 0;
-	if ((y2>y4) && (y2-s*8/10<y4)) botbend = 0;
-
+	edge_bends(e, &topbend, &botbend);
 	if (topbend) tbend_node(f,e,1);
 	if (botbend) bbend_node(f,e,1);
 
@@ -687,6 +672,285 @@ GEDGE e;
 	INDPRINT(f,"}%s\n","");
 }
 
+
+/*  Bend points of an edge
+ *  ----------------------
+ *  The top bend point is printed if it is not too near to the start
+ *  point, the bottom bend point if it is not too near to the end point.
+ */
+
+#ifdef ANSI_C
+static void edge_bends(GEDGE e, int *topbend, int *botbend)
+#else
+static void edge_bends(e, topbend, botbend)
+GEDGE e;
+int *topbend;
+int *botbend;
+#endif
+{
+	int   x1,x2,x3,x4,y1,y2,y3,y4,s;
+
+	x1 = ESTARTX(e);
+	y1 = ESTARTY(e);
+	x2 = EENDX(e);
+	y2 = EENDY(e);
+	x3 = ETBENDX(e);
+	y3 = ETBENDY(e);
+	x4 = EBBENDX(e);
+	y4 = EBBENDY(e);
+	s  = EARROWSIZE(e);
+
+	*topbend = 0;
+	if ((y3!=y1)||(x3!=x1)) *topbend = 1;
+	if ((x1<x3) && (x1+s*8/10>x3)) *topbend = 0;
+	if ((x1>x3) && (x1-s*8/10<x3)) *topbend = 0;
+	if ((y1<y3) && (y1+s*8/10>y3)) *topbend = 0;
+	if ((y1>y3) && (y1-s*8/10<y3)) *topbend = 0;
+	*botbend = 0;
+	if ((y4!=y2)||(x4!=x2)) *botbend = 1;
+	if ((x2<x4) && (x2+s*8/10>x4)) *botbend = 0;
+	if ((x2>x4) && (x2-s*8/10<x4)) *botbend = 0;
+	if ((y2<y4) && (y2+s*8/10>y4)) *botbend = 0;
+	if ((y2>y4) && (y2-s*8/10<y4)) *botbend = 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*   Print the layout in binary form	         		      */
+/*--------------------------------------------------------------------*/
+
+/*  The binary dump contains only the geometry of the layout. It cannot
+ *  be parsed again, but it is much smaller and faster to read for other
+ *  tools than the output of print_graph. The format is:
+ *
+ *    "VCGB"		magic
+ *    1			version
+ *    n			number of nodes
+ *    n times		title, x, y, width, height, level, horizontal_order
+ *    m			number of edges
+ *    m times		source, target, class, k, k times x y
+ *
+ *  All numbers are variable length integers (see outbuf.c); x and y
+ *  are signed. A title is its length followed by its bytes.
+ *  The nodes are numbered 0 ... n-1 in the order they are written,
+ *  which is the same as in print_graph. source and target are such
+ *  numbers (or n, if the node is not written). The k points of an edge
+ *  are the start point, the bend points that print_graph shows as
+ *  nodes, and the end point. Each point is relative to the previous
+ *  one, the first relative to (0,0).
+ */
+
+#define BIN_VERSION 1
+
+static GNODE	*bin_hash = NULL;	/* node numbers, hashed by address */
+static int	*bin_num  = NULL;
+static unsigned long bin_mask;		/* size of bin_hash - 1 */
+static int	bin_nr_nodes;
+static long	bin_nr_edges;
+
+
+/*  Hash table of the node numbers
+ *  ------------------------------
+ *  open addressing, linear probing.
+ */
+
+#define bin_slot(v)  ((((unsigned long)(v)>>4)*2654435761UL) & bin_mask)
+
+#ifdef ANSI_C
+static void bin_enter(GNODE v, int n)
+#else
+static void bin_enter(v, n)
+GNODE v;
+int n;
+#endif
+{
+	unsigned long h;
+
+	h = bin_slot(v);
+	while (bin_hash[h]) h = (h+1) & bin_mask;
+	bin_hash[h] = v;
+	bin_num[h]  = n;
+}
+
+#ifdef ANSI_C
+static int bin_lookup(GNODE v)
+#else
+static int bin_lookup(v)
+GNODE v;
+#endif
+{
+	unsigned long h;
+
+	h = bin_slot(v);
+	while (bin_hash[h]) {
+		if (bin_hash[h]==v) return(bin_num[h]);
+		h = (h+1) & bin_mask;
+	}
+	return(bin_nr_nodes);
+}
+
+
+/*  Number or write the nodes of a list
+ *  -----------------------------------
+ */
+
+#ifdef ANSI_C
+static void bin_nodes(GNODE v, int write)
+#else
+static void bin_nodes(v, write)
+GNODE v;
+int write;
+#endif
+{
+	char buf[64];
+	char *t;
+
+	for (; v; v = NNEXT(v)) {
+		if (NANCHORNODE(v)) continue;
+		if (!write) { bin_enter(v, bin_nr_nodes++); continue; }
+		if (!NTITLE(v)||!NTITLE(v)[0]) {
+			SPRINTF(buf,"_internal_%ld",(long)v);
+			t = buf;
+		}
+		else	t = NTITLE(v);
+		ob_uvarint((unsigned long)strlen(t));
+		ob_puts(t);
+		ob_svarint(NX(v));
+		ob_svarint(NY(v));
+		ob_uvarint((unsigned long)NWIDTH(v));
+		ob_uvarint((unsigned long)NHEIGHT(v));
+		ob_uvarint((unsigned long)NTIEFE(v));
+		ob_uvarint((unsigned long)NPOS(v));
+	}
+}
+
+
+/*  Count or write an edge
+ *  ----------------------
+ */
+
+#ifdef ANSI_C
+static void bin_edge(GEDGE e, int write)
+#else
+static void bin_edge(e, write)
+GEDGE e;
+int write;
+#endif
+{
+	GNODE vs;
+	int   topbend, botbend;
+	long  x, y;
+
+	if (EANCHOR(e)==66) return;
+	if (!write) { bin_nr_edges++; return; }
+
+	vs = ESTART(e);
+	if (NANCHORNODE(vs)) vs = ESTART(CEDGE(NCONNECT(vs)));
+	edge_bends(e, &topbend, &botbend);
+
+	ob_uvarint((unsigned long)bin_lookup(vs));
+	ob_uvarint((unsigned long)bin_lookup(EEND(e)));
+	ob_uvarint((unsigned long)ECLASS(e));
+	ob_uvarint((unsigned long)(2+topbend+botbend));
+	x = ESTARTX(e); y = ESTARTY(e);
+	ob_svarint(x); ob_svarint(y);
+	if (topbend) {
+		ob_svarint(ETBENDX(e)-x); ob_svarint(ETBENDY(e)-y);
+		x = ETBENDX(e); y = ETBENDY(e);
+	}
+	if (botbend) {
+		ob_svarint(EBBENDX(e)-x); ob_svarint(EBBENDY(e)-y);
+		x = EBBENDX(e); y = EBBENDY(e);
+	}
+	ob_svarint(EENDX(e)-x); ob_svarint(EENDY(e)-y);
+}
+
+
+/*  Count or write the edges at the nodes of a list
+ *  -----------------------------------------------
+ *  in the same order as print_graph.
+ */
+
+#ifdef ANSI_C
+static void bin_edges(GNODE v, int write)
+#else
+static void bin_edges(v, write)
+GNODE v;
+int write;
+#endif
+{
+	ADJEDGE li;
+	CONNECT c;
+
+	for (; v; v = NNEXT(v)) {
+                c = NCONNECT(v);
+                if (c) {
+                        if (backward_connection1(c))
+                                bin_edge(CEDGE(c), write);
+                        if (backward_connection2(c))
+                                bin_edge(CEDGE2(c), write);
+                }
+		for (li = NPRED(v); li; li = ANEXT(li))
+			bin_edge(AKANTE(li), write);
+	}
+}
+
+
+#ifdef ANSI_C
+int print_graph_binary(char *fname)
+#else
+int print_graph_binary(fname)
+char *fname;
+#endif
+{
+	GNODE v;
+	FILE *f;
+	int ok, n;
+
+	f = fopen(fname,"r");
+	if (f!=NULL) { fclose(f); return(0); }
+	f = fopen(fname,"wb");
+	if (f==NULL) return(0);
+
+	/* number the nodes */
+	n = 0;
+	for (v = nodelist;  v; v = NNEXT(v)) n++;
+	for (v = labellist; v; v = NNEXT(v)) n++;
+	for (v = dummylist; v; v = NNEXT(v)) n++;
+	bin_mask = 1;
+	while (bin_mask < 2*(unsigned long)n+2) bin_mask <<= 1;
+	bin_hash = (GNODE *)calloc(bin_mask, sizeof(GNODE));
+	bin_num  = (int *)malloc(bin_mask*sizeof(int));
+	if ((!bin_hash)||(!bin_num)) Fatal_error("memory exhausted","");
+	bin_mask--;
+	bin_nr_nodes = 0;
+	bin_nodes(nodelist, 0);
+	bin_nodes(labellist, 0);
+	bin_nodes(dummylist, 0);
+	bin_nr_edges = 0;
+	bin_edges(nodelist, 0);
+	bin_edges(labellist, 0);
+	bin_edges(dummylist, 0);
+
+	ob_open(f);
+	ob_write("VCGB", 4);
+	ob_uvarint(BIN_VERSION);
+	ob_uvarint((unsigned long)bin_nr_nodes);
+	bin_nodes(nodelist, 1);
+	bin_nodes(labellist, 1);
+	bin_nodes(dummylist, 1);
+	ob_uvarint((unsigned long)bin_nr_edges);
+	bin_edges(nodelist, 1);
+	bin_edges(labellist, 1);
+	bin_edges(dummylist, 1);
+	ok = ob_close();
+	if (fclose(f)) ok = 0;
+
+	free(bin_hash); bin_hash = NULL;
+	free(bin_num);  bin_num  = NULL;
+	return(ok);
+}
+
+
 /*--------------------------------------------------------------------*/
 /*   Convert a color into its name				      */
 /*--------------------------------------------------------------------*/
@@ -80,6 +80,7 @@
  */
 
 int  	print_graph	_PP(( char *fname));
+int  	print_graph_binary _PP(( char *fname));
 char 	*color_text	_PP(( int c));
 char 	*textmode_text	_PP(( int t));
 char 	*shape_text	_PP(( int t));
@@ -91,6 +92,7 @@ int 	print_pbm
   _PP((char *fn,int a,int b,int c,int d,int l,int t,int r,int st,int sh));
 int 	print_ppm	
   _PP((char *fn,int a,int b,int c,int d,int l,int t,int r,int st,int sh));
+int 	print_bitmap_file _PP((char *fname));
 
 
 /*--------------------------------------------------------------------*/
@@ -97,9 +97,17 @@ static char *id_string="$Id: grprint2.c,v 3.6 1995/02/08 11:11:14 sander Exp $";
  *  the speed is reasonable. All global function names must be mapped
  *  to new names, otherwise we have linking conflicts.
  *
+ *  The bitmap is not drawn at once. The drawing only records the lines
+ *  and rectangles into a display list. Then the bitmap is rasterized
+ *  in horizontal bands, possibly by several threads (option -rthreads),
+ *  and the bands are written into the file as soon as they are ready.
+ *  Thus only a few bands are in memory at a time, even for posters.
+ *
  *  Basically, the following functions are in this file:
  *    print_pbm		      prints the B&W   bitmap into a PBM-file
  *    print_ppm		      prints the color bitmap into a PPM-file
+ *    print_bitmap_file	      prints the whole graph into the file given
+ *			      by the option -pbmoutput or -ppmoutput
  ************************************************************************/
 
 
@@ -142,6 +150,8 @@ static char *id_string="$Id: grprint2.c,v 3.6 1995/02/08 11:11:14 sander Exp $";
 #define gs_solidarrow        bm_solidarrow
 #define gs_dashedarrow       bm_dashedarrow
 #define gs_dottedarrow       bm_dottedarrow
+#define gs_lodnode           bm_lodnode
+#define gs_lodedge           bm_lodedge
 #define gs_line              bm_line
 #define gs_rectangle         bm_rectangle
 #define gs_actbackground     bm_actbackground
@@ -165,7 +175,42 @@ static char *id_string="$Id: grprint2.c,v 3.6 1995/02/08 11:11:14 sander Exp $";
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 #include "globals.h"
+#include "alloc.h"
+#include "options.h"
+#include "steps.h"
+
+/* Display list and bands
+ * -----------------------
+ * A primitive of the display list is a line from (a,b) to (c,d), or a
+ * rectangle at (a,b) with width c and height d. The coordinates are
+ * the same as given to bm_line and bm_rectangle. b0 and b1 are the
+ * first and last band the primitive touches, b0 = -1 if none.
+ *
+ * A band contains the rows row0 ... row1-1 of the bitmap.
+ */
+
+#define BM_LINE	0
+#define BM_RECT	1
+
+typedef struct bm_prim {
+	int	kind;
+	int	a, b, c, d;
+	int	col;
+	int	b0, b1;
+} *BMPRIM;
+
+typedef struct bm_band {
+	unsigned char	*buf;
+	int		row0, row1;
+} *BAND;
+
 
 /* Prototypes
  * ----------
@@ -176,12 +221,16 @@ static FILE *check_and_open_file  _PP((char *fname));
 void bm_line            _PP((int fx,int fy,int tx,int ty,int c));
 static void bm_rectangle       _PP((int x,int y,int w,int h,int c));
 
-static void bw_point	       _PP(( int x, int y, int c));
-static void bw_line            _PP((int fx,int fy,int tx,int ty,int c));
-static void bw_rectangle       _PP((int x,int y,int w,int h,int c));
-static void co_point	       _PP(( int x, int y, int c));
-static void co_line            _PP((int fx,int fy,int tx,int ty,int c));
-static void co_rectangle       _PP((int x,int y,int w,int h,int c));
+static void bm_record          _PP((int k,int a,int b,int c,int d,int col));
+static void bm_raster          _PP((FILE *f));
+static void bm_buckets         _PP((void));
+static void bm_do_band         _PP((int k));
+
+static void bw_point	       _PP(( BAND bd, int x, int y, int c));
+static void co_point	       _PP(( BAND bd, int x, int y, int c));
+static void band_line          _PP(( BAND bd, BMPRIM p));
+static void band_fill          _PP(( BAND bd, int r0, int r1, int c0, int c1, int c));
+static void band_rectangle     _PP(( BAND bd, BMPRIM p));
 
 
 
@@ -227,10 +276,32 @@ static int rotated = 0;
 
 static int leftmargin, topmargin;
 
-/* The bitmap itself, where the output is prepared.
+/* The display list: nr_prims primitives in the order of drawing.
  */
 
-static unsigned char *bitmap=NULL;
+static struct bm_prim *prims = NULL;
+static int nr_prims  = 0;
+static int max_prims = 0;
+
+/* The bands: the bitmap is rasterized in bands of band_rows rows, each
+ * row has row_bytes bytes. The bucket of band k contains the indices
+ * bucket[bucket_start[k] ... bucket_start[k+1]-1] of the primitives
+ * that touch band k, in increasing order.
+ * A band should have about BM_BANDBYTES bytes, but at least BM_MINROWS
+ * rows, because long edges would otherwise fall into too many buckets.
+ */
+
+#define BM_BANDBYTES	(1024*1024)
+#define BM_MINROWS	16
+
+static int nr_bands, band_rows, row_bytes;
+static int *bucket_start = NULL;
+static int *bucket       = NULL;
+
+/* The band buffers of the actual round of rasterization.
+ */
+
+static struct bm_band *bands = NULL;
 
 /* Flag, wether pbm or ppm
  */
@@ -298,6 +369,38 @@ int a, b, c, d;
 }
 
 
+/*  File output without interaction
+ *  ===============================
+ *  The whole graph is printed into the file fname, according to the
+ *  options -pbmoutput or -ppmoutput (see options.c). The default
+ *  scaling is 100 percent, the default margins are 0.
+ */
+
+#ifdef ANSI_C
+int print_bitmap_file(char *fname)
+#else
+int print_bitmap_file(fname)
+char *fname;
+#endif
+{
+	act_output_type = extype;
+	act_color_type  = excolor;
+	act_ori_type    = exori;
+	act_xdpi        = exxdpi;
+	act_ydpi        = exydpi;
+	act_scaling     = 1.0;
+	act_left_margin = 0.0;
+	act_top_margin  = 0.0;
+	if (exscaling > 0.0) act_scaling     = exscaling;
+	if (exleftm >= 0.0)  act_left_margin = exleftm;
+	if (extopm >= 0.0)   act_top_margin  = extopm;
+
+	if ((act_output_type!=1)&&(act_output_type!=2)) return(0);
+	return(print_pbm_or_ppm(fname, 0, 0,
+			maximal_xpos+G_xbase, maximal_ypos+G_ybase));
+}
+
+
 /*  Print PBM-file
  *  ==============
  *  The region (a,b)-(c,d) is printed to the file.
@@ -341,7 +444,6 @@ int  a,b,c,d,l,t,r,sh,st;
 {
 	int Vs_xmin, Vs_ymin, Vs_xmax, Vs_ymax;
 	int s_stretch, s_shrink, col;
-	int i,j;
 	FILE *f;
 
 	pbm_flag = 1;
@@ -381,33 +483,18 @@ int  a,b,c,d,l,t,r,sh,st;
 	G_shrink  = sh; G_stretch = st;
 	colored   = 0;
 
-	gs_wait_message('m');
-	bitmap = (unsigned char *)malloc(hlen/8*vlen+vlen);
-	gs_wait_message('M');
-	if (!bitmap) Fatal_error("memory exhausted","");
-	for (i=0; i<vlen; i++) {
-		wait_cntr++;
-		if (wait_cntr > 60)  { gs_wait_message('i'); wait_cntr = 0; }
-		for (j=0; j<hlen/8; j++) bitmap[i*hlen/8+j] = 0;
-	}
-
-	/* draw bitmap */
+	/* draw into the display list */
+	nr_prims = 0;
 	bm_draw_main();
 
 	/* save PBM format into file */
 	FPRINTF(f,"P4\n");
 	FPRINTF(f,"%d %d\n",hlen,vlen);
-	for (i=0; i<vlen; i++) {
-		wait_cntr++;
-		if (wait_cntr > 30)  { gs_wait_message('s'); wait_cntr = 0; }
-		fwrite(&(bitmap[i*hlen/8]),1,hlen/8,f);
-	}
+	row_bytes = hlen/8;
+	bm_raster(f);
 
 	if (f) fclose(f);
 
-	if (bitmap)  free(bitmap);
-	bitmap = NULL;
-
 	/* restore old values */
 	V_xmin = Vs_xmin;     V_ymin = Vs_ymin;
 	V_xmax = Vs_xmax;     V_ymax = Vs_ymax;
@@ -466,7 +553,6 @@ int  a,b,c,d,l,t,r,sh,st;
 {
 	int Vs_xmin, Vs_ymin, Vs_xmax, Vs_ymax;
 	int s_stretch, s_shrink, col;
-	int i,j;
 	FILE *f;
 
 	pbm_flag = 0;
@@ -505,34 +591,19 @@ int  a,b,c,d,l,t,r,sh,st;
 	G_shrink  = sh; G_stretch = st;
 	colored   = 1;
 
-	gs_wait_message('m');
-	bitmap = (unsigned char *)malloc((hlen*vlen+vlen)*3);
-	gs_wait_message('M');
-	if (!bitmap) Fatal_error("memory exhausted","");
-	for (i=0; i<vlen; i++) {
-		wait_cntr++;
-		if (wait_cntr > 60)  { gs_wait_message('i'); wait_cntr = 0; }
-		for (j=0; j<3*hlen; j++) bitmap[i*3*hlen+j] = 255;
-	}
-
+	/* draw into the display list */
+	nr_prims = 0;
         bm_rectangle(a, b, c-a, d-b, G_color);
-
-	/* draw bitmap */
 	bm_draw_main();
 
 	/* save PPM format into file */
 	FPRINTF(f,"P6\n");
 	FPRINTF(f,"%d %d\n",hlen,vlen);
 	FPRINTF(f,"255\n");
-	for (i=0; i<vlen; i++) {
-		fwrite(&(bitmap[i*hlen*3]),1,hlen*3,f);
-		wait_cntr++;
-		if (wait_cntr > 30)  { gs_wait_message('s'); wait_cntr = 0; }
-	}
-	if (f) fclose(f);
+	row_bytes = 3*hlen;
+	bm_raster(f);
 
-	if (bitmap)  free(bitmap);
-	bitmap = NULL;
+	if (f) fclose(f);
 
 	/* restore old values */
 	V_xmin = Vs_xmin;     V_ymin = Vs_ymin;
@@ -591,7 +662,8 @@ char *fname;
 
 /* Draw a rectangle
  * ----------------
- * at (x,y) with width w, height h and color c
+ * at (x,y) with width w, height h and color c.
+ * The rectangle is only recorded into the display list.
  */
 
 #ifdef ANSI_C
@@ -603,13 +675,13 @@ int     x, y, w, h, c;
 {
 	wait_cntr++;
 	if (wait_cntr > 30)  { gs_wait_message('r'); wait_cntr = 0; }
-	if (pbm_flag) bw_rectangle(x, y, w, h, c);
-	else 	      co_rectangle(x, y, w, h, c);
+	bm_record(BM_RECT, x, y, w, h, c);
 }
 
 /* Draw a line
  * -----------
  * from fx,fy to tx,ty with color c.
+ * The line is only recorded into the display list.
  */
 
 #ifdef ANSI_C
@@ -621,8 +693,591 @@ int     fx, fy, tx, ty, c;
 {
 	wait_cntr++;
 	if (wait_cntr > 30)  { gs_wait_message('l'); wait_cntr = 0; }
-	if (pbm_flag) bw_line(fx, fy, tx, ty, c);
-	else          co_line(fx, fy, tx, ty, c);
+	bm_record(BM_LINE, fx, fy, tx, ty, c);
+}
+
+
+/* Append a primitive to the display list
+ * --------------------------------------
+ */
+
+#ifdef ANSI_C
+static void bm_record(int k,int a,int b,int c,int d,int col)
+#else
+static void bm_record(k, a, b, c, d, col)
+int k, a, b, c, d, col;
+#endif
+{
+	BMPRIM p;
+
+	if (nr_prims >= max_prims) {
+		max_prims = 2*max_prims + 1024;
+		p = (BMPRIM)realloc(prims, max_prims*sizeof(struct bm_prim));
+		if (!p) Fatal_error("memory exhausted","");
+		prims = p;
+	}
+	p = &(prims[nr_prims++]);
+	p->kind = k;
+	p->a = a; p->b = b; p->c = c; p->d = d;
+	p->col = col;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Rasterization in bands                                            */
+/*--------------------------------------------------------------------*/
+
+/* Row of a point
+ * --------------
+ * The point (x,y) relative to (V_xmin,V_ymin) falls into this row of
+ * the bitmap, see bw_point and co_point.
+ */
+
+#define bm_row(x,y)  (rotated ? (x)+leftmargin : (y)+topmargin)
+
+
+/* Fill the buckets
+ * ----------------
+ * Calculates the bands each primitive touches, and fills the bucket
+ * of each band with the primitives in the order of drawing. This is
+ * counting sort: first the sizes of the buckets, then the indices.
+ */
+
+#ifdef ANSI_C
+static void bm_buckets(void)
+#else
+static void bm_buckets()
+#endif
+{
+	BMPRIM p;
+	int i, k, r0, r1, x, y;
+
+	if (bucket_start) free(bucket_start);
+	bucket_start = (int *)calloc(nr_bands+1, sizeof(int));
+	if (!bucket_start) Fatal_error("memory exhausted","");
+
+	for (i=0; i<nr_prims; i++) {
+		p = &(prims[i]);
+		p->b0 = -1;
+		x = p->a-V_xmin;
+		y = p->b-V_ymin;
+		if (p->kind==BM_LINE) {
+			r0 = bm_row(x,y);
+			r1 = bm_row(p->c-V_xmin,p->d-V_ymin);
+			if (r0>r1) { k = r0; r0 = r1; r1 = k; }
+		}
+		else {
+			if ((p->c<=0)||(p->d<=0)) continue;
+			r0 = bm_row(x,y);
+			r1 = r0 + (rotated ? p->c : p->d) - 1;
+		}
+		if (r0<0)      r0 = 0;
+		if (r1>=vlen)  r1 = vlen-1;
+		if (r0>r1) continue;
+		p->b0 = r0/band_rows;
+		p->b1 = r1/band_rows;
+		for (k=p->b0; k<=p->b1; k++) bucket_start[k+1]++;
+	}
+	for (k=0; k<nr_bands; k++) bucket_start[k+1] += bucket_start[k];
+
+	if (bucket) free(bucket);
+	bucket = (int *)malloc((bucket_start[nr_bands]+1)*sizeof(int));
+	if (!bucket) Fatal_error("memory exhausted","");
+
+	/* bucket_start[k] is used as fill pointer and restored afterwards */
+	for (i=0; i<nr_prims; i++) {
+		p = &(prims[i]);
+		if (p->b0<0) continue;
+		for (k=p->b0; k<=p->b1; k++) bucket[bucket_start[k]++] = i;
+	}
+	for (k=nr_bands; k>0; k--) bucket_start[k] = bucket_start[k-1];
+	bucket_start[0] = 0;
+}
+
+
+/* Draw band k
+ * -----------
+ * into the buffer bands[k % nr_buffers]. This may run in any thread.
+ */
+
+static int nr_buffers;
+
+#ifdef ANSI_C
+static void bm_do_band(int k)
+#else
+static void bm_do_band(k)
+int k;
+#endif
+{
+	BAND bd;
+	BMPRIM p;
+	int i;
+
+	bd = &(bands[k % nr_buffers]);
+	bd->row0 = k*band_rows;
+	bd->row1 = bd->row0 + band_rows;
+	if (bd->row1 > vlen) bd->row1 = vlen;
+
+	memset(bd->buf, (pbm_flag ? 0 : 255),
+		(size_t)row_bytes*(bd->row1-bd->row0));
+	for (i=bucket_start[k]; i<bucket_start[k+1]; i++) {
+		p = &(prims[bucket[i]]);
+		if (p->kind==BM_LINE) band_line(bd, p);
+		else                  band_rectangle(bd, p);
+	}
+}
+
+
+/*  Parallel rasterization
+ *  ----------------------
+ *  The bands are rasterized in rounds of nr_buffers bands. In each
+ *  round, the threads take the next band that is not yet done, until
+ *  all bands of the round are done. Then the calling thread writes
+ *  the bands of the round into the file. Each band is drawn exactly
+ *  as the same rows of a full bitmap, thus the file is the same for
+ *  any number of threads.
+ *
+ *  The threads are started at the first use and then wait for the
+ *  next round, as the threads of layerdata.c.
+ */
+
+#define BM_MAXTHREADS	64	/* maximal number of threads        */
+#define BM_ROUNDBANDS	2	/* bands per thread in each round   */
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION	bm_mutex_t;
+typedef CONDITION_VARIABLE	bm_cond_t;
+#define bm_lock()		EnterCriticalSection(&bm_mutex)
+#define bm_unlock()		LeaveCriticalSection(&bm_mutex)
+#define bm_wait(c)		SleepConditionVariableCS(&(c), &bm_mutex, INFINITE)
+#define bm_wakeall(c)		WakeAllConditionVariable(&(c))
+#else
+typedef pthread_mutex_t		bm_mutex_t;
+typedef pthread_cond_t		bm_cond_t;
+#define bm_lock()		pthread_mutex_lock(&bm_mutex)
+#define bm_unlock()		pthread_mutex_unlock(&bm_mutex)
+#define bm_wait(c)		pthread_cond_wait(&(c), &bm_mutex)
+#define bm_wakeall(c)		pthread_cond_broadcast(&(c))
+#endif
+
+static bm_mutex_t bm_mutex;
+static bm_cond_t  bm_start;	/* signalled if a new round starts   */
+static bm_cond_t  bm_done;	/* signalled if all threads are done */
+
+static int	bm_nthreads = 1;	/* threads running incl. caller   */
+static int	bm_round    = 0;	/* number of the actual round     */
+static int	bm_next, bm_last;	/* next band and end of the round */
+static int	bm_active;		/* threads used in the round      */
+static int	bm_busy;		/* threads not yet finished       */
+static int	bm_seen[BM_MAXTHREADS];	/* last round seen by a thread    */
+
+
+/*  Take and draw bands of the actual round
+ *  ---------------------------------------
+ *  Must be called with the lock held.
+ */
+
+#ifdef ANSI_C
+static void bm_take_bands(void)
+#else
+static void bm_take_bands()
+#endif
+{
+	int	k;
+
+	while (bm_next < bm_last) {
+		k = bm_next++;
+		bm_unlock();
+		bm_do_band(k);
+		bm_lock();
+	}
+}
+
+
+/*  Main loop of a worker thread
+ *  ----------------------------
+ *  arg is the number of the thread. Threads with a number >= bm_active
+ *  are not used in the round.
+ */
+
+#ifdef _WIN32
+static DWORD WINAPI bm_worker(LPVOID arg)
+#else
+static void *bm_worker(void *arg)
+#endif
+{
+	int	t;
+
+	t = (int)(size_t)arg;
+	bm_lock();
+	for (;;) {
+		while (bm_round == bm_seen[t]) bm_wait(bm_start);
+		bm_seen[t] = bm_round;
+		if (t >= bm_active) continue;
+		bm_take_bands();
+		bm_busy--;
+		if (bm_busy == 0) bm_wakeall(bm_done);
+	}
+	return(0);
+}
+
+
+/*  Start the threads
+ *  -----------------
+ *  Increases the number of threads to n. Threads are never stopped;
+ *  if they cannot be started, we continue with fewer ones.
+ */
+
+#ifdef ANSI_C
+static void bm_start_threads(int n)
+#else
+static void bm_start_threads(n)
+int	n;
+#endif
+{
+#ifdef _WIN32
+	HANDLE	h;
+#else
+	pthread_t h;
+#endif
+
+	if (bm_nthreads == 1) {
+#ifdef _WIN32
+		InitializeCriticalSection(&bm_mutex);
+		InitializeConditionVariable(&bm_start);
+		InitializeConditionVariable(&bm_done);
+#else
+		pthread_mutex_init(&bm_mutex, NULL);
+		pthread_cond_init(&bm_start, NULL);
+		pthread_cond_init(&bm_done, NULL);
+#endif
+	}
+	bm_lock();
+	while (bm_nthreads < n) {
+		bm_seen[bm_nthreads] = bm_round;
+#ifdef _WIN32
+		h = CreateThread(NULL, 0, bm_worker,
+				(LPVOID)(size_t)bm_nthreads, 0, NULL);
+		if (!h) break;
+		CloseHandle(h);
+#else
+		if (pthread_create(&h, NULL, bm_worker,
+				(void *)(size_t)bm_nthreads)) break;
+		pthread_detach(h);
+#endif
+		bm_nthreads++;
+	}
+	bm_unlock();
+}
+
+
+/*  Rasterize the display list into the file f
+ *  ------------------------------------------
+ *  hlen, vlen and row_bytes must be set. The header of the file is
+ *  already written.
+ */
+
+#ifdef ANSI_C
+static void bm_raster(FILE *f)
+#else
+static void bm_raster(f)
+FILE *f;
+#endif
+{
+	int	threads, k, first, last;
+
+	band_rows = BM_BANDBYTES / row_bytes;
+	if (band_rows < BM_MINROWS) band_rows = BM_MINROWS;
+	if (band_rows > vlen)       band_rows = vlen;
+	nr_bands = (vlen + band_rows - 1) / band_rows;
+
+	gs_wait_message('i');
+	bm_buckets();
+
+	threads = raster_threads;
+	if (threads > BM_MAXTHREADS) threads = BM_MAXTHREADS;
+	if (threads > nr_bands)      threads = nr_bands;
+	if (threads > bm_nthreads) bm_start_threads(threads);
+	if (threads > bm_nthreads) threads = bm_nthreads;
+
+	nr_buffers = (threads==1) ? 1 : threads*BM_ROUNDBANDS;
+	if (nr_buffers > nr_bands) nr_buffers = nr_bands;
+
+	gs_wait_message('m');
+	bands = (BAND)calloc(nr_buffers, sizeof(struct bm_band));
+	if (!bands) Fatal_error("memory exhausted","");
+	for (k=0; k<nr_buffers; k++) {
+		bands[k].buf = (unsigned char *)
+				malloc((size_t)row_bytes*band_rows);
+		if (!bands[k].buf) Fatal_error("memory exhausted","");
+	}
+	gs_wait_message('M');
+
+	for (first=0; first<nr_bands; first+=nr_buffers) {
+		last = first + nr_buffers;
+		if (last > nr_bands) last = nr_bands;
+
+		if (threads == 1) {
+			for (k=first; k<last; k++) bm_do_band(k);
+		}
+		else {
+			bm_lock();
+			bm_next = first;
+			bm_last = last;
+			bm_active = threads;
+			bm_busy   = threads-1;
+			bm_round++;
+			bm_wakeall(bm_start);
+			bm_take_bands();
+			while (bm_busy > 0) bm_wait(bm_done);
+			bm_unlock();
+		}
+
+		for (k=first; k<last; k++) {
+			fwrite(bands[k % nr_buffers].buf, 1, (size_t)row_bytes
+			       * (bands[k % nr_buffers].row1
+				  - bands[k % nr_buffers].row0), f);
+		}
+		wait_cntr++;
+		if (wait_cntr > 1)  { gs_wait_message('s'); wait_cntr = 0; }
+	}
+
+	for (k=0; k<nr_buffers; k++) free(bands[k].buf);
+	free(bands);
+	bands = NULL;
+	free(bucket);       bucket       = NULL;
+	free(bucket_start); bucket_start = NULL;
+	free(prims);        prims        = NULL;
+	nr_prims = max_prims = 0;
+}
+
+
+/* Draw a point
+ * ------------
+ * at (x,y) with color c into the band bd. The band buffer has the
+ * same layout as the rows row0 ... row1-1 of a full bitmap.
+ */
+
+#ifdef ANSI_C
+static void band_point(BAND bd,int x,int y,int c)
+#else
+static void band_point(bd,x,y,c)
+BAND bd;
+int x;
+int y;
+int c;
+#endif
+{
+	if (pbm_flag) bw_point(bd, x, y, c);
+	else          co_point(bd, x, y, c);
+}
+
+
+/* Fill a span of rows
+ * -------------------
+ * The rows r0 ... r1-1 and columns c0 ... c1-1 of the bitmap are set
+ * to color c. They must be inside the band bd and the bitmap.
+ */
+
+#ifdef ANSI_C
+static void band_fill(BAND bd,int r0,int r1,int c0,int c1,int c)
+#else
+static void band_fill(bd, r0, r1, c0, c1, c)
+BAND	bd;
+int	r0, r1, c0, c1, c;
+#endif
+{
+	unsigned char *cc, mask;
+	int r, xx;
+
+	for (r=r0; r<r1; r++) {
+		cc = &(bd->buf[(size_t)(r-bd->row0)*row_bytes]);
+		if (pbm_flag) {
+			xx = c0;
+			while ((xx<c1)&&(xx%8)) {
+				mask = 0x80 >> (xx%8);
+				if (c==WHITE) cc[xx/8] &= ~mask;
+				else          cc[xx/8] |= mask;
+				xx++;
+			}
+			if (c1-xx >= 8) {
+				memset(&(cc[xx/8]), (c==WHITE ? 0 : 0xff),
+					(c1-xx)/8);
+				xx += ((c1-xx)/8)*8;
+			}
+			while (xx<c1) {
+				mask = 0x80 >> (xx%8);
+				if (c==WHITE) cc[xx/8] &= ~mask;
+				else          cc[xx/8] |= mask;
+				xx++;
+			}
+		}
+		else {
+			for (xx=c0; xx<c1; xx++) {
+				cc[xx*3]   = redmap[c];
+				cc[xx*3+1] = greenmap[c];
+				cc[xx*3+2] = bluemap[c];
+			}
+		}
+	}
+}
+
+
+/* Draw a rectangle
+ * ----------------
+ * p is the rectangle at (x,y) with width w, height h and color c.
+ * The pixels inside the band bd and the bitmap form again a rectangle,
+ * which is filled row by row.
+ */
+
+#ifdef ANSI_C
+static void    band_rectangle(BAND bd,BMPRIM p)
+#else
+static void    band_rectangle(bd, p)
+BAND	bd;
+BMPRIM	p;
+#endif
+{
+	int ilo,ihi,jlo,jhi,x,y;
+
+	x = p->a-V_xmin;
+	y = p->b-V_ymin;
+	ilo = 0; ihi = p->d;
+	jlo = 0; jhi = p->c;
+
+	/* co_point draws nothing left of or above (V_xmin,V_ymin) */
+	if (!pbm_flag) {
+		if (jlo < -x) jlo = -x;
+		if (ilo < -y) ilo = -y;
+	}
+
+	/* restrict the rows to the band and the columns to the bitmap */
+	if (rotated) {
+		if (jlo < bd->row0-leftmargin-x) jlo = bd->row0-leftmargin-x;
+		if (jhi > bd->row1-leftmargin-x) jhi = bd->row1-leftmargin-x;
+		if (ilo < -topmargin-y)          ilo = -topmargin-y;
+		if (ihi > hlen-topmargin-y)      ihi = hlen-topmargin-y;
+		if ((ilo>=ihi)||(jlo>=jhi)) return;
+		band_fill(bd, x+jlo+leftmargin, x+jhi+leftmargin,
+			  hlen-(y+ihi+topmargin), hlen-(y+ilo+topmargin),
+			  p->col);
+	}
+	else {
+		if (ilo < bd->row0-topmargin-y)  ilo = bd->row0-topmargin-y;
+		if (ihi > bd->row1-topmargin-y)  ihi = bd->row1-topmargin-y;
+		if (jlo < -leftmargin-x)         jlo = -leftmargin-x;
+		if (jhi > hlen-leftmargin-x)     jhi = hlen-leftmargin-x;
+		if ((ilo>=ihi)||(jlo>=jhi)) return;
+		band_fill(bd, y+ilo+topmargin, y+ihi+topmargin,
+			  x+jlo+leftmargin, x+jhi+leftmargin, p->col);
+	}
+}
+
+
+/* Draw a line
+ * -----------
+ * p is the line from fx,fy to tx,ty with color c.
+ * The line runs along its major axis, and the point number i is
+ * calculated by the same formula as in a full bitmap. The rows of
+ * the points are monotonic in i, thus the points inside the band bd
+ * are an interval of i that is found by binary search.
+ */
+
+typedef struct bm_seg {
+	int	x1, y1, x2, y2;
+	int	xmajor;		/* 1, if the line runs along x     */
+	int	dir;		/* +1 or -1 along the major axis   */
+} *BMSEG;
+
+#ifdef ANSI_C
+static void seg_point(BMSEG s,int i,int *xp,int *yp)
+#else
+static void seg_point(s, i, xp, yp)
+BMSEG	s;
+int	i;
+int	*xp, *yp;
+#endif
+{
+	if (s->xmajor) {
+		*xp = s->x1 + i*s->dir;
+		*yp = ((s->y2-s->y1)*(*xp-s->x1)+s->y1*(s->x2-s->x1))
+			/(s->x2-s->x1);
+	}
+	else {
+		*yp = s->y1 + i*s->dir;
+		*xp = ((s->x2-s->x1)*(*yp-s->y1)+s->x1*(s->y2-s->y1))
+			/(s->y2-s->y1);
+	}
+}
+
+
+/*  First point number i in 0...n-1 with row >= r (up = 1) or row <= r
+ *  (up = 0), or n if there is none. The condition must be monotonic.
+ */
+
+#ifdef ANSI_C
+static int seg_search(BMSEG s,int n,int r,int up)
+#else
+static int seg_search(s, n, r, up)
+BMSEG	s;
+int	n, r, up;
+#endif
+{
+	int lo, hi, m, xp, yp, row;
+
+	lo = 0; hi = n;
+	while (lo < hi) {
+		m = lo + (hi-lo)/2;
+		seg_point(s, m, &xp, &yp);
+		row = bm_row(xp,yp);
+		if (up ? (row >= r) : (row <= r)) hi = m;
+		else lo = m+1;
+	}
+	return(lo);
+}
+
+
+#ifdef ANSI_C
+static void    band_line(BAND bd,BMPRIM p)
+#else
+static void    band_line(bd, p)
+BAND	bd;
+BMPRIM	p;
+#endif
+{
+	struct bm_seg s;
+	int n,i,lo,hi,xp,yp,c;
+
+	s.x1 = p->a-V_xmin;
+	s.y1 = p->b-V_ymin;
+	s.x2 = p->c-V_xmin;
+	s.y2 = p->d-V_ymin;
+	c    = p->col;
+	band_point(bd,s.x1,s.y1,c);
+	if ((s.x2-s.x1==0)&&(s.y2-s.y1==0)) return;
+	if ((s.x2-s.x1)*(s.x2-s.x1) > (s.y2-s.y1)*(s.y2-s.y1)) {
+		s.xmajor = 1;
+		s.dir = (s.x1<s.x2) ? 1 : -1;
+		n = (s.x2-s.x1)*s.dir + 1;
+	}
+	else {
+		s.xmajor = 0;
+		s.dir = (s.y1<s.y2) ? 1 : -1;
+		n = (s.y2-s.y1)*s.dir + 1;
+	}
+
+	if (bm_row(s.x1,s.y1) <= bm_row(s.x2,s.y2)) {
+		lo = seg_search(&s, n, bd->row0, 1);
+		hi = seg_search(&s, n, bd->row1, 1);
+	}
+	else {
+		lo = seg_search(&s, n, bd->row1-1, 0);
+		hi = seg_search(&s, n, bd->row0-1, 0);
+	}
+	for (i=lo; i<hi; i++) {
+		seg_point(&s, i, &xp, &yp);
+		band_point(bd,xp,yp,c);
+	}
 }
 
 
@@ -636,9 +1291,10 @@ int     fx, fy, tx, ty, c;
  */
 
 #ifdef ANSI_C
-static void bw_point(int x,int y,int c)
+static void bw_point(BAND bd,int x,int y,int c)
 #else
-static void bw_point(x,y,c)
+static void bw_point(bd,x,y,c)
+BAND bd;
 int x;
 int y;
 int c;
@@ -655,11 +1311,11 @@ int c;
 		yy = y + topmargin;
 	}
 	if (xx<0) return;
-	if (yy<0) return;
+	if (yy<bd->row0) return;
 	if (xx>=hlen) return;
-	if (yy>=vlen) return;
+	if (yy>=bd->row1) return;
 
-	cc = &(bitmap[yy*(hlen/8)+xx/8]);
+	cc = &(bd->buf[(yy-bd->row0)*(hlen/8)+xx/8]);
 	switch (xx%8) {
 	case 0: mask = 0x80; break;
 	case 1: mask = 0x40; break;
@@ -681,76 +1337,6 @@ int c;
 }
 
 
-/* Draw a rectangle
- * ----------------
- * at (x,y) with width w, height h and color c
- */
-
-#ifdef ANSI_C
-static void    bw_rectangle(int x,int y,int w,int h,int c)
-#else
-static void    bw_rectangle(x, y, w, h, c)
-int     x, y, w, h, c;
-#endif
-{
-	int i,j;
-
-	for (i=0; i<h; i++) {
-		for (j=0; j<w; j++) {
-			bw_point(x-V_xmin+j,y-V_ymin+i,c);
-		}
-	}
-}
-
-/* Draw a line
- * -----------
- * from fx,fy to tx,ty with color c.
- */
-
-#ifdef ANSI_C
-static void    bw_line(int fx,int fy,int tx,int ty,int c)
-#else
-static void    bw_line(fx, fy, tx, ty, c)
-int     fx, fy, tx, ty, c;
-#endif
-{
-	 int x1,y1,x2,y2,xp,yp;
-
-	 x1 = fx-V_xmin;
-	 y1 = fy-V_ymin;
-	 x2 = tx-V_xmin;
-	 y2 = ty-V_ymin;
-	 bw_point(x1,y1,c);
-	 if ((x2-x1==0)&&(y2-y1==0)) return;
-	 if ((x2-x1)*(x2-x1) > (y2-y1)*(y2-y1)) {
-		xp = x1;
-		if (x1<x2) while (xp<=x2) {
-			yp = ((y2-y1)*(xp-x1)+y1*(x2-x1))/(x2-x1);
-	 		bw_point(xp,yp,c);
-			xp++;
-		}
-		else while (xp>=x2) {
-			yp = ((y2-y1)*(xp-x1)+y1*(x2-x1))/(x2-x1);
-	 		bw_point(xp,yp,c);
-			xp--;
-		}
-	 }
-	 else {
-		yp = y1;
-		if (y1<y2) while (yp<=y2) {
-			xp = ((x2-x1)*(yp-y1)+x1*(y2-y1))/(y2-y1);
-	 		bw_point(xp,yp,c);
-			yp++;
-		}
-		else while (yp>=y2) {
-			xp = ((x2-x1)*(yp-y1)+x1*(y2-y1))/(y2-y1);
-	 		bw_point(xp,yp,c);
-			yp--;
-		}
-	 }
-}
-
-
 /*--------------------------------------------------------------------*/
 /*  Device driver for ppm-Files                                       */
 /*--------------------------------------------------------------------*/
@@ -761,9 +1347,10 @@ int     fx, fy, tx, ty, c;
  */
 
 #ifdef ANSI_C
-static void co_point(int x,int y,int c)
+static void co_point(BAND bd,int x,int y,int c)
 #else
-static void co_point(x,y,c)
+static void co_point(bd,x,y,c)
+BAND bd;
 int x;
 int y;
 int c;
@@ -782,86 +1369,15 @@ int c;
 		yy = y + topmargin;
 	}
 	if (xx<0) return;
-	if (yy<0) return;
+	if (yy<bd->row0) return;
 	if (xx>=hlen) return;
-	if (yy>=vlen) return;
+	if (yy>=bd->row1) return;
 
-	cc = &(bitmap[yy*hlen*3+xx*3]);
+	cc = &(bd->buf[(yy-bd->row0)*hlen*3+xx*3]);
 
 	*cc++ = redmap[c];
 	*cc++ = greenmap[c];
 	*cc   = bluemap[c];
 }
 
-
-/* Draw a rectangle
- * ----------------
- * at (x,y) with width w, height h and color c
- */
-
-#ifdef ANSI_C
-static void    co_rectangle(int x,int y,int w,int h,int c)
-#else
-static void    co_rectangle(x, y, w, h, c)
-int     x, y, w, h, c;
-#endif
-{
-	int i,j;
-
-	for (i=0; i<h; i++) {
-		for (j=0; j<w; j++) {
-			co_point(x-V_xmin+j,y-V_ymin+i,c);
-		}
-	}
-}
-
-/* Draw a line
- * -----------
- * from fx,fy to tx,ty with color c.
- */
-
-#ifdef ANSI_C
-static void    co_line(int fx,int fy,int tx,int ty,int c)
-#else
-static void    co_line(fx, fy, tx, ty, c)
-int     fx, fy, tx, ty, c;
-#endif
-{
-	 int x1,y1,x2,y2,xp,yp;
-
-	 x1 = fx-V_xmin;
-	 y1 = fy-V_ymin;
-	 x2 = tx-V_xmin;
-	 y2 = ty-V_ymin;
-	 co_point(x1,y1,c);
-	 if ((x2-x1==0)&&(y2-y1==0)) return;
-	 if ((x2-x1)*(x2-x1) > (y2-y1)*(y2-y1)) {
-		xp = x1;
-		if (x1<x2) while (xp<=x2) {
-			yp = ((y2-y1)*(xp-x1)+y1*(x2-x1))/(x2-x1);
-	 		co_point(xp,yp,c);
-			xp++;
-		}
-		else while (xp>=x2) {
-			yp = ((y2-y1)*(xp-x1)+y1*(x2-x1))/(x2-x1);
-	 		co_point(xp,yp,c);
-			xp--;
-		}
-	 }
-	 else {
-		yp = y1;
-		if (y1<y2) while (yp<=y2) {
-			xp = ((x2-x1)*(yp-y1)+x1*(y2-y1))/(y2-y1);
-	 		co_point(xp,yp,c);
-			yp++;
-		}
-		else while (yp>=y2) {
-			xp = ((x2-x1)*(yp-y1)+x1*(y2-y1))/(y2-y1);
-	 		co_point(xp,yp,c);
-			yp--;
-		}
-	 }
-}
-
 /*--------------------------------------------------------------------*/
-
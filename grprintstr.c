@@ -98,6 +98,8 @@ static char *id_string="$Id: grprintstr.c,v 1.1 1995/02/08 11:11:14 sander Exp $
 #define gs_solidarrow        bm_solidarrow       
 #define gs_dashedarrow       bm_dashedarrow     
 #define gs_dottedarrow       bm_dottedarrow    
+#define gs_lodnode           bm_lodnode
+#define gs_lodedge           bm_lodedge
 #define gs_line              bm_line
 #define gs_rectangle         bm_rectangle
 #define gs_actbackground     bm_actbackground
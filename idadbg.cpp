@@ -6,9 +6,11 @@
 
 #include <pin.H>
 #include <portability.H>
+#include <atomic.hpp>
 
 #include "idadbg.h"
 #include "idadbg_local.h"
+#include "idadbg_ring.h"
 
 //--------------------------------------------------------------------------
 // By default we use a separate internal thread for reinstrumentation
@@ -133,6 +135,9 @@ public:
 
   inline void export_ctx(idapin_registers_t *regs);
 
+  // trace buffer of the thread; must be called by the thread itself
+  inline trc_ring_t *get_ring();
+
   static int nthreads()                { return thread_cnt;   }
   static int nsuspended()              { return suspeded_cnt; }
   static bool have_suspended_threads() { return suspeded_cnt != 0; }
@@ -140,6 +145,7 @@ public:
 
   static inline thread_data_t *get_thread_data();
   static inline thread_data_t *get_thread_data(THREADID tid);
+  static inline thread_data_t *attach_thread(THREADID tid);
   static inline CONTEXT *get_thread_context(THREADID tid);
   static inline bool release_thread_data(THREADID tid);
 
@@ -149,6 +155,8 @@ public:
 
   static inline thread_data_t *get_any_stopped_thread();
 
+  static void init_tls();
+
 private:
   void create_ctx()                    { if ( !ctx_ok() ) ctx = new CONTEXT; }
   inline void try_init_ext_tid(THREADID locat_tid);
@@ -156,6 +164,7 @@ private:
 
   CONTEXT *ctx;
   const idapin_registers_t *ctx_regs; // NULL if not defined->will get from ctx
+  trc_ring_t *ring;    // NULL until the thread records a trace event
   PIN_SEMAPHORE thr_sem;
   PIN_LOCK ctx_lock;
   pin_thid ext_tid;
@@ -168,6 +177,9 @@ private:
   static std::map <pin_thid, THREADID> local_tids;
   static PIN_LOCK thr_data_lock;
   static bool thr_data_lock_inited;
+  // thread_data_t of the current thread, to avoid thr_data_lock in
+  // analysis routines
+  static TLS_KEY tls_key;
 };
 
 //--------------------------------------------------------------------------
@@ -285,8 +297,10 @@ public:
   static inline void resume();
 
   static inline size_t tracebuf_size();
-  static inline bool tracebuf_is_full();
+  static inline bool tracebuf_is_full(trc_ring_t *ring);
   static inline void clear_trace();
+  static trc_ring_t *new_ring();
+  static void release_ring(trc_ring_t *ring);
   static int get_trace_events(idatrace_events_t *out_trc_events);
   static bool set_limits(bool only_new, uint32 enq_size, const char *imgname);
   static void process_image(const IMG &img, bool as_default);
@@ -343,12 +357,17 @@ private:
 
   static uint32 curr_trace_types();
 
-  // recorded instructions
-  typedef std::deque<trc_element_t> trc_deque_t;
-  static PIN_LOCK tracebuf_lock;
-  static trc_deque_t trace_addrs;
+  // recorded instructions: one ring per application thread.
+  // rings_lock protects the list, not the contents of the rings
+  typedef std::vector<trc_ring_t *> ring_list_t;
+  static PIN_LOCK rings_lock;
+  static ring_list_t rings;
+  // the sequence number of the next event get_trace_events expects
+  static uint64 read_seq;
   // semaphore used for pausing when trace buffer is full
   static PIN_SEMAPHORE tracebuf_sem;
+  // lock for all_addrs
+  static PIN_LOCK tracebuf_lock;
 
   // Already recorded instructions, those should be skipped if
   // only_new_instructions flag is true.
@@ -661,7 +680,7 @@ static VOID image_unload_cb(IMG img, VOID *)
 //lint -e{818} Pointer parameter 'ctx' could be declared as pointing to const
 static VOID thread_start_cb(THREADID tid, CONTEXT *ctx, INT32, VOID *)
 {
-  thread_data_t *tdata = thread_data_t::get_thread_data(tid);
+  thread_data_t *tdata = thread_data_t::attach_thread(tid);
   tdata->save_ctx(ctx);
 
   DEBUG(2, "thread_start_cb(%d/%d)\n", int(tid), int(thread_data_t::get_ext_thread_id(tid)));
@@ -812,7 +831,7 @@ static const char *const packet_names[] =
   "CLEAR TRACE",    "PAUSE",       "RESUME",      "RESUME START",
   "ADD BPT",        "DEL BPT",     "RESUME BPT",  "CAN READ REGS",
   "READ REGS",      "SET TRACE",   "SET OPTIONS", "STEP INTO",
-  "THREAD SUSPEND", "THREAD RESUME"
+  "THREAD SUSPEND", "THREAD RESUME", "READ TRACE PACKED"
 };
 
 //--------------------------------------------------------------------------
@@ -887,8 +906,9 @@ static bool accept_conn()
   // know if we're using the correct IDA version (32 or 64 bits)
   idapin_packet_t ans;
   ans.data = sizeof(ADDRINT) | addr_t(TARGET_OS);
-  // ...and the version of the protocol
-  ans.size = PIN_PROTOCOL_VERSION;
+  // ...and the version of the protocol. Clients before version 3 don't
+  // know PTT_READ_TRACE_PACKED: they get version 2
+  ans.size = req.size >= PIN_PROTOCOL_VERSION ? PIN_PROTOCOL_VERSION : 2;
   ans.code = PTT_ACK;
   if ( !send_packet(&ans, sizeof(idapin_packet_t), NULL, 0, __FUNCTION__) )
     return false;
@@ -1254,6 +1274,9 @@ static void handle_start_process(void)
   // Register PIN exception callback
   PIN_AddInternalExceptionHandler(internal_excp_cb, 0);
 
+  // Cache of the thread data for the analysis routines
+  thread_data_t::init_tls();
+
   // Create the thread for communicating with IDA
   THREADID thread_id = PIN_SpawnInternalThread(ida_pin_listener, NULL, 0, &listener_uid);
   if ( thread_id == INVALID_THREADID )
@@ -1539,6 +1562,30 @@ static bool handle_read_trace(void)
   return bytes == sizeof(trc_events);
 }
 
+//--------------------------------------------------------------------------
+// The buffers are static because they are large; only the listener
+// thread reads the trace
+static bool handle_read_trace_packed(uint32 flags)
+{
+  static idatrace_events_t trc_events;
+  static uchar buf[TRACE_EVENTS_SIZE * TRACE_PACKED_EVENT_MAX];
+  instrumenter_t::get_trace_events(&trc_events);
+  bool with_regs = (flags & TF_REGISTERS) != 0;
+  idatrace_packed_t pkt;
+  pkt.code = PTT_ACK;
+  pkt.count = trc_events.size;
+  pkt.flags = with_regs ? TF_REGISTERS : 0;
+  pkt.size = pin_size_t(pack_trace_events(buf, trc_events.trace, trc_events.size, with_regs));
+  DEBUG(3, "handle_read_trace_packed: %d events in %d bytes\n", int(pkt.count), int(pkt.size));
+  ssize_t bytes = pin_send(cli_socket, &pkt, sizeof(pkt), __FUNCTION__);
+  if ( bytes != sizeof(pkt) )
+    return false;
+  if ( pkt.size == 0 )
+    return true;
+  bytes = pin_send(cli_socket, buf, pkt.size, __FUNCTION__);
+  return bytes == ssize_t(pkt.size);
+}
+
 //--------------------------------------------------------------------------
 static bool handle_read_regs(THREADID tid)
 {
@@ -1771,6 +1818,9 @@ static bool handle_packet(const idapin_packet_t *res)
     case PTT_READ_TRACE:
       ret = handle_read_trace();
       break;
+    case PTT_READ_TRACE_PACKED:
+      ret = handle_read_trace_packed(uint32(res->data));
+      break;
     case PTT_CLEAR_TRACE:
       instrumenter_t::clear_trace();
       ret = true;
@@ -1995,10 +2045,12 @@ thread_data_t::thrdata_map_t thread_data_t::thr_data;
 std::map <pin_thid, THREADID> thread_data_t::local_tids;
 PIN_LOCK thread_data_t::thr_data_lock;
 bool thread_data_t::thr_data_lock_inited = false;
+TLS_KEY thread_data_t::tls_key;
+volatile uint64 trc_ring_t::seq_counter = 0;
 
 //--------------------------------------------------------------------------
 inline thread_data_t::thread_data_t()
-  : ctx(NULL), ctx_regs(NULL), ext_tid(NO_THREAD), susp(false), ev_handled(false)
+  : ctx(NULL), ctx_regs(NULL), ring(NULL), ext_tid(NO_THREAD), susp(false), ev_handled(false)
 {
   PIN_SemaphoreInit(&thr_sem);
   PIN_SemaphoreSet(&thr_sem);
@@ -2011,6 +2063,9 @@ inline thread_data_t::thread_data_t()
 inline thread_data_t::~thread_data_t()
 {
   delete ctx;
+  // the listener may not have read all the trace of the thread yet
+  if ( ring != NULL )
+    instrumenter_t::release_ring(ring);
   local_tids.erase(ext_tid);
   ctx_regs = NULL;
   --thread_cnt;
@@ -2082,9 +2137,40 @@ inline void thread_data_t::export_ctx(idapin_registers_t *regs)
 }
 
 //--------------------------------------------------------------------------
+inline trc_ring_t *thread_data_t::get_ring()
+{
+  if ( ring == NULL )
+    ring = instrumenter_t::new_ring();
+  return ring;
+}
+
+//--------------------------------------------------------------------------
+void thread_data_t::init_tls()
+{
+  tls_key = PIN_CreateThreadDataKey(NULL);
+}
+
+//--------------------------------------------------------------------------
+// thread data of the current thread
 inline thread_data_t *thread_data_t::get_thread_data()
 {
-  return get_thread_data(get_thread_id());
+  THREADID tid = get_thread_id();
+  thread_data_t *tdata = (thread_data_t *)PIN_GetThreadData(tls_key, tid);
+  if ( tdata == NULL )
+  {
+    tdata = get_thread_data(tid);
+    PIN_SetThreadData(tls_key, tdata, tid);
+  }
+  return tdata;
+}
+
+//--------------------------------------------------------------------------
+// called by a new thread: a thread with a reused id gets its own data
+inline thread_data_t *thread_data_t::attach_thread(THREADID tid)
+{
+  thread_data_t *tdata = get_thread_data(tid);
+  PIN_SetThreadData(tls_key, tdata, tid);
+  return tdata;
 }
 
 //--------------------------------------------------------------------------
@@ -2131,6 +2217,9 @@ inline bool thread_data_t::release_thread_data(THREADID tid)
   thrdata_map_t::iterator it = thr_data.find(tid);
   if ( it == thr_data.end() )
     return false;
+  // the TLS of get_thread_data() must not point to the deleted data,
+  // PIN may give the thread id to a new thread
+  PIN_SetThreadData(tls_key, NULL, tid);
   delete it->second;
   thr_data.erase(it);
   return true;
@@ -2615,9 +2704,11 @@ instrumenter_t::state = instrumenter_t::INSTR_STATE_INITIAL;
 uchar instrumenter_t::instrumentations = 0;
 
 // trace buffer
-PIN_LOCK instrumenter_t::tracebuf_lock;
-instrumenter_t::trc_deque_t instrumenter_t::trace_addrs;
+PIN_LOCK instrumenter_t::rings_lock;
+instrumenter_t::ring_list_t instrumenter_t::rings;
+uint64 instrumenter_t::read_seq = 0;
 PIN_SEMAPHORE instrumenter_t::tracebuf_sem;
+PIN_LOCK instrumenter_t::tracebuf_lock;
 // already recorded instructions
 instrumenter_t::addr_deque_t instrumenter_t::all_addrs;
 // limits
@@ -2657,7 +2748,9 @@ bool instrumenter_t::init()
   PIN_SemaphoreInit(&tracebuf_sem);
   // And immediately set it
   sema_set(&tracebuf_sem);
-  // Initialize the trace events list lock
+  // Initialize the trace ring list lock
+  PIN_InitLock(&rings_lock);
+  // Initialize the recorded instructions lock
   PIN_InitLock(&tracebuf_lock);
   return true;
 }
@@ -3014,7 +3107,7 @@ inline void instrumenter_t::add_to_trace(
   DEBUG(3, "add_to_trace1: Adding instruction at %p\n", (void*)ea);
 
   // set the current thread's context used for reading registers
-  thread_data_t *tdata = thread_data_t::get_thread_data(thread_data_t::get_thread_id());
+  thread_data_t *tdata = thread_data_t::get_thread_data();
   tdata->save_ctx(ctx);
   store_trace_entry(ctx, ea, tev_type);
 }
@@ -3033,33 +3126,89 @@ inline void instrumenter_t::store_trace_entry(
   ADDRINT ea,
   pin_tev_type_t tev_type)
 {
-  // wait until the tracebuf is read if it's full
-  app_wait(&tracebuf_sem);
+  // wait until the tracebuf is read if it's full.
+  // process_state is read without lock: a change is noticed
+  // at the next trace event at the latest
+  if ( !PIN_SemaphoreIsSet(&tracebuf_sem) || process_state != APP_STATE_RUNNING )
+    app_wait(&tracebuf_sem);
 
-  if ( tracebuf_is_full() )
+  trc_ring_t *ring = thread_data_t::get_thread_data()->get_ring();
+  if ( tracebuf_is_full(ring) )
     prepare_and_wait_trace_flush();
 
-  trc_element_t trc(PIN_GetTid(), ea, tev_type);
-  if ( instrumenter_t::tracing_registers && ctx != NULL )
-    get_context_regs(ctx, &trc.regs);
-
-  janitor_for_pinlock_t plj(&tracebuf_lock);
   if ( only_new_instructions )
+  {
+    janitor_for_pinlock_t plj(&tracebuf_lock);
     register_recorded_insn(ea);
-  trace_addrs.push_back(trc);
+  }
+  const CONTEXT *regs_ctx = tracing_registers ? ctx : NULL;
+  while ( !ring->push(ea, tev_type, regs_ctx) )
+  {
+    // the ring is full but the process is being suspended for another
+    // reason: wait until the listener reads the trace
+    prepare_and_wait_trace_flush();
+    PIN_Yield();
+  }
 }
 
 //--------------------------------------------------------------------------
 inline size_t instrumenter_t::tracebuf_size()
 {
-  janitor_for_pinlock_t plj(&tracebuf_lock);
-  return trace_addrs.size();
+  janitor_for_pinlock_t plj(&rings_lock);
+  size_t size = 0;
+  for ( ring_list_t::iterator p = rings.begin(); p != rings.end(); ++p )
+    size += (*p)->size();
+  return size;
 }
 
 //--------------------------------------------------------------------------
-inline bool instrumenter_t::tracebuf_is_full()
+// The trace buffer is full if all rings together hold enqueue_limit events
+// (or the ring of the current thread is full). Summing the rings takes
+// rings_lock, so a thread does it only when its ring reaches its quota:
+// the current size plus its share of the events still free.
+inline bool instrumenter_t::tracebuf_is_full(trc_ring_t *ring)
 {
-  return tracebuf_size() >= enqueue_limit;
+  size_t size = ring->size();
+  if ( size < ring->quota )
+    return false;
+  size_t total = tracebuf_size();
+  if ( total >= enqueue_limit || size >= ring->capacity() )
+    return true;
+  int n = thread_data_t::nthreads();
+  size_t share = (enqueue_limit - total) / (n > 1 ? n : 1);
+  if ( share == 0 )
+    share = 1;
+  ring->quota = size + share;
+  if ( ring->quota > ring->capacity() )
+    ring->quota = ring->capacity();
+  return false;
+}
+
+//--------------------------------------------------------------------------
+// called by an application thread when it records its first trace event
+trc_ring_t *instrumenter_t::new_ring()
+{
+  trc_ring_t *ring = new trc_ring_t(PIN_GetTid(), enqueue_limit);
+  janitor_for_pinlock_t plj(&rings_lock);
+  rings.push_back(ring);
+  return ring;
+}
+
+//--------------------------------------------------------------------------
+// called when the owner of the ring has exited
+void instrumenter_t::release_ring(trc_ring_t *ring)
+{
+  janitor_for_pinlock_t plj(&rings_lock);
+  if ( ring->size() != 0 )
+  {
+    // get_trace_events deletes it when it's drained
+    ring->retired = true;
+    return;
+  }
+  ring_list_t::iterator p = std::find(rings.begin(), rings.end(), ring);
+  if ( p != rings.end() )
+    rings.erase(p);
+  delete ring;
 }
 
 //--------------------------------------------------------------------------
@@ -3071,7 +3220,7 @@ inline void instrumenter_t::prepare_and_wait_trace_flush()
     janitor_for_pinlock_t process_state_guard(&process_state_lock);
     if ( process_state == APP_STATE_RUNNING )
     {
-      DEBUG(2, "prepare_and_wait_trace_flush: generate TRACE_FULL event (trace size=%d)\n", int(trace_addrs.size()));
+      DEBUG(2, "prepare_and_wait_trace_flush: generate TRACE_FULL event (trace size=%d)\n", int(tracebuf_size()));
       pin_debug_event_t event;
       event.eid = TRACE_FULL;
       events.push_front(event);
@@ -3087,22 +3236,27 @@ inline void instrumenter_t::prepare_and_wait_trace_flush()
 }
 
 //--------------------------------------------------------------------------
+// The rings are merged by the sequence numbers of the events, so the
+// events of all threads come in the order they were recorded, up to the
+// batches of trc_ring_t::push (see trc_ring_t::merge)
 int instrumenter_t::get_trace_events(idatrace_events_t *out_trc_events)
 {
-  out_trc_events->size = 0;
-  janitor_for_pinlock_t plj(&tracebuf_lock);
-  do
-  {
-    if ( trace_addrs.empty() )
-      break;
+  janitor_for_pinlock_t plj(&rings_lock);
+  trc_ring_t::merge(rings, &read_seq, out_trc_events);
 
-    trc_element_t trc = trace_addrs.front();
-    trace_addrs.pop_front();
-    out_trc_events->trace[out_trc_events->size].tid = trc.tid;
-    out_trc_events->trace[out_trc_events->size].ea = trc.ea;
-    out_trc_events->trace[out_trc_events->size].type = trc.type;
-    out_trc_events->trace[out_trc_events->size].registers = trc.regs;
-  } while ( ++out_trc_events->size < TRACE_EVENTS_SIZE );
+  // delete the drained rings of exited threads
+  for ( ring_list_t::iterator p = rings.begin(); p != rings.end(); )
+  {
+    if ( (*p)->retired && (*p)->size() == 0 )
+    {
+      delete *p;
+      p = rings.erase(p);
+    }
+    else
+    {
+      ++p;
+    }
+  }
   return out_trc_events->size;
 }
 
@@ -3115,8 +3269,11 @@ inline void instrumenter_t::resume()
 //--------------------------------------------------------------------------
 inline void instrumenter_t::clear_trace()
 {
-  janitor_for_pinlock_t plj(&tracebuf_lock);
-  trace_addrs.clear();
+  janitor_for_pinlock_t plj(&rings_lock);
+  for ( ring_list_t::iterator p = rings.begin(); p != rings.end(); ++p )
+    (*p)->clear();
+  // the numbers of the cleared events are not expected anymore
+  read_seq = trc_ring_t::next_seq();
 }
 
 //--------------------------------------------------------------------------
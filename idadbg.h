@@ -13,7 +13,11 @@ using namespace std;
 typedef unsigned int uint32;
 typedef unsigned char uchar;
 
-#define PIN_PROTOCOL_VERSION 2
+#define PIN_PROTOCOL_VERSION 3
+
+// version 3: PTT_READ_TRACE_PACKED. The PIN tool answers PTT_HELLO with
+// the lower of its own version and the version of the client, so a
+// client may send PTT_READ_TRACE_PACKED only if the answer is >= 3.
 
 #ifdef IDA_SDK_VERSION
 // IDA specific declarations
@@ -227,7 +231,8 @@ enum packet_type_t
   PTT_STEP = 23,
   PTT_THREAD_SUSPEND = 24,
   PTT_THREAD_RESUME = 25,
-  PTT_END = 26
+  PTT_READ_TRACE_PACKED = 26, // since v.3, see pack_trace_events
+  PTT_END = 27
 };
 
 //--------------------------------------------------------------------------
@@ -349,6 +354,15 @@ struct idatrace_events_t
   idatrace_data_t trace[TRACE_EVENTS_SIZE];
 };
 
+// answer to PTT_READ_TRACE_PACKED; 'size' bytes of packed events follow
+struct idatrace_packed_t
+{
+  packet_type_t code;
+  pin_size_t size;      // number of bytes that follow
+  pin_size_t count;     // number of events
+  uint32 flags;         // TF_REGISTERS if the registers are included
+};
+
 struct idabpt_packet_t
 {
   bpttype_t type;
@@ -384,4 +398,204 @@ struct idalimits_packet_t
 
 #pragma pack(pop)
 
+//--------------------------------------------------------------------------
+// Packed trace events (PTT_READ_TRACE_PACKED)
+//
+// The client sends PTT_READ_TRACE_PACKED with data = TF_REGISTERS if it
+// wants the registers, 0 otherwise. The answer is idatrace_packed_t
+// followed by the events, in runs of events of the same thread:
+//
+//   uvarint  thread id
+//   uvarint  number of events in the run
+//   for each event of the run:
+//     byte     event type
+//     svarint  ea minus the ea of the previous event (0 for the first one)
+//     only if TF_REGISTERS:
+//     uvarint  mask of the registers that differ from the previous event
+//              of the run (bit i: i-th field of idapin_registers_t)
+//     svarint  new minus old value, for each register in the mask
+//
+// uvarint: 7 bits per byte, lowest bits first, bit 7 set if more bytes
+// follow. svarint: uvarint of the zigzag coded value (0,-1,1,-2,...).
+// At the start of a run the previous registers are all BADADDR.
+// Without TF_REGISTERS, the registers of an event are all BADADDR
+// except eip = ea, as for events without recorded registers.
+//
+// Plain instruction tracing takes 3 bytes per event or so instead of
+// sizeof(idatrace_data_t). The coding functions call neither IDA nor
+// PIN; outside of both, this header needs only the types ADDRINT and
+// OS_THREAD_ID (see tests/packtrace_test.cpp).
+
+#define TRACE_NREGS (sizeof(idapin_registers_t) / sizeof(uint64))
+
+// maximal size of a packed event, including a run header
+#define TRACE_PACKED_EVENT_MAX (2*5 + 1 + 10 + 5 + TRACE_NREGS*10)
+
+//--------------------------------------------------------------------------
+inline void init_trace_regs(idapin_registers_t *regs, uint64 ea)
+{
+  uint64 *r = (uint64 *)regs;
+  for ( size_t i = 0; i < TRACE_NREGS; i++ )
+    r[i] = ~uint64(0);  // BADADDR
+  regs->eip = ea;
+}
+
+//--------------------------------------------------------------------------
+inline uchar *pack_uvarint(uchar *p, uint64 v)
+{
+  while ( v >= 0x80 )
+  {
+    *p++ = uchar(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = uchar(v);
+  return p;
+}
+
+//--------------------------------------------------------------------------
+inline uchar *pack_svarint(uchar *p, uint64 v)
+{
+  // v is the two's complement of a signed value
+  return pack_uvarint(p, (v << 1) ^ (uint64(0) - (v >> 63)));
+}
+
+//--------------------------------------------------------------------------
+// returns NULL if the number does not end before 'end'
+inline const uchar *unpack_uvarint(const uchar *p, const uchar *end, uint64 *v)
+{
+  *v = 0;
+  for ( int shift = 0; p < end && shift < 64; shift += 7 )
+  {
+    uchar b = *p++;
+    *v |= uint64(b & 0x7F) << shift;
+    if ( (b & 0x80) == 0 )
+      return p;
+  }
+  return NULL;
+}
+
+//--------------------------------------------------------------------------
+inline const uchar *unpack_svarint(const uchar *p, const uchar *end, uint64 *v)
+{
+  p = unpack_uvarint(p, end, v);
+  if ( p != NULL )
+    *v = (*v >> 1) ^ (uint64(0) - (*v & 1));
+  return p;
+}
+
+//--------------------------------------------------------------------------
+// Pack n events into buf, which must have room for
+// n * TRACE_PACKED_EVENT_MAX bytes. Returns the number of bytes used.
+inline size_t pack_trace_events(
+        uchar *buf,
+        const idatrace_data_t *events,
+        size_t n,
+        bool with_regs)
+{
+  uchar *p = buf;
+  uint64 prev_ea = 0;
+  idapin_registers_t prev;
+  for ( size_t i = 0; i < n; )
+  {
+    // a run of events of the same thread
+    size_t k = i + 1;
+    while ( k < n && events[k].tid == events[i].tid )
+      k++;
+    p = pack_uvarint(p, uint32(events[i].tid));
+    p = pack_uvarint(p, k - i);
+    init_trace_regs(&prev, ~uint64(0));
+    for ( ; i < k; i++ )
+    {
+      const idatrace_data_t &ev = events[i];
+      *p++ = uchar(ev.type);
+      p = pack_svarint(p, ev.ea - prev_ea);
+      prev_ea = ev.ea;
+      if ( !with_regs )
+        continue;
+      const uint64 *r = (const uint64 *)&ev.registers;
+      uint64 *o = (uint64 *)&prev;
+      uint32 mask = 0;
+      for ( size_t j = 0; j < TRACE_NREGS; j++ )
+        if ( r[j] != o[j] )
+          mask |= 1 << j;
+      p = pack_uvarint(p, mask);
+      for ( size_t j = 0; j < TRACE_NREGS; j++ )
+      {
+        if ( (mask & (1 << j)) != 0 )
+        {
+          p = pack_svarint(p, r[j] - o[j]);
+          o[j] = r[j];
+        }
+      }
+    }
+  }
+  return p - buf;
+}
+
+//--------------------------------------------------------------------------
+// Unpack the events of buf[0..size-1] into events[0..maxn-1].
+// Returns the number of events, or -1 if the data is malformed or has
+// more than maxn events. Data cut right after a run cannot be told
+// from a shorter answer: compare the result with idatrace_packed_t.count.
+inline int unpack_trace_events(
+        idatrace_data_t *events,
+        size_t maxn,
+        const uchar *buf,
+        size_t size,
+        bool with_regs)
+{
+  const uchar *p = buf;
+  const uchar *end = buf + size;
+  uint64 prev_ea = 0;
+  idapin_registers_t prev;
+  size_t n = 0;
+  while ( p < end )
+  {
+    uint64 tid, cnt;
+    p = unpack_uvarint(p, end, &tid);
+    if ( p == NULL )
+      return -1;
+    p = unpack_uvarint(p, end, &cnt);
+    if ( p == NULL || cnt > maxn - n )
+      return -1;
+    init_trace_regs(&prev, ~uint64(0));
+    for ( ; cnt > 0; cnt--, n++ )
+    {
+      idatrace_data_t &ev = events[n];
+      uint64 delta;
+      if ( p >= end )
+        return -1;
+      ev.type = *p++;
+      ev.tid = pin_thid(tid);
+      p = unpack_svarint(p, end, &delta);
+      if ( p == NULL )
+        return -1;
+      prev_ea += delta;
+      ev.ea = prev_ea;
+      if ( !with_regs )
+      {
+        init_trace_regs(&ev.registers, ev.ea);
+        continue;
+      }
+      uint64 mask;
+      p = unpack_uvarint(p, end, &mask);
+      if ( p == NULL || mask >= (uint64(1) << TRACE_NREGS) )
+        return -1;
+      uint64 *o = (uint64 *)&prev;
+      for ( size_t j = 0; j < TRACE_NREGS; j++ )
+      {
+        if ( (mask & (uint64(1) << j)) != 0 )
+        {
+          p = unpack_svarint(p, end, &delta);
+          if ( p == NULL )
+            return -1;
+          o[j] += delta;
+        }
+      }
+      ev.registers = prev;
+    }
+  }
+  return int(n);
+}
+
 #endif
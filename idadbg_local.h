@@ -8,6 +8,7 @@
 #include <deque>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -203,48 +204,6 @@ typedef WINDOWS::SOCKET SOCKET;
 #define sema_set(sem)          SEMAFORE_SET(sem)
 #define wait_after_callback()  WAIT_AFTER_CALLBACK()
 
-//--------------------------------------------------------------------------
-// tracebuf entry
-struct trc_element_t
-{
-  idapin_registers_t regs;
-  ADDRINT ea;
-  THREADID tid;
-  pin_tev_type_t type;
-
-  trc_element_t(THREADID _tid, ADDRINT _ea, pin_tev_type_t _type)
-    : ea(_ea), tid(_tid), type(_type)
-  {
-    regs.eip = ea;
-
-    regs.eax =
-    regs.ebx =
-    regs.ecx =
-    regs.edx =
-    regs.esi =
-    regs.edi =
-    regs.ebp =
-    regs.esp =
-#if defined(PIN_64)
-    regs.r8 =
-    regs.r9 =
-    regs.r10 =
-    regs.r11 =
-    regs.r12 =
-    regs.r13 =
-    regs.r14 =
-    regs.r15 =
-#endif
-    regs.eflags =
-    regs.cs =
-    regs.ds =
-    regs.es =
-    regs.fs =
-    regs.gs =
-    regs.ss = BADADDR;
-  };
-};
-
 //--------------------------------------------------------------------------
 class janitor_for_pinlock_t
 {
@@ -0,0 +1,228 @@
+#ifndef IDADBG_RING_H
+#define IDADBG_RING_H
+
+// Trace buffer of the application threads, included by idadbg.cpp after
+// pin.H and idadbg.h. It uses nothing else of PIN than ATOMIC::OPS,
+// PIN_Yield and get_context_regs, thus tests/tracering_test.cpp can
+// define these and test the rings without the PIN kit.
+
+//--------------------------------------------------------------------------
+static inline void get_context_regs(const CONTEXT *ctx, idapin_registers_t *regs);
+
+//--------------------------------------------------------------------------
+// tracebuf entry; the registers are kept in a separate array of the
+// trace ring (see trc_ring_t), only if registers are traced; without
+// them, the event gets the registers of init_trace_regs (idadbg.h)
+struct trc_element_t
+{
+  ADDRINT ea;
+  uint64 seq;            // order of the events of all threads
+  uint32 type;           // pin_tev_type_t
+  uint32 has_regs;       // registers were recorded for this entry
+};
+
+//--------------------------------------------------------------------------
+// Trace buffer of one application thread. The thread itself is the only
+// producer and the listener thread the only consumer, so the ring needs
+// no lock: the producer publishes an entry by advancing 'head' after
+// writing it, the consumer releases it by advancing 'tail' after reading.
+//
+// The consumer merges the rings by sequence numbers from a counter shared
+// by all rings (see merge). A thread doesn't take a number per event:
+// it looks at the counter every SEQ_BATCH events and takes a new number
+// only if another thread took one since. A thread that runs alone never
+// writes the counter, and threads that run at the same time write it
+// once per SEQ_BATCH events. The price is that the events of different
+// threads are ordered only up to SEQ_BATCH events of each thread.
+class trc_ring_t
+{
+public:
+  trc_ring_t(pin_thid _tid, uint32 limit);
+  ~trc_ring_t();
+
+  // number of entries in the ring (approximate if called by the producer)
+  size_t size() const
+  {
+    return ATOMIC::OPS::Load(&head) - ATOMIC::OPS::Load(&tail);
+  }
+  uint32 capacity() const              { return mask + 1; }
+  // the sequence number of the next batch of any thread
+  static uint64 next_seq()             { return ATOMIC::OPS::Load(&seq_counter); }
+  // events of a thread that may get the same number
+  static const uint32 SEQ_BATCH = 32;
+
+  // called by the producer
+  inline bool push(ADDRINT ea, pin_tev_type_t type, const CONTEXT *ctx);
+  // called by the consumer
+  inline bool peek_seq(uint64 *seq) const;
+  inline bool pop(idatrace_data_t *out);
+  inline void clear();
+  static inline int merge(
+        const std::vector<trc_ring_t *> &rings,
+        uint64 *read_seq,
+        idatrace_events_t *out);
+
+  // the owner thread has exited; the ring is deleted once it's drained
+  bool retired;
+  // size up to which the producer needn't check the whole trace buffer,
+  // see instrumenter_t::tracebuf_is_full; used by the producer only
+  size_t quota;
+
+private:
+  static const uint32 MIN_RING_SIZE = 0x10;
+  static const uint32 MAX_RING_SIZE = 0x10000;
+  static volatile uint64 seq_counter;
+
+  trc_element_t *entries;
+  idapin_registers_t *regs;  // allocated when the first registers are recorded
+  volatile uint32 head;      // written by the producer only
+  volatile uint32 tail;      // written by the consumer only
+  uint32 mask;               // capacity - 1, the capacity is a power of 2
+  uint64 batch_seq;          // number of the events of the producer
+  uint32 batch_left;         // events until the counter is looked at again
+  bool numbered;             // batch_seq is valid
+  pin_thid tid;
+};
+
+//--------------------------------------------------------------------------
+// The ring holds 'limit' events (the trace buffer size), rounded up to a
+// power of 2, but at most MAX_RING_SIZE.
+inline trc_ring_t::trc_ring_t(pin_thid _tid, uint32 limit)
+  : retired(false), quota(0), regs(NULL), head(0), tail(0),
+    batch_seq(0), batch_left(0), numbered(false), tid(_tid)
+{
+  uint32 size = MIN_RING_SIZE;
+  while ( size < limit && size < MAX_RING_SIZE )
+    size <<= 1;
+  mask = size - 1;
+  entries = new trc_element_t[size];
+}
+
+//--------------------------------------------------------------------------
+inline trc_ring_t::~trc_ring_t()
+{
+  delete [] entries;
+  delete [] regs;
+}
+
+//--------------------------------------------------------------------------
+// returns false if the ring is full
+inline bool trc_ring_t::push(ADDRINT ea, pin_tev_type_t type, const CONTEXT *ctx)
+{
+  uint32 h = head;
+  if ( h - ATOMIC::OPS::Load(&tail) > mask )
+    return false;
+  if ( batch_left == 0 )
+  {
+    // the counter is the number after the last one taken
+    if ( !numbered || ATOMIC::OPS::Load(&seq_counter) != batch_seq + 1 )
+      batch_seq = ATOMIC::OPS::Increment(&seq_counter, (uint64)1);
+    numbered = true;
+    batch_left = SEQ_BATCH;
+  }
+  --batch_left;
+  uint32 i = h & mask;
+  trc_element_t &trc = entries[i];
+  trc.ea = ea;
+  trc.seq = batch_seq;
+  trc.type = type;
+  trc.has_regs = ctx != NULL;
+  if ( ctx != NULL )
+  {
+    if ( regs == NULL )
+      regs = new idapin_registers_t[mask + 1];
+    get_context_regs(ctx, &regs[i]);
+  }
+  // the entry must be complete before the consumer can see it
+  ATOMIC::OPS::Store(&head, h + 1);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// returns false if the ring is empty
+inline bool trc_ring_t::peek_seq(uint64 *seq) const
+{
+  uint32 t = tail;
+  if ( t == ATOMIC::OPS::Load(&head) )
+    return false;
+  *seq = entries[t & mask].seq;
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// returns false if the ring is empty
+inline bool trc_ring_t::pop(idatrace_data_t *out)
+{
+  uint32 t = tail;
+  if ( t == ATOMIC::OPS::Load(&head) )
+    return false;
+  uint32 i = t & mask;
+  const trc_element_t &trc = entries[i];
+  out->ea = trc.ea;
+  out->tid = tid;
+  out->type = trc.type;
+  if ( trc.has_regs )
+    out->registers = regs[i];
+  else
+    init_trace_regs(&out->registers, trc.ea);
+  ATOMIC::OPS::Store(&tail, t + 1);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+inline void trc_ring_t::clear()
+{
+  ATOMIC::OPS::Store(&tail, ATOMIC::OPS::Load(&head));
+}
+
+//--------------------------------------------------------------------------
+// Moves the events of the rings to 'out' in the order of their sequence
+// numbers; *read_seq is the number the merge expects next. A missing
+// number is a batch that its thread has numbered but not yet published:
+// the merge stops there and the event comes with the next read. If the
+// gap comes first, the merge waits for the event for a while, and then
+// goes on without it. An event with a number below *read_seq, i.e. of a
+// batch that was continued after a later batch was read, comes at once.
+// Returns the number of events.
+inline int trc_ring_t::merge(
+  const std::vector<trc_ring_t *> &rings,
+  uint64 *read_seq,
+  idatrace_events_t *out)
+{
+  out->size = 0;
+  size_t n = rings.size();
+  int waits = 0;
+  while ( out->size < TRACE_EVENTS_SIZE )
+  {
+    trc_ring_t *next = NULL;
+    uint64 next_seq = 0;
+    for ( size_t k = 0; k < n; k++ )
+    {
+      uint64 seq;
+      if ( rings[k]->peek_seq(&seq) && (next == NULL || seq < next_seq) )
+      {
+        next = rings[k];
+        next_seq = seq;
+      }
+    }
+    if ( next == NULL )
+      break;
+    if ( next_seq > *read_seq )
+    {
+      if ( out->size != 0 )
+        break;
+      if ( ++waits < 100 )
+      {
+        PIN_Yield();
+        continue;
+      }
+    }
+    next->pop(&out->trace[out->size]);
+    ++out->size;
+    if ( next_seq >= *read_seq )
+      *read_seq = next_seq + 1;
+  }
+  return out->size;
+}
+
+#endif // IDADBG_RING_H
@@ -0,0 +1,1568 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         incrlayout.c                                       */
+/*   description:  Incremental relayout: reuse of unchanged layers    */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * Folding or unfolding a subgraph or region starts a complete new
+ * layout (relayout in vcg_main.c). Usually, most of the layers are
+ * the same as before. With option -incremental, the crossing reduction
+ * keeps the order of these layers and optimizes only the others:
+ *
+ * 1) After the crossing reduction of step2, remember_layer_order stores
+ *    for each node the level and the position. Real nodes (nodes of the
+ *    nodelist) survive the relayout, thus the values are stored in the
+ *    node itself (NOLDLEVEL, NOLDPOS), together with a stamp NOLDSTAMP
+ *    that tells which layout they belong to. Dummy nodes are allocated again on
+ *    each layout. They are identified by the real nodes at both ends
+ *    of their chain of dummy nodes, and stored in a hash table.
+ *
+ * 2) After the initial ordering of step2, seed_layer_order looks for
+ *    each node of the new layers for the old level and position.
+ *    A layer is unchanged if all its nodes are found at the same level,
+ *    and if it has the same number of nodes as before. Unchanged layers
+ *    get their old order again. They are frozen unless they are
+ *    neighboured to a changed layer.
+ *
+ * 3) The phases of the crossing reduction skip the frozen layers
+ *    (layer_is_frozen). The local optimizations after the resolution
+ *    of connections are done for all layers as before, thus an
+ *    unchanged graph gets exactly the same layout again.
+ *
+ * The coordinates are still calculated completely by step3, because
+ * the x positions of different layers depend on each other.
+ *
+ * The anytime layout (see timelim.c) sets incremental_layout to 2:
+ * all unchanged layers get their old order, but none is frozen, thus
+ * the crossing reduction continues from the previous layout.
+ *
+ * With option -warmstart <file>, the previous layout comes from a file
+ * instead, e.g. the layout of a graph before it was edited and exported
+ * again. The file has the format of print_graph_binary (grprint.c):
+ * the title, position, level and position in the level of each node,
+ * and the edges. The nodes are identified by their titles.
+ *
+ * 1) Before step1, warm_start_seed reads the file. A node with the title
+ *    of an old node gets the old level (as by the attribute level), if
+ *    no level is specified for it. warm_start_unseed removes these
+ *    levels after step1 again.
+ *
+ * 2) In seed_layer_order, the nodes of each layer are sorted by their
+ *    old x co-ordinate. Dummy nodes get the x co-ordinate of the dummy
+ *    node of their edge at the same level in the old layout, or if
+ *    there is none, a value interpolated between the real nodes at the
+ *    ends of their chain. New nodes stay behind their left neighbour
+ *    of the initial order. A layer is unchanged if all its real nodes are old
+ *    nodes of the same level, and all its dummy nodes belong to edges
+ *    between old nodes that were connected before. Unchanged layers are
+ *    frozen as above, thus only the changed parts are optimized.
+ *
+ * 3) Before the balancing of step3, warm_start_place gives each node
+ *    the old x co-ordinate of its center (the dummy nodes that of the
+ *    old dummy node of their chain), as far as the distances to the
+ *    left neighbours allow. The balancing skips the frozen layers
+ *    (layer_is_placed), thus an unchanged layer keeps its old
+ *    co-ordinates, up to a common shift of the whole drawing. Only the
+ *    changed layers are balanced around them.
+ *
+ * 4) The first complete layout of the fully unfolded graph (see also
+ *    layout_complete in layoutcache.c) is written into the file by
+ *    warm_start_store, for the next export of the graph. Relayouts
+ *    after folding, the levels of the anytime layout before the last
+ *    one and layouts cut by the time limit are not stored.
+ *
+ * A cache entry of layoutcache.c is a warm start file of the same
+ * graph, which is used for the first layout after the graph is parsed
+ * (warm_exact). Then the levels are not seeded, because step1 gives
+ * the same levels anyway. A dummy node is matched with the old dummy
+ * node of the same chain (warm_chain_pair), or at a turn, of the chain
+ * to the same other node (warm_turn). All layers are frozen, and after
+ * the local optimizations of step2, warm_start_restore sorts each
+ * layer as in the file again, thus step3 and step4 calculate the same
+ * co-ordinates as before. warm_start_place does nothing in this case.
+ * If a real node is missing in its layer, the entry is ignored; if
+ * a layer does not match after step2, relayout starts again without
+ * the entry (warm_start_missed).
+ *
+ * This file provides the following functions:
+ *
+ * remember_layer_order	store the order of the layers for the next layout
+ * seed_layer_order	restore the order of unchanged layers
+ * layer_is_frozen	check whether a layer must not be reordered
+ * warm_start_seed	read the warm start file and seed the levels
+ * warm_start_unseed	remove the seeded levels after step1
+ * warm_start_active	check whether the layout is seeded from a file
+ * warm_start_restore	restore the order of a cache entry after step2
+ * warm_start_missed	check whether the cache entry did not match
+ * warm_start_place	seed the x co-ordinates of step3 from the file
+ * layer_is_placed	check whether step3 must not move a layer
+ * warm_start_reset	called by parse_part for a new graph
+ * warm_start_store	write the layout into the warm start file
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "steps.h"
+#include "grprint.h"
+#include "layoutcache.h"
+#include "timing.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+#define xralign(a)  ((((a)+G_xraster-1)/G_xraster)*G_xraster)
+#define dxralign(a) ((((a)+G_dxraster-1)/G_dxraster)*G_dxraster)
+
+
+/* Types
+ * =====
+ */
+
+/* Old position of a dummy node: the chain of dummy nodes goes from the
+ * real node upper to the real node lower.
+ */
+
+typedef struct oldpos {
+	GNODE	upper;		/* real node at the upper end of the chain */
+	GNODE	lower;		/* real node at the lower end of the chain */
+	int	level;		/* level of the dummy node                 */
+	int	pos;		/* position of the dummy node              */
+	int	used;		/* 1, if already matched with a new node   */
+	int	next;		/* next entry in the hash chain, or -1     */
+} OLDPOS;
+
+
+/* Key for sorting a layer
+ */
+
+typedef struct seedkey {
+	int	key;
+	int	idx;		/* position in the initial order, for ties */
+	GNODE	node;
+} SEEDKEY;
+
+
+/* Node of the warm start file
+ */
+
+typedef struct warmnode {
+	char	*title;
+	long	x;		/* x co-ordinate of the center        */
+	int	level;
+	int	real;		/* 0 for dummy and label nodes        */
+	int	succ;		/* next node of a chain, or -1        */
+	int	next;		/* next entry in the hash chain or -1 */
+	int	turn, turn2;	/* the smallest real nodes of chains  */
+				/* that end here, or -1               */
+} WARMNODE;
+
+
+/* Pair of old nodes that were connected by an edge or a chain
+ */
+
+typedef struct warmpair {
+	int	a, b;		/* a < b */
+	int	from;		/* a or b: the upper end of the chain  */
+	int	first;		/* first dummy node of the chain or -1 */
+	int	used;		/* 1, if matched with a new chain      */
+	int	turn;		/* 1, if the chain ends at a turn      */
+	int	next;		/* next entry in the hash chain or -1 */
+} WARMPAIR;
+
+
+/* Prototypes
+ * ==========
+ */
+
+static GNODE	chain_end	_PP((GNODE v, int up));
+static GNODE	chain_top	_PP((GNODE v));
+static int	dummy_hash	_PP((GNODE upper, GNODE lower, int level));
+static void	enlarge_oldpos	_PP((int n));
+static int	old_position	_PP((GNODE v, int level));
+static int	compare_seedkey	_PP((const SEEDKEY *a, const SEEDKEY *b));
+static void	sort_layer	_PP((GNLIST li, int n));
+static int	warm_x		_PP((GNODE v, int level, long *x));
+static int	warm_layer_keys	_PP((GNLIST li, int level, int *n));
+static int	warm_read	_PP((char *fname));
+static void	warm_free	_PP((void));
+static int	warm_folded	_PP((void));
+static int	warm_lookup	_PP((char *title));
+static int	warm_pair	_PP((int a, int b));
+static void	warm_add_pair	_PP((int a, int b, int first));
+static int	warm_chain_pair	_PP((GNODE v, int ku, int kl, int kp,
+					     int turn));
+static int	warm_turn	_PP((GNODE v, int ku));
+static int	warm_chain	_PP((GNODE upper, GNODE lower, int *ku, int *kl,
+				     int *kp));
+static int	warm_connection	_PP((GNODE v, GNODE *a));
+static unsigned long warm_uvarint _PP((void));
+static long	warm_svarint	_PP((void));
+static unsigned long title_hash	_PP((char *s, int len));
+
+
+/* Global variables
+ * ================
+ */
+
+static int	layout_stamp = 0;	/* number of the remembered layout */
+
+static int	*old_anz     = NULL;	/* number of nodes per old layer   */
+static int	old_maxdepth = -1;	/* maxdepth of the old layout      */
+static int	old_size     = 0;	/* size of old_anz                 */
+
+static OLDPOS	*oldpos      = NULL;	/* positions of old dummy nodes    */
+static int	oldpos_num   = 0;	/* number of entries of oldpos     */
+static int	oldpos_size  = 0;	/* size of oldpos                  */
+static int	*oldpos_hash = NULL;	/* hash table into oldpos          */
+static int	hash_size    = 0;	/* size of oldpos_hash             */
+
+static char	*frozen      = NULL;	/* 1, if the layer is frozen       */
+static int	frozen_size  = 0;	/* size of frozen                  */
+static int	frozen_valid = 0;	/* 1, if frozen belongs to step2   */
+
+static SEEDKEY	*seedkeys    = NULL;	/* sort array of seed_layer_order  */
+static int	seedkey_size = 0;	/* size of seedkeys                */
+
+static WARMNODE	*warm        = NULL;	/* nodes of the warm start file    */
+static int	warm_num     = 0;	/* number of entries of warm       */
+static char	*warm_titles = NULL;	/* the titles of these nodes       */
+static int	*warm_hash   = NULL;	/* hash table of the titles        */
+static WARMPAIR	*warm_pairs  = NULL;	/* connected pairs of old nodes    */
+static int	warm_npairs  = 0;	/* number of entries of warm_pairs */
+static int	*warm_phash  = NULL;	/* hash table of the pairs         */
+static int	warm_hsize   = 0;	/* size of both hash tables        */
+static int	warm_loaded  = 0;	/* 1, if the file is read          */
+static int	warm_placed  = 0;	/* 1, if step3 is seeded from it   */
+static int	warm_pending = 0;	/* 1, if the graph is to be stored */
+static int	warm_replay  = 0;	/* 1, if the cache is not yet used */
+static int	warm_exact   = 0;	/* 1, if the file is a cache entry */
+static int	warm_missed  = 0;	/* 1, if the cache entry mismatched */
+
+static GNODE	*warm_seeded = NULL;	/* nodes that got a level          */
+static int	warm_nseeded = 0;	/* number of these nodes           */
+
+static unsigned char *warm_buf = NULL;	/* contents of the file            */
+static long	warm_len     = 0L;	/* size of the file                */
+static long	warm_at      = 0L;	/* read position                   */
+static int	warm_bad     = 0;	/* 1, if the file is corrupt       */
+
+
+/*--------------------------------------------------------------------*/
+/*  Identification of dummy nodes                                     */
+/*--------------------------------------------------------------------*/
+
+/*  End of a chain of dummy nodes
+ *  -----------------------------
+ *  returns the first real node above (up=1) or below (up=0) of v,
+ *  or NULL if the chain ends at a dummy node.
+ */
+
+#ifdef ANSI_C
+static GNODE chain_end(GNODE v, int up)
+#else
+static GNODE chain_end(v, up)
+GNODE	v;
+int	up;
+#endif
+{
+	while (v && !NINLIST(v)) {
+		if (up) {
+			if (!NPRED(v)) return(NULL);
+			v = ESTART(AKANTE(NPRED(v)));
+		}
+		else {
+			if (!NSUCC(v)) return(NULL);
+			v = EEND(AKANTE(NSUCC(v)));
+		}
+	}
+	return(v);
+}
+
+
+/*  Top of a turn
+ *  -------------
+ *  A chain may start at a dummy node without predecessor that is
+ *  connected to a real node of its level, e.g. if an edge goes up
+ *  and down again. Returns this real node, or NULL.
+ */
+
+#ifdef ANSI_C
+static GNODE chain_top(GNODE v)
+#else
+static GNODE chain_top(v)
+GNODE	v;
+#endif
+{
+	CONNECT	c;
+
+	while (v && !NINLIST(v) && NPRED(v)) v = ESTART(AKANTE(NPRED(v)));
+	if (!v || NINLIST(v)) return(NULL);
+	c = NCONNECT(v);
+	if (!c) return(NULL);
+	if (CTARGET(c)  && NINLIST(CTARGET(c)))  return(CTARGET(c));
+	if (CTARGET2(c) && NINLIST(CTARGET2(c))) return(CTARGET2(c));
+	return(NULL);
+}
+
+
+#ifdef ANSI_C
+static int dummy_hash(GNODE upper, GNODE lower, int level)
+#else
+static int dummy_hash(upper, lower, level)
+GNODE	upper;
+GNODE	lower;
+int	level;
+#endif
+{
+	unsigned long h;
+
+	h = (unsigned long)(size_t)upper * 31UL
+	  + (unsigned long)(size_t)lower * 17UL
+	  + (unsigned long)level;
+	h ^= (h >> 13);
+	return((int)(h % (unsigned long)hash_size));
+}
+
+
+#ifdef ANSI_C
+static void enlarge_oldpos(int n)
+#else
+static void enlarge_oldpos(n)
+int	n;
+#endif
+{
+	int	i;
+
+	if (n > oldpos_size) {
+		if (oldpos) free(oldpos);
+		oldpos_size = n + 1024;
+		oldpos = (OLDPOS *)malloc(oldpos_size * sizeof(OLDPOS));
+		if (!oldpos) Fatal_error("memory exhausted","");
+	}
+	if (2*n+1 > hash_size) {
+		if (oldpos_hash) free(oldpos_hash);
+		hash_size = 2*n+1;
+		oldpos_hash = (int *)malloc(hash_size * sizeof(int));
+		if (!oldpos_hash) Fatal_error("memory exhausted","");
+	}
+	for (i=0; i<hash_size; i++) oldpos_hash[i] = -1;
+	oldpos_num = 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Remember the layout                                               */
+/*--------------------------------------------------------------------*/
+
+/*  Store the order of the layers l[0..maxdepth+1]
+ *  ----------------------------------------------
+ *  This is called by step2 after the crossing reduction, but before
+ *  the connections are resolved, because the nodes of connections are
+ *  not yet part of the layers when seed_layer_order is called.
+ *  From now on, no layer is frozen.
+ */
+
+#ifdef ANSI_C
+void remember_layer_order(DEPTH *l)
+#else
+void remember_layer_order(l)
+DEPTH	*l;
+#endif
+{
+	GNLIST	li;
+	GNODE	v;
+	OLDPOS	*p;
+	int	i, pos, ndummies, h;
+
+	debugmessage("remember_layer_order","");
+	frozen_valid = 0;
+	layout_stamp++;
+
+	if (maxdepth+2 > old_size) {
+		if (old_anz) free(old_anz);
+		old_size = maxdepth+2;
+		old_anz = (int *)malloc(old_size * sizeof(int));
+		if (!old_anz) Fatal_error("memory exhausted","");
+	}
+	old_maxdepth = maxdepth;
+
+	/* First the real nodes, because the dummy nodes refer to them */
+
+	ndummies = 0;
+	for (i=0; i<=maxdepth+1; i++) {
+		pos = 0;
+		li = l[i].succlist;
+		while (li) {
+			v = GNNODE(li);
+			if (NINLIST(v)) {
+				NOLDLEVEL(v) = i;
+				NOLDPOS(v)   = pos;
+				NOLDSTAMP(v) = layout_stamp;
+			}
+			else ndummies++;
+			pos++;
+			li = GNNEXT(li);
+		}
+		old_anz[i] = pos;
+	}
+
+	enlarge_oldpos(ndummies);
+	for (i=0; i<=maxdepth+1; i++) {
+		pos = 0;
+		li = l[i].succlist;
+		while (li) {
+			v = GNNODE(li);
+			if (!NINLIST(v)) {
+				p = &oldpos[oldpos_num];
+				p->upper = chain_end(v, 1);
+				p->lower = chain_end(v, 0);
+				p->level = i;
+				p->pos   = pos;
+				p->used  = 0;
+				h = dummy_hash(p->upper, p->lower, i);
+				p->next  = oldpos_hash[h];
+				oldpos_hash[h] = oldpos_num++;
+			}
+			pos++;
+			li = GNNEXT(li);
+		}
+	}
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Reuse the layout                                                  */
+/*--------------------------------------------------------------------*/
+
+/*  Old position of a node at level
+ *  -------------------------------
+ *  returns -1 if the node was not at this level in the old layout.
+ *  Each old dummy node is matched only once.
+ */
+
+#ifdef ANSI_C
+static int old_position(GNODE v, int level)
+#else
+static int old_position(v, level)
+GNODE	v;
+int	level;
+#endif
+{
+	GNODE	upper, lower;
+	int	k;
+
+	if (NINLIST(v)) {
+		if (NOLDSTAMP(v) != layout_stamp) return(-1);
+		if (NOLDLEVEL(v) != level) return(-1);
+		return(NOLDPOS(v));
+	}
+	upper = chain_end(v, 1);
+	lower = chain_end(v, 0);
+
+	/* The real nodes must be part of the old layout, otherwise their
+	 * addresses may belong to a different graph.
+	 */
+
+	if (upper && (NOLDSTAMP(upper) != layout_stamp)) return(-1);
+	if (lower && (NOLDSTAMP(lower) != layout_stamp)) return(-1);
+
+	k = oldpos_hash[dummy_hash(upper, lower, level)];
+	while (k >= 0) {
+		if (   (!oldpos[k].used) && (oldpos[k].level == level)
+		    && (oldpos[k].upper == upper) && (oldpos[k].lower == lower)) {
+			oldpos[k].used = 1;
+			return(oldpos[k].pos);
+		}
+		k = oldpos[k].next;
+	}
+	return(-1);
+}
+
+
+#ifdef ANSI_C
+static int compare_seedkey(const SEEDKEY *a, const SEEDKEY *b)
+#else
+static int compare_seedkey(a, b)
+SEEDKEY	*a;
+SEEDKEY	*b;
+#endif
+{
+	if (a->key > b->key) return(1);
+	if (a->key < b->key) return(-1);
+	if (a->idx > b->idx) return(1);
+	if (a->idx < b->idx) return(-1);
+	return(0);
+}
+
+
+/*  Sort the layer li by the n keys of seedkeys
+ *  -------------------------------------------
+ */
+
+#ifdef ANSI_C
+static void sort_layer(GNLIST li, int n)
+#else
+static void sort_layer(li, n)
+GNLIST	li;
+int	n;
+#endif
+{
+	int	j;
+
+#ifdef ANSI_C
+	qsort(seedkeys, n, sizeof(SEEDKEY),
+		(int (*) (const void *, const void *))compare_seedkey);
+#else
+	qsort(seedkeys, n, sizeof(SEEDKEY), compare_seedkey);
+#endif
+	j = 0;
+	while (li) {
+		GNNODE(li) = seedkeys[j++].node;
+		li = GNNEXT(li);
+	}
+}
+
+
+/*  Restore the order of unchanged layers
+ *  -------------------------------------
+ *  l is the layer array of step2, after the initial ordering.
+ *  The node lists of unchanged layers are reordered as in the old
+ *  layout, and the frozen layers are marked (not if incremental_layout
+ *  is 2). With a warm start file, all layers are reordered as the
+ *  old layout, unless there is a previous layout in memory.
+ */
+
+#ifdef ANSI_C
+void seed_layer_order(DEPTH *l)
+#else
+void seed_layer_order(l)
+DEPTH	*l;
+#endif
+{
+	GNLIST	li;
+	int	i, j, n, pos, changed, use_warm;
+
+	debugmessage("seed_layer_order","");
+	frozen_valid = 0;
+	use_warm = warm_loaded && (   warm_exact || (!incremental_layout)
+				   || (layout_stamp == 0));
+	if ((!incremental_layout) && (!use_warm)) return;
+
+	if (maxdepth+2 > frozen_size) {
+		if (frozen) free(frozen);
+		frozen_size = maxdepth+2;
+		frozen = (char *)malloc(frozen_size * sizeof(char));
+		if (!frozen) Fatal_error("memory exhausted","");
+	}
+	if (max_nodes_per_layer+2 > seedkey_size) {
+		if (seedkeys) free(seedkeys);
+		seedkey_size = max_nodes_per_layer+2;
+		seedkeys = (SEEDKEY *)malloc(seedkey_size * sizeof(SEEDKEY));
+		if (!seedkeys) Fatal_error("memory exhausted","");
+	}
+	for (j=0; j<oldpos_num; j++) oldpos[j].used = 0;
+
+	/* A cache entry must contain each real node at its level,
+	 * otherwise the layout is calculated as without cache. Some
+	 * dummy nodes are found only after the connections are resolved
+	 * (see warm_start_restore), thus all layers are frozen.
+	 */
+
+	if (use_warm && warm_exact) {
+		for (i=0; i<=maxdepth+1; i++)
+			if (warm_layer_keys(l[i].succlist, i, &n) == 2) break;
+		if (i <= maxdepth+1) {
+			warm_free();
+			warm_exact = 0;
+			return;
+		}
+	}
+
+	/* frozen[i] is first 1 for unchanged layers */
+
+	for (i=0; i<=maxdepth+1; i++) {
+		if (use_warm) {
+			changed = warm_layer_keys(l[i].succlist, i, &n);
+			if (warm_exact) changed = 0;
+		}
+		else {
+			changed = (layout_stamp == 0) || (i > old_maxdepth+1);
+			n = 0;
+			li = l[i].succlist;
+			while (li && !changed) {
+				assert((n < seedkey_size));
+				pos = old_position(GNNODE(li), i);
+				if (pos < 0) changed = 1;
+				seedkeys[n].key  = pos;
+				seedkeys[n].idx  = n;
+				seedkeys[n].node = GNNODE(li);
+				n++;
+				li = GNNEXT(li);
+			}
+			if (!changed && (n != old_anz[i])) changed = 1;
+		}
+		frozen[i] = !changed && (incremental_layout != 2);
+		if (changed && !use_warm) continue;
+		sort_layer(l[i].succlist, n);
+	}
+
+	/* Neighbours of changed layers are optimized, too */
+
+	for (i=0; i<=maxdepth+1; i++) {
+		if (frozen[i] != 1) continue;
+		if ((i>0) && (frozen[i-1]==0)) frozen[i] = 2;
+		else if ((i<=maxdepth) && (frozen[i+1]==0)) frozen[i] = 2;
+	}
+	n = 0;
+	for (i=0; i<=maxdepth+1; i++) {
+		if (frozen[i]==2) frozen[i] = 0;
+		if (frozen[i]) n++;
+	}
+	frozen_valid = 1;
+
+#ifdef DEBUG
+	PRINTF("Incremental layout: %d of %d layers frozen\n",n,maxdepth+2);
+#endif
+}
+
+
+/*  Check whether a layer is frozen
+ *  -------------------------------
+ */
+
+#ifdef ANSI_C
+int layer_is_frozen(int i)
+#else
+int layer_is_frozen(i)
+int	i;
+#endif
+{
+	if (!frozen_valid) return(0);
+	if ((i<0) || (i>maxdepth+1)) return(0);
+	return(frozen[i]);
+}
+
+
+
+/*--------------------------------------------------------------------*/
+/*  Warm start from a file                                            */
+/*--------------------------------------------------------------------*/
+
+#ifdef ANSI_C
+static unsigned long warm_uvarint(void)
+#else
+static unsigned long warm_uvarint()
+#endif
+{
+	unsigned long u;
+	int	shift;
+
+	u = 0UL;
+	shift = 0;
+	while (warm_at < warm_len) {
+		u |= ((unsigned long)(warm_buf[warm_at] & 0x7f)) << shift;
+		if (!(warm_buf[warm_at++] & 0x80)) return(u);
+		shift += 7;
+		if (shift > 56) break;
+	}
+	warm_bad = 1;
+	return(0UL);
+}
+
+
+#ifdef ANSI_C
+static long warm_svarint(void)
+#else
+static long warm_svarint()
+#endif
+{
+	unsigned long u;
+
+	u = warm_uvarint();
+	if (u & 1UL) return(-(long)(u>>1) - 1L);
+	return((long)(u>>1));
+}
+
+
+#ifdef ANSI_C
+static unsigned long title_hash(char *s, int len)
+#else
+static unsigned long title_hash(s, len)
+char	*s;
+int	len;
+#endif
+{
+	unsigned long h;
+	int	i;
+
+	h = 5381UL;
+	for (i=0; i<len; i++) h = h*33UL + (unsigned char)s[i];
+	return(h % (unsigned long)warm_hsize);
+}
+
+
+#ifdef ANSI_C
+static void warm_free(void)
+#else
+static void warm_free()
+#endif
+{
+	if (warm)        free(warm);
+	if (warm_titles) free(warm_titles);
+	if (warm_hash)   free(warm_hash);
+	if (warm_pairs)  free(warm_pairs);
+	if (warm_phash)  free(warm_phash);
+	if (warm_buf)    free(warm_buf);
+	warm = NULL;       warm_titles = NULL;
+	warm_hash = NULL;  warm_pairs  = NULL;
+	warm_phash = NULL; warm_buf    = NULL;
+	warm_num = warm_npairs = warm_hsize = 0;
+	warm_loaded = 0;
+}
+
+
+/*  Index of the old node with this title, or -1
+ *  --------------------------------------------
+ */
+
+#ifdef ANSI_C
+static int warm_lookup(char *title)
+#else
+static int warm_lookup(title)
+char	*title;
+#endif
+{
+	int	k;
+
+	if (!title || !warm_hsize) return(-1);
+	k = warm_hash[title_hash(title, (int)strlen(title))];
+	while (k >= 0) {
+		if (warm[k].real && !strcmp(warm[k].title, title)) return(k);
+		k = warm[k].next;
+	}
+	return(-1);
+}
+
+
+/*  Pair of connected old nodes
+ *  ---------------------------
+ *  Returns the index of the pair a, b in warm_pairs, or -1.
+ */
+
+#ifdef ANSI_C
+static int warm_pair(int a, int b)
+#else
+static int warm_pair(a, b)
+int	a;
+int	b;
+#endif
+{
+	int	k;
+
+	if (a > b) { k = a; a = b; b = k; }
+	k = warm_phash[((unsigned long)a*31UL + (unsigned long)b)
+			% (unsigned long)warm_hsize];
+	while (k >= 0) {
+		if ((warm_pairs[k].a == a) && (warm_pairs[k].b == b)) return(k);
+		k = warm_pairs[k].next;
+	}
+	return(-1);
+}
+
+
+/*  Old nodes of the ends of a chain
+ *  --------------------------------
+ *  The chain from upper to lower is matched with a chain of the old
+ *  layout between *ku and *kl, the pair *kp of warm_pairs. Before the connections are resolved,
+ *  a chain may end at a node that is connected to the end of the old
+ *  chain, thus the nodes connected to the ends are tried, too.
+ */
+
+#define WARM_CONN 16	/* maximal number of connected nodes tried */
+
+#ifdef ANSI_C
+static int warm_chain(GNODE upper, GNODE lower, int *ku, int *kl, int *kp)
+#else
+static int warm_chain(upper, lower, ku, kl, kp)
+GNODE	upper;
+GNODE	lower;
+int	*ku;
+int	*kl;
+int	*kp;
+#endif
+{
+	GNODE	u[WARM_CONN], l[WARM_CONN];
+	int	nu, nl, i, j;
+
+	nu = warm_connection(upper, u);
+	nl = warm_connection(lower, l);
+	for (i=0; i<nu; i++) {
+		if (NWARM(u[i]) < 0) continue;
+		for (j=0; j<nl; j++) {
+			if (NWARM(l[j]) < 0) continue;
+			*kp = warm_pair(NWARM(u[i]), NWARM(l[j]));
+			if (*kp >= 0) {
+				*ku = NWARM(u[i]);
+				*kl = NWARM(l[j]);
+				return(1);
+			}
+		}
+	}
+	return(0);
+}
+
+
+/*  Nodes connected to v
+ *  --------------------
+ *  are entered into a, starting with v itself. Returns their number.
+ */
+
+#ifdef ANSI_C
+static int warm_connection(GNODE v, GNODE *a)
+#else
+static int warm_connection(v, a)
+GNODE	v;
+GNODE	*a;
+#endif
+{
+	CONNECT	c;
+	GNODE	w;
+	int	n, i, j, k;
+
+	n = 0;
+	a[n++] = v;
+	for (i=0; i<n; i++) {
+		c = NCONNECT(a[i]);
+		if (!c) continue;
+		for (k=0; k<2; k++) {
+			w = k ? CTARGET2(c) : CTARGET(c);
+			if (!w) continue;
+			for (j=0; j<n; j++) if (a[j]==w) break;
+			if ((j==n) && (n<WARM_CONN)) a[n++] = w;
+		}
+	}
+	return(n);
+}
+
+
+/*  Enter a pair of connected old nodes
+ *  -----------------------------------
+ *  first is the first dummy node of the chain from a, or -1.
+ */
+
+#ifdef ANSI_C
+static void warm_add_pair(int a, int b, int first)
+#else
+static void warm_add_pair(a, b, first)
+int	a;
+int	b;
+int	first;
+#endif
+{
+	int	h, k;
+
+	warm_pairs[warm_npairs].from = a;
+	if (a > b) { k = a; a = b; b = k; }
+	h = (int)(((unsigned long)a*31UL + (unsigned long)b)
+			% (unsigned long)warm_hsize);
+	warm_pairs[warm_npairs].a = a;
+	warm_pairs[warm_npairs].b = b;
+	warm_pairs[warm_npairs].first = first;
+	warm_pairs[warm_npairs].used  = 0;
+	warm_pairs[warm_npairs].turn  = 0;
+	warm_pairs[warm_npairs].next = warm_phash[h];
+	warm_phash[h] = warm_npairs++;
+}
+
+
+/*  Read the warm start file
+ *  ------------------------
+ *  returns 0 if the file does not exist or is corrupt. The nodes are
+ *  entered into warm, and the real nodes that were connected by an
+ *  edge or a chain of dummy nodes into warm_pairs.
+ */
+
+#ifdef ANSI_C
+static int warm_read(char *fname)
+#else
+static int warm_read(fname)
+char	*fname;
+#endif
+{
+	FILE	*f;
+	WARMNODE *w;
+	char	*t;
+	long	len, x, tsize;
+	int	i, j, k, m, a, b, d, e, h, steps, nturns;
+	int	*turns;
+	unsigned long n;
+
+	warm_free();
+	f = fopen(fname, "rb");
+	if (!f) return(0);
+	len = 0L;
+	if (!fseek(f, 0L, SEEK_END)) len = ftell(f);
+	if (len < 4) { fclose(f); return(0); }
+	rewind(f);
+	warm_buf = (unsigned char *)malloc(len);
+	if (!warm_buf) Fatal_error("memory exhausted","");
+	if (fread(warm_buf, 1, len, f) != (size_t)len) len = 0L;
+	fclose(f);
+	warm_len = len;
+	warm_at  = 4L;
+	warm_bad = 0;
+
+	if ((len < 4) || strncmp((char *)warm_buf, "VCGB", 4)) warm_bad = 1;
+	if (!warm_bad && (warm_uvarint() != 1UL)) warm_bad = 1;
+	n = warm_bad ? 0UL : warm_uvarint();
+	if ((long)n > len) warm_bad = 1;	/* each node needs some bytes */
+	if (warm_bad) { warm_free(); return(0); }
+
+	warm_num   = (int)n;
+	warm_hsize = 2*warm_num+1;
+	warm  = (WARMNODE *)malloc((warm_num+1) * sizeof(WARMNODE));
+	warm_hash = (int *)malloc(warm_hsize * sizeof(int));
+	warm_titles = (char *)malloc(len);	/* the titles are shorter */
+	if (!warm || !warm_hash || !warm_titles)
+		Fatal_error("memory exhausted","");
+	for (i=0; i<warm_hsize; i++) warm_hash[i] = -1;
+
+	tsize = 0L;
+	for (i=0; (i<warm_num) && !warm_bad; i++) {
+		w = &warm[i];
+		n = warm_uvarint();
+		if ((long)n > warm_len-warm_at) { warm_bad = 1; break; }
+		t = &warm_titles[tsize];
+		memcpy(t, warm_buf+warm_at, n);
+		t[n] = 0;
+		warm_at += n;
+		tsize += n+1;
+		w->title = t;
+		w->real  = strncmp(t, "_internal_", 10) ? 1 : 0;
+		x = warm_svarint();
+		(void)warm_svarint();			/* y      */
+		w->x = x + (long)warm_uvarint()/2;	/* width  */
+		(void)warm_uvarint();			/* height */
+		w->level = (int)warm_uvarint();
+		(void)warm_uvarint();			/* pos    */
+		if ((w->level < 0) || (w->level > warm_num)) warm_bad = 1;
+		w->succ = -1;
+		w->turn = w->turn2 = -1;
+		h = (int)title_hash(t, (int)n);
+		w->next = warm_hash[h];
+		warm_hash[h] = i;
+	}
+
+	/* The edges: first the successors of the dummy nodes, then
+	 * the pairs of real nodes.
+	 */
+
+	m = warm_bad ? 0 : (int)warm_uvarint();
+	if ((long)m > warm_len) warm_bad = 1;
+	if (warm_bad) { warm_free(); return(0); }
+	warm_pairs = (WARMPAIR *)malloc((m+1) * sizeof(WARMPAIR));
+	warm_phash = (int *)malloc(warm_hsize * sizeof(int));
+	if (!warm_pairs || !warm_phash) Fatal_error("memory exhausted","");
+	for (i=0; i<warm_hsize; i++) warm_phash[i] = -1;
+
+	for (i=0; (i<m) && !warm_bad; i++) {
+		a = (int)warm_uvarint();
+		b = (int)warm_uvarint();
+		(void)warm_uvarint();			/* class  */
+		k = (int)warm_uvarint();
+		if ((k < 0) || ((long)k > warm_len)) { warm_bad = 1; break; }
+		for (j=0; j<2*k; j++) (void)warm_svarint();
+		warm_pairs[i].a = -1;
+		if ((a<0) || (b<0) || (a>=warm_num) || (b>=warm_num)) continue;
+		if (   !warm[a].real && warm[b].real
+		    && (warm[a].level == warm[b].level)) {
+			/* a connection to a real node, see chain_top */
+			k = a; a = b; b = k;
+		}
+		if (!warm[a].real) warm[a].succ = b;
+		warm_pairs[i].a = a;		/* provisionally */
+		warm_pairs[i].b = b;
+	}
+	if (warm_bad) { warm_free(); return(0); }
+	free(warm_buf); warm_buf = NULL;
+
+	/* A chain may end at a dummy node without successor, e.g. the
+	 * turn of an edge between nodes of the same level. The chains
+	 * that meet there are paired with the smallest of the other
+	 * real nodes that end there (see warm_turn).
+	 */
+
+	turns = (int *)malloc((3*m+1) * sizeof(int));
+	if (!turns) Fatal_error("memory exhausted","");
+	nturns = 0;
+	warm_npairs = 0;
+	for (i=0; i<m; i++) {
+		a = warm_pairs[i].a;
+		b = warm_pairs[i].b;
+		if ((a<0) || (b<0) || (a>=warm_num) || (b>=warm_num)) continue;
+		if (!warm[a].real) continue;
+		d = warm[b].real ? -1 : b;
+		e = -1;
+		steps = 0;
+		while ((b >= 0) && !warm[b].real && (steps++ < warm_num)) {
+			e = b;
+			b = warm[b].succ;
+		}
+		if ((b >= 0) && warm[b].real) warm_add_pair(a, b, d);
+		else if ((b < 0) && (e >= 0)) {
+			turns[nturns++] = a;
+			turns[nturns++] = d;
+			turns[nturns++] = e;
+			if ((warm[e].turn < 0) || (a < warm[e].turn)) {
+				warm[e].turn2 = warm[e].turn;
+				warm[e].turn  = a;
+			}
+			else if ((warm[e].turn2 < 0) || (a < warm[e].turn2))
+				warm[e].turn2 = a;
+		}
+	}
+	for (i=0; i<nturns; i+=3) {
+		a = turns[i];
+		e = turns[i+2];
+		b = (a == warm[e].turn) ? warm[e].turn2 : warm[e].turn;
+		if (b < 0) continue;
+		warm_add_pair(a, b, turns[i+1]);
+		warm_pairs[warm_npairs-1].turn = 1;
+	}
+	free(turns);
+	warm_loaded = 1;
+	return(1);
+}
+
+
+/*  Read the warm start file and seed the levels
+ *  --------------------------------------------
+ *  This is called before step1. Nodes of the old layout get their
+ *  old level, if they have no level attribute. Without file, or if
+ *  there is a previous layout in memory (-incremental), nothing is
+ *  done.
+ */
+
+#ifdef ANSI_C
+void warm_start_seed(void)
+#else
+void warm_start_seed()
+#endif
+{
+	GNODE	v;
+	char	*fname;
+	int	k, n;
+
+	debugmessage("warm_start_seed","");
+	warm_nseeded = 0;
+	warm_placed  = 0;
+	warm_exact   = 0;
+	warm_missed  = 0;
+	frozen_valid = 0;
+	if (warm_loaded) warm_free();
+
+	/* A cache entry is the layout of the same graph: it is used
+	 * for the first layout of the parsed graph only.
+	 */
+
+	fname = (warm_replay ? layout_cache_entry() : NULL);
+	warm_replay = 0;
+	if (fname) warm_exact = 1;
+	else {
+		fname = warm_start_file;
+		if (!fname) return;
+		if (incremental_layout && (layout_stamp > 0)) return;
+	}
+
+	start_time();
+	if (!warm_read(fname)) {
+		if (warm_bad && !silent)
+			FPRINTF(stderr,"Warning: %s is no layout file, ignored\n",
+				fname);
+		warm_exact = 0;
+		return;
+	}
+	n = 0;
+	for (v = nodelist; v; v = NNEXT(v)) n++;
+	if (warm_seeded) free(warm_seeded);
+	warm_seeded = (GNODE *)malloc((n+1) * sizeof(GNODE));
+	if (!warm_seeded) Fatal_error("memory exhausted","");
+
+	/* The levels of a cache entry are those that step1 calculates */
+
+	for (v = nodelist; v; v = NNEXT(v)) {
+		k = warm_lookup(NTITLE(v));
+		NWARM(v) = k;
+		if ((k >= 0) && (NLEVEL(v) < 0) && !warm_exact) {
+			NLEVEL(v) = warm[k].level;
+			warm_seeded[warm_nseeded++] = v;
+		}
+	}
+	stop_time("warm_start");
+}
+
+
+/*  Remove the seeded levels
+ *  ------------------------
+ *  This is called after step1, such that the levels of the old layout
+ *  do not look like specified levels afterwards.
+ */
+
+#ifdef ANSI_C
+void warm_start_unseed(void)
+#else
+void warm_start_unseed()
+#endif
+{
+	int	i;
+
+	for (i=0; i<warm_nseeded; i++) NLEVEL(warm_seeded[i]) = -1;
+	warm_nseeded = 0;
+}
+
+
+#ifdef ANSI_C
+int warm_start_active(void)
+#else
+int warm_start_active()
+#endif
+{
+	return(warm_loaded);
+}
+
+
+/*  Restore the order of a cache entry
+ *  ----------------------------------
+ *  This is called by step2 after the local optimizations, i.e. when
+ *  the nodes of the connections are part of the layers, too. If the
+ *  file is a cache entry, each layer gets its order of the file again.
+ *  The local optimizations started from this order, but need not end
+ *  in it. If a layer does not match, warm_start_missed tells relayout
+ *  to calculate the layout without cache.
+ */
+
+#ifdef ANSI_C
+void warm_start_restore(DEPTH *l)
+#else
+void warm_start_restore(l)
+DEPTH	*l;
+#endif
+{
+	GNLIST	li;
+	int	i, n;
+
+	debugmessage("warm_start_restore","");
+	if (!warm_loaded || !warm_exact) return;
+	for (i=0; i<=maxdepth+1; i++) {
+		n = 0;
+		for (li = l[i].succlist; li; li = GNNEXT(li)) n++;
+		if (n > seedkey_size) {
+			if (seedkeys) free(seedkeys);
+			seedkey_size = n;
+			seedkeys = (SEEDKEY *)malloc(n * sizeof(SEEDKEY));
+			if (!seedkeys) Fatal_error("memory exhausted","");
+		}
+		if (warm_layer_keys(l[i].succlist, i, &n)) warm_missed = 1;
+		else sort_layer(l[i].succlist, n);
+	}
+}
+
+
+#ifdef ANSI_C
+int warm_start_missed(void)
+#else
+int warm_start_missed()
+#endif
+{
+	return(warm_missed);
+}
+
+
+/*  Other end of a turn
+ *  -------------------
+ *  The chain of the dummy node v from the old node ku ends at a dummy
+ *  node without successor, where other chains end, too, or which is
+ *  connected to real nodes of its level. As in warm_read, the chain
+ *  is paired with the smallest old node at the other ends. Returns
+ *  this old node, or -1.
+ */
+
+#ifdef ANSI_C
+static int warm_turn(GNODE v, int ku)
+#else
+static int warm_turn(v, ku)
+GNODE	v;
+int	ku;
+#endif
+{
+	ADJEDGE	a;
+	CONNECT	c;
+	GNODE	w;
+	int	k, j, self, best;
+
+	while (NSUCC(v)) {
+		v = EEND(AKANTE(NSUCC(v)));
+		if (NINLIST(v)) return(-1);
+	}
+	self = 0;
+	best = -1;
+	c = NCONNECT(v);
+	a = NPRED(v);
+	j = 0;
+	for (;;) {
+		if (a) {
+			w = chain_end(ESTART(AKANTE(a)), 1);
+			a = ANEXT(a);
+		}
+		else if (c && (j < 2)) {
+			w = j ? CTARGET2(c) : CTARGET(c);
+			if (w && !NINLIST(w)) w = NULL;
+			j++;
+		}
+		else break;
+		k = w ? NWARM(w) : -1;
+		if (k < 0) continue;
+		if ((k == ku) && !self) { self = 1; continue; }
+		if ((best < 0) || (k < best)) best = k;
+	}
+	return(best);
+}
+
+
+/*  Old chain of a chain
+ *  --------------------
+ *  The chain of the dummy node v goes from the old node ku to the old
+ *  node kl, and kp is the first pair of warm_pairs between them; turn
+ *  is 1 if the chain ends at a turn. Parallel chains and both halfs of
+ *  a turn have the same pair of old nodes, thus each new chain is
+ *  matched with an old chain of its own of the same kind that starts
+ *  at ku, if possible. The match is stored in the dummy
+ *  nodes of the chain (NWARM), such that all levels of the chain use
+ *  the same old chain. Returns the index of the old chain.
+ */
+
+#define same_pair(k) (   (warm_pairs[k].a == (ku<kl ? ku : kl)) \
+		      && (warm_pairs[k].b == (ku<kl ? kl : ku)))
+
+#ifdef ANSI_C
+static int warm_chain_pair(GNODE v, int ku, int kl, int kp, int turn)
+#else
+static int warm_chain_pair(v, ku, kl, kp, turn)
+GNODE	v;
+int	ku;
+int	kl;
+int	kp;
+int	turn;
+#endif
+{
+	GNODE	w;
+	int	k, best, rank, r;
+
+	k = NWARM(v);
+	if ((k >= 0) && (k < warm_npairs) && same_pair(k)) return(k);
+
+	/* rank 3: unused chain from ku, 2: used chain from ku, 1: other,
+	 * plus 4 if both chains end at a turn or both do not.
+	 */
+
+	best = kp;
+	rank = 0;
+	for (k = kp; k >= 0; k = warm_pairs[k].next) {
+		if (!same_pair(k)) continue;
+		if (warm_pairs[k].from == ku) r = (warm_pairs[k].used ? 2 : 3);
+		else r = 1;
+		if (warm_pairs[k].turn == turn) r += 4;
+		if (r > rank) { best = k; rank = r; }
+		if (rank == 7) break;
+	}
+	if ((rank & 3) != 3) return(best);
+	warm_pairs[best].used = 1;
+
+	/* the chain ends where a node has more than one neighbour */
+
+	for (w = v; w && !NINLIST(w); ) {
+		NWARM(w) = best;
+		if (!NPRED(w) || ANEXT(NPRED(w))) break;
+		w = ESTART(AKANTE(NPRED(w)));
+	}
+	for (w = v; w && !NINLIST(w); ) {
+		NWARM(w) = best;
+		if (!NSUCC(w) || ANEXT(NSUCC(w))) break;
+		w = EEND(AKANTE(NSUCC(w)));
+	}
+	return(best);
+}
+
+#undef same_pair
+
+
+/*  Old x co-ordinate of a node
+ *  ---------------------------
+ *  The center of v in the warm start file is entered into *x, if v is
+ *  an old node of the same level, or a dummy node of a chain between
+ *  old nodes that were connected. Then 1 is returned, otherwise 0.
+ *  A dummy node gets the position of the old dummy node of its level,
+ *  or if the old chain has none, a position interpolated between the
+ *  ends of the chain.
+ */
+
+#ifdef ANSI_C
+static int warm_x(GNODE v, int level, long *x)
+#else
+static int warm_x(v, level, x)
+GNODE	v;
+int	level;
+long	*x;
+#endif
+{
+	GNODE	upper, lower;
+	long	xu, xl;
+	int	k, ku, kl, kp, du, dl, steps;
+
+	if (NINLIST(v)) {
+		k = NWARM(v);
+		if ((k < 0) || (warm[k].level != level)) return(0);
+		*x = warm[k].x;
+		return(1);
+	}
+	upper = chain_end(v, 1);
+	if (!upper) upper = chain_top(v);
+	lower = chain_end(v, 0);
+	if (!upper) return(0);
+	if (lower) {
+		if (!warm_chain(upper, lower, &ku, &kl, &kp)) return(0);
+	}
+	else {
+		ku = NWARM(upper);
+		kl = (ku < 0) ? -1 : warm_turn(v, ku);
+		kp = (kl < 0) ? -1 : warm_pair(ku, kl);
+		if (kp < 0) return(0);
+	}
+
+	kp = warm_chain_pair(v, ku, kl, kp, lower ? 0 : 1);
+	steps = 0;
+	for (k = warm_pairs[kp].first; k >= 0; k = warm[k].succ) {
+		if (warm[k].real || (steps++ >= warm_num)) break;
+		if (warm[k].level == level) { *x = warm[k].x; return(1); }
+	}
+	if (!lower) return(0);
+
+	/* otherwise interpolate between the ends of the chain */
+
+	xu = warm[ku].x;
+	xl = warm[kl].x;
+	du = level - NTIEFE(upper);
+	dl = NTIEFE(lower) - level;
+	if (du+dl > 0) *x = xu + (xl-xu)*du/(du+dl);
+	else	       *x = xu;
+	return(1);
+}
+
+
+/*  Sort keys of a layer from the warm start file
+ *  ---------------------------------------------
+ *  The keys of the nodes of the layer li at level are entered into
+ *  seedkeys, and their number into *n. Returns 0 if each node has an
+ *  old position, 1 if only dummy nodes have none, and 2 if a real
+ *  node has none.
+ */
+
+#ifdef ANSI_C
+static int warm_layer_keys(GNLIST li, int level, int *n)
+#else
+static int warm_layer_keys(li, level, n)
+GNLIST	li;
+int	level;
+int	*n;
+#endif
+{
+	GNODE	v;
+	long	x;
+	int	i, key, ok, changed;
+
+	changed = 0;
+	key = -MAXINT;
+	i = 0;
+	for (; li; li = GNNEXT(li)) {
+		assert((i < seedkey_size));
+		v = GNNODE(li);
+		ok = warm_x(v, level, &x);
+		if (ok) key = (int)x;
+
+		/* otherwise, the node stays behind its left neighbour */
+
+		if (!ok && NINLIST(v)) changed = 2;
+		else if (!ok && !changed) changed = 1;
+		seedkeys[i].key  = key;
+		seedkeys[i].idx  = i;
+		seedkeys[i].node = v;
+		i++;
+	}
+	*n = i;
+	return(changed);
+}
+
+
+/*  Seed the x co-ordinates from the warm start file
+ *  ------------------------------------------------
+ *  Called by step3 before the balancing of the coordinates, instead
+ *  of the left aligned initial placement. Each node gets the old x
+ *  co-ordinate of its center, as far as its left neighbour allows.
+ *  A node without old position is placed next to its left neighbour.
+ *  The balancing starts from the old layout and leaves the frozen
+ *  layers alone (layer_is_placed). Rotated layouts are not seeded,
+ *  because the file contains the rotated co-ordinates.
+ */
+
+#ifdef ANSI_C
+void warm_start_place(void)
+#else
+void warm_start_place()
+#endif
+{
+	GNLIST	li;
+	GNODE	v, w;
+	long	x, minx;
+	int	i;
+
+	debugmessage("warm_start_place","");
+	warm_placed = 0;
+	if (!warm_loaded || warm_exact) return;
+	if (G_orientation != TOP_TO_BOTTOM) return;
+
+	for (i=0; i<=maxdepth+1; i++) {
+		w = NULL;
+		for (li = layer[i].succlist; li; li = GNNEXT(li)) {
+			v = GNNODE(li);
+			if (!w) minx = G_xbase;
+			else if ((NWIDTH(v)==0) || (NWIDTH(w)==0))
+				minx = NX(w) + NWIDTH(w) + G_dspace;
+			else	minx = NX(w) + NWIDTH(w) + G_xspace;
+			if (!warm_x(v, i, &x) || (x-NWIDTH(v)/2 < minx))
+				x = minx + NWIDTH(v)/2;
+			if ((NWIDTH(v)==0) && (NHEIGHT(v)==0))
+				NX(v) = dxralign(x) - NWIDTH(v)/2;
+			else	NX(v) = xralign(x) - NWIDTH(v)/2;
+			w = v;
+		}
+	}
+	warm_placed = 1;
+}
+
+
+/*  Check whether a layer keeps the seeded co-ordinates
+ *  ---------------------------------------------------
+ *  The balancing of step3 skips the frozen layers after a warm start,
+ *  thus they keep the old co-ordinates, up to the final shift of the
+ *  whole drawing to G_xbase.
+ */
+
+#ifdef ANSI_C
+int layer_is_placed(int i)
+#else
+int layer_is_placed(i)
+int	i;
+#endif
+{
+	return(warm_placed && layer_is_frozen(i));
+}
+
+
+/*  A new graph is parsed
+ *  ---------------------
+ *  Its layout is to be stored into the warm start file once.
+ */
+
+#ifdef ANSI_C
+void warm_start_reset(void)
+#else
+void warm_start_reset()
+#endif
+{
+	warm_pending = 1;
+	warm_replay  = 1;
+}
+
+
+/*  Check whether the graph has folded parts
+ *  ----------------------------------------
+ *  A folded subgraph or region is a summary node in the nodelist.
+ */
+
+#ifdef ANSI_C
+static int warm_folded(void)
+#else
+static int warm_folded()
+#endif
+{
+	GNODE	v;
+
+	for (v = nodelist; v; v = NNEXT(v))
+		if (NSGRAPH(v) || NREGREPL(v)) return(1);
+	return(0);
+}
+
+
+/*  Write the layout into the warm start file
+ *  -----------------------------------------
+ *  This is called at the end of each relayout, but the file is written
+ *  only once per graph: the first complete layout (layout_complete)
+ *  without folded subgraphs or regions, i.e. the last level of the
+ *  anytime layout of the fully unfolded graph.
+ *  The relayouts after folding or unfolding do not write the file.
+ *  The file is written under a temporary name first, such that a
+ *  failed write does not destroy the old layout.
+ */
+
+#ifdef ANSI_C
+void warm_start_store(void)
+#else
+void warm_start_store()
+#endif
+{
+	char	*tmp;
+
+	debugmessage("warm_start_store","");
+	if (!warm_start_file || !warm_pending) return;
+	if (!layout_complete() || warm_folded()) return;
+	warm_pending = 0;
+	tmp = (char *)malloc(strlen(warm_start_file)+5);
+	if (!tmp) Fatal_error("memory exhausted","");
+	SPRINTF(tmp, "%s.tmp", warm_start_file);
+	(void)remove(tmp);
+	if (print_graph_binary(tmp)) {
+		(void)remove(warm_start_file);
+		if (rename(tmp, warm_start_file) && !silent)
+			FPRINTF(stderr,"Warning: cannot write %s\n",
+				warm_start_file);
+	}
+	else {
+		(void)remove(tmp);
+		if (!silent) FPRINTF(stderr,"Warning: cannot write %s\n",
+				     warm_start_file);
+	}
+	free(tmp);
+}
@@ -0,0 +1,901 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         layerdata.c                                        */
+/*   description:  Layer data as arrays for the crossing reduction,   */
+/*                 fast counting of crossings                         */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * The crossing reduction (step2.c) calculates the barycenter and median
+ * weights of the nodes again and again. Each weight needs the positions
+ * of the neighbours, i.e. for each edge the way
+ *
+ *       node -> adjacency cell -> edge -> neighbour node -> position
+ *
+ * through four different records. The GNODE records are large, thus
+ * most of the loaded cache lines are wasted.
+ *
+ * Here we keep the few fields needed for these weights in contiguous
+ * arrays (structure of arrays). Each node of the layers gets a slot
+ * NSLOT(v). The slots of one layer are consecutive, in the order of the
+ * layer at the time the data is built. For a slot s:
+ *
+ *    layer_pos[s]               the position of the node, a copy of NPOS
+ *    ld_indeg[s], ld_outdeg[s]  the degrees NINDEG, NOUTDEG
+ *    ld_pslot[ld_pstart[s] .. ld_pstart[s+1]-1]
+ *                               the slots of the predecessors
+ *    ld_panchor[...]            the anchor values of these edges
+ *    ld_sslot, ld_sstart, ld_sanchor   the same for the successors.
+ *
+ * The slots and the adjacency arrays are fixed as long as the data is
+ * valid. Only the positions change: step2 writes all positions by the
+ * macro set_position, which updates NPOS and layer_pos together.
+ * When step2 starts to change the adjacency lists (at the resolution
+ * of connections), it invalidates the data, and the weights are again
+ * calculated from the GNODE records.
+ *
+ * The weights calculated here are exactly the same as those of step2,
+ * thus the layout does not change.
+ *
+ * The arrays exist for the parallel weights of wide layers (option
+ * -cthreads, see ld_weights): the worker threads calculate the weights
+ * from the arrays only, and write nothing but NBARY of their own nodes.
+ * Without -cthreads, the arrays are not built, and step2 calculates the
+ * weights from the GNODE records as before. For one thread the arrays
+ * do not pay off. Wall time of step2 and of the whole layout (vcgbatch,
+ * one thread), with the arrays and without:
+ *
+ *    graph                  step2 with / without     total with / without
+ *    IDA flow chart,  5k    1.0 - 1.2 / 1.1 - 1.5 s    2.1 / 2.1 s
+ *    random DAG,      5k     24 - 28  /  26 - 32  s     33 /  32 s
+ *    IDA flow chart, 20k     16.1     /  17.6     s
+ *    IDA flow chart, 50k     74 - 91  /  79 - 88  s    227 / 232 s
+ *
+ * The gain in the weights is at most some percent of step2 and lost in
+ * the noise of the total, because the crossing counting dominates.
+ * The speedup of -cthreads on several processors has not been measured
+ * either; the layouts are the same for any number of threads.
+ *
+ * This file provides the following functions:
+ *
+ * build_layer_data	 creates the arrays from the layers of step2,
+ *			 if there is more than one thread.
+ * invalidate_layer_data the arrays are not anymore used; stops the
+ *			 threads.
+ * ld_predbary		 barycenter weight of the predecessors of a node
+ * ld_succbary		 barycenter weight of the successors of a node
+ * ld_predmedian	 median weight of the predecessors of a node
+ * ld_succmedian	 median weight of the successors of a node
+ * ld_sort_bary		 sort an array of nodes according to their
+ *			 barycenter weights.
+ * ld_parallel		 check whether the weights of a layer are
+ *			 calculated by several threads.
+ * ld_weights		 calculate the weights of a layer, in parallel.
+ * bilayer_crossings	 number of crossings between two layers.
+ *			 This does not need the arrays.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "steps.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+
+/* Prototypes
+ * ==========
+ */
+
+static int	*ld_realloc	_PP((int *a, int size));
+static int	ld_compare_int	_PP((const int *a, const int *b));
+static double	ld_median	_PP((int *slots, int n, int *tmp));
+static double	ld_pmedian	_PP((GNODE node, int *tmp));
+static double	ld_smedian	_PP((GNODE node, int *tmp));
+static void	ld_quicksort	_PP((GNODE *a, int l, int r));
+static void	ld_stop_threads	_PP((void));
+
+
+/* Global variables
+ * ================
+ */
+
+int	layer_data_valid = 0;	/* 1, if the arrays can be used   */
+int	*layer_pos	 = NULL;	/* position of a slot             */
+
+static int	*ld_indeg   = NULL;	/* indegree of a slot             */
+static int	*ld_outdeg  = NULL;	/* outdegree of a slot            */
+static int	*ld_pstart  = NULL;	/* first predecessor of a slot    */
+static int	*ld_pslot   = NULL;	/* slots of the predecessors      */
+static int	*ld_panchor = NULL;	/* anchors of the pred. edges     */
+static int	*ld_sstart  = NULL;	/* first successor of a slot      */
+static int	*ld_sslot   = NULL;	/* slots of the successors        */
+static int	*ld_sanchor = NULL;	/* anchors of the succ. edges     */
+
+static int	ld_maxslots = 0;	/* size of the slot arrays        */
+static int	ld_maxedges = 0;	/* size of the edge arrays        */
+
+static int	*ld_mtmp    = NULL;	/* positions for the median       */
+static int	ld_maxmtmp  = 0;	/* size of ld_mtmp                */
+
+static float	*ld_key     = NULL;	/* sort keys for ld_sort_bary     */
+static int	ld_maxkey   = 0;	/* size of ld_key                 */
+static int	ld_seed;		/* pivot selection of the sort    */
+
+static int	*ld_acc     = NULL;	/* accumulator tree of crossings  */
+static int	ld_maxacc   = 0;	/* size of ld_acc                 */
+
+
+/*--------------------------------------------------------------------*/
+/*  Creation of the arrays                                            */
+/*--------------------------------------------------------------------*/
+
+/*  Enlarge an int array
+ *  --------------------
+ *  The old contents need not to be kept.
+ */
+
+#ifdef ANSI_C
+static int *ld_realloc(int *a, int size)
+#else
+static int *ld_realloc(a, size)
+int	*a;
+int	size;
+#endif
+{
+	if (a) free(a);
+	a = (int *)malloc(size * sizeof(int));
+	if (!a) Fatal_error("memory exhausted","");
+	return(a);
+}
+
+
+/*  Build the arrays from the layers
+ *  --------------------------------
+ *  l is the layer array that step2 works on (tmp_layer), with the nodes
+ *  of level i in l[i].succlist. The arrays are only valid if the layers
+ *  are proper, i.e. all edges go from level i to level i+1.
+ *  The arrays are kept for the next layout, and only enlarged if they
+ *  are too small. They are only built for -cthreads, see above.
+ */
+
+#ifdef ANSI_C
+void build_layer_data(DEPTH *l)
+#else
+void build_layer_data(l)
+DEPTH	*l;
+#endif
+{
+	GNLIST	li;
+	ADJEDGE	a;
+	GNODE	v;
+	int	i, s, nslots, nedges, maxdeg;
+
+	debugmessage("build_layer_data","");
+	invalidate_layer_data();
+	if (crossing_threads <= 1) return;
+
+	/* Count slots and edges, and assign the slots */
+
+	nslots = nedges = maxdeg = 0;
+	for (i=0; i<=maxdepth+1; i++) {
+		li = l[i].succlist;
+		while (li) {
+			v = GNNODE(li);
+			if (NTIEFE(v)!=i) return;
+			NSLOT(v) = nslots++;
+			nedges += NINDEG(v) + NOUTDEG(v);
+			if (NINDEG(v)  > maxdeg) maxdeg = NINDEG(v);
+			if (NOUTDEG(v) > maxdeg) maxdeg = NOUTDEG(v);
+			li = GNNEXT(li);
+		}
+	}
+
+	if (nslots+1 > ld_maxslots) {
+		ld_maxslots = nslots+1;
+		layer_pos = ld_realloc(layer_pos, ld_maxslots);
+		ld_indeg  = ld_realloc(ld_indeg,  ld_maxslots);
+		ld_outdeg = ld_realloc(ld_outdeg, ld_maxslots);
+		ld_pstart = ld_realloc(ld_pstart, ld_maxslots);
+		ld_sstart = ld_realloc(ld_sstart, ld_maxslots);
+	}
+	if (nedges+1 > ld_maxedges) {
+		ld_maxedges = nedges+1;
+		ld_pslot   = ld_realloc(ld_pslot,   ld_maxedges);
+		ld_panchor = ld_realloc(ld_panchor, ld_maxedges);
+		ld_sslot   = ld_realloc(ld_sslot,   ld_maxedges);
+		ld_sanchor = ld_realloc(ld_sanchor, ld_maxedges);
+	}
+	if (maxdeg+1 > ld_maxmtmp) {
+		ld_maxmtmp = maxdeg+1;
+		ld_mtmp = ld_realloc(ld_mtmp, ld_maxmtmp);
+	}
+
+	/* Fill the arrays. The adjacency lists may be longer than the
+	 * degrees, thus we check the bounds.
+	 */
+
+	s = 0;
+	ld_pstart[0] = ld_sstart[0] = 0;
+	for (i=0; i<=maxdepth+1; i++) {
+		li = l[i].succlist;
+		while (li) {
+			v = GNNODE(li);
+			layer_pos[s] = NPOS(v);
+			ld_indeg[s]  = NINDEG(v);
+			ld_outdeg[s] = NOUTDEG(v);
+			ld_pstart[s+1] = ld_pstart[s];
+			a = NPRED(v);
+			while (a) {
+				if (NTIEFE(ESTART(AKANTE(a)))!=i-1) return;
+				if (ld_pstart[s+1]>=ld_maxedges) return;
+				ld_pslot[ld_pstart[s+1]]   = NSLOT(ESTART(AKANTE(a)));
+				ld_panchor[ld_pstart[s+1]] = EANCHOR(AKANTE(a));
+				ld_pstart[s+1]++;
+				a = ANEXT(a);
+			}
+			ld_sstart[s+1] = ld_sstart[s];
+			a = NSUCC(v);
+			while (a) {
+				if (NTIEFE(EEND(AKANTE(a)))!=i+1) return;
+				if (ld_sstart[s+1]>=ld_maxedges) return;
+				ld_sslot[ld_sstart[s+1]]   = NSLOT(EEND(AKANTE(a)));
+				ld_sanchor[ld_sstart[s+1]] = EANCHOR(AKANTE(a));
+				ld_sstart[s+1]++;
+				a = ANEXT(a);
+			}
+			if (ld_pstart[s+1]-ld_pstart[s] > ld_maxmtmp) return;
+			if (ld_sstart[s+1]-ld_sstart[s] > ld_maxmtmp) return;
+			s++;
+			li = GNNEXT(li);
+		}
+	}
+	layer_data_valid = 1;
+}
+
+
+/*  Invalidate the arrays
+ *  ---------------------
+ *  After this, the slots of the nodes are meaningless.
+ */
+
+#ifdef ANSI_C
+void invalidate_layer_data(void)
+#else
+void invalidate_layer_data()
+#endif
+{
+	debugmessage("invalidate_layer_data","");
+	layer_data_valid = 0;
+	ld_stop_threads();
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Barycenter and median weights                                     */
+/*--------------------------------------------------------------------*/
+
+/*  Barycenter weights
+ *  ------------------
+ *  The average position of the predecessors (successors), where the
+ *  anchor points shift an edge by a fraction of 1/256.
+ */
+
+#ifdef ANSI_C
+double ld_predbary(GNODE node)
+#else
+double ld_predbary(node)
+GNODE	node;
+#endif
+{
+	int	s, k, e, Sum;
+
+	s = NSLOT(node);
+	if (ld_indeg[s]==0) return(0.0);
+	Sum = 0;
+	e = ld_pstart[s+1];
+	for (k=ld_pstart[s]; k<e; k++)
+		Sum += 256 * layer_pos[ld_pslot[k]] + ld_panchor[k];
+	return ( ((double) Sum) / ((double) (256*ld_indeg[s])) );
+}
+
+#ifdef ANSI_C
+double ld_succbary(GNODE node)
+#else
+double ld_succbary(node)
+GNODE	node;
+#endif
+{
+	int	s, k, e, Sum;
+
+	s = NSLOT(node);
+	if (ld_outdeg[s]==0) return(0.0);
+	Sum = 0;
+	e = ld_sstart[s+1];
+	for (k=ld_sstart[s]; k<e; k++)
+		Sum += 256 * layer_pos[ld_sslot[k]] - ld_sanchor[k];
+	return ( ((double) Sum) / ((double) (256*ld_outdeg[s])) );
+}
+
+
+/*  Median weights
+ *  --------------
+ *  For more than 2 neighbours: the median position, or for an even
+ *  number of neighbours, the weighted mean of both median positions.
+ */
+
+#ifdef ANSI_C
+static int ld_compare_int(const int *a, const int *b)
+#else
+static int ld_compare_int(a, b)
+int	*a;
+int	*b;
+#endif
+{
+	if (*a > *b) return(1);
+	if (*a < *b) return(-1);
+	return(0);
+}
+
+/*  tmp is a scratch array of at least n entries. Each thread of the
+ *  parallel weight calculation has its own one.
+ */
+
+#ifdef ANSI_C
+static double ld_median(int *slots, int n, int *tmp)
+#else
+static double ld_median(slots, n, tmp)
+int	*slots;
+int	n;
+int	*tmp;
+#endif
+{
+	int	i, leftpart, rightpart;
+
+	for (i=0; i<n; i++) tmp[i] = layer_pos[slots[i]];
+#ifdef ANSI_C
+	qsort(tmp, n, sizeof(int),
+		(int (*) (const void *, const void *))ld_compare_int);
+#else
+	qsort(tmp, n, sizeof(int), ld_compare_int);
+#endif
+	if (n % 2) return((double)tmp[n/2]);
+	leftpart  = tmp[n/2-1] - tmp[0];
+	rightpart = tmp[n-1]   - tmp[n/2];
+	return ( ((double) (tmp[n/2-1] * rightpart + tmp[n/2] * leftpart))
+		/ ((double) (leftpart+rightpart)) );
+}
+
+#ifdef ANSI_C
+double ld_predmedian(GNODE node)
+#else
+double ld_predmedian(node)
+GNODE	node;
+#endif
+{
+	return(ld_pmedian(node, ld_mtmp));
+}
+
+#ifdef ANSI_C
+double ld_succmedian(GNODE node)
+#else
+double ld_succmedian(node)
+GNODE	node;
+#endif
+{
+	return(ld_smedian(node, ld_mtmp));
+}
+
+#ifdef ANSI_C
+static double ld_pmedian(GNODE node, int *tmp)
+#else
+static double ld_pmedian(node, tmp)
+GNODE	node;
+int	*tmp;
+#endif
+{
+	int	s, k;
+
+	s = NSLOT(node);
+	k = ld_pstart[s];
+	switch (ld_indeg[s]) {
+	case 0: return(0.0);
+	case 1: return((double)layer_pos[ld_pslot[k]]
+			+ (double)ld_panchor[k]/256.0);
+	case 2: return(((double)(layer_pos[ld_pslot[k]]
+			+ layer_pos[ld_pslot[k+1]])) / 2.0);
+	}
+	return(ld_median(&ld_pslot[k], ld_pstart[s+1]-k, tmp));
+}
+
+#ifdef ANSI_C
+static double ld_smedian(GNODE node, int *tmp)
+#else
+static double ld_smedian(node, tmp)
+GNODE	node;
+int	*tmp;
+#endif
+{
+	int	s, k;
+
+	s = NSLOT(node);
+	k = ld_sstart[s];
+	switch (ld_outdeg[s]) {
+	case 0: return(0.0);
+	case 1: return((double)layer_pos[ld_sslot[k]]
+			- (double)ld_sanchor[k]/256.0);
+	case 2: return(((double)(layer_pos[ld_sslot[k]]
+			+ layer_pos[ld_sslot[k+1]])) / 2.0);
+	}
+	return(ld_median(&ld_sslot[k], ld_sstart[s+1]-k, tmp));
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Parallel calculation of the weights                               */
+/*--------------------------------------------------------------------*/
+
+/*  The weight of a node depends only on the positions of the adjacent
+ *  layer, which do not change while the weights of a layer are
+ *  calculated. Thus the nodes of a wide layer are split into contiguous
+ *  parts that are handled by different threads (option -cthreads).
+ *  Each thread writes only the NBARY fields of its own part, so the
+ *  result is exactly the same as with one thread.
+ *
+ *  The threads are started at the first use and then wait for the
+ *  next layer. The calling thread calculates the first part itself.
+ *  When the arrays are invalidated, the threads are stopped and joined,
+ *  thus no thread is left between the layouts.
+ */
+
+#define LD_MAXTHREADS	64	/* maximal number of threads          */
+#define LD_MINPARALLEL	256	/* minimal layer width for threads    */
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION	ld_mutex_t;
+typedef CONDITION_VARIABLE	ld_cond_t;
+#define ld_lock()		EnterCriticalSection(&ld_mutex)
+#define ld_unlock()		LeaveCriticalSection(&ld_mutex)
+#define ld_wait(c)		SleepConditionVariableCS(&(c), &ld_mutex, INFINITE)
+#define ld_wakeall(c)		WakeAllConditionVariable(&(c))
+#else
+typedef pthread_mutex_t		ld_mutex_t;
+typedef pthread_cond_t		ld_cond_t;
+#define ld_lock()		pthread_mutex_lock(&ld_mutex)
+#define ld_unlock()		pthread_mutex_unlock(&ld_mutex)
+#define ld_wait(c)		pthread_cond_wait(&(c), &ld_mutex)
+#define ld_wakeall(c)		pthread_cond_broadcast(&(c))
+#endif
+
+static ld_mutex_t ld_mutex;
+static ld_cond_t  ld_start;	/* signalled if a new job is available */
+static ld_cond_t  ld_done;	/* signalled if all parts are finished */
+
+static int	ld_nthreads = 1;	/* threads running incl. caller  */
+static int	ld_todo[LD_MAXTHREADS];	/* 1, if part t must be done     */
+static int	ld_pending;		/* parts not yet finished        */
+static int	ld_quit;		/* 1, if the threads must stop   */
+#ifdef _WIN32
+static HANDLE	ld_thread[LD_MAXTHREADS];	/* the worker threads    */
+#else
+static pthread_t ld_thread[LD_MAXTHREADS];	/* the worker threads    */
+#endif
+
+static GNODE	*ld_job_nodes;		/* the job: nodes of the layer   */
+static int	ld_job_n;		/* number of nodes               */
+static int	ld_job_parts;		/* number of parts               */
+static int	ld_job_w1, ld_job_w2;	/* the weights, see ld_weights   */
+
+static int	*ld_tmtmp[LD_MAXTHREADS];    /* median scratch per thread */
+static int	ld_tmaxmtmp[LD_MAXTHREADS];  /* sizes of ld_tmtmp         */
+
+
+/*  Weight of kind w of a node
+ *  --------------------------
+ */
+
+#ifdef ANSI_C
+static double ld_weight(GNODE v, int w, int *tmp)
+#else
+static double ld_weight(v, w, tmp)
+GNODE	v;
+int	w;
+int	*tmp;
+#endif
+{
+	switch (w) {
+	case LD_PREDBARY:   return(ld_predbary(v));
+	case LD_SUCCBARY:   return(ld_succbary(v));
+	case LD_PREDMEDIAN: return(ld_pmedian(v, tmp));
+	case LD_SUCCMEDIAN: return(ld_smedian(v, tmp));
+	}
+	assert((0));
+	return(0.0);
+}
+
+
+/*  Calculate part t of the actual job
+ *  ----------------------------------
+ *  This is the same formula as in the loops of step2, thus also the
+ *  rounding to float is the same.
+ */
+
+#ifdef ANSI_C
+static void ld_do_part(int t)
+#else
+static void ld_do_part(t)
+int	t;
+#endif
+{
+	int	j, l, r;
+	GNODE	v;
+
+	l = (int)(((long)ld_job_n * t)     / ld_job_parts);
+	r = (int)(((long)ld_job_n * (t+1)) / ld_job_parts);
+	for (j=l; j<r; j++) {
+		v = ld_job_nodes[j];
+		if (ld_job_w2 == LD_NOWEIGHT)
+			NBARY(v) = ld_weight(v, ld_job_w1, ld_tmtmp[t]);
+		else	NBARY(v) = ld_weight(v, ld_job_w1, ld_tmtmp[t])
+				 + ld_weight(v, ld_job_w2, ld_tmtmp[t])/10000.0;
+	}
+}
+
+
+/*  Main loop of a worker thread
+ *  ----------------------------
+ *  arg is the number of the part the thread is responsible for.
+ *  The thread returns when ld_quit is set.
+ */
+
+#ifdef _WIN32
+static DWORD WINAPI ld_worker(LPVOID arg)
+#else
+static void *ld_worker(void *arg)
+#endif
+{
+	int	t;
+
+	t = (int)(size_t)arg;
+	ld_lock();
+	for (;;) {
+		while (!ld_todo[t] && !ld_quit) ld_wait(ld_start);
+		if (ld_quit) break;
+		ld_unlock();
+		ld_do_part(t);
+		ld_lock();
+		ld_todo[t] = 0;
+		ld_pending--;
+		if (ld_pending == 0) ld_wakeall(ld_done);
+	}
+	ld_unlock();
+	return(0);
+}
+
+
+/*  Start the threads
+ *  -----------------
+ *  Increases the number of threads to n. If they cannot be started,
+ *  we continue with fewer ones.
+ */
+
+#ifdef ANSI_C
+static void ld_start_threads(int n)
+#else
+static void ld_start_threads(n)
+int	n;
+#endif
+{
+#ifdef _WIN32
+	HANDLE	h;
+#else
+	pthread_t h;
+#endif
+
+	if (ld_nthreads == 1) {
+#ifdef _WIN32
+		InitializeCriticalSection(&ld_mutex);
+		InitializeConditionVariable(&ld_start);
+		InitializeConditionVariable(&ld_done);
+#else
+		pthread_mutex_init(&ld_mutex, NULL);
+		pthread_cond_init(&ld_start, NULL);
+		pthread_cond_init(&ld_done, NULL);
+#endif
+	}
+	ld_lock();
+	while (ld_nthreads < n) {
+#ifdef _WIN32
+		h = CreateThread(NULL, 0, ld_worker,
+				(LPVOID)(size_t)ld_nthreads, 0, NULL);
+		if (!h) break;
+#else
+		if (pthread_create(&h, NULL, ld_worker,
+				(void *)(size_t)ld_nthreads)) break;
+#endif
+		ld_thread[ld_nthreads++] = h;
+	}
+	ld_unlock();
+}
+
+
+/*  Stop the threads
+ *  ----------------
+ *  Called between the jobs: the threads wait for ld_start. They are
+ *  joined, and the next ld_weights starts new ones.
+ */
+
+#ifdef ANSI_C
+static void ld_stop_threads(void)
+#else
+static void ld_stop_threads()
+#endif
+{
+	int	t;
+
+	if (ld_nthreads == 1) return;
+	ld_lock();
+	ld_quit = 1;
+	ld_wakeall(ld_start);
+	ld_unlock();
+	for (t=1; t<ld_nthreads; t++) {
+#ifdef _WIN32
+		WaitForSingleObject(ld_thread[t], INFINITE);
+		CloseHandle(ld_thread[t]);
+#else
+		pthread_join(ld_thread[t], NULL);
+#endif
+	}
+#ifdef _WIN32
+	DeleteCriticalSection(&ld_mutex);
+#else
+	pthread_mutex_destroy(&ld_mutex);
+	pthread_cond_destroy(&ld_start);
+	pthread_cond_destroy(&ld_done);
+#endif
+	ld_quit = 0;
+	ld_nthreads = 1;
+}
+
+
+/*  Check whether the weights of n nodes should be done in parallel
+ *  ---------------------------------------------------------------
+ */
+
+#ifdef ANSI_C
+int ld_parallel(int n)
+#else
+int ld_parallel(n)
+int	n;
+#endif
+{
+	return (layer_data_valid && (crossing_threads > 1)
+		&& (n >= LD_MINPARALLEL));
+}
+
+
+/*  Calculate the weights of the nodes a[0..n-1]
+ *  --------------------------------------------
+ *  NBARY(a[j]) becomes the weight w1 of a[j], plus the weight w2
+ *  divided by 10000.0 unless w2 is LD_NOWEIGHT. The weights are
+ *  LD_PREDBARY, LD_SUCCBARY, LD_PREDMEDIAN and LD_SUCCMEDIAN.
+ */
+
+#ifdef ANSI_C
+void ld_weights(GNODE *a, int n, int w1, int w2)
+#else
+void ld_weights(a, n, w1, w2)
+GNODE	*a;
+int	n;
+int	w1, w2;
+#endif
+{
+	int	t, parts;
+
+	assert((layer_data_valid));
+	parts = crossing_threads;
+	if (parts > LD_MAXTHREADS) parts = LD_MAXTHREADS;
+	if (parts > ld_nthreads) ld_start_threads(parts);
+	if (parts > ld_nthreads) parts = ld_nthreads;
+
+	for (t=0; t<parts; t++) {
+		if (ld_tmaxmtmp[t] < ld_maxmtmp) {
+			ld_tmaxmtmp[t] = ld_maxmtmp;
+			ld_tmtmp[t] = ld_realloc(ld_tmtmp[t], ld_maxmtmp);
+		}
+	}
+
+	ld_job_nodes = a;
+	ld_job_n     = n;
+	ld_job_parts = parts;
+	ld_job_w1    = w1;
+	ld_job_w2    = w2;
+	if (parts == 1) { ld_do_part(0); return; }
+
+	ld_lock();
+	for (t=1; t<parts; t++) ld_todo[t] = 1;
+	ld_pending = parts-1;
+	ld_wakeall(ld_start);
+	ld_unlock();
+
+	ld_do_part(0);
+
+	ld_lock();
+	while (ld_pending > 0) ld_wait(ld_done);
+	ld_unlock();
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Sorting according to the barycenter weights                       */
+/*--------------------------------------------------------------------*/
+
+/*  Sort an array of nodes
+ *  ----------------------
+ *  This is the randomized quicksort of step2 (OWN_QUICKSORT), with the
+ *  same choice of pivots, thus the result is the same. The weights are
+ *  first copied into the contiguous array ld_key, and the comparisons
+ *  are done there. Nodes with weight 0.0 are not moved relatively to
+ *  the others.
+ */
+
+#define exchange(i,j) { t = a[i]; a[i] = a[j]; a[j] = t; \
+			kt = ld_key[i]; ld_key[i] = ld_key[j]; ld_key[j] = kt; }
+
+#ifdef ANSI_C
+void ld_sort_bary(GNODE *a, int n)
+#else
+void ld_sort_bary(a, n)
+GNODE	*a;
+int	n;
+#endif
+{
+	int	i;
+
+	if (n <= 0) return;
+	if (n > ld_maxkey) {
+		if (ld_key) free(ld_key);
+		ld_maxkey = n + 16;
+		ld_key = (float *)malloc(ld_maxkey * sizeof(float));
+		if (!ld_key) Fatal_error("memory exhausted","");
+	}
+	for (i=0; i<n; i++) ld_key[i] = NBARY(a[i]);
+	ld_seed = 211;
+	ld_quicksort(a, 0, n-1);
+}
+
+
+#ifdef ANSI_C
+static void ld_quicksort(GNODE *a, int l, int r)
+#else
+static void ld_quicksort(a, l, r)
+GNODE	*a;
+int	l, r;
+#endif
+{
+	int	i, j, k;
+	GNODE	t;
+	float	kt, v;
+
+	k = r-l;
+	if (k>5) {
+		j = l + (ld_seed % k);
+		ld_seed = (ld_seed + 10891) % MAXINT;
+		exchange(l,j);
+	}
+	v = ld_key[l];
+	i = l;
+	j = r+1;
+	if (v==0.0) j = l+k/2;
+	else {
+		while (i<j) {
+			do j--;
+			while ((ld_key[j]!=0.0) && (ld_key[j]>v));
+			do i++;
+			while ((i<=j) && (ld_key[i]!=0.0) && (ld_key[i]<v));
+			if (i<j) exchange(j,i);
+		}
+	}
+	exchange(l,j);
+	if (l<j-1) ld_quicksort(a, l, j-1);
+	if (j+1<r) ld_quicksort(a, j+1, r);
+}
+
+
+
+/*--------------------------------------------------------------------*/
+/*  Counting of crossings                                             */
+/*--------------------------------------------------------------------*/
+
+/*  Crossings between two adjacent layers
+ *  -------------------------------------
+ *  This is the accumulator tree method of Barth, Juenger and Mutzel:
+ *  The edges are visited in the lexicographic order of the positions
+ *  of their source and target nodes. Two edges cross iff the target of
+ *  the later edge is left of the target of the earlier edge. The tree
+ *  counts for each new edge the number of edges already visited that
+ *  have a target more right, in O(log n) per edge.
+ *
+ *  upper and lower are the node lists of the two layers. The positions
+ *  of the nodes of lower must be nonnegative and distinct, and the
+ *  successor lists of the nodes of upper must already be sorted
+ *  according to the positions of the targets. The crossing count of
+ *  step2 ensures this before it calls us (option -ctree).
+ */
+
+#ifdef ANSI_C
+int bilayer_crossings(GNLIST upper, GNLIST lower)
+#else
+int bilayer_crossings(upper, lower)
+GNLIST	upper;
+GNLIST	lower;
+#endif
+{
+	GNLIST	li;
+	ADJEDGE	a;
+	int	i, n, first, index, crossings;
+
+	debugmessage("bilayer_crossings","");
+
+	/* The leaves of the tree are the positions 0..n-1 */
+
+	n = 0;
+	li = lower;
+	while (li) {
+		if (NPOS(GNNODE(li)) >= n) n = NPOS(GNNODE(li)) + 1;
+		li = GNNEXT(li);
+	}
+	first = 1;
+	while (first < n) first *= 2;
+	if (2*first > ld_maxacc) {
+		ld_maxacc = 2*first;
+		ld_acc = ld_realloc(ld_acc, ld_maxacc);
+	}
+	for (i=0; i<2*first-1; i++) ld_acc[i] = 0;
+	first--;
+
+	crossings = 0;
+	li = upper;
+	while (li) {
+		a = NSUCC(GNNODE(li));
+		while (a) {
+			index = NPOS(EEND(AKANTE(a))) + first;
+			assert((index <= 2*first));
+			ld_acc[index]++;
+			while (index > 0) {
+				if (index % 2) crossings += ld_acc[index+1];
+				index = (index-1)/2;
+				ld_acc[index]++;
+			}
+			a = ANEXT(a);
+		}
+		li = GNNEXT(li);
+	}
+	return(crossings);
+}
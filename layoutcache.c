@@ -0,0 +1,673 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         layoutcache.c                                      */
+/*   description:  On-disk cache of final layouts                     */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * IDA writes the specification of a flow chart anew each time the user
+ * opens it, and starts a new process to show it. Thus the same graph
+ * is laid out again and again, although neither the graph nor the
+ * layout options changed.
+ *
+ * With the option -cache <dir>, the final layout of a graph is kept
+ * in the directory <dir>. It is written by print_graph_binary, i.e.
+ * as for -warmstart. On a hit, the input file is parsed as usual, and
+ * the layout of the entry is replayed on the parsed graph (see
+ * incrlayout.c): step1_main calculates the levels, the layers of
+ * step2_main get the order of the entry without crossing reduction,
+ * and step3_main and step4_main calculate the co-ordinates from this
+ * order as before. Thus a hit gives the same graph, the same layout
+ * and the same statistics as the calculated layout, only faster. If
+ * the entry does not fit, the layout is calculated as without cache.
+ *
+ * The name of a cache entry is a 64 bit hash of
+ *
+ *   - the specification, where each sequence of white space outside
+ *     of strings counts as one blank, i.e. the hash does not depend
+ *     on line ends and indentation,
+ *   - the options that influence the layout (layout_options below),
+ *   - the version of the format (CACHE_VERSION).
+ *
+ * The hash is calculated from the mapped input file (see gdlmap.c),
+ * before it is parsed. On a miss, the layout is stored at the end of
+ * relayout. It is not stored if
+ *
+ *   - the layout was cut by the time limit,
+ *   - the anytime layout did not yet reach the last level,
+ *   - the graph has subgraphs, folded nodes or hidden edge classes,
+ *     because the replay needs the layout of the complete graph,
+ *   - the specification contains locations already.
+ *
+ * With -warmstart, the cache is not used: the layout depends on the
+ * warm start file, which is not part of the key.
+ *
+ * An entry is written to a temporary file that is renamed afterwards,
+ * thus a concurrent process never reads a partial entry. The name of
+ * the temporary file contains the process id, thus two processes that
+ * store the same entry at the same time do not write into the same
+ * file. Temporary files of processes that died before the rename are
+ * removed by the next scan of the directory if they are older than
+ * CACHE_TMP_AGE seconds. A hit sets
+ * the modification time of the entry to the actual time. If the
+ * entries exceed layout_cache_size kilobytes after a store, the least
+ * recently used ones (by modification time) are removed.
+ *
+ * Input from stdin is not cached. Entries of version 1 (print_graph
+ * text, named *.gdl) are removed by the next scan of the directory.
+ *
+ * This file provides the following functions:
+ *
+ * layout_cache_open	called by parse_part with the opened input file,
+ *			which is returned. Looks up the entry.
+ * layout_cache_store	called at the end of relayout: stores the layout
+ *			if the last layout_cache_open was a miss.
+ * layout_cache_loaded	true, if the layout of the actual graph is cached.
+ * layout_cache_entry	the path of the entry on a hit, otherwise NULL.
+ * layout_complete	true, if the actual layout is the complete final
+ *			layout of the graph (also used for -warmstart).
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+#include "globals.h"
+#include "grammar.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "folding.h"
+#include "timelim.h"
+#include "gdlmap.h"
+#include "grprint.h"
+#include "layoutcache.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+
+/* Global variables
+ * ================
+ */
+
+#define CACHE_VERSION	2	/* change if print_graph_binary changes */
+#define CACHE_NAMELEN	1024
+#define CACHE_TMP_AGE	3600	/* seconds until a temporary file is stale */
+#define CACHE_EXT	".lay"	/* extension of the entries */
+#define CACHE_OLD_EXT	".gdl"	/* of the entries of version 1 */
+
+static unsigned long key1;	/* FNV-1a hash of the input */
+static unsigned long key2;	/* sdbm hash of the input   */
+
+static int cache_pending = 0;	/* the actual layout is to be stored */
+static int cache_loaded  = 0;	/* the actual layout is cached       */
+
+static char cache_name[CACHE_NAMELEN];	/* path of the actual entry */
+
+
+/* The options that influence the layout. The options that are
+ * set by the specification are reset by visualize_part, or are
+ * contained in the specification anyway.
+ */
+
+static int *layout_options[] = {
+	&layout_flag, &crossing_heuristics, &local_unwind,
+	&near_edge_layout, &near_edge_compaction, &fine_tune_layout,
+	&layer_ranking, &coord_engine, &edge_label_phase,
+	&min_baryiterations, &max_baryiterations, &skip_baryphase2,
+	&anytime_layout,
+	&max_mediumshifts, &min_mediumshifts, &nwdumping_phase,
+	&max_centershifts, &min_centershifts, &prio_phase,
+	&straight_phase, &max_straighttune, &max_edgebendings,
+	&manhatten_edges, &one_line_manhatten,
+	&layout_downfactor, &layout_upfactor, &layout_nearfactor,
+	&summarize_double_edges, &hide_single_nodes,
+	&G_spline, &G_flat_factor, &G_displayel,
+	NULL
+};
+
+
+/*--------------------------------------------------------------------*/
+/*  Key of a graph                                                    */
+/*--------------------------------------------------------------------*/
+
+#ifdef ANSI_C
+static void hash_char(int c)
+#else
+static void hash_char(c)
+int c;
+#endif
+{
+	key1 = ((key1 ^ (unsigned long)c) * 16777619UL) & 0xffffffffUL;
+	key2 = ((unsigned long)c + (key2<<6) + (key2<<16) - key2)
+		& 0xffffffffUL;
+}
+
+
+#ifdef ANSI_C
+static void hash_int(long v)
+#else
+static void hash_int(v)
+long v;
+#endif
+{
+	int i;
+
+	for (i=0; i<4; i++) { hash_char((int)(v & 0xffL)); v >>= 8; }
+}
+
+
+/*  Hash the specification
+ *  ----------------------
+ *  White space outside of strings counts as one blank.
+ */
+
+#ifdef ANSI_C
+static void hash_input(char *p, long size)
+#else
+static void hash_input(p, size)
+char *p;
+long size;
+#endif
+{
+	int c, instring, blank;
+
+	instring = blank = 0;
+	while (size-- > 0) {
+		c = *p++ & 0xff;
+		if (instring) {
+			hash_char(c);
+			if ((c=='\\') && (size>0)) {
+				hash_char(*p++ & 0xff);
+				size--;
+			}
+			else if (c=='"') instring = 0;
+			continue;
+		}
+		if (   (c==' ') || (c=='\t') || (c=='\n')
+		    || (c=='\r') || (c=='\f')) {
+			blank = 1;
+			continue;
+		}
+		if (blank) { hash_char(' '); blank = 0; }
+		hash_char(c);
+		if (c=='"') instring = 1;
+	}
+}
+
+
+/*  Calculate the name of the cache entry
+ *  -------------------------------------
+ *  Returns 0 if the name does not fit.
+ */
+
+#ifdef ANSI_C
+static int cache_key(char *input, long size)
+#else
+static int cache_key(input, size)
+char *input;
+long size;
+#endif
+{
+	int i;
+
+	if (strlen(layout_cache_dir) > CACHE_NAMELEN-32) return(0);
+
+	key1 = 2166136261UL;
+	key2 = 0UL;
+	hash_int((long)CACHE_VERSION);
+	for (i=0; layout_options[i]; i++) hash_int((long)*layout_options[i]);
+	hash_input(input, size);
+
+	SPRINTF(cache_name, "%s/%08lx%08lx%s", layout_cache_dir, key1, key2,
+		CACHE_EXT);
+	return(1);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Lookup                                                            */
+/*--------------------------------------------------------------------*/
+
+/*  Open the graph
+ *  --------------
+ *  f is the input file, mapped by map_input_file.
+ */
+
+#ifdef ANSI_C
+FILE *layout_cache_open(FILE *f)
+#else
+FILE *layout_cache_open(f)
+FILE *f;
+#endif
+{
+	FILE *c;
+	char *input;
+	long size;
+
+	debugmessage("layout_cache_open","");
+
+	cache_pending = cache_loaded = 0;
+	if ((!layout_cache_dir) || (!*layout_cache_dir)) return(f);
+	if ((!f) || (f==stdin)) return(f);
+	if (warm_start_file) return(f);
+
+	input = mapped_input(&size);
+	if (!input) return(f);
+	if (!cache_key(input, size)) return(f);
+
+	c = fopen(cache_name, "r");
+	if (!c) {
+		cache_pending = 1;
+		return(f);
+	}
+
+	/* Hit: the entry is now the most recently used one. The input
+	 * is parsed as usual, the layout is replayed from the entry.
+	 */
+
+	fclose(c);
+	(void)utime(cache_name, NULL);
+	cache_loaded = 1;
+	return(f);
+}
+
+
+/*  Check whether the layout of the actual graph is in the cache
+ *  ------------------------------------------------------------
+ */
+
+#ifdef ANSI_C
+int layout_cache_loaded(void)
+#else
+int layout_cache_loaded()
+#endif
+{
+	return(cache_loaded);
+}
+
+
+/*  The entry of the actual graph
+ *  -----------------------------
+ *  Returns the path of the entry on a hit, otherwise NULL.
+ */
+
+#ifdef ANSI_C
+char *layout_cache_entry(void)
+#else
+char *layout_cache_entry()
+#endif
+{
+	return(cache_loaded ? cache_name : NULL);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Eviction                                                          */
+/*--------------------------------------------------------------------*/
+
+typedef struct cache_entry {
+	char	name[32];	/* file name in layout_cache_dir */
+	long	size;		/* bytes                         */
+	time_t	used;		/* time of last use              */
+} CACHE_ENTRY;
+
+static CACHE_ENTRY *entries = NULL;
+static int nr_entries   = 0;
+static int size_entries = 0;
+
+
+/*  Check whether a file name is the name of an entry
+ *  -------------------------------------------------
+ *  i.e. 16 hex digits followed by the extension ext
+ */
+
+#ifdef ANSI_C
+static int is_entry_name(char *s, char *ext)
+#else
+static int is_entry_name(s, ext)
+char *s;
+char *ext;
+#endif
+{
+	int i;
+
+	for (i=0; i<16; i++) {
+		if (   ((s[i]<'0') || (s[i]>'9'))
+		    && ((s[i]<'a') || (s[i]>'f'))) return(0);
+	}
+	return(strcmp(s+16, ext)==0);
+}
+
+
+/*  Check whether a file name is the name of a temporary entry
+ *  ----------------------------------------------------------
+ *  i.e. an entry name followed by .<pid>.tmp (see layout_cache_store)
+ */
+
+#ifdef ANSI_C
+static int is_tmp_name(char *s)
+#else
+static int is_tmp_name(s)
+char *s;
+#endif
+{
+	int i;
+
+	for (i=0; i<16; i++) {
+		if (   ((s[i]<'0') || (s[i]>'9'))
+		    && ((s[i]<'a') || (s[i]>'f'))) return(0);
+	}
+	s += 16;
+	if (strncmp(s, CACHE_EXT, strlen(CACHE_EXT))!=0) return(0);
+	s += strlen(CACHE_EXT);
+	if (*s++ != '.') return(0);
+	if ((*s<'0') || (*s>'9')) return(0);
+	while ((*s>='0') && (*s<='9')) s++;
+	return(strcmp(s, ".tmp")==0);
+}
+
+
+/*  Remove a temporary entry if it is stale
+ *  ---------------------------------------
+ *  A temporary file younger than CACHE_TMP_AGE may still be written
+ *  by a concurrent process.
+ */
+
+#ifdef ANSI_C
+static void sweep_tmp(char *name, time_t written, time_t now)
+#else
+static void sweep_tmp(name, written, now)
+char *name;
+time_t written;
+time_t now;
+#endif
+{
+	char path[CACHE_NAMELEN];
+
+	if (!is_tmp_name(name)) return;
+	if (now - written < CACHE_TMP_AGE) return;
+	SPRINTF(path, "%s/%s", layout_cache_dir, name);
+	(void)remove(path);
+}
+
+
+/*  Remove an entry of version 1
+ *  ----------------------------
+ *  Its key can never match again.
+ */
+
+#ifdef ANSI_C
+static void sweep_old(char *name)
+#else
+static void sweep_old(name)
+char *name;
+#endif
+{
+	char path[CACHE_NAMELEN];
+
+	if (!is_entry_name(name, CACHE_OLD_EXT)) return;
+	SPRINTF(path, "%s/%s", layout_cache_dir, name);
+	(void)remove(path);
+}
+
+
+#ifdef ANSI_C
+static void add_entry(char *name, long size, time_t used)
+#else
+static void add_entry(name, size, used)
+char *name;
+long size;
+time_t used;
+#endif
+{
+	CACHE_ENTRY *h;
+
+	if (!is_entry_name(name, CACHE_EXT)) return;
+	if (nr_entries >= size_entries) {
+		h = (CACHE_ENTRY *)realloc(entries,
+			(size_entries+64) * sizeof(CACHE_ENTRY));
+		if (!h) Fatal_error("memory exhausted","");
+		entries = h;
+		size_entries += 64;
+	}
+	strcpy(entries[nr_entries].name, name);
+	entries[nr_entries].size = size;
+	entries[nr_entries].used = used;
+	nr_entries++;
+}
+
+
+/*  Collect the entries of the cache directory
+ *  ------------------------------------------
+ */
+
+#ifdef _WIN32
+
+#ifdef ANSI_C
+static void scan_entries(void)
+#else
+static void scan_entries()
+#endif
+{
+	char pattern[CACHE_NAMELEN];
+	struct _finddata_t fd;
+	intptr_t h;
+
+	time_t now;
+
+	nr_entries = 0;
+	now = time(NULL);
+	SPRINTF(pattern, "%s/*.tmp", layout_cache_dir);
+	h = _findfirst(pattern, &fd);
+	if (h != -1) {
+		do {
+			sweep_tmp(fd.name, fd.time_write, now);
+		} while (_findnext(h, &fd) == 0);
+		_findclose(h);
+	}
+	SPRINTF(pattern, "%s/*%s", layout_cache_dir, CACHE_OLD_EXT);
+	h = _findfirst(pattern, &fd);
+	if (h != -1) {
+		do {
+			sweep_old(fd.name);
+		} while (_findnext(h, &fd) == 0);
+		_findclose(h);
+	}
+	SPRINTF(pattern, "%s/*%s", layout_cache_dir, CACHE_EXT);
+	h = _findfirst(pattern, &fd);
+	if (h == -1) return;
+	do {
+		add_entry(fd.name, (long)fd.size, fd.time_write);
+	} while (_findnext(h, &fd) == 0);
+	_findclose(h);
+}
+
+#else
+
+#ifdef ANSI_C
+static void scan_entries(void)
+#else
+static void scan_entries()
+#endif
+{
+	char path[CACHE_NAMELEN];
+	struct stat st;
+	struct dirent *e;
+	DIR *d;
+	time_t now;
+
+	nr_entries = 0;
+	now = time(NULL);
+	d = opendir(layout_cache_dir);
+	if (!d) return;
+	while ((e = readdir(d)) != NULL) {
+		if (is_tmp_name(e->d_name)) {
+			SPRINTF(path, "%s/%s", layout_cache_dir, e->d_name);
+			if (stat(path, &st) == 0)
+				sweep_tmp(e->d_name, st.st_mtime, now);
+			continue;
+		}
+		sweep_old(e->d_name);
+		if (!is_entry_name(e->d_name, CACHE_EXT)) continue;
+		SPRINTF(path, "%s/%s", layout_cache_dir, e->d_name);
+		if (stat(path, &st) != 0) continue;
+		add_entry(e->d_name, (long)st.st_size, st.st_mtime);
+	}
+	closedir(d);
+}
+
+#endif /* _WIN32 */
+
+
+/* Least recently used first */
+
+#ifdef ANSI_C
+static int compare_entries(const void *a, const void *b)
+#else
+static int compare_entries(a, b)
+char *a;
+char *b;
+#endif
+{
+	CACHE_ENTRY *x = (CACHE_ENTRY *)a;
+	CACHE_ENTRY *y = (CACHE_ENTRY *)b;
+
+	if (x->used < y->used) return(-1);
+	if (x->used > y->used) return(1);
+	return(strcmp(x->name, y->name));
+}
+
+
+/*  Remove the least recently used entries
+ *  --------------------------------------
+ *  until the cache is below layout_cache_size kilobytes.
+ */
+
+#ifdef ANSI_C
+static void evict_entries(void)
+#else
+static void evict_entries()
+#endif
+{
+	char path[CACHE_NAMELEN];
+	double total, limit;
+	int i;
+
+	scan_entries();
+	total = 0.0;
+	for (i=0; i<nr_entries; i++) total += (double)entries[i].size;
+	limit = (double)layout_cache_size * 1024.0;
+	if (total <= limit) return;
+
+	qsort(entries, nr_entries, sizeof(CACHE_ENTRY), compare_entries);
+	for (i=0; (i<nr_entries) && (total>limit); i++) {
+		SPRINTF(path, "%s/%s", layout_cache_dir, entries[i].name);
+		if (remove(path) == 0) total -= (double)entries[i].size;
+	}
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Store                                                             */
+/*--------------------------------------------------------------------*/
+
+/*  Check whether edge classes are hidden
+ *  -------------------------------------
+ */
+
+#ifdef ANSI_C
+static int hidden_classes(void)
+#else
+static int hidden_classes()
+#endif
+{
+	int i;
+
+	if (!hide_class) return(0);
+	for (i=0; i<max_nr_classes; i++) if (hide_class[i]) return(1);
+	return(0);
+}
+
+
+/*  Check whether the layout is complete
+ *  ------------------------------------
+ *  i.e. it is the final layout of the whole graph, as computed from
+ *  the specification. See the conditions at the top of this file.
+ */
+
+#ifdef ANSI_C
+int layout_complete(void)
+#else
+int layout_complete()
+#endif
+{
+	if (anytime_pending()) return(0);
+	if ((nr_errors!=0) || (locFlag) || (timelimit_exceeded())) return(0);
+	if ((graphlist) || (invis_nodes) || (hidden_classes())) return(0);
+	return(1);
+}
+
+
+/*  Store the actual layout
+ *  -----------------------
+ */
+
+#ifdef ANSI_C
+void layout_cache_store(void)
+#else
+void layout_cache_store()
+#endif
+{
+	char tmpname[CACHE_NAMELEN+32];
+
+	debugmessage("layout_cache_store","");
+
+	if (!cache_pending) return;
+	if (anytime_pending()) return;
+	cache_pending = 0;
+	if (!layout_complete()) return;
+
+	SPRINTF(tmpname, "%s.%ld.tmp", cache_name, (long)getpid());
+	(void)remove(tmpname);
+
+	if (!print_graph_binary(tmpname)) { (void)remove(tmpname); return; }
+
+	(void)remove(cache_name);
+	if (rename(tmpname, cache_name) != 0) {
+		(void)remove(tmpname);
+		return;
+	}
+	evict_entries();
+}
+
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,37 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         layoutcache.h                                      */
+/*   description:  On-disk cache of final layouts                     */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+#ifndef LAYOUTCACHE_H
+#define LAYOUTCACHE_H
+
+/*--------------------------------------------------------------------*/
+
+/* Prototypes
+ * ----------
+ * See layoutcache.c for more information.
+ */
+
+FILE   *layout_cache_open	_PP((FILE *f));
+void	layout_cache_store	_PP((void));
+int	layout_cache_loaded	_PP((void));
+char   *layout_cache_entry	_PP((void));
+int	layout_complete		_PP((void));
+
+/*--------------------------------------------------------------------*/
+
+#endif /* LAYOUTCACHE_H */
@@ -5229,6 +5229,66 @@ void *ptr;
 
 
 
+/*--------------------------------------------------------------------*/
+/*   Scan an input that is completely in memory                       */
+/*--------------------------------------------------------------------*/
+
+/* init_lex_mapped sets up the scanner to read directly from base, 
+ * which contains size characters followed by two NUL characters 
+ * (the end of buffer characters of the scanner). Nothing is copied:
+ * the tokens are scanned in place. The buffer must be writable,
+ * because the scanner temporarily terminates yytext with a NUL.
+ * The next init_lex uses this buffer instead of yyin. 
+ * exit_lex_mapped releases the buffer, it must be called before 
+ * base becomes invalid. 
+ */
+
+static YY_BUFFER_STATE yy_mapped_buffer = 0;
+static YY_BUFFER_STATE yy_stdio_buffer  = 0;
+
+#ifdef ANSI_C
+void exit_lex_mapped(void)
+#else
+void exit_lex_mapped()
+#endif
+{
+	if (!yy_mapped_buffer) return;
+	yy_flex_free( (void *) yy_mapped_buffer );
+	yy_mapped_buffer  = 0;
+	yy_current_buffer = yy_stdio_buffer;
+	yy_stdio_buffer   = 0;
+	yy_init = 1;
+}
+
+#ifdef ANSI_C
+void init_lex_mapped(char *base, long size)
+#else
+void init_lex_mapped(base, size)
+char *base;
+long size;
+#endif
+{
+	YY_BUFFER_STATE b;
+
+	exit_lex_mapped();
+	b = (YY_BUFFER_STATE) yy_flex_alloc( sizeof( struct yy_buffer_state ) );
+	if ( ! b )
+		YY_FATAL_ERROR( "out of dynamic memory in init_lex_mapped()" );
+
+	b->yy_input_file     = yyin;	/* never read, but closed later */
+	b->yy_ch_buf         = base;
+	b->yy_buf_pos        = base;
+	b->yy_buf_size       = (int)size;
+	b->yy_n_chars        = (int)size;
+	b->yy_is_interactive = 0;
+	b->yy_fill_buffer    = 0;	/* the end of buffer is the EOF */
+	b->yy_eof_status     = EOF_NOT_SEEN;
+
+	yy_stdio_buffer  = yy_current_buffer;
+	yy_mapped_buffer = b;
+}
+
+
 #line 88 "/RW/esprit/users/sander/src/PARSEGEN/scan.skel"
 
 /*--------------------------------------------------------------------*/
@@ -5241,6 +5301,19 @@ void init_lex(void)
 void init_lex()
 #endif
 {
+	if (yy_mapped_buffer) {
+
+		/* scan from memory: this replaces the initialization
+		 * of the first call of yylex, that would reset the buffer.
+		 */
+
+		if ( ! yy_start ) yy_start = 1;
+		if ( ! yyout )    yyout = stdout;
+		yy_current_buffer = yy_mapped_buffer;
+		yy_load_buffer_state();
+		yy_init = 0;
+		return;
+	}
 	yy_init = 1;
 }
 
@@ -5569,6 +5642,27 @@ char *s;
         return(look);
 }
 
+/* HashLookup returns the number of s, or -1 if s was never inserted */
+
+#ifdef ANSI_C
+long HashLookup(register char *s)
+#else
+long HashLookup(s)
+char *s;
+#endif
+{
+        register  hashentry h;
+
+        if (!hashtable) init_hash();
+
+	h = hashtable[hash(s)];
+        while (h != NULL) {
+                if ( strcmp(s,decode[h->num]) == 0L) return(h->num);
+                h=h->next;
+        }
+        return(-1L);
+}
+
 #ifdef ANSI_C
 long HashTableSize(void)
 #else
@@ -166,6 +166,7 @@ extern int remove_input_file;
 
 int  main 		_PP((int argc, char *argv[]));
 void Fatal_error	_PP((char *x, char *y));
+void set_fast_layout	_PP((void));
 void parse_part		_PP((void));
 void visualize_part	_PP((void));
 void relayout		_PP((void));
@@ -9,25 +9,54 @@
 #include <QtGui/QPlainTextEdit>
 #include <QtGui/QLabel>
 #include <QtGui/QStatusBar>
+#include <QtGui/QDockWidget>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QScrollArea>
 #include <QtGui/QColor>
 #include <QtGui/QCursor>
 #include <QtGui/QPainter>
+#include <QtGui/QPixmap>
+#include <QtGui/QImage>
+#include <QtCore/QCache>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <string.h>
 
 class MouseCanvas;
 struct PaintStruct;
 
+// everything that changes the picture of a tile, see checkTiles()
+struct TileState {
+   TileState() : stretch(-1), shrink(-1), builds(-1), base(0),
+                 bgcolor(-1), displayel(-1), dirtyel(-1), colored(-1) {
+      memset(colors, 0, sizeof(colors));
+   }
+   bool operator==(const TileState &o) const;
+
+   int stretch, shrink;     // scaling
+   int builds;              // builds of the spatial index, i.e. layouts
+   unsigned char colors[3*256];  // the color maps
+   QRgb base;               // background of the window
+   int bgcolor;             // G_color
+   int displayel, dirtyel;  // edge labels
+   int colored;
+};
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
    MainWindow();
+   ~MainWindow();
    
    void setZoomValue(const char *zoom);
    void setOriginValue(const char *origin);
    void setNodesValue(const char *nodes);
+   void updateProfile();
    
    void drawGraph(PaintStruct *p);
+   bool isRefining() const { return refining; }
    
    QAbstractScrollArea *canvas;
 
@@ -49,6 +78,8 @@ private slots:
    void cartFixed();
    void showLabels();
    void setShowLabelsIcon();
+   void showProfile();
+   void refineLayout();
    
    void zoomIn();
    void zoomOut();
@@ -62,12 +93,15 @@ private slots:
 
    void scrollAction(int action);
    void scrollSliderReleased();
+   void prefetchTile();
+   void tileReady(qlonglong key, int generation, QImage image);
 
 private:
    void createActions();
    void createMenus();
    void createToolBars();
    void createStatusBar();
+   void createProfilePane();
    void readSettings();
    void writeSettings();
    bool maybeSave();
@@ -75,6 +109,10 @@ private:
    bool saveFile(const QString &fileName);
    void setCurrentFile(const QString &fileName);
    QString strippedName(const QString &fullFileName);
+   bool paintTiles(QPainter &p, int border);
+   bool checkTiles();
+   void dropTiles();
+   void requestTile(long tx, long ty);
    
    QPlainTextEdit *textEdit;
    QString curFile;
@@ -99,6 +137,7 @@ private:
    QAction *cartAct;
    QAction *cartFixedAct;
    QAction *showLabelsAct;
+   QAction *showProfileAct;
    
    QAction *zoomInAct;
    QAction *zoomOutAct;
@@ -116,8 +155,24 @@ private:
    QLabel *origin;
    QLabel *nodes;
    
+   QDockWidget *profileDock;
+   QPlainTextEdit *profileText;
+   
    QScrollArea *scroller;
    QColor fgColor;
+
+   // tile cache of the drawing, see paintTiles()
+   QCache<qint64, QImage> tiles;
+   QSet<qint64> tilePending;             // tiles in work
+   TileState tileState;                  // of the cached tiles
+   int tileGeneration;                   // incremented when they are dropped
+   long tileX0, tileY0, tileX1, tileY1;  // tiles of the window
+   bool tilePrefetch;
+
+   // -anytime, see refineLayout()
+   QTimer *refineTimer;
+   QPixmap refineFrame;        // the previous layout during a level
+   bool refining, refineClose;
    
    QCursor *MOVING_CURSOR;
    bool sticky;
@@ -170,6 +170,13 @@ int fastflag = 0;
 int supress_nodes = 0;
 int supress_edges = 0;
 
+/*  Level of detail: nodes thinner than lod_pixels (in pixels) are drawn
+ *  as filled rectangles without text, edges whose arrows are smaller
+ *  are drawn as plain lines without arrowheads. 0 means full detail.
+ */
+
+int lod_pixels = 0;
+
 /*  Flag to summarize multiple edges without label between same nodes.
  */
 
@@ -227,12 +234,29 @@ int local_unwind = 1;
 int near_edge_layout = 1;
 
 
+/*  Near edges of weight 0 pull their nodes together after the x
+ *  coordinates are calculated: 1 = yes, 0 = no. Off in the fast
+ *  levels of the anytime layout, because this is quadratic.
+ */
+
+int near_edge_compaction = 1;
+
+
 /*  Fine tuning allowed: 1 = yes, 0 = no
  */
 
 int fine_tune_layout = 1;
 
 
+/*  Ranking of the levels after the partitioning:
+ *  0 = keep the levels of the layout algorithm (see layout_flag),
+ *  1 = minimize the total length of edges by the network simplex
+ *      method, see ranking.c. This replaces the fine tuning.
+ */
+
+int layer_ranking = 0;
+
+
 /*  When to add (nondirty) edge labels:
  *  Phase 0 = directly after folding
  *  Phase 1 = after partitioning
@@ -255,6 +279,53 @@ int max_baryiterations = MAXINT;
 int skip_baryphase2 = 0;
 
 
+/*  Method to count the crossings during the crossing reduction:
+ *  0 = sweep over both layers, 1 = accumulator tree (faster on wide
+ *  layers).
+ */
+
+int crossing_counter = 0;
+
+
+/*  Number of threads used to calculate the weights of the crossing
+ *  reduction. The layout does not depend on it.
+ */
+
+int crossing_threads = 1;
+
+
+/*  Flag, indicates that a relayout keeps the order of the unchanged
+ *  layers of the previous layout, see incrlayout.c. If 2, these layers
+ *  are reordered again (anytime layout).
+ */
+
+int incremental_layout = 0;
+
+
+/*  Flag, indicates that the first layout is a fast one, which is
+ *  refined by further layouts, see anytime_refine in timelim.c
+ */
+
+int anytime_layout = 0;
+
+
+/*  Directory of the cache of final layouts, see layoutcache.c,
+ *  or NULL if layouts are not cached. The cache is kept below
+ *  layout_cache_size kilobytes.
+ */
+
+char *layout_cache_dir  = NULL;
+int   layout_cache_size = 32768;
+
+
+/*  File of the warm start, see incrlayout.c, or NULL. The layout is
+ *  seeded from the layout stored there, and the new layout is stored
+ *  there again.
+ */
+
+char *warm_start_file = NULL;
+
+
 /*  Number of iteration used for the initial medium shifting
  *  that calculates x positions. Minimal and maximal.
  */
@@ -300,6 +371,15 @@ int prio_phase = 0;
 int straight_phase = 0;
 
 
+/*  Engine for the x coordinates of step 3:
+ *  0 = pendulum and rubberband method (iterative),
+ *  1 = linear time method of Brandes and Koepf, see bkplace.c.
+ *      This replaces the pendulum and rubberband phases.
+ */
+
+int coord_engine = 0;
+
+
 /*  Number of iterations during the calculation of bendings.
  */
 
@@ -372,6 +452,12 @@ double  extopm    = -1.0;  /* Top    Margin */
 double  exbottomm = -1.0;  /* Bottom Margin */
 int    exbbox    = 1;     /* with Bounding Box */
 
+/*  Number of threads used to rasterize the bitmap output, see
+ *  grprint2.c. The bitmap does not depend on it.
+ */
+
+int    raster_threads = 1;
+
 
 /*  Color maps
  *  ----------
@@ -911,6 +997,10 @@ int parseSimpleOptions() {
 	else if (simpleOption("-nocopt1"))   local_unwind = 0;
 	else if (simpleOption("-nocoptl"))   local_unwind = 0;
 	else if (simpleOption("-nocoptloc")) local_unwind = 0;
+	else if (simpleOption("-ctree"))     crossing_counter = 1;
+	else if (simpleOption("-csweep"))    crossing_counter = 0;
+	else if (simpleOption("-incremental")) incremental_layout = 1;
+	else if (simpleOption("-anytime"))   anytime_layout = 1;
 	else if (simpleOption("-notune"))    fine_tune_layout = 0;
 	else if (simpleOption("-nofinetune"))fine_tune_layout = 0;
 	else if (simpleOption("-nonearedge"))near_edge_layout = 0;
@@ -967,8 +1057,17 @@ int parseIntOptions(int *help) {
 	else if (   intOption("-cmax",      &max_baryiterations));
 	else if (   intOption("-crossing",  &max_baryiterations));
 	else if (   intOption("-cmin",      &min_baryiterations));
+	else if (   intOption("-cachesize", &layout_cache_size)) {
+		if (layout_cache_size<0) layout_cache_size = 0;
+	}
+	else if (   intOption("-cthreads",  &crossing_threads)) {
+		if (crossing_threads<1) crossing_threads = 1;
+	}
 	else if (   intOption("-e",         &nr_max_errors));
 	else if (   intOption("-error",     &nr_max_errors));
+	else if (   intOption("-lod",       &lod_pixels)) {
+		if (lod_pixels<0) lod_pixels = 0;
+	}
 	else if (   intOption("-p",         &max_mediumshifts));
 	else if (   intOption("-pmax",      &max_mediumshifts));
 	else if (   intOption("-pendulum",  &max_mediumshifts));
@@ -1050,6 +1149,12 @@ int scanOptions(int argc, char *argv[]) {
 		else if (stringOption("-d", "maxdeg"))      layout_flag = 11;
 		else if (stringOption("-d", "maxdegree"))   layout_flag = 11;
 		else if (stringOption("-d", "tree")) layout_flag = TREE_LAYOUT;
+		else if (stringOption("-rank", "dfs"))     layer_ranking = 0;
+		else if (stringOption("-rank", "simplex")) layer_ranking = 1;
+		else if (stringOption("-coord", "iterative")) coord_engine = 0;
+		else if (stringOption("-coord", "bk"))        coord_engine = 1;
+		else if (  wordOption("-cache", &layout_cache_dir));
+		else if (  wordOption("-warmstart", &warm_start_file));
 
 		/* Options for the view */
 		/* -------------------- */
@@ -1099,6 +1204,9 @@ int scanOptions(int argc, char *argv[]) {
 		}
 		else if (   intOption("-xdpi",   &exxdpi));
 		else if (   intOption("-ydpi",   &exydpi));
+		else if (   intOption("-rthreads", &raster_threads)) {
+			if (raster_threads<1) raster_threads = 1;
+		}
 		else if (   intOption("-scale",  &help))
 			exscaling = help / 100.0;
 		else if (  unitOption("-width",  &exwidth));
@@ -1277,6 +1385,12 @@ void print_help(void) {
 	PRINTF("                  crossings (default: infinite).\n");
 	PRINTF("-cmin <num>       Minimal number of iterations used for the reduction of edge\n");
 	PRINTF("                  crossings (default: 0).\n");
+	PRINTF("-cthreads <num>   Number of threads used for the  weights of wide layers in\n");
+	PRINTF("                  the reduction of edge crossings (default: 1). The layout\n");
+	PRINTF("                  is the same for any number of threads.\n");
+	PRINTF("-ctree | -csweep  Count the crossings by an accumulator tree,  or by a sweep\n");
+	PRINTF("                  over both layers (default). The tree is faster  if layers\n");
+	PRINTF("                  are wide.  Both yield the same layout.\n");
 	PRINTF("-p <num> | -pmax <num> | -pendulum <num>\n");
 	PRINTF("                  Maximal number of iterations used for the balancing  by the\n");
 	PRINTF("                  pendulum method (default: 100).\n");
@@ -1295,6 +1409,22 @@ void print_help(void) {
 	PRINTF("-nocoptl | -nocoptloc\n");
 	PRINTF("                  Switch local crossing optimization off. However, this phase\n");
 	PRINTF("                  is normally not time critical.\n");
+	PRINTF("-incremental      After folding or unfolding,  keep the order of the layers\n");
+	PRINTF("                  that did not change,  and reduce the crossings only at the\n");
+	PRINTF("                  changed layers. This is faster,  and the layout jumps less.\n");
+	PRINTF("-anytime          Show first a fast layout  (one barycenter sweep and linear\n");
+	PRINTF("                  time coordinates),  then a better one  that starts from its\n");
+	PRINTF("                  order,  and at last the normal layout  with the options as\n");
+	PRINTF("                  given.  A click or a key interrupts the refinement.\n");
+	PRINTF("-cache <dir>      Keep the final layouts in the directory <dir>.  If the same\n");
+	PRINTF("                  graph is  loaded again  with the same  layout options,  its\n");
+	PRINTF("                  layout is taken from there instead of being calculated.\n");
+	PRINTF("-cachesize <num>  Bound of  the size of  the layout cache  in kilobytes.  The\n");
+	PRINTF("                  least recently used layouts are removed (default: 32768).\n");
+	PRINTF("-warmstart <file> Start from the layout in <file>,  if it exists: nodes with\n");
+	PRINTF("                  the same title keep their level and their order,  and only\n");
+	PRINTF("                  the layers that changed are reordered.  The new layout is\n");
+	PRINTF("                  stored into <file> (same format as vcgbatch -binlayout).\n");
 
 
 	PRINTF("\n");
@@ -1335,6 +1465,18 @@ void print_help(void) {
 	PRINTF("                  degrees.\n");
 	PRINTF("-d tree           Use specialized layout  for trees.  This does not work with\n");
 	PRINTF("                  non-trees.\n");
+	PRINTF("-rank dfs         Keep the levels of the distribution of nodes (default).\n");
+	PRINTF("-rank simplex     Shift the nodes afterwards  by the network simplex method\n");
+	PRINTF("                  into the levels  such that the  total length  of edges is\n");
+	PRINTF("                  minimal.  This yields less dummy nodes  and a faster layout\n");
+	PRINTF("                  of graphs with many long edges. The fine tuning is skipped.\n");
+	PRINTF("-coord iterative  Calculate the x coordinates  by the pendulum and rubberband\n");
+	PRINTF("                  methods (default).\n");
+	PRINTF("-coord bk         Calculate the x coordinates in linear time by the method of\n");
+	PRINTF("                  Brandes and Koepf. Long edges are straight, and the layout\n");
+	PRINTF("                  of large graphs is much faster.  The pendulum and rubber-\n");
+	PRINTF("                  band iterations are skipped.  Since long edges cannot bend,\n");
+	PRINTF("                  the layout is wider,  on flow charts 2.5 to 5 times.\n");
 
 	PRINTF("\n");
 	PRINTF("Options for the view onto the graph:\n");
@@ -1355,6 +1497,10 @@ void print_help(void) {
 	PRINTF("                  drawing of splines is very slow.\n");
 	PRINTF("-nonodes          Suppress drawing of nodes.\n");
 	PRINTF("-noedges          Suppress drawing of edges.\n");
+	PRINTF("-lod <num>        Level of detail: nodes smaller than <num> pixels are drawn\n");
+	PRINTF("                  as filled rectangles without text, and edges with arrows\n");
+	PRINTF("                  smaller than <num> pixels as lines without arrowheads.\n");
+	PRINTF("                  Default is 0 (always full detail).\n");
 	PRINTF("-xpos <num>       Set the x-coordinate of the initial point of the graph that\n");
 	PRINTF("                  appears at the window origin or of the initial focus point.\n");
 	PRINTF("-ypos <num>       Set the y-coordinate of the initial point of the graph that\n");
@@ -1396,6 +1542,9 @@ void print_help(void) {
 	PRINTF("                  The number of pages must be one of 1,4,9,16,25.\n");
 	PRINTF("-xdpi  <num>      Set the horizontal resolution for the bitmap output.\n");
 	PRINTF("-ydpi  <num>      Set the vertical resolution for the bitmap output.\n");
+	PRINTF("-rthreads <num>   Number of threads used to rasterize the bitmap output\n");
+	PRINTF("                  (default: 1). The bitmap is the same for any number of\n");
+	PRINTF("                  threads.\n");
 	PRINTF("-scale <num>      Scale the graph to <num> percent  for the file output.  The\n");
 	PRINTF("                  default scaling fits the graph with maximal aspect ratio to\n");
 	PRINTF("                  the paper size.\n");
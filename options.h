@@ -86,6 +86,7 @@ extern int nr_max_errors;
 extern int fastflag;
 extern int supress_nodes;
 extern int supress_edges;
+extern int lod_pixels;
 extern int summarize_double_edges;
 extern int hide_single_nodes;
 extern int layout_flag;
@@ -95,11 +96,21 @@ extern int layout_flag;
 extern int crossing_heuristics;
 extern int local_unwind;
 extern int near_edge_layout;
+extern int near_edge_compaction;
 extern int fine_tune_layout;
+extern int layer_ranking;
+extern int coord_engine;
 extern int edge_label_phase;
 extern int min_baryiterations;
 extern int max_baryiterations;
 extern int skip_baryphase2;
+extern int crossing_counter;
+extern int crossing_threads;
+extern int incremental_layout;
+extern int anytime_layout;
+extern char *layout_cache_dir;
+extern int layout_cache_size;
+extern char *warm_start_file;
 extern int max_mediumshifts;
 extern int min_mediumshifts;
 extern int nwdumping_phase;
@@ -137,6 +148,7 @@ extern double  exrightm;
 extern double  extopm;
 extern double  exbottomm;
 extern int    exbbox;
+extern int    raster_threads;
 
 extern int      cmap_size;
 extern int      cmap_changed;
@@ -0,0 +1,373 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         outbuf.c                                           */
+/*   description:  Buffered writer for the file output                */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * print_graph writes some 40 short lines per node and edge, each by
+ * its own fprintf. For large graphs, the output was bound by the
+ * interpretation of the format strings and the locking of stdio, not
+ * by the file system.
+ *
+ * The writer collects the output in one large buffer that is allocated
+ * once and reused, and writes it by fwrite when it is full. Numbers
+ * are converted by hand. ob_printf understands only the conversions
+ * used by print_graph: %s, %c, %d, %ld and %f (the latter by sprintf),
+ * without flags and widths.
+ *
+ * There is only one writer at a time: ob_open starts it on an opened
+ * file, ob_close flushes the buffer. The file is not closed.
+ *
+ * For the binary layout dump, numbers are written as variable length
+ * integers: 7 bits per byte, lowest bits first, the high bit of a byte
+ * is set if more bytes follow. Signed numbers are zigzag coded first,
+ * such that small negative numbers are short, too.
+ *
+ * This file provides the following functions:
+ *
+ * ob_open		start writing to a file
+ * ob_close		flush the buffer; returns 0 on a write error
+ * ob_flush		write the buffer into the file
+ * ob_write		write n bytes
+ * ob_puts		write a string
+ * ob_putc		write a character
+ * ob_putlong		write a number in decimal
+ * ob_indent		write n levels of indentation (two blanks each)
+ * ob_printf		formatted output
+ * ob_uvarint		write an unsigned variable length integer
+ * ob_svarint		write a signed variable length integer
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "globals.h"
+#include "main.h"
+#include "outbuf.h"
+
+
+/* Global variables
+ * ================
+ */
+
+#define OB_SIZE		(256*1024)	/* size of the buffer         */
+#define OB_RESERVE	64		/* space for a number or so   */
+
+int ob_unbuffered = 0;
+
+static char	*ob_buf  = NULL;	/* the buffer, kept for reuse */
+static int	ob_len   = 0;		/* bytes in the buffer        */
+static FILE	*ob_file = NULL;	/* the actual file            */
+static int	ob_error = 0;		/* 1, if a write failed       */
+
+
+/*--------------------------------------------------------------------*/
+/*  Opening and closing                                               */
+/*--------------------------------------------------------------------*/
+
+/*  Start writing to the file f
+ *  ---------------------------
+ */
+
+#ifdef ANSI_C
+void ob_open(FILE *f)
+#else
+void ob_open(f)
+FILE *f;
+#endif
+{
+	if (!ob_buf) {
+		ob_buf = (char *)malloc(OB_SIZE);
+		if (!ob_buf) Fatal_error("memory exhausted","");
+	}
+	ob_file  = f;
+	ob_len   = 0;
+	ob_error = 0;
+}
+
+
+/*  Write the buffer into the file
+ *  ------------------------------
+ */
+
+#ifdef ANSI_C
+void ob_flush(void)
+#else
+void ob_flush()
+#endif
+{
+	if (ob_len > 0) {
+		if (fwrite(ob_buf, 1, ob_len, ob_file) != (size_t)ob_len)
+			ob_error = 1;
+	}
+	ob_len = 0;
+}
+
+
+/*  Finish writing
+ *  --------------
+ *  Returns 1 if all output was written successfully.
+ */
+
+#ifdef ANSI_C
+int ob_close(void)
+#else
+int ob_close()
+#endif
+{
+	ob_flush();
+	if (fflush(ob_file)) ob_error = 1;
+	if (ferror(ob_file)) ob_error = 1;
+	ob_file = NULL;
+	return(!ob_error);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Text output                                                       */
+/*--------------------------------------------------------------------*/
+
+/*  Write n bytes
+ *  -------------
+ */
+
+#ifdef ANSI_C
+void ob_write(char *s, int n)
+#else
+void ob_write(s, n)
+char *s;
+int n;
+#endif
+{
+	int k;
+
+	if (ob_unbuffered) {
+		if (fwrite(s, 1, n, ob_file) != (size_t)n) ob_error = 1;
+		return;
+	}
+	if (n <= OB_SIZE-ob_len) {	/* the usual case */
+		memcpy(ob_buf+ob_len, s, n);
+		ob_len += n;
+		return;
+	}
+	while (n > 0) {
+		if (ob_len == OB_SIZE) ob_flush();
+		k = OB_SIZE - ob_len;
+		if (k > n) k = n;
+		memcpy(ob_buf+ob_len, s, k);
+		ob_len += k;
+		s += k;
+		n -= k;
+	}
+}
+
+
+/*  Write a string
+ *  --------------
+ */
+
+#ifdef ANSI_C
+void ob_puts(char *s)
+#else
+void ob_puts(s)
+char *s;
+#endif
+{
+	if (ob_unbuffered) { (void)fputs(s, ob_file); return; }
+	ob_write(s, (int)strlen(s));
+}
+
+
+/*  Write a character
+ *  -----------------
+ */
+
+#ifdef ANSI_C
+void ob_putc(int c)
+#else
+void ob_putc(c)
+int c;
+#endif
+{
+	if (ob_unbuffered) { (void)putc(c, ob_file); return; }
+	if (ob_len == OB_SIZE) ob_flush();
+	ob_buf[ob_len++] = (char)c;
+}
+
+
+/*  Write a number in decimal
+ *  -------------------------
+ *  The digits are produced backwards into a small array. The unsigned
+ *  arithmetic works also for the smallest long.
+ */
+
+#ifdef ANSI_C
+void ob_putlong(long n)
+#else
+void ob_putlong(n)
+long n;
+#endif
+{
+	char	digits[24];
+	int	k;
+	unsigned long u;
+
+	if (ob_unbuffered) { FPRINTF(ob_file, "%ld", n); return; }
+	if (ob_len > OB_SIZE-OB_RESERVE) ob_flush();
+
+	u = (n<0) ? 0UL-(unsigned long)n : (unsigned long)n;
+	k = 24;
+	do {
+		digits[--k] = (char)('0' + u%10);
+		u /= 10;
+	} while (u);
+	if (n<0) digits[--k] = '-';
+	memcpy(ob_buf+ob_len, digits+k, 24-k);
+	ob_len += 24-k;
+}
+
+
+/*  Write n levels of indentation
+ *  -----------------------------
+ */
+
+#define OB_INDENT 16
+
+static char blanks[2*OB_INDENT+1] = "                                ";
+
+#ifdef ANSI_C
+void ob_indent(int n)
+#else
+void ob_indent(n)
+int n;
+#endif
+{
+	int i;
+
+	if (ob_unbuffered) {
+		for (i=0; i<n; i++) FPRINTF(ob_file, "  ");
+		return;
+	}
+	while (n > OB_INDENT) {
+		ob_write(blanks, 2*OB_INDENT);
+		n -= OB_INDENT;
+	}
+	ob_write(blanks, 2*n);
+}
+
+
+/*  Formatted output
+ *  ----------------
+ *  Only %s, %c, %d, %ld, %f and %% are understood. A NULL string
+ *  is printed as (null), as by the fprintf of glibc.
+ */
+
+void ob_printf(char *fmt, ...)
+{
+	va_list	args;
+	char	*c, *t;
+	char	fbuf[400];
+
+	va_start(args, fmt);
+	if (ob_unbuffered) {
+		(void)vfprintf(ob_file, fmt, args);
+		va_end(args);
+		return;
+	}
+	c = fmt;
+	for (;;) {
+		/* the literal text is copied in the same pass that scans it */
+		while ((*c) && (*c!='%')) {
+			if (ob_len == OB_SIZE) ob_flush();
+			ob_buf[ob_len++] = *c++;
+		}
+		if (!*c) break;
+		c++;
+		switch (*c) {
+		case 's': t = va_arg(args, char *);
+			  ob_puts(t ? t : "(null)");	/* as glibc */
+			  break;
+		case 'c': ob_putc(va_arg(args, int));            break;
+		case 'd': ob_putlong((long)va_arg(args, int));   break;
+		case 'f': SPRINTF(fbuf, "%f", va_arg(args, double));
+			  ob_puts(fbuf);
+			  break;
+		case 'l': c++;
+			  assert((*c=='d'));
+			  ob_putlong(va_arg(args, long));
+			  break;
+		case '%': ob_putc('%'); break;
+		default:  assert((0));
+		}
+		c++;
+	}
+	va_end(args);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Binary output                                                     */
+/*--------------------------------------------------------------------*/
+
+/*  Write an unsigned variable length integer
+ *  -----------------------------------------
+ */
+
+#ifdef ANSI_C
+void ob_uvarint(unsigned long n)
+#else
+void ob_uvarint(n)
+unsigned long n;
+#endif
+{
+	char b;
+
+	if (ob_unbuffered) {
+		while (n >= 0x80) {
+			(void)putc((int)((n & 0x7f) | 0x80), ob_file);
+			n >>= 7;
+		}
+		(void)putc((int)n, ob_file);
+		return;
+	}
+	if (ob_len > OB_SIZE-OB_RESERVE) ob_flush();
+	while (n >= 0x80) {
+		b = (char)((n & 0x7f) | 0x80);
+		ob_buf[ob_len++] = b;
+		n >>= 7;
+	}
+	ob_buf[ob_len++] = (char)n;
+}
+
+
+/*  Write a signed variable length integer
+ *  --------------------------------------
+ *  zigzag: 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+ */
+
+#ifdef ANSI_C
+void ob_svarint(long n)
+#else
+void ob_svarint(n)
+long n;
+#endif
+{
+	if (n<0) ob_uvarint(((0UL-(unsigned long)n)<<1) - 1);
+	else     ob_uvarint(((unsigned long)n)<<1);
+}
+
+/*--------------------------------------------------------------------*/
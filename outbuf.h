@@ -0,0 +1,50 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         outbuf.h                                           */
+/*   description:  Buffered writer for the file output                */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+/*--------------------------------------------------------------------*/
+
+/* Flag: if 1, the writer passes everything directly to stdio.
+ * For comparison only (see vcgbatch -outbench).
+ */
+
+extern int ob_unbuffered;
+
+
+/* Prototypes
+ * ----------
+ * See outbuf.c for more information.
+ */
+
+void	ob_open		_PP((FILE *f));
+int	ob_close	_PP((void));
+void	ob_flush	_PP((void));
+void	ob_write	_PP((char *s, int n));
+void	ob_puts		_PP((char *s));
+void	ob_putc		_PP((int c));
+void	ob_putlong	_PP((long n));
+void	ob_indent	_PP((int n));
+void	ob_printf	_PP((char *fmt, ...));
+void	ob_uvarint	_PP((unsigned long n));
+void	ob_svarint	_PP((long n));
+
+/*--------------------------------------------------------------------*/
+
+#endif /* OUTBUF_H */
@@ -0,0 +1,660 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         profile.c                                          */
+/*   description:  Phase times and counters of the layout             */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * The phases of the layout are marked by start_time/stop_time (see
+ * timing.h). If compiled with PHASE_TIMING, these markers call
+ * phase_start_time and phase_stop_time. For each phase name, we
+ * record the wall time and the CPU time of the process (all threads).
+ *
+ * Measurements are grouped into rounds: parse_part starts a round for
+ * a new graph, relayout a round for a new layout, and the GUI a round
+ * for the next drawing (prof_frame_begin). A drawing may consist of
+ * several calls of draw_graph, e.g. one per tile of the window (see
+ * mainwindow.cpp); their times are added. The time of a phase is the
+ * time of the last round in which the phase was measured. Thus after a relayout,
+ * the times of parse_part and step0 remain those of the last parse,
+ * and the drawing times are those of the last drawing. Only phases
+ * measured for the actual graph are reported.
+ *
+ * prof_frame_begin and prof_frame_end enclose one repaint of the GUI
+ * window. Its wall and CPU time are kept apart from the phases,
+ * because the drawing phases are part of it.
+ *
+ * Besides the times, some counters of the actual layout are kept:
+ * the iterations of the barycentering, the crossings before and after
+ * step 2 (set by step2_main), and the numbers of nodes, dummy nodes,
+ * edge segments and levels (set by prof_count_layout at the end of
+ * relayout). The bytes of the memory pools of alloc.c are queried
+ * when the profile is written.
+ *
+ * The profile can be written as one line of JSON (prof_json, used by
+ * the batch driver), or as text for the status pane of the GUI
+ * (prof_summary).
+ *
+ * This file provides the following functions:
+ *
+ * phase_start_time	start the clock of a phase
+ * phase_stop_time	stop the clock and add the time to a phase
+ * prof_begin		start a new round of measurements
+ * prof_frame_begin	start a repaint: a new drawing round
+ * prof_frame_end	end of the repaint
+ * prof_set		set a counter of the actual layout
+ * prof_get		get a counter of the actual layout
+ * prof_count_layout	count nodes, dummy nodes, edges and levels
+ * prof_nr_phases	number of phases known so far
+ * prof_phase_name	name of a phase
+ * prof_phase_wall	wall time of a phase for the actual graph
+ * prof_phase_cpu	CPU time of a phase for the actual graph
+ * prof_phase_total	wall time of a phase summarized over all graphs
+ * prof_add_total	add wall time of another process to a phase
+ * prof_wall_clock	the wall clock in seconds
+ * prof_json		the profile as one line of JSON
+ * prof_summary		the profile as text
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#endif
+
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "steps.h"
+#include "profile.h"
+
+
+/* Prototypes
+ * ==========
+ */
+
+static double	wall_clock	_PP((void));
+static double	cpu_clock	_PP((void));
+static int	find_phase	_PP((char *x));
+static int	put_string	_PP((char *buf, int len, int pos, char *s));
+static int	put_name	_PP((char *buf, int len, int pos, char *s));
+
+
+/* Global variables
+ * ================
+ */
+
+/*  Phase table: one entry per distinct stop_time name.
+ */
+
+#define MAXPHASES 16
+
+static struct prof_phase {
+	char	*name;		/* phase name as given to stop_time */
+	double	wall;		/* wall time of the last round      */
+	double	cpu;		/* CPU time of the last round       */
+	double	total;		/* wall time summarized over graphs */
+	long	graph;		/* graph of the last round          */
+	long	round;		/* last round of the measurement    */
+} phases[MAXPHASES];
+
+static int	nr_phases  = 0;
+static double	wall_start = 0.0;
+static double	cpu_start  = 0.0;
+
+static long	act_graph  = 0;		/* number of the actual graph  */
+static long	act_round  = 0;		/* number of the actual round  */
+
+static double	frame_wall  = 0.0;	/* wall time of the last repaint */
+static double	frame_cpu   = 0.0;	/* CPU time of the last repaint  */
+static long	frame_graph = -1;	/* graph of the last repaint     */
+static double	frame_wall_start = 0.0;
+static double	frame_cpu_start  = 0.0;
+
+/*  Counters of the actual layout, and their names in the profile.
+ */
+
+static long	counters[PROF_NR_COUNTERS];
+
+static char	*counter_names[PROF_NR_COUNTERS] = {
+	"bary_iterations",
+	"crossings_before",
+	"crossings_after",
+	"nodes",
+	"dummy_nodes",
+	"edge_segments",
+	"levels"
+};
+
+
+/*--------------------------------------------------------------------*/
+/*  Clocks                                                            */
+/*--------------------------------------------------------------------*/
+
+/*  Wall clock and CPU time of the process in seconds
+ *  -------------------------------------------------
+ */
+
+#ifdef _MSC_VER
+static double wall_clock(void)
+{
+	LARGE_INTEGER freq, cnt;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&cnt);
+	return((double)cnt.QuadPart / (double)freq.QuadPart);
+}
+
+static double cpu_clock(void)
+{
+	FILETIME c, e, k, u;
+	ULARGE_INTEGER kt, ut;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &c, &e, &k, &u))
+		return(0.0);
+	kt.LowPart = k.dwLowDateTime; kt.HighPart = k.dwHighDateTime;
+	ut.LowPart = u.dwLowDateTime; ut.HighPart = u.dwHighDateTime;
+	return((double)(kt.QuadPart + ut.QuadPart) / 10000000.0);
+}
+#else
+#ifdef ANSI_C
+static double wall_clock(void)
+#else
+static double wall_clock()
+#endif
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return((double)tv.tv_sec + (double)tv.tv_usec / 1000000.0);
+}
+
+#ifdef ANSI_C
+static double cpu_clock(void)
+#else
+static double cpu_clock()
+#endif
+{
+	struct rusage r;
+
+	if (getrusage(RUSAGE_SELF, &r)) return(0.0);
+	return((double)(r.ru_utime.tv_sec + r.ru_stime.tv_sec)
+		+ (double)(r.ru_utime.tv_usec + r.ru_stime.tv_usec) / 1000000.0);
+}
+#endif
+
+
+/*  Wall clock for measurements outside of the phases
+ *  -------------------------------------------------
+ */
+
+#ifdef ANSI_C
+double prof_wall_clock(void)
+#else
+double prof_wall_clock()
+#endif
+{
+	return(wall_clock());
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Phases                                                            */
+/*--------------------------------------------------------------------*/
+
+/*  Start and stop a phase
+ *  ----------------------
+ *  stop_time restarts the clock, thus two stops without start in
+ *  between measure two consecutive intervals. Inside one round, the
+ *  times of a phase are added.
+ */
+
+#ifdef ANSI_C
+void phase_start_time(void)
+#else
+void phase_start_time()
+#endif
+{
+	wall_start = wall_clock();
+	cpu_start  = cpu_clock();
+}
+
+#ifdef ANSI_C
+void phase_stop_time(char *x)
+#else
+void phase_stop_time(x)
+char *x;
+#endif
+{
+	double wall, cpu;
+	int i;
+
+	wall = wall_clock();
+	cpu  = cpu_clock();
+	i = find_phase(x);
+	if (i>=0) {
+		if (phases[i].round != act_round) {
+			phases[i].wall  = 0.0;
+			phases[i].cpu   = 0.0;
+			phases[i].graph = act_graph;
+			phases[i].round = act_round;
+		}
+		phases[i].wall  += wall - wall_start;
+		phases[i].cpu   += cpu  - cpu_start;
+		phases[i].total += wall - wall_start;
+	}
+	wall_start = wall;
+	cpu_start  = cpu;
+}
+
+
+/*  Find the entry of a phase
+ *  -------------------------
+ *  A new entry is created if necessary. Returns -1 if the table is full.
+ *  The names are string literals, thus we keep the pointers.
+ */
+
+#ifdef ANSI_C
+static int find_phase(char *x)
+#else
+static int find_phase(x)
+char *x;
+#endif
+{
+	int i;
+
+	for (i=0; i<nr_phases; i++)
+		if (strcmp(phases[i].name, x)==0) return(i);
+	if (nr_phases==MAXPHASES) return(-1);
+	phases[i].name  = x;
+	phases[i].wall  = 0.0;
+	phases[i].cpu   = 0.0;
+	phases[i].total = 0.0;
+	phases[i].graph = -1;
+	phases[i].round = -1;
+	nr_phases++;
+	return(i);
+}
+
+
+/*  Start a new round
+ *  -----------------
+ *  what is PROF_GRAPH, PROF_LAYOUT or PROF_DRAW. A new graph or a new
+ *  layout clears the counters.
+ */
+
+#ifdef ANSI_C
+void prof_begin(int what)
+#else
+void prof_begin(what)
+int what;
+#endif
+{
+	int i;
+
+	act_round++;
+	if (what == PROF_DRAW) return;
+	if (what == PROF_GRAPH) act_graph++;
+	for (i=0; i<PROF_NR_COUNTERS; i++) counters[i] = 0;
+}
+
+
+/*  Measure a repaint of the GUI
+ *  ----------------------------
+ *  prof_frame_begin starts a new drawing round, thus the drawing phases
+ *  of all calls of draw_graph up to prof_frame_end are added.
+ */
+
+#ifdef ANSI_C
+void prof_frame_begin(void)
+#else
+void prof_frame_begin()
+#endif
+{
+	prof_begin(PROF_DRAW);
+	frame_wall_start = wall_clock();
+	frame_cpu_start  = cpu_clock();
+}
+
+#ifdef ANSI_C
+void prof_frame_end(void)
+#else
+void prof_frame_end()
+#endif
+{
+	frame_wall  = wall_clock() - frame_wall_start;
+	frame_cpu   = cpu_clock()  - frame_cpu_start;
+	frame_graph = act_graph;
+}
+
+
+/*  Access to the phase table
+ *  -------------------------
+ *  The times of phases that were not measured for the actual graph
+ *  are 0.
+ */
+
+#ifdef ANSI_C
+int prof_nr_phases(void)
+#else
+int prof_nr_phases()
+#endif
+{
+	return(nr_phases);
+}
+
+#ifdef ANSI_C
+char *prof_phase_name(int i)
+#else
+char *prof_phase_name(i)
+int i;
+#endif
+{
+	return(phases[i].name);
+}
+
+#ifdef ANSI_C
+double prof_phase_wall(int i)
+#else
+double prof_phase_wall(i)
+int i;
+#endif
+{
+	if (phases[i].graph != act_graph) return(0.0);
+	return(phases[i].wall);
+}
+
+#ifdef ANSI_C
+double prof_phase_cpu(int i)
+#else
+double prof_phase_cpu(i)
+int i;
+#endif
+{
+	if (phases[i].graph != act_graph) return(0.0);
+	return(phases[i].cpu);
+}
+
+#ifdef ANSI_C
+double prof_phase_total(int i)
+#else
+double prof_phase_total(i)
+int i;
+#endif
+{
+	return(phases[i].total);
+}
+
+
+/*  Add the wall time of a phase measured by another process
+ *  --------------------------------------------------------
+ *  This is used to collect the summaries of the batch workers.
+ */
+
+#ifdef ANSI_C
+void prof_add_total(char *x, double wall)
+#else
+void prof_add_total(x, wall)
+char *x;
+double wall;
+#endif
+{
+	int i;
+
+	i = find_phase(x);
+	if (i>=0) phases[i].total += wall;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Counters                                                          */
+/*--------------------------------------------------------------------*/
+
+/*  Set and get a counter of the actual layout
+ *  ------------------------------------------
+ */
+
+#ifdef ANSI_C
+void prof_set(int c, long v)
+#else
+void prof_set(c, v)
+int c;
+long v;
+#endif
+{
+	if ((c>=0) && (c<PROF_NR_COUNTERS)) counters[c] = v;
+}
+
+#ifdef ANSI_C
+long prof_get(int c)
+#else
+long prof_get(c)
+int c;
+#endif
+{
+	if ((c>=0) && (c<PROF_NR_COUNTERS)) return(counters[c]);
+	return(0);
+}
+
+
+/*  Count the objects of the layout
+ *  -------------------------------
+ *  This is done at the end of relayout. The statistics of step 4 are
+ *  updated as a side effect.
+ */
+
+#ifdef ANSI_C
+void prof_count_layout(void)
+#else
+void prof_count_layout()
+#endif
+{
+	statistics();
+	counters[PROF_NODES]   = st_nr_vis_nodes;
+	counters[PROF_DUMMIES] = st_nr_vis_dummies;
+	counters[PROF_EDGES]   = st_nr_vis_edges;
+	counters[PROF_LEVELS]  = maxdepth+1;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Output of the profile                                             */
+/*--------------------------------------------------------------------*/
+
+/*  Append a string to a buffer
+ *  ---------------------------
+ *  The buffer buf has len bytes, and is filled up to pos. Returns the
+ *  new fill position. The result is truncated if the buffer is full.
+ */
+
+#ifdef ANSI_C
+static int put_string(char *buf, int len, int pos, char *s)
+#else
+static int put_string(buf, len, pos, s)
+char *buf;
+int len, pos;
+char *s;
+#endif
+{
+	while (*s && (pos < len-1)) buf[pos++] = *s++;
+	buf[pos] = 0;
+	return(pos);
+}
+
+
+/*  Append a JSON string
+ *  --------------------
+ *  The string is quoted and escaped; file names may contain anything.
+ */
+
+#ifdef ANSI_C
+static int put_name(char *buf, int len, int pos, char *s)
+#else
+static int put_name(buf, len, pos, s)
+char *buf;
+int len, pos;
+char *s;
+#endif
+{
+	char esc[8];
+
+	pos = put_string(buf, len, pos, "\"");
+	for (; *s; s++) {
+		if ((*s=='"') || (*s=='\\')) {
+			esc[0] = '\\'; esc[1] = *s; esc[2] = 0;
+		}
+		else if ((unsigned char)*s < 0x20)
+			SPRINTF(esc, "\\u%04x", (unsigned char)*s);
+		else {
+			esc[0] = *s; esc[1] = 0;
+		}
+		pos = put_string(buf, len, pos, esc);
+	}
+	return(put_string(buf, len, pos, "\""));
+}
+
+
+/*  The profile as JSON
+ *  -------------------
+ *  One object on one line, with the graph name, the times of the
+ *  phases in seconds, the counters and the memory pools:
+ *
+ *    {"graph":"a.gdl","ok":true,
+ *     "phases":{"parse_part":{"wall":0.012,"cpu":0.011},...},
+ *     "counters":{"bary_iterations":4,...},
+ *     "pools":{"core":{"bytes":123456},
+ *              "GNODE":{"objects":10,"bytes":1520,"peak":10,
+ *                       "reserved":65536},...}}
+ *
+ *  Returns the length of the line, including the final newline. If
+ *  buf is too small, the line is truncated, but still ends with the
+ *  newline, such that the next line starts on a line of its own.
+ */
+
+#ifdef ANSI_C
+int prof_json(char *buf, int len, char *graphname, int ok)
+#else
+int prof_json(buf, len, graphname, ok)
+char *buf;
+int len;
+char *graphname;
+int ok;
+#endif
+{
+	char	item[256];
+	char	*name;
+	long	objects, bytes, peak, reserved;
+	int	i, pos, first;
+
+	pos = put_string(buf, len, 0, "{\"graph\":");
+	pos = put_name(buf, len, pos, graphname);
+	pos = put_string(buf, len, pos, ok ? ",\"ok\":true" : ",\"ok\":false");
+
+	pos = put_string(buf, len, pos, ",\"phases\":{");
+	first = 1;
+	for (i=0; i<nr_phases; i++) {
+		if (phases[i].graph != act_graph) continue;
+		if (!first) pos = put_string(buf, len, pos, ",");
+		first = 0;
+		pos = put_name(buf, len, pos, phases[i].name);
+		SPRINTF(item, ":{\"wall\":%.6f,\"cpu\":%.6f}",
+			phases[i].wall, phases[i].cpu);
+		pos = put_string(buf, len, pos, item);
+	}
+
+	pos = put_string(buf, len, pos, "},\"counters\":{");
+	for (i=0; i<PROF_NR_COUNTERS; i++) {
+		SPRINTF(item, "%s\"%s\":%ld", i ? "," : "",
+			counter_names[i], counters[i]);
+		pos = put_string(buf, len, pos, item);
+	}
+
+	SPRINTF(item, "},\"pools\":{\"core\":{\"bytes\":%ld}", core_memory_bytes());
+	pos = put_string(buf, len, pos, item);
+	for (i=0; arena_counters(i, &name, &objects, &bytes, &peak, &reserved); i++) {
+		SPRINTF(item,
+		    ",\"%s\":{\"objects\":%ld,\"bytes\":%ld,\"peak\":%ld,\"reserved\":%ld}",
+			name, objects, bytes, peak, reserved);
+		pos = put_string(buf, len, pos, item);
+	}
+	pos = put_string(buf, len, pos, "}}\n");
+	if ((pos > 0) && (buf[pos-1] != '\n')) buf[pos-1] = '\n';
+	return(pos);
+}
+
+
+/*  The profile as text
+ *  -------------------
+ *  One phase per line, then the counters and the memory pools.
+ *  Returns the length of the text.
+ */
+
+#ifdef ANSI_C
+int prof_summary(char *buf, int len)
+#else
+int prof_summary(buf, len)
+char *buf;
+int len;
+#endif
+{
+	char	item[256];
+	char	*name;
+	long	objects, bytes, peak, reserved;
+	double	wall, cpu;
+	int	i, pos;
+
+	pos = 0;
+	buf[0] = 0;
+	wall = cpu = 0.0;
+	for (i=0; i<nr_phases; i++) {
+		if (phases[i].graph != act_graph) continue;
+		SPRINTF(item, "%-28.40s %8.3f s  cpu %8.3f s\n",
+			phases[i].name, phases[i].wall, phases[i].cpu);
+		pos = put_string(buf, len, pos, item);
+		wall += phases[i].wall;
+		cpu  += phases[i].cpu;
+	}
+	SPRINTF(item, "%-28s %8.3f s  cpu %8.3f s\n\n", "total", wall, cpu);
+	pos = put_string(buf, len, pos, item);
+	if (frame_graph == act_graph) {
+		SPRINTF(item, "%-28s %8.3f s  cpu %8.3f s\n\n", "last repaint",
+			frame_wall, frame_cpu);
+		pos = put_string(buf, len, pos, item);
+	}
+
+	SPRINTF(item, "%ld nodes, %ld dummy nodes, %ld edge segments, %ld levels\n",
+		counters[PROF_NODES], counters[PROF_DUMMIES],
+		counters[PROF_EDGES], counters[PROF_LEVELS]);
+	pos = put_string(buf, len, pos, item);
+	SPRINTF(item, "%ld crossings before, %ld after, %ld barycenter iterations\n\n",
+		counters[PROF_CROSSINGS_BEFORE], counters[PROF_CROSSINGS_AFTER],
+		counters[PROF_BARY_ITERATIONS]);
+	pos = put_string(buf, len, pos, item);
+
+	SPRINTF(item, "%-8s %10ld bytes\n", "core", core_memory_bytes());
+	pos = put_string(buf, len, pos, item);
+	for (i=0; arena_counters(i, &name, &objects, &bytes, &peak, &reserved); i++) {
+		SPRINTF(item, "%-8s %10ld bytes, %ld objects, peak %ld, reserved %ld bytes\n",
+			name, bytes, objects, peak, reserved);
+		pos = put_string(buf, len, pos, item);
+	}
+	return(pos);
+}
@@ -0,0 +1,75 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         profile.h                                          */
+/*   description:  Phase times and counters of the layout             */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/*--------------------------------------------------------------------*/
+
+/* Measurement rounds, see prof_begin
+ * ----------------------------------
+ */
+
+#define PROF_GRAPH   0	/* a new graph is parsed        */
+#define PROF_LAYOUT  1	/* a new layout is calculated   */
+#define PROF_DRAW    2	/* the graph is drawn again     */
+
+
+/* Counters of the actual layout
+ * -----------------------------
+ */
+
+#define PROF_BARY_ITERATIONS	0  /* iterations of the barycentering  */
+#define PROF_CROSSINGS_BEFORE	1  /* crossings before step2 reduction */
+#define PROF_CROSSINGS_AFTER	2  /* crossings after step2            */
+#define PROF_NODES		3  /* visible nodes                    */
+#define PROF_DUMMIES		4  /* dummy nodes                      */
+#define PROF_EDGES		5  /* visible edge segments            */
+#define PROF_LEVELS		6  /* number of levels                 */
+#define PROF_NR_COUNTERS	7
+
+
+/* Prototypes
+ * ----------
+ * See profile.c for more information.
+ */
+
+void	phase_start_time	_PP((void));
+void	phase_stop_time		_PP((char *x));
+
+void	prof_begin		_PP((int what));
+void	prof_frame_begin	_PP((void));
+void	prof_frame_end		_PP((void));
+void	prof_set		_PP((int c, long v));
+long	prof_get		_PP((int c));
+void	prof_count_layout	_PP((void));
+
+int	prof_nr_phases		_PP((void));
+char   *prof_phase_name		_PP((int i));
+double	prof_phase_wall		_PP((int i));
+double	prof_phase_cpu		_PP((int i));
+double	prof_phase_total	_PP((int i));
+void	prof_add_total		_PP((char *x, double wall));
+double	prof_wall_clock		_PP((void));
+
+int	prof_json		_PP((char *buf, int len, char *graphname, int ok));
+int	prof_summary		_PP((char *buf, int len));
+
+/*--------------------------------------------------------------------*/
+
+#endif /* PROFILE_H */
@@ -0,0 +1,1043 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         ranking.c                                          */
+/*   description:  Network simplex ranking of the levels              */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * The partitioning of step1 assigns the levels (NTIEFE) by a depth
+ * first search. Each edge that spans more than one level gets a chain
+ * of dummy nodes later, and the dummy nodes inflate the crossing
+ * reduction, the coordinate assignment and the edge routing.
+ * On call graphs, the DFS levels are often much deeper than necessary.
+ *
+ * With option -rank simplex, the levels of the DFS are only used as
+ * initial solution of the following problem (Gansner et al., "A
+ * technique for drawing directed graphs", IEEE TSE 19(3), 1993):
+ *
+ *	minimize   sum over all edges (u,v) of  prio(u,v) * (l(v)-l(u))
+ *	such that  l(v)-l(u) >= minlen(u,v)
+ *
+ * It is solved by the network simplex method. The direction of each
+ * edge is the direction given by the DFS levels, thus the reverted
+ * edges stay the same. Edges that span at least one level keep
+ * minlen 1, edges inside a level get minlen 0.
+ *
+ * Nodes that must keep their distance form one class and are moved
+ * together:
+ *   - the nodes that are connected by near edges (NCONNECT),
+ *   - all nodes with a fixed level (NLEVEL>=0).
+ * The rank of a class is the level of its representative; the other
+ * nodes of the class keep their offset to it.
+ *
+ * The nodes are numbered by NDFS, which is not needed anymore after
+ * the DFS. All recursions of the textbook version (tight tree, low/lim
+ * numbering) are done by explicit stacks, because the graphs may be
+ * very deep.
+ *
+ * Unlike the fine tuning phase, the result is optimal. Thus the
+ * fine tuning is not done afterwards.
+ *
+ * This file provides the following function:
+ *
+ * simplex_ranking	recalculate the levels by the network simplex
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "timelim.h"
+#include "steps.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+
+/* Types
+ * =====
+ */
+
+/* Edge between two classes. The edge goes from the upper class tail
+ * to the lower class head.
+ */
+
+typedef struct nsedge {
+	int	tail;		/* upper class                             */
+	int	head;		/* lower class                             */
+	int	minlen;		/* minimal value of rank(head)-rank(tail)  */
+	int	weight;		/* priority of the edge                    */
+	int	tree;		/* index in ns_tree, or -1 if not in tree  */
+	long	cut;		/* cut value, if the edge is in the tree   */
+} NSEDGE;
+
+/* Class of nodes that are moved together
+ */
+
+typedef struct nsclass {
+	int	rank;		/* current rank                            */
+	int	init;		/* rank of the DFS                         */
+	int	lo;		/* minimal offset of the nodes             */
+	int	par;		/* tree edge to the parent, or -1          */
+	int	low;		/* smallest lim in the subtree             */
+	int	lim;		/* postorder number in the tree            */
+	int	adj;		/* first incident edge in ns_adj           */
+	int	deg;		/* number of incident edges                */
+	int	sub;		/* union find of the subtrees              */
+	int	size;		/* size of the subtree, if sub is the root */
+	int	last;		/* last member of the subtree              */
+	int	next;		/* next member of the subtree              */
+} NSCLASS;
+
+/* Entry of the DFS stack and the heap of subtrees
+ */
+
+typedef struct nspair {
+	int	key;
+	int	val;
+} NSPAIR;
+
+
+/* Prototypes
+ * ==========
+ */
+
+static int	node_index	_PP((GNODE v));
+static int	uf_find		_PP((int *p, int i));
+static int	uf_find_sub	_PP((int i));
+static int	collect_nodes	_PP((void));
+static void	build_classes	_PP((void));
+static int	build_edges	_PP((void));
+static void	heap_push	_PP((int key, int val));
+static int	heap_pop	_PP((NSPAIR *res));
+static void	tight_subtree	_PP((int r));
+static void	feasible_tree	_PP((void));
+static int	dfs_range	_PP((int root, int par, int low));
+static long	x_val		_PP((int e, int v, int dir));
+static void	x_cutval	_PP((int f));
+static void	init_cutvalues	_PP((void));
+static int	leave_edge	_PP((void));
+static int	enter_edge	_PP((int f));
+static int	tree_update	_PP((int v, int w, long cutvalue, int dir));
+static void	update		_PP((int e, int f));
+static void	normalize	_PP((void));
+static void	free_ranking	_PP((void));
+
+
+/* Global variables
+ * ================
+ */
+
+static GNODE	*ns_node   = NULL;	/* the nodes                         */
+static int	*ns_class  = NULL;	/* class of each node                */
+static int	*ns_off    = NULL;	/* offset of each node to its class  */
+static int	ns_nnodes  = 0;		/* number of nodes                   */
+
+static NSCLASS	*ns_c      = NULL;	/* the classes                       */
+static int	ns_ncls    = 0;		/* number of classes                 */
+static int	ns_pinned  = -1;	/* class of nodes with fixed level   */
+
+static NSEDGE	*ns_e      = NULL;	/* the edges                         */
+static int	ns_nedges  = 0;		/* number of edges                   */
+static int	*ns_adj    = NULL;	/* incident edges of each class      */
+
+static int	*ns_tree   = NULL;	/* the edges of the tree             */
+static int	ns_ntree   = 0;		/* number of edges of the tree       */
+static int	*ns_order  = NULL;	/* classes in order of lim           */
+static NSPAIR	*ns_stack  = NULL;	/* stack of dfs_range                */
+static NSPAIR	*ns_heap   = NULL;	/* heap of subtrees of feasible_tree */
+static int	ns_heapsize= 0;		/* number of entries of the heap     */
+static int	ns_search  = 0;		/* start of the search of leave_edge */
+
+#define SEARCHSIZE 30
+
+#define SLACK(e)  (ns_c[ns_e[e].head].rank-ns_c[ns_e[e].tail].rank \
+		   -ns_e[e].minlen)
+
+#define INSUBTREE(v,w) ((ns_c[v].low<=ns_c[w].lim)&&(ns_c[w].lim<=ns_c[v].lim))
+
+#define OTHER(e,v) ((ns_e[e].tail==(v)) ? ns_e[e].head : ns_e[e].tail)
+
+
+/*--------------------------------------------------------------------*/
+/*  Network simplex ranking                                           */
+/*--------------------------------------------------------------------*/
+
+/*  Driver
+ *  ------
+ *  The levels NTIEFE of all nodes of nodelist, labellist and dummylist
+ *  must be set by the DFS of step1. The levels are replaced by the
+ *  optimal levels, and maxdepth is updated.
+ */
+
+#ifdef ANSI_C
+void simplex_ranking(void)
+#else
+void simplex_ranking()
+#endif
+{
+	int	f, e, i, iterations;
+
+	debugmessage("simplex_ranking","");
+	gs_wait_message('p');
+
+	if (!collect_nodes()) return;
+	build_classes();
+	if (!build_edges()) {
+		free_ranking();
+		return;
+	}
+
+	feasible_tree();
+	init_cutvalues();
+
+	iterations = 0;
+	while ((f = leave_edge()) >= 0) {
+		e = enter_edge(f);
+		if (e<0) break;
+		update(f,e);
+		iterations++;
+		if ((iterations % 1000)==0) {
+			gs_wait_message('p');
+			if (G_timelimit>0) if (test_timelimit(30)) {
+				gs_wait_message('t');
+				break;
+			}
+		}
+	}
+
+	/* Every intermediate solution is feasible, thus we can use the
+	 * ranks even if the time limit was exceeded.
+	 */
+
+	normalize();
+	maxdepth = 0;
+	for (i=0; i<ns_nnodes; i++) {
+		NTIEFE(ns_node[i]) = ns_c[ns_class[i]].rank + ns_off[i];
+		if (NTIEFE(ns_node[i])>maxdepth) maxdepth = NTIEFE(ns_node[i]);
+	}
+	free_ranking();
+}
+
+
+/*  Release the memory
+ *  ------------------
+ */
+
+#ifdef ANSI_C
+static void free_ranking(void)
+#else
+static void free_ranking()
+#endif
+{
+	if (ns_node)  free(ns_node);
+	if (ns_class) free(ns_class);
+	if (ns_off)   free(ns_off);
+	if (ns_c)     free(ns_c);
+	if (ns_e)     free(ns_e);
+	if (ns_adj)   free(ns_adj);
+	if (ns_tree)  free(ns_tree);
+	if (ns_order) free(ns_order);
+	if (ns_stack) free(ns_stack);
+	if (ns_heap)  free(ns_heap);
+	ns_node  = NULL;
+	ns_class = ns_off = ns_adj = ns_tree = ns_order = NULL;
+	ns_c     = NULL;
+	ns_e     = NULL;
+	ns_stack = ns_heap = NULL;
+	ns_nnodes = ns_ncls = ns_nedges = ns_ntree = 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  The graph of the classes                                          */
+/*--------------------------------------------------------------------*/
+
+/*  Index of a node
+ *  ---------------
+ *  returns -1, if the node is not in the lists of the partitioning.
+ */
+
+#ifdef ANSI_C
+static int node_index(GNODE v)
+#else
+static int node_index(v)
+GNODE	v;
+#endif
+{
+	long i;
+
+	if (!v) return(-1);
+	i = NDFS(v);
+	if ((i<0)||(i>=ns_nnodes)||(ns_node[i]!=v)) return(-1);
+	return((int)i);
+}
+
+
+/*  Union find with path halving
+ *  ----------------------------
+ */
+
+#ifdef ANSI_C
+static int uf_find(int *p, int i)
+#else
+static int uf_find(p, i)
+int	*p;
+int	i;
+#endif
+{
+	while (p[i]!=i) {
+		p[i] = p[p[i]];
+		i = p[i];
+	}
+	return(i);
+}
+
+
+#ifdef ANSI_C
+static int uf_find_sub(int i)
+#else
+static int uf_find_sub(i)
+int	i;
+#endif
+{
+	while (ns_c[i].sub!=i) {
+		ns_c[i].sub = ns_c[ns_c[i].sub].sub;
+		i = ns_c[i].sub;
+	}
+	return(i);
+}
+
+
+/*  Collect the nodes
+ *  -----------------
+ *  from the nodelist, labellist and dummylist, and number them by NDFS.
+ *  Returns 0 if there is nothing to do.
+ */
+
+#ifdef ANSI_C
+static int collect_nodes(void)
+#else
+static int collect_nodes()
+#endif
+{
+	GNODE	v;
+	int	n, i;
+
+	n = 0;
+	for (v=nodelist;  v; v=NNEXT(v)) n++;
+	for (v=labellist; v; v=NNEXT(v)) n++;
+	for (v=dummylist; v; v=NNEXT(v)) n++;
+	if (n<2) return(0);
+
+	ns_node  = (GNODE *)malloc(n*sizeof(GNODE));
+	ns_class = (int *)malloc(n*sizeof(int));
+	ns_off   = (int *)malloc(n*sizeof(int));
+	if ((!ns_node)||(!ns_class)||(!ns_off))
+		Fatal_error("memory exhausted","");
+
+	i = 0;
+	for (v=nodelist;  v; v=NNEXT(v)) ns_node[i++] = v;
+	for (v=labellist; v; v=NNEXT(v)) ns_node[i++] = v;
+	for (v=dummylist; v; v=NNEXT(v)) ns_node[i++] = v;
+	ns_nnodes = n;
+	for (i=0; i<n; i++) NDFS(ns_node[i]) = i;
+	return(1);
+}
+
+
+/*  Build the classes
+ *  -----------------
+ *  Nodes connected by near edges, and all nodes with fixed level,
+ *  are merged into one class. Afterwards, ns_class contains the
+ *  class number of each node.
+ */
+
+#ifdef ANSI_C
+static void build_classes(void)
+#else
+static void build_classes()
+#endif
+{
+	CONNECT	c;
+	int	i, j, r, pinned, nc;
+
+	for (i=0; i<ns_nnodes; i++) ns_class[i] = i;
+
+	pinned = -1;
+	for (i=0; i<ns_nnodes; i++) {
+		r = uf_find(ns_class,i);
+		c = NCONNECT(ns_node[i]);
+		if (c) {
+			j = node_index(CTARGET(c));
+			if (j>=0) {
+				j = uf_find(ns_class,j);
+				if (j!=r) ns_class[j] = r;
+			}
+			j = node_index(CTARGET2(c));
+			if (j>=0) {
+				j = uf_find(ns_class,j);
+				if (j!=r) ns_class[j] = r;
+			}
+		}
+		if (NLEVEL(ns_node[i])>=0) {
+			if (pinned<0) pinned = i;
+			else {
+				j = uf_find(ns_class,pinned);
+				r = uf_find(ns_class,i);
+				if (j!=r) ns_class[r] = j;
+			}
+		}
+	}
+
+	/* Number the classes. ns_off temporarily holds the class number
+	 * of the representatives.
+	 */
+
+	nc = 0;
+	for (i=0; i<ns_nnodes; i++) {
+		if (uf_find(ns_class,i)==i) ns_off[i] = nc++;
+	}
+	ns_c = (NSCLASS *)malloc(nc*sizeof(NSCLASS));
+	if (!ns_c) Fatal_error("memory exhausted","");
+	ns_ncls = nc;
+
+	for (i=0; i<ns_nnodes; i++) ns_class[i] = uf_find(ns_class,i);
+	for (i=0; i<ns_nnodes; i++) {
+		if (ns_class[i]==i) {
+			r = ns_off[i];
+			ns_c[r].init = ns_c[r].rank = NTIEFE(ns_node[i]);
+			ns_c[r].lo   = 0;
+			ns_c[r].deg  = 0;
+		}
+	}
+	for (i=0; i<ns_nnodes; i++) ns_class[i] = ns_off[ns_class[i]];
+	for (i=0; i<ns_nnodes; i++) {
+		r = ns_class[i];
+		ns_off[i] = NTIEFE(ns_node[i]) - ns_c[r].init;
+		if (ns_off[i]<ns_c[r].lo) ns_c[r].lo = ns_off[i];
+	}
+	ns_pinned = (pinned<0) ? -1 : ns_class[pinned];
+}
+
+
+/*  Build the edges between the classes
+ *  -----------------------------------
+ *  The direction and the minimal length of an edge are given by the
+ *  current levels. Edges inside a class are ignored. Returns 0 if an
+ *  edge leaves the lists of the partitioning; then we keep the levels.
+ */
+
+#ifdef ANSI_C
+static int build_edges(void)
+#else
+static int build_edges()
+#endif
+{
+	ADJEDGE	a;
+	GNODE	v, w;
+	int	i, j, k, n, t, h;
+
+	n = 0;
+	for (i=0; i<ns_nnodes; i++) {
+		for (a=NSUCC(ns_node[i]); a; a=ANEXT(a)) {
+			j = node_index(EEND(AKANTE(a)));
+			if (j<0) return(0);
+			if (ns_class[i]!=ns_class[j]) n++;
+		}
+	}
+
+	ns_e   = (NSEDGE *)malloc((n+1)*sizeof(NSEDGE));
+	ns_adj = (int *)malloc((2*n+1)*sizeof(int));
+	ns_tree  = (int *)malloc(ns_ncls*sizeof(int));
+	ns_order = (int *)malloc(ns_ncls*sizeof(int));
+	ns_stack = (NSPAIR *)malloc((ns_ncls+1)*sizeof(NSPAIR));
+	ns_heap  = (NSPAIR *)malloc(2*(ns_ncls+1)*sizeof(NSPAIR));
+	if ((!ns_e)||(!ns_adj)||(!ns_tree)||(!ns_order)||(!ns_stack)||(!ns_heap))
+		Fatal_error("memory exhausted","");
+
+	k = 0;
+	for (i=0; i<ns_nnodes; i++) {
+		v = ns_node[i];
+		for (a=NSUCC(v); a; a=ANEXT(a)) {
+			w = EEND(AKANTE(a));
+			j = node_index(w);
+			if (ns_class[i]==ns_class[j]) continue;
+			if (NTIEFE(w)<NTIEFE(v)) { t = j; h = i; }
+			else			 { t = i; h = j; }
+			ns_e[k].tail   = ns_class[t];
+			ns_e[k].head   = ns_class[h];
+			ns_e[k].minlen = ((NTIEFE(v)!=NTIEFE(w)) ? 1 : 0)
+					 + ns_off[t] - ns_off[h];
+			ns_e[k].weight = EPRIO(AKANTE(a));
+			ns_e[k].tree   = -1;
+			ns_e[k].cut    = 0L;
+			ns_c[ns_e[k].tail].deg++;
+			ns_c[ns_e[k].head].deg++;
+			k++;
+		}
+	}
+	ns_nedges = n;
+
+	/* Incident edges of the classes */
+
+	k = 0;
+	for (i=0; i<ns_ncls; i++) {
+		ns_c[i].adj = k;
+		k += ns_c[i].deg;
+		ns_c[i].deg = 0;
+	}
+	for (i=0; i<n; i++) {
+		t = ns_e[i].tail;
+		h = ns_e[i].head;
+		ns_adj[ns_c[t].adj + ns_c[t].deg++] = i;
+		ns_adj[ns_c[h].adj + ns_c[h].deg++] = i;
+	}
+	return(1);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Feasible tree                                                     */
+/*--------------------------------------------------------------------*/
+
+/*  Heap of subtrees
+ *  ----------------
+ *  ordered by size. Each subtree is pushed when it is created or
+ *  grows, thus there are less than 2*ns_ncls entries. Outdated entries
+ *  are skipped by feasible_tree.
+ */
+
+#ifdef ANSI_C
+static void heap_push(int key, int val)
+#else
+static void heap_push(key, val)
+int	key;
+int	val;
+#endif
+{
+	NSPAIR	*h;
+	NSPAIR	x;
+	int	i, p;
+
+	h = ns_heap;
+	i = ns_heapsize++;
+	x.key = key;
+	x.val = val;
+	while (i>0) {
+		p = (i-1)/2;
+		if (h[p].key<=key) break;
+		h[i] = h[p];
+		i = p;
+	}
+	h[i] = x;
+}
+
+
+#ifdef ANSI_C
+static int heap_pop(NSPAIR *res)
+#else
+static int heap_pop(res)
+NSPAIR	*res;
+#endif
+{
+	NSPAIR	*h;
+	NSPAIR	x;
+	int	i, c;
+
+	if (ns_heapsize==0) return(0);
+	h = ns_heap;
+	*res = h[0];
+	x = h[--ns_heapsize];
+	i = 0;
+	while ((c = 2*i+1) < ns_heapsize) {
+		if ((c+1<ns_heapsize)&&(h[c+1].key<h[c].key)) c++;
+		if (x.key<=h[c].key) break;
+		h[i] = h[c];
+		i = c;
+	}
+	h[i] = x;
+	return(1);
+}
+
+
+/*  Maximal tight subtree
+ *  ---------------------
+ *  starting at class r, by a breadth first search along the edges
+ *  with slack 0. The members are linked by next; the list is also the
+ *  queue of the search.
+ */
+
+#ifdef ANSI_C
+static void tight_subtree(int r)
+#else
+static void tight_subtree(r)
+int	r;
+#endif
+{
+	int	v, w, e, i;
+
+	ns_c[r].sub  = r;
+	ns_c[r].size = 1;
+	ns_c[r].last = r;
+	ns_c[r].next = -1;
+	for (v=r; v>=0; v=ns_c[v].next) {
+		for (i=0; i<ns_c[v].deg; i++) {
+			e = ns_adj[ns_c[v].adj+i];
+			w = OTHER(e,v);
+			if (ns_c[w].sub>=0) continue;
+			if (SLACK(e)!=0) continue;
+			ns_c[w].sub  = r;
+			ns_c[w].next = -1;
+			ns_c[ns_c[r].last].next = w;
+			ns_c[r].last = w;
+			ns_c[r].size++;
+			ns_e[e].tree = ns_ntree;
+			ns_tree[ns_ntree++] = e;
+		}
+	}
+	heap_push(ns_c[r].size, r);
+}
+
+
+/*  Feasible tree
+ *  -------------
+ *  First, we build the maximal tight subtrees. Then the smallest
+ *  subtree is shifted such that its incident edge with minimal slack
+ *  becomes tight, and it is merged with the subtree at the other end.
+ *  Since always the smaller subtree is shifted, each class is shifted
+ *  at most log(n) times. At the end, there is one tight tree for
+ *  each connected component.
+ */
+
+#ifdef ANSI_C
+static void feasible_tree(void)
+#else
+static void feasible_tree()
+#endif
+{
+	NSPAIR	top;
+	int	i, v, w, e, s, t, best, bestslack, delta;
+
+	ns_ntree = 0;
+	ns_heapsize = 0;
+	for (i=0; i<ns_ncls; i++) ns_c[i].sub = -1;
+	for (i=0; i<ns_ncls; i++) {
+		if (ns_c[i].sub<0) tight_subtree(i);
+	}
+
+	while (heap_pop(&top)) {
+		s = top.val;
+		if ((ns_c[s].sub!=s)||(ns_c[s].size!=top.key)) continue;
+
+		best = t = -1;
+		bestslack = delta = 0;
+		for (v=s; v>=0; v=ns_c[v].next) {
+			for (i=0; i<ns_c[v].deg; i++) {
+				e = ns_adj[ns_c[v].adj+i];
+				if (ns_e[e].tree>=0) continue;
+				w = uf_find_sub(OTHER(e,v));
+				if (w==s) continue;
+				if ((best<0)||(SLACK(e)<bestslack)) {
+					best = e;
+					bestslack = SLACK(e);
+					delta = (ns_e[e].tail==v) ? bestslack : -bestslack;
+					t = w;
+				}
+			}
+		}
+		if (best<0) continue;	/* component finished */
+
+		if (delta) {
+			for (v=s; v>=0; v=ns_c[v].next) ns_c[v].rank += delta;
+		}
+		ns_e[best].tree = ns_ntree;
+		ns_tree[ns_ntree++] = best;
+		ns_c[s].sub = t;
+		ns_c[t].size += ns_c[s].size;
+		ns_c[ns_c[t].last].next = s;
+		ns_c[t].last = ns_c[s].last;
+		heap_push(ns_c[t].size, t);
+	}
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Cut values                                                        */
+/*--------------------------------------------------------------------*/
+
+/*  Postorder numbering of a subtree
+ *  --------------------------------
+ *  numbers the subtree of root by lim, starting at low, and sets par,
+ *  low, lim and ns_order. par is the tree edge from root to its parent.
+ *  Returns the next free number.
+ */
+
+#ifdef ANSI_C
+static int dfs_range(int root, int par, int low)
+#else
+static int dfs_range(root, par, low)
+int	root;
+int	par;
+int	low;
+#endif
+{
+	int	sp, v, w, e, lim;
+
+	lim = low;
+	sp  = 0;
+	ns_c[root].par = par;
+	ns_c[root].low = low;
+	ns_stack[0].key = root;
+	ns_stack[0].val = 0;
+	while (sp>=0) {
+		v = ns_stack[sp].key;
+		if (ns_stack[sp].val < ns_c[v].deg) {
+			e = ns_adj[ns_c[v].adj + ns_stack[sp].val++];
+			if ((ns_e[e].tree<0)||(e==ns_c[v].par)) continue;
+			w = OTHER(e,v);
+			ns_c[w].par = e;
+			ns_c[w].low = lim;
+			sp++;
+			ns_stack[sp].key = w;
+			ns_stack[sp].val = 0;
+		}
+		else {
+			ns_c[v].lim = lim;
+			ns_order[lim] = v;
+			lim++;
+			sp--;
+		}
+	}
+	return(lim);
+}
+
+
+/*  Contribution of an edge to a cut value
+ *  --------------------------------------
+ *  e is incident to v, and v is at the side of the tree edge whose
+ *  cut value is calculated. dir is 1 if v is the tail of this tree
+ *  edge, and -1 otherwise.
+ */
+
+#ifdef ANSI_C
+static long x_val(int e, int v, int dir)
+#else
+static long x_val(e, v, dir)
+int	e;
+int	v;
+int	dir;
+#endif
+{
+	int	other, d, f;
+	long	rv;
+
+	other = OTHER(e,v);
+	if (!INSUBTREE(v,other)) {
+		f  = 1;
+		rv = (long)ns_e[e].weight;
+	}
+	else {
+		f  = 0;
+		rv = (ns_e[e].tree>=0) ? ns_e[e].cut : 0L;
+		rv -= (long)ns_e[e].weight;
+	}
+	if (dir>0) d = (ns_e[e].head==v) ? 1 : -1;
+	else	   d = (ns_e[e].tail==v) ? 1 : -1;
+	if (f) d = -d;
+	if (d<0) rv = -rv;
+	return(rv);
+}
+
+
+/*  Cut value of a tree edge
+ *  ------------------------
+ *  The cut values of the tree edges below f must be known.
+ */
+
+#ifdef ANSI_C
+static void x_cutval(int f)
+#else
+static void x_cutval(f)
+int	f;
+#endif
+{
+	int	v, dir, i;
+	long	sum;
+
+	if (ns_c[ns_e[f].tail].par==f) { v = ns_e[f].tail; dir = 1;  }
+	else				{ v = ns_e[f].head; dir = -1; }
+
+	sum = 0L;
+	for (i=0; i<ns_c[v].deg; i++)
+		sum += x_val(ns_adj[ns_c[v].adj+i], v, dir);
+	ns_e[f].cut = sum;
+}
+
+
+/*  Initial cut values
+ *  ------------------
+ *  The tree is numbered in postorder, thus the cut values can be
+ *  calculated bottom up in the order of lim.
+ */
+
+#ifdef ANSI_C
+static void init_cutvalues(void)
+#else
+static void init_cutvalues()
+#endif
+{
+	int	i, lim;
+
+	for (i=0; i<ns_ncls; i++) ns_c[i].lim = -1;
+	lim = 0;
+	for (i=0; i<ns_ncls; i++) {
+		if (ns_c[i].lim<0) lim = dfs_range(i,-1,lim);
+	}
+	for (i=0; i<ns_ncls; i++) {
+		if (ns_c[ns_order[i]].par>=0) x_cutval(ns_c[ns_order[i]].par);
+	}
+	ns_search = 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Simplex iteration                                                 */
+/*--------------------------------------------------------------------*/
+
+/*  Leaving edge
+ *  ------------
+ *  returns a tree edge with negative cut value, or -1 if the solution
+ *  is optimal. We take the most negative of the next SEARCHSIZE
+ *  candidates, and continue the search there the next time.
+ */
+
+#ifdef ANSI_C
+static int leave_edge(void)
+#else
+static int leave_edge()
+#endif
+{
+	int	f, rv, j, cnt;
+
+	rv  = -1;
+	cnt = 0;
+	j   = ns_search;
+	while (ns_search<ns_ntree) {
+		f = ns_tree[ns_search];
+		if (ns_e[f].cut<0) {
+			if ((rv<0)||(ns_e[rv].cut>ns_e[f].cut)) rv = f;
+			if (++cnt>=SEARCHSIZE) return(rv);
+		}
+		ns_search++;
+	}
+	if (j>0) {
+		ns_search = 0;
+		while (ns_search<j) {
+			f = ns_tree[ns_search];
+			if (ns_e[f].cut<0) {
+				if ((rv<0)||(ns_e[rv].cut>ns_e[f].cut)) rv = f;
+				if (++cnt>=SEARCHSIZE) return(rv);
+			}
+			ns_search++;
+		}
+	}
+	return(rv);
+}
+
+
+/*  Entering edge
+ *  -------------
+ *  Removing the tree edge f splits the tree into two components.
+ *  returns the non tree edge between the components with minimal
+ *  slack that goes in the same direction as f.
+ *  The lower component is the subtree of the endpoint with smaller
+ *  lim; its classes are ns_order[low..lim].
+ */
+
+#ifdef ANSI_C
+static int enter_edge(int f)
+#else
+static int enter_edge(f)
+int	f;
+#endif
+{
+	int	v, w, e, i, l, outsearch, best, bestslack;
+
+	if (ns_c[ns_e[f].tail].lim < ns_c[ns_e[f].head].lim) {
+		v = ns_e[f].tail;
+		outsearch = 0;
+	}
+	else {
+		v = ns_e[f].head;
+		outsearch = 1;
+	}
+
+	best = -1;
+	bestslack = 0;
+	for (l=ns_c[v].low; l<=ns_c[v].lim; l++) {
+		w = ns_order[l];
+		for (i=0; i<ns_c[w].deg; i++) {
+			e = ns_adj[ns_c[w].adj+i];
+			if (ns_e[e].tree>=0) continue;
+			if (outsearch) {
+				if (ns_e[e].tail!=w) continue;
+				if (INSUBTREE(v,ns_e[e].head)) continue;
+			}
+			else {
+				if (ns_e[e].head!=w) continue;
+				if (INSUBTREE(v,ns_e[e].tail)) continue;
+			}
+			if ((best<0)||(SLACK(e)<bestslack)) {
+				best = e;
+				bestslack = SLACK(e);
+			}
+		}
+	}
+	return(best);
+}
+
+
+/*  Update the cut values on a tree path
+ *  ------------------------------------
+ *  from v upwards to the common ancestor of v and w, which is returned.
+ */
+
+#ifdef ANSI_C
+static int tree_update(int v, int w, long cutvalue, int dir)
+#else
+static int tree_update(v, w, cutvalue, dir)
+int	v;
+int	w;
+long	cutvalue;
+int	dir;
+#endif
+{
+	int	e, d;
+
+	while (!INSUBTREE(v,w)) {
+		e = ns_c[v].par;
+		d = (v==ns_e[e].tail) ? dir : !dir;
+		if (d) ns_e[e].cut += cutvalue;
+		else   ns_e[e].cut -= cutvalue;
+		if (ns_c[ns_e[e].tail].lim > ns_c[ns_e[e].head].lim)
+			v = ns_e[e].tail;
+		else	v = ns_e[e].head;
+	}
+	return(v);
+}
+
+
+/*  Exchange the tree edge e by the non tree edge f
+ *  -----------------------------------------------
+ *  The lower component of e is shifted such that f becomes tight.
+ *  Then the cut values on the tree path between the endpoints of f
+ *  change, and the subtree of their common ancestor is renumbered.
+ */
+
+#ifdef ANSI_C
+static void update(int e, int f)
+#else
+static void update(e, f)
+int	e;
+int	f;
+#endif
+{
+	int	v, l, delta, lca;
+	long	cutvalue;
+
+	delta = SLACK(f);
+	if (delta>0) {
+		if (ns_c[ns_e[e].tail].lim < ns_c[ns_e[e].head].lim) {
+			v = ns_e[e].tail;
+			delta = -delta;
+		}
+		else	v = ns_e[e].head;
+		for (l=ns_c[v].low; l<=ns_c[v].lim; l++)
+			ns_c[ns_order[l]].rank += delta;
+	}
+
+	cutvalue = ns_e[e].cut;
+	lca = tree_update(ns_e[f].tail, ns_e[f].head, cutvalue, 1);
+	(void)tree_update(ns_e[f].head, ns_e[f].tail, cutvalue, 0);
+	ns_e[f].cut = -cutvalue;
+	ns_e[e].cut = 0L;
+
+	ns_e[f].tree = ns_e[e].tree;
+	ns_tree[ns_e[e].tree] = f;
+	ns_e[e].tree = -1;
+
+	(void)dfs_range(lca, ns_c[lca].par, ns_c[lca].low);
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Result                                                            */
+/*--------------------------------------------------------------------*/
+
+/*  Normalize the ranks
+ *  -------------------
+ *  The ranks of each connected component are shifted such that the
+ *  smallest level is 0. The component that contains the nodes with
+ *  fixed level is shifted such that these nodes get their level back.
+ *  If then a node gets a negative level, this component keeps the
+ *  levels of the DFS.
+ *  The components are the subtrees of the roots, i.e. the classes
+ *  ns_order[low..lim] of the roots.
+ */
+
+#ifdef ANSI_C
+static void normalize(void)
+#else
+static void normalize()
+#endif
+{
+	int	r, l, v, lowest, pinned;
+
+	for (r=0; r<ns_ncls; r++) {
+		if (ns_c[r].par>=0) continue;
+		pinned = (ns_pinned>=0) && INSUBTREE(r,ns_pinned);
+
+		lowest = MAXINT;
+		for (l=ns_c[r].low; l<=ns_c[r].lim; l++) {
+			v = ns_order[l];
+			if (ns_c[v].rank+ns_c[v].lo < lowest)
+				lowest = ns_c[v].rank+ns_c[v].lo;
+		}
+
+		if (!pinned) {
+			for (l=ns_c[r].low; l<=ns_c[r].lim; l++)
+				ns_c[ns_order[l]].rank -= lowest;
+		}
+		else if (lowest + ns_c[ns_pinned].init - ns_c[ns_pinned].rank >= 0) {
+			lowest = ns_c[ns_pinned].rank - ns_c[ns_pinned].init;
+			for (l=ns_c[r].low; l<=ns_c[r].lim; l++)
+				ns_c[ns_order[l]].rank -= lowest;
+		}
+		else {
+			for (l=ns_c[r].low; l<=ns_c[r].lim; l++) {
+				v = ns_order[l];
+				ns_c[v].rank = ns_c[v].init;
+			}
+		}
+	}
+}
@@ -0,0 +1,758 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         spatial.c                                          */
+/*   description:  Spatial index of the final layout for hit-testing  */
+/*                 and viewport queries                               */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * After the layout, the nodes and edges do not move anymore until the
+ * next relayout. Nevertheless, each redraw traversed all nodes and all
+ * edges, and the drawing primitives of drawlib.c found out one by one
+ * that most of them are outside the visible window. Selecting a node
+ * by the mouse (search_xy_node) traversed the whole nodelist, too.
+ *
+ * Here we keep a uniform grid over the layout co-ordinates (i.e. not
+ * scaled by G_stretch/G_shrink). There are two grids:
+ *
+ *   - the node grid contains the rectangles of the nodes of the
+ *     nodelist (class SP_NODE) and of the labellist (SP_LABEL).
+ *     The anchor nodes (SP_ANCHOR) draw lines to the node they belong
+ *     to, thus they are always drawn.
+ *   - the edge grid contains the three segments start - top bend -
+ *     bottom bend - end of each visible edge, enlarged by thickness
+ *     and arrow size. Edges with labels or anchors are always drawn.
+ *
+ * Each object gets a number in the order in which draw_nodes and
+ * draw_edges traverse the lists. A query returns the objects sorted by
+ * this number, thus the objects are drawn in the same order as before,
+ * and search_xy_node finds the same node as the linear search.
+ *
+ * The number of grid cells is about the number of pieces. Pieces that
+ * cover too many cells (e.g. very long edges) are not put into the
+ * cells but into a list of pieces that are always checked.
+ *
+ * The index is built after the layout (relayout in vcg_main.c) and is
+ * invalidated by free_all_lists. If it is not valid at a query, it is
+ * built at this time.
+ *
+ * This file provides the following functions:
+ *
+ * build_spatial_index		build the grids from the actual layout
+ * invalidate_spatial_index	the grids are not anymore valid
+ * window_culling		check whether the grids can be used
+ *				to draw the visible window
+ * window_nodes			nodes intersecting the visible window
+ * window_edges			edges intersecting the visible window
+ * spatial_xy_node		the node at a position (search_xy_node)
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "fisheye.h"
+#include "timing.h"
+#include "spatial.h"
+
+#undef DEBUG
+#undef debugmessage
+#ifdef DEBUG
+#define debugmessage(a,b) {FPRINTF(stderr,"Debug: %s %s\n",a,b);}
+#else
+#define debugmessage(a,b) /**/
+#endif
+
+
+/* Maximal number of cells of a grid, and maximal number of cells of a
+ * piece. Pieces covering more cells are always checked.
+ */
+
+#define SP_MAXCELLS  (1<<20)
+#define SP_MAXSPAN   64
+
+
+/* Types
+ * =====
+ */
+
+/* A piece is a rectangle of an object: a node or a segment of an edge.
+ */
+
+typedef struct sppiece {
+	long	x1, y1;		/* upper left corner  */
+	long	x2, y2;		/* lower right corner */
+	int	obj;		/* number of the object */
+	int	all;		/* 1, if found by each query */
+} SPPIECE;
+
+
+/* A grid: the entries of cell c are entry[start[c] .. start[c+1]-1].
+ */
+
+typedef struct spgrid {
+	SPPIECE	*piece;		/* the pieces                           */
+	int	npiece;		/* number of pieces                     */
+	int	maxpiece;	/* size of piece                        */
+	int	*start;		/* start of the entries of each cell    */
+	int	maxstart;	/* size of start                        */
+	int	*entry;		/* pieces of the cells                  */
+	int	maxentry;	/* size of entry                        */
+	int	*always;	/* pieces that are always checked       */
+	int	nalways;	/* number of always checked pieces      */
+	int	maxalways;	/* size of always                       */
+	int	*stamp;		/* last query that found the object     */
+	int	*hits;		/* objects found by the last query      */
+	int	nobj;		/* number of objects                    */
+	int	maxstamp;	/* size of stamp                        */
+	int	maxhits;	/* size of hits                         */
+	int	query;		/* number of the actual query           */
+	long	x0, y0;		/* upper left corner of the grid        */
+	long	cw, ch;		/* width and height of a cell           */
+	int	ncx, ncy;	/* number of cells in x and y direction */
+} SPGRID;
+
+
+/* Prototypes
+ * ==========
+ */
+
+static char	*sp_enlarge	_PP((char *p, int *size, int n, int elsize));
+static void	add_node	_PP((GNODE v, int cls));
+static void	add_edge	_PP((GEDGE e));
+static void	add_piece	_PP((SPGRID *g, long x1, long y1,
+				     long x2, long y2, int obj));
+static void	add_always	_PP((SPGRID *g, int obj));
+static void	cell_range	_PP((SPGRID *g, long x1, long y1, long x2,
+				     long y2, int *cx1, int *cy1,
+				     int *cx2, int *cy2));
+static void	build_grid	_PP((SPGRID *g, int nobj));
+static int	query_grid	_PP((SPGRID *g, long x1, long y1,
+				     long x2, long y2));
+static long	to_layout	_PP((double x));
+static int	compare_int	_PP((const int *a, const int *b));
+
+
+/* Global variables
+ * ================
+ */
+
+static int	spatial_valid = 0;	/* 1, if the grids belong to the layout */
+
+/* Number of builds of the index. Each new layout builds the index, thus
+ * a drawing of the graph stays valid as long as spatial_builds and the
+ * scaling do not change (used by the tile cache of wingraph).
+ */
+
+int	spatial_builds = 0;
+
+static SPGRID	node_grid;		/* grid of the node objects	*/
+static SPGRID	edge_grid;		/* grid of the edge objects	*/
+
+static GNODE	*sp_node     = NULL;	/* node objects			*/
+static char	*sp_cls      = NULL;	/* classes of the node objects	*/
+static int	sp_nnode     = 0;	/* number of node objects	*/
+static int	sp_maxnode   = 0;	/* size of sp_node		*/
+static int	sp_maxcls    = 0;	/* size of sp_cls		*/
+
+static GEDGE	*sp_edge     = NULL;	/* edge objects			*/
+static int	sp_nedge     = 0;	/* number of edge objects	*/
+static int	sp_maxedge   = 0;	/* size of sp_edge		*/
+
+static GNODE	*res_node    = NULL;	/* result of window_nodes	*/
+static char	*res_cls     = NULL;	/* classes of res_node		*/
+static GEDGE	*res_edge    = NULL;	/* result of window_edges	*/
+static int	res_maxnode  = 0;	/* size of res_node		*/
+static int	res_maxcls   = 0;	/* size of res_cls		*/
+static int	res_maxedge  = 0;	/* size of res_edge		*/
+
+
+/*--------------------------------------------------------------------*/
+/*  Building of the index                                             */
+/*--------------------------------------------------------------------*/
+
+/*  Enlarge an array
+ *  ----------------
+ *  such that it has at least n elements of size elsize. The old
+ *  contents are kept. size is the actual number of elements.
+ */
+
+#ifdef ANSI_C
+static char *sp_enlarge(char *p, int *size, int n, int elsize)
+#else
+static char *sp_enlarge(p, size, n, elsize)
+char	*p;
+int	*size;
+int	n;
+int	elsize;
+#endif
+{
+	if (n <= *size) return(p);
+	*size = n + n/2 + 256;
+	p = (char *)realloc(p, (size_t)(*size) * (size_t)elsize);
+	if (!p) Fatal_error("memory exhausted","");
+	return(p);
+}
+
+
+/*  Add a piece to a grid
+ *  ---------------------
+ */
+
+#ifdef ANSI_C
+static void add_piece(SPGRID *g, long x1, long y1, long x2, long y2, int obj)
+#else
+static void add_piece(g, x1, y1, x2, y2, obj)
+SPGRID	*g;
+long	x1, y1, x2, y2;
+int	obj;
+#endif
+{
+	SPPIECE *p;
+
+	g->piece = (SPPIECE *)sp_enlarge((char *)g->piece, &(g->maxpiece),
+				g->npiece+1, sizeof(SPPIECE));
+	p = &(g->piece[g->npiece++]);
+	if (x1 <= x2) { p->x1 = x1; p->x2 = x2; }
+	else	      { p->x1 = x2; p->x2 = x1; }
+	if (y1 <= y2) { p->y1 = y1; p->y2 = y2; }
+	else	      { p->y1 = y2; p->y2 = y1; }
+	p->obj = obj;
+	p->all = 0;
+}
+
+
+/*  Add an object that is found by each query
+ *  -----------------------------------------
+ */
+
+#ifdef ANSI_C
+static void add_always(SPGRID *g, int obj)
+#else
+static void add_always(g, obj)
+SPGRID	*g;
+int	obj;
+#endif
+{
+	add_piece(g, 0L, 0L, 0L, 0L, obj);
+	g->piece[g->npiece-1].all = 1;
+}
+
+
+/*  Add a node object
+ *  -----------------
+ */
+
+#ifdef ANSI_C
+static void add_node(GNODE v, int cls)
+#else
+static void add_node(v, cls)
+GNODE	v;
+int	cls;
+#endif
+{
+	sp_node = (GNODE *)sp_enlarge((char *)sp_node, &sp_maxnode,
+				sp_nnode+1, sizeof(GNODE));
+	sp_cls  = sp_enlarge(sp_cls, &sp_maxcls, sp_nnode+1, sizeof(char));
+	sp_node[sp_nnode] = v;
+	sp_cls[sp_nnode]  = (char)cls;
+	if (cls==SP_ANCHOR) add_always(&node_grid, sp_nnode);
+	else add_piece(&node_grid, NX(v)-1, NY(v)-1,
+		NX(v)+NWIDTH(v)+1, NY(v)+NHEIGHT(v)+1, sp_nnode);
+	sp_nnode++;
+}
+
+
+/*  Add an edge object
+ *  ------------------
+ *  The segments are enlarged by the thickness and the arrow size.
+ *  Edges with labels or with anchor lines draw outside of their
+ *  segments, thus they are always drawn.
+ */
+
+#ifdef ANSI_C
+static void add_edge(GEDGE e)
+#else
+static void add_edge(e)
+GEDGE	e;
+#endif
+{
+	long m;
+
+	switch (ELSTYLE(e)) {
+	case SOLID:
+	case DASHED:
+	case DOTTED: break;
+	default:     return;
+	}
+
+	sp_edge = (GEDGE *)sp_enlarge((char *)sp_edge, &sp_maxedge,
+				sp_nedge+1, sizeof(GEDGE));
+	sp_edge[sp_nedge] = e;
+
+	if (ELABEL(e) || (EANCHOR(e)==66)) {
+		add_always(&edge_grid, sp_nedge);
+		sp_nedge++;
+		return;
+	}
+	m = ETHICKNESS(e) + 2;
+	if (EARROWSIZE(e) > EARROWBSIZE(e)) m += EARROWSIZE(e);
+	else				    m += EARROWBSIZE(e);
+
+	add_piece(&edge_grid, ESTARTX(e), ESTARTY(e), ETBENDX(e), ETBENDY(e),
+		  sp_nedge);
+	add_piece(&edge_grid, ETBENDX(e), ETBENDY(e), EBBENDX(e), EBBENDY(e),
+		  sp_nedge);
+	add_piece(&edge_grid, EBBENDX(e), EBBENDY(e), EENDX(e), EENDY(e),
+		  sp_nedge);
+	edge_grid.piece[edge_grid.npiece-3].x1 -= m;
+	edge_grid.piece[edge_grid.npiece-3].y1 -= m;
+	edge_grid.piece[edge_grid.npiece-3].x2 += m;
+	edge_grid.piece[edge_grid.npiece-3].y2 += m;
+	edge_grid.piece[edge_grid.npiece-2].x1 -= m;
+	edge_grid.piece[edge_grid.npiece-2].y1 -= m;
+	edge_grid.piece[edge_grid.npiece-2].x2 += m;
+	edge_grid.piece[edge_grid.npiece-2].y2 += m;
+	edge_grid.piece[edge_grid.npiece-1].x1 -= m;
+	edge_grid.piece[edge_grid.npiece-1].y1 -= m;
+	edge_grid.piece[edge_grid.npiece-1].x2 += m;
+	edge_grid.piece[edge_grid.npiece-1].y2 += m;
+	sp_nedge++;
+}
+
+
+/*  Cells covered by a rectangle
+ *  ----------------------------
+ *  The range is clipped to the grid. If the rectangle is outside,
+ *  the range is empty (cx1>cx2 or cy1>cy2).
+ */
+
+#ifdef ANSI_C
+static void cell_range(SPGRID *g, long x1, long y1, long x2, long y2,
+		       int *cx1, int *cy1, int *cx2, int *cy2)
+#else
+static void cell_range(g, x1, y1, x2, y2, cx1, cy1, cx2, cy2)
+SPGRID	*g;
+long	x1, y1, x2, y2;
+int	*cx1, *cy1, *cx2, *cy2;
+#endif
+{
+	if (x1 < g->x0) x1 = g->x0;
+	if (y1 < g->y0) y1 = g->y0;
+	if (x2 < g->x0) { *cx1 = 1; *cx2 = 0; *cy1 = 1; *cy2 = 0; return; }
+	if (y2 < g->y0) { *cx1 = 1; *cx2 = 0; *cy1 = 1; *cy2 = 0; return; }
+	*cx1 = (int)((x1 - g->x0) / g->cw);
+	*cy1 = (int)((y1 - g->y0) / g->ch);
+	if ((x2 - g->x0) / g->cw >= g->ncx) *cx2 = g->ncx - 1;
+	else *cx2 = (int)((x2 - g->x0) / g->cw);
+	if ((y2 - g->y0) / g->ch >= g->ncy) *cy2 = g->ncy - 1;
+	else *cy2 = (int)((y2 - g->y0) / g->ch);
+}
+
+
+/*  Build the cells of a grid from its pieces
+ *  -----------------------------------------
+ *  The grid has about as many cells as pieces. The shape of the cells
+ *  follows the shape of the bounding box of all pieces.
+ */
+
+#ifdef ANSI_C
+static void build_grid(SPGRID *g, int nobj)
+#else
+static void build_grid(g, nobj)
+SPGRID	*g;
+int	nobj;
+#endif
+{
+	SPPIECE	*p;
+	long	x2, y2;
+	double	w, h, cells, nx;
+	int	i, c, cx, cy, cx1, cy1, cx2, cy2, ncells;
+
+	g->stamp = (int *)sp_enlarge((char *)g->stamp, &(g->maxstamp),
+				nobj+1, sizeof(int));
+	g->hits  = (int *)sp_enlarge((char *)g->hits, &(g->maxhits),
+				nobj+1, sizeof(int));
+	g->nobj = nobj;
+	for (i=0; i<nobj; i++) g->stamp[i] = 0;
+	g->query = 0;
+
+	g->ncx = g->ncy = 0;
+	g->nalways = 0;
+	for (i=0; i<g->npiece; i++) if (!g->piece[i].all) break;
+	if (i==g->npiece) {
+		/* no cells, only always checked pieces */
+		for (i=0; i<g->npiece; i++) {
+			g->always = (int *)sp_enlarge((char *)g->always,
+				&(g->maxalways), g->nalways+1, sizeof(int));
+			g->always[g->nalways++] = i;
+		}
+		return;
+	}
+
+	g->x0 = x2 = g->piece[i].x1;
+	g->y0 = y2 = g->piece[i].y1;
+	for (i=0; i<g->npiece; i++) {
+		p = &(g->piece[i]);
+		if (p->all) continue;
+		if (p->x1 < g->x0) g->x0 = p->x1;
+		if (p->y1 < g->y0) g->y0 = p->y1;
+		if (p->x2 > x2)    x2    = p->x2;
+		if (p->y2 > y2)    y2    = p->y2;
+	}
+	w = (double)(x2 - g->x0) + 1.0;
+	h = (double)(y2 - g->y0) + 1.0;
+	cells = (double)g->npiece;
+	if (cells > (double)SP_MAXCELLS) cells = (double)SP_MAXCELLS;
+	nx = floor(sqrt(cells * w / h) + 0.5);
+	if (nx < 1.0)   nx = 1.0;
+	if (nx > cells) nx = cells;
+	g->cw = (long)ceil(w / nx);
+	g->ch = (long)ceil(h / floor(cells / nx));
+	if (g->cw < 1) g->cw = 1;
+	if (g->ch < 1) g->ch = 1;
+	g->ncx = (int)((x2 - g->x0) / g->cw) + 1;
+	g->ncy = (int)((y2 - g->y0) / g->ch) + 1;
+	ncells = g->ncx * g->ncy;
+
+	g->start = (int *)sp_enlarge((char *)g->start, &(g->maxstart),
+				ncells+1, sizeof(int));
+	for (c=0; c<=ncells; c++) g->start[c] = 0;
+
+	/* count the entries of each cell; pieces that cover too many
+	 * cells go to the always checked pieces.
+	 */
+	for (i=0; i<g->npiece; i++) {
+		p = &(g->piece[i]);
+		cell_range(g, p->x1, p->y1, p->x2, p->y2, &cx1, &cy1, &cx2, &cy2);
+		if (p->all || ((cx2-cx1+1)*(cy2-cy1+1) > SP_MAXSPAN)) {
+			g->always = (int *)sp_enlarge((char *)g->always,
+				&(g->maxalways), g->nalways+1, sizeof(int));
+			g->always[g->nalways++] = i;
+			continue;
+		}
+		for (cy=cy1; cy<=cy2; cy++)
+			for (cx=cx1; cx<=cx2; cx++)
+				g->start[cy*g->ncx+cx+1]++;
+	}
+	for (c=0; c<ncells; c++) g->start[c+1] += g->start[c];
+
+	g->entry = (int *)sp_enlarge((char *)g->entry, &(g->maxentry),
+				g->start[ncells]+1, sizeof(int));
+	for (i=0; i<g->npiece; i++) {
+		p = &(g->piece[i]);
+		cell_range(g, p->x1, p->y1, p->x2, p->y2, &cx1, &cy1, &cx2, &cy2);
+		if (p->all || ((cx2-cx1+1)*(cy2-cy1+1) > SP_MAXSPAN)) continue;
+		for (cy=cy1; cy<=cy2; cy++)
+			for (cx=cx1; cx<=cx2; cx++)
+				g->entry[g->start[cy*g->ncx+cx]++] = i;
+	}
+	for (c=ncells; c>0; c--) g->start[c] = g->start[c-1];
+	g->start[0] = 0;
+}
+
+
+/*  Build the index
+ *  ===============
+ *  The objects are numbered in the order of draw_nodes and draw_edges.
+ */
+
+#define backward_connection1(c) ((CEDGE(c))&& (EEND(CEDGE(c)) ==v))
+#define backward_connection2(c) ((CEDGE2(c))&&(EEND(CEDGE2(c))==v))
+
+#ifdef ANSI_C
+void build_spatial_index(void)
+#else
+void build_spatial_index()
+#endif
+{
+	GNODE	v;
+	ADJEDGE	li;
+	CONNECT	c;
+	int	i;
+	GNODE	lists[3];
+
+	debugmessage("build_spatial_index","");
+	start_time();
+
+	sp_nnode = sp_nedge = 0;
+	node_grid.npiece = 0;
+	edge_grid.npiece = 0;
+
+	for (v = nodelist;  v; v = NNEXT(v)) add_node(v, SP_NODE);
+	for (v = labellist; v; v = NNEXT(v)) add_node(v, SP_LABEL);
+	for (v = dummylist; v; v = NNEXT(v))
+		if (NANCHORNODE(v)) add_node(v, SP_ANCHOR);
+
+	lists[0] = nodelist;
+	lists[1] = labellist;
+	lists[2] = dummylist;
+	for (i=0; i<3; i++) {
+		for (v = lists[i]; v; v = NNEXT(v)) {
+			c = NCONNECT(v);
+			if (c) {
+				if (backward_connection1(c)) add_edge(CEDGE(c));
+				if (backward_connection2(c)) add_edge(CEDGE2(c));
+			}
+			for (li = NPRED(v); li; li = ANEXT(li))
+				add_edge(AKANTE(li));
+		}
+	}
+
+	build_grid(&node_grid, sp_nnode);
+	build_grid(&edge_grid, sp_nedge);
+
+	res_node = (GNODE *)sp_enlarge((char *)res_node, &res_maxnode,
+				sp_nnode+1, sizeof(GNODE));
+	res_cls  = sp_enlarge(res_cls, &res_maxcls, sp_nnode+1, sizeof(char));
+	res_edge = (GEDGE *)sp_enlarge((char *)res_edge, &res_maxedge,
+				sp_nedge+1, sizeof(GEDGE));
+
+	spatial_valid = 1;
+	spatial_builds++;
+	stop_time("build_spatial_index");
+}
+
+
+/*  Invalidate the index
+ *  ====================
+ *  This is called if the nodes and edges are given free.
+ */
+
+#ifdef ANSI_C
+void invalidate_spatial_index(void)
+#else
+void invalidate_spatial_index()
+#endif
+{
+	spatial_valid = 0;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Queries                                                           */
+/*--------------------------------------------------------------------*/
+
+#ifdef ANSI_C
+static int compare_int(const int *a, const int *b)
+#else
+static int compare_int(a, b)
+int	*a;
+int	*b;
+#endif
+{
+	if (*a < *b) return(-1);
+	if (*a > *b) return(1);
+	return(0);
+}
+
+
+/*  Objects intersecting a rectangle
+ *  --------------------------------
+ *  are stored into g->hits, sorted by their number. The number of
+ *  objects is returned.
+ */
+
+#ifdef ANSI_C
+static int query_grid(SPGRID *g, long x1, long y1, long x2, long y2)
+#else
+static int query_grid(g, x1, y1, x2, y2)
+SPGRID	*g;
+long	x1, y1, x2, y2;
+#endif
+{
+	SPPIECE	*p;
+	int	i, k, n, cx, cy, cx1, cy1, cx2, cy2;
+
+	g->query++;
+	if (g->query <= 0) {
+		for (i=0; i<g->nobj; i++) g->stamp[i] = 0;
+		g->query = 1;
+	}
+	n = 0;
+	if (g->ncx==0) { cx1 = cy1 = 1; cx2 = cy2 = 0; }
+	else cell_range(g, x1, y1, x2, y2, &cx1, &cy1, &cx2, &cy2);
+	for (cy=cy1; cy<=cy2; cy++) {
+		for (cx=cx1; cx<=cx2; cx++) {
+			k = cy*g->ncx+cx;
+			for (i=g->start[k]; i<g->start[k+1]; i++) {
+				p = &(g->piece[g->entry[i]]);
+				if (g->stamp[p->obj]==g->query) continue;
+				if ((p->x2 < x1) || (p->x1 > x2)) continue;
+				if ((p->y2 < y1) || (p->y1 > y2)) continue;
+				g->stamp[p->obj] = g->query;
+				g->hits[n++] = p->obj;
+			}
+		}
+	}
+	for (i=0; i<g->nalways; i++) {
+		p = &(g->piece[g->always[i]]);
+		if (g->stamp[p->obj]==g->query) continue;
+		if (!p->all) {
+			if ((p->x2 < x1) || (p->x1 > x2)) continue;
+			if ((p->y2 < y1) || (p->y1 > y2)) continue;
+		}
+		g->stamp[p->obj] = g->query;
+		g->hits[n++] = p->obj;
+	}
+	if (n>1) qsort(g->hits, n, sizeof(int),
+		       (int (*) (const void *, const void *))compare_int);
+	return(n);
+}
+
+
+/*  Conversion of a scaled co-ordinate into layout co-ordinates
+ *  -----------------------------------------------------------
+ */
+
+#ifdef ANSI_C
+static long to_layout(double x)
+#else
+static long to_layout(x)
+double	x;
+#endif
+{
+	x = x * (double)G_shrink / (double)G_stretch;
+	if (x < -(double)(MAXLONG/4)) return(-MAXLONG/4);
+	if (x >  (double)(MAXLONG/4)) return(MAXLONG/4);
+	return((long)x);
+}
+
+
+/*  Check whether the index can be used for drawing
+ *  -----------------------------------------------
+ *  With fisheye views, the positions on the screen are not anymore
+ *  proportional to the co-ordinates. Splines follow the whole chain
+ *  of dummy nodes of an edge, thus with splines, the edges are not
+ *  culled (edges!=0).
+ */
+
+#ifdef ANSI_C
+int window_culling(int edges)
+#else
+int window_culling(edges)
+int	edges;
+#endif
+{
+	if (fisheye_view != 0) return(0);
+	if ((G_stretch <= 0) || (G_shrink <= 0)) return(0);
+	if (edges && G_spline) return(0);
+	if (!spatial_valid) build_spatial_index();
+	return(1);
+}
+
+
+/*  Nodes intersecting the visible window
+ *  =====================================
+ *  The window is V_xmin..V_xmax, V_ymin..V_ymax scaled by
+ *  G_stretch/G_shrink. The nodes are returned in res in the order
+ *  nodelist, labellist, anchor nodes of the dummylist, and their
+ *  classes in cls. The number of nodes is returned.
+ */
+
+#ifdef ANSI_C
+int window_nodes(GNODE **res, char **cls)
+#else
+int window_nodes(res, cls)
+GNODE	**res;
+char	**cls;
+#endif
+{
+	long	d;
+	int	i, n;
+
+	d = G_shrink/G_stretch + 2;
+	n = query_grid(&node_grid,
+		to_layout((double)V_xmin) - d, to_layout((double)V_ymin) - d,
+		to_layout((double)V_xmax) + d, to_layout((double)V_ymax) + d);
+	for (i=0; i<n; i++) {
+		res_node[i] = sp_node[node_grid.hits[i]];
+		res_cls[i]  = sp_cls[node_grid.hits[i]];
+	}
+	*res = res_node;
+	*cls = res_cls;
+	return(n);
+}
+
+
+/*  Edges intersecting the visible window
+ *  =====================================
+ *  in the order of draw_edges. The number of edges is returned.
+ */
+
+#ifdef ANSI_C
+int window_edges(GEDGE **res)
+#else
+int window_edges(res)
+GEDGE	**res;
+#endif
+{
+	long	d;
+	int	i, n;
+
+	d = G_shrink/G_stretch + 2;
+	n = query_grid(&edge_grid,
+		to_layout((double)V_xmin) - d, to_layout((double)V_ymin) - d,
+		to_layout((double)V_xmax) + d, to_layout((double)V_ymax) + d);
+	for (i=0; i<n; i++) res_edge[i] = sp_edge[edge_grid.hits[i]];
+	*res = res_edge;
+	return(n);
+}
+
+
+/*  Search the node at a position
+ *  =============================
+ *  x and y are relative to the visible window, as in search_xy_node.
+ *  The candidates of the grid are checked by exactly the same test
+ *  as search_xy_node does, and the first node of the nodelist that
+ *  passes the test is returned, or NULL.
+ */
+
+#ifdef ANSI_C
+GNODE spatial_xy_node(long x,long y)
+#else
+GNODE spatial_xy_node(x,y)
+long	x,y;
+#endif
+{
+	GNODE	v;
+	int	i, n;
+	int	width, height;
+	long	xpos, ypos, d;
+
+	if (!spatial_valid) build_spatial_index();
+	d = G_shrink/G_stretch + 2;
+	n = query_grid(&node_grid,
+		to_layout((double)x + (double)V_xmin) - d,
+		to_layout((double)y + (double)V_ymin) - d,
+		to_layout((double)x + (double)V_xmin + 1.0) + d,
+		to_layout((double)y + (double)V_ymin + 1.0) + d);
+	for (i=0; i<n; i++) {
+		if (sp_cls[node_grid.hits[i]] != SP_NODE) break;
+		v = sp_node[node_grid.hits[i]];
+		xpos = (NX(v)*G_stretch)/G_shrink - V_xmin;
+		ypos = (NY(v)*G_stretch)/G_shrink - V_ymin;
+		width = (NWIDTH(v)*G_stretch)/G_shrink;
+		height = (NHEIGHT(v)*G_stretch)/G_shrink;
+		if ( (xpos <= x) && (x <= xpos+width) &&
+	     	     (ypos <= y) && (y <= ypos+height) )
+		    	return(v);      /* node found */
+	}
+	return(NULL);		/* no node found */
+}
+
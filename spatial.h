@@ -0,0 +1,54 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         spatial.h                                          */
+/*   description:  Spatial index of the final layout                  */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+/*--------------------------------------------------------------------*/
+
+/* Classes of the node objects of the index, in drawing order
+ * ----------------------------------------------------------
+ */
+
+#define SP_NODE    0	/* node of the nodelist         */
+#define SP_LABEL   1	/* label node of the labellist  */
+#define SP_ANCHOR  2	/* anchor node of the dummylist */
+
+
+/* Number of builds of the index, i.e. of layouts
+ * -----------------------------------------------
+ */
+
+extern int spatial_builds;
+
+
+/* Prototypes
+ * ----------
+ * See spatial.c for more information.
+ */
+
+void	build_spatial_index	 _PP((void));
+void	invalidate_spatial_index _PP((void));
+int	window_culling		 _PP((int edges));
+int	window_nodes		 _PP((GNODE **res, char **cls));
+int	window_edges		 _PP((GEDGE **res));
+GNODE	spatial_xy_node		 _PP((long x,long y));
+
+/*--------------------------------------------------------------------*/
+
+#endif /* SPATIAL_H */
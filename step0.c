@@ -177,11 +177,12 @@ static void   one_edge_attribute
 static int    get_color		_PP((yysyntaxtree node));
 static int    get_yesno         _PP((yysyntaxtree node));
 static void   calc_nr_classes	_PP((yysyntaxtree x));
-static GNODE  search_node	_PP((yysyntaxtree x,char *s));
+static GNODE  search_node	_PP((yysyntaxtree x,long id));
 static void   check_node	_PP((yysyntaxtree x,GNODE m));
 static void   init_hashtable	_PP((void));
-static int    hashval		_PP((char *s));
+static long   hashval		_PP((GNODE x));
 static void   insert_hashnode	_PP((GNODE x));
+static GNODE  lookup_hashid	_PP((long id));
 
 
 #ifdef CHECKNODE
@@ -308,37 +309,6 @@ void	step0_main()
 
 
 
-/*--------------------------------------------------------------------*/
-
-/* Check number of necessary nodes
- * ===============================
- * The result is in numnodes. We traverse the syntax tree and look
- * for T_Co_graph and T_Co_node parts.
- */
-
-static int numnodes;    /* Number of necessary nodes */
-
-#ifdef ANSI_C
-static void estimate_num_nodes(yysyntaxtree x)
-#else
-static void estimate_num_nodes(x)
-yysyntaxtree x;
-#endif
-{
-        register int j,len;
-
-        if (!x) return;
-        len = nr_of_sons(x);
-
-	if (tag(x)==T_Co_graph) numnodes++;
-        else if (tag(x)==T_Co_node)  numnodes++; 
-
-        for (j=1; j<=len; j++) {
-                estimate_num_nodes(son(x,j));
-        }
-}
-
-
 /*--------------------------------------------------------------------*/
 
 /*  Node analysis per subgraph
@@ -1366,7 +1336,8 @@ int	*borderc_set;	/* flag if borderc was set     */
 
 	switch(tag(node2)) {
 	case T_Co_title:
-		NTITLE(v) = SDecode(son1(node2));
+		NTITLE(v)   = SDecode(son1(node2));
+		NTITLEID(v) = get_lnum(son1(node2));
 	    	break;
 	case T_Co_label:
 		NLABEL(v) = SDecode(son1(node2));
@@ -1542,10 +1513,10 @@ int	*barrowc_set;	/* flag if back arrow color was set */
 
 	switch(tag(node2)) {
 	case T_Co_sourcename:
-		ESTART(e) = search_node(node2,SDecode(son1(node2)));
+		ESTART(e) = search_node(node2,get_lnum(son1(node2)));
 		break;
 	case T_Co_targetname:
-		EEND(e)   = search_node(node2,SDecode(son1(node2)));
+		EEND(e)   = search_node(node2,get_lnum(son1(node2)));
 		break;
 	case T_Co_linestyle:
 		switch(tag(son1(node2))) {
@@ -1845,18 +1816,18 @@ static char buffer[1024];      /* Buffer to create error messages */
  */          	
 
 #ifdef ANSI_C
-static GNODE search_node(yysyntaxtree x,char *title)
+static GNODE search_node(yysyntaxtree x,long id)
 #else
-static GNODE search_node(x,title)
+static GNODE search_node(x,id)
 yysyntaxtree x;
-char *title;
+long id;
 #endif
 {
 	GNODE n;
-	debugmessage("search_node",(title?title:"(null)"));
-	n = lookup_hashnode(title);
+	debugmessage("search_node",Decode(id));
+	n = lookup_hashid(id);
 	if (n==NULL) {
-		SPRINTF(buffer,"Undefined node %s",title);
+		SPRINTF(buffer,"Undefined node %s",Decode(id));
 		SYERR(x,buffer);
 	}
         return(n);
@@ -1910,7 +1881,7 @@ GNODE m;
 	title = NTITLE(m);
 	debugmessage("check_node",(title?title:"(null)"));
 	if (title && (!fastflag)) {
-		n = lookup_hashnode(title);
+		n = lookup_hashid(hashval(m));
 		if (n!=NULL) {
 			SPRINTF(buffer,"Double defined node %s",title);
 			SYERR(x,buffer);
@@ -1929,23 +1900,23 @@ GNODE m;
  *  misuse the NINTERN field of nodes.
  *  The hash table is an array whose entries are lists of GNODE
  *  objects, linked by the NINTERN field. 
- *  The are hashed with respect to the title.
- */
-
-/* The size of the hashtable maxhashtable should be a prime number. 
- * Good candidates are: 101, 211, 307, 503, 1013, 1511, 2003, 3001, 5003, ...  
+ *  The scanner has already interned all strings of the specification,
+ *  i.e. each title has a unique number (see HashInsert). This number
+ *  is used as index into the table, thus we never hash or compare 
+ *  the title strings of nodes again.
  */
 
 
 /*  The hash table 
  */
 
-static int maxhashtable = 211;
+static long maxhashtable = 0;
 static GNODE *hashtable = 0;
 
 
 /*  Initialization of the Hashtable
  *  -------------------------------
+ *  The table has one entry for each string of the specification.
  */ 
 
 #ifdef ANSI_C
@@ -1954,26 +1925,17 @@ static void init_hashtable(void)
 static void init_hashtable()
 #endif
 {
-	int i;
-	if (!hashtable) {
-		numnodes = 0;
-		estimate_num_nodes(Syntax_Tree);
-
-		if (numnodes>30000)      maxhashtable = 32003; 
-		else if (numnodes>25000) maxhashtable = 30011; 
-		else if (numnodes>20000) maxhashtable = 25013; 
-		else if (numnodes>15000) maxhashtable = 20011; 
-		else if (numnodes>10000) maxhashtable = 15013; 
-		else if (numnodes>7500)  maxhashtable = 10007;
-		else if (numnodes>5000)  maxhashtable = 7507;
-		else if (numnodes>2000)  maxhashtable = 5003;
-		else maxhashtable = 2003;
+	long i, size;
+
+	size = HashTableSize() + 1L;
+	if (size > maxhashtable) {
+		if (hashtable) free(hashtable);
+		maxhashtable = size;
 		hashtable = (GNODE *)malloc(maxhashtable*sizeof(GNODE));
 		if (!hashtable) {
 			Fatal_error("memory exhausted","");
 		}
 #ifdef DEBUG
-		PRINTF("Number of detected nodes: %d\n", numnodes);
                	PRINTF("Sizeof tables `hashtable': %ld Bytes\n",
                         (maxhashtable)*sizeof(GNODE));
 #endif
@@ -1984,25 +1946,40 @@ static void init_hashtable()
 
 /*  Hashvalue calculation.
  *  ---------------------
- *  The get an useful dispersion, we add for each character 101 and
- *  the ASCII value of the character.  
- *  The hashvalue is between 0 and maxhashtable-1.
+ *  The hashvalue of a node is the number of its title string.
+ *  This number is already known if the title comes from the 
+ *  specification. Otherwise (e.g. the default title of graph
+ *  summary nodes), the title is interned now. 
+ *  If necessary, the table is enlarged.
  */
 
 #ifdef ANSI_C
-static int hashval(char *s)
+static long hashval(GNODE x)
 #else
-static int hashval(s)
-char *s;
+static long hashval(x)
+GNODE x;
 #endif
 {
-	register int res;
+	long i, id, size;
+	GNODE *h;
 
-	assert((s));
-	res = 0;
-	while (*s) { res = (10 * res + *s + 101) % maxhashtable; s++; }
-	if (res<0) res = -res;
-	return(res % maxhashtable);
+	assert((x) && (NTITLE(x)));
+	id = NTITLEID(x);
+	if ((id<0) || (Decode(id)!=NTITLE(x))) {
+		id = NTITLEID(x) = HashInsert(NTITLE(x));
+	}
+	if (id >= maxhashtable) {
+		size = 2L * maxhashtable;
+		if (size <= id) size = id + 1L;
+		h = (GNODE *)realloc(hashtable, size*sizeof(GNODE));
+		if (!h) {
+			Fatal_error("memory exhausted","");
+		}
+		for (i=maxhashtable; i<size; i++) h[i] = NULL;
+		hashtable    = h;
+		maxhashtable = size;
+	}
+	return(id);
 }
 
 /*  Insert a node into the hash table.
@@ -2022,7 +1999,7 @@ GNODE x;
 #endif
 {
 	char *title;
-	int val;
+	long val;
 
 	assert((x));
 	title = NTITLE(x);
@@ -2031,7 +2008,7 @@ GNODE x;
 		FPRINTF(stderr,"Missing title of a node");
 		return;
 	}
-	val = hashval(title);
+	val = hashval(x);
 	assert((NINTERN(x)==NULL));
 	NINTERN(x) = hashtable[val];		
 	hashtable[val] = x;
@@ -2039,9 +2016,22 @@ GNODE x;
 
 /*  Lookup in the hash table
  *  ------------------------
- *  returns the first node that has the title, or NULL.
+ *  lookup_hashid returns the first node whose title has the number id, 
+ *  lookup_hashnode the first node that has the title, or NULL.
  */
 
+#ifdef ANSI_C
+static GNODE lookup_hashid(long id)
+#else
+static GNODE lookup_hashid(id)
+long id;
+#endif
+{
+	if ((id<0) || (id>=maxhashtable)) return(NULL);
+	return(hashtable[id]);
+}
+
+
 #ifdef ANSI_C
 GNODE lookup_hashnode(char *title)
 #else
@@ -2049,16 +2039,9 @@ GNODE lookup_hashnode(title)
 char *title;
 #endif
 {
-	GNODE h;
-
 	debugmessage("lookup_hashnode",(title?title:"(null)"));
-	h = hashtable[hashval(title)];
-	while (h) {
-                if (title==NTITLE(h)) return(h);
-                if (strcmp(title,NTITLE(h))==0) return(h);
-		h = NINTERN(h);
-	}
-	return(NULL);	
+	if (!title) return(NULL);
+	return(lookup_hashid(HashLookup(title)));
 }
 
 
@@ -63,7 +63,7 @@ static void gs_ide30 _PP((GNODE node)); static void gs_ide28 _PP((GNODE node));
 8 _PP((/N;D+ node));;*/ static void gs_ide35 _PP((void)); static void gs_ide34 _PP((GEDGE edge)); /*;/+D/+ edge));
 ;*/ static void gs_ide29 _PP((void)); static void gs_ide27 _PP((void)); static int gs_ide8 _PP((GNODE v,GNODE w,GNODE z)); /*;void gs_ide30 _PP((/N;D+ node));
 _ide28 _PP((/N;D+ node));;*/ static void gs_ide33 _PP((void)); static void gs_ide20 _PP((GNODE node)); /*;_PP((void));
-D/+ edge));;*/ static void gs_ide5 _PP((GNODE node)); static void gs_ide43 _PP((ADJEDGE edge,GNODE node,int prio)); /*;static void gs_ide29 _PP((void));
+D/+ edge));;*/ static void gs_ide5 _PP((GNODE node)); /*;static void gs_ide29 _PP((void));
 void gs_ide27 _PP((void));;*/ static void gs_ide46 _PP((void)); static void gs_ide4 _PP((GNODE v)); /*;_PP((void));
 ;D+ node));;*/  static GNODE gs_ide24 _PP((void)); static int gs_ide49 _PP((GNODE node1,GNODE node2)); /*;;D+ node));
 ));;*/ static void gs_ide50 _PP((GNODE node1,GNODE node2,int l)); static void gs_ide47 _PP((GNODE node1,GNODE node2)); /*;atic void gs_ide43 _PP((ADJ+D/+ edge,/N
@@ -91,8 +91,8 @@ void step1_main()
 #endif
 { int i; start_time(); ; assert((dummylist==NULL)); prepare_back_edges(); /*;void step1_main()
 {;*/ gs_ide35 (); insert_anchor_edges(); gs_ide29 (); gs_ide27 (); if (layout_flag==3) gs_ide46 (); /*;(dummylist==NULL));
-dges();;*/ else if (layout_flag==0) gs_ide37 (); else gs_ide33 (); if (edge_label_phase == 1) gs_ide2 (); /*;anchor_edges();
-gs_ide29 ();;*/ if (fine_tune_layout==1) gs_ide52 (); if (maxdepth+2 > gs_ide42 ) { if (layer) free(layer); /*;g==3) gs_ide46 ();
+dges();;*/ else if (layout_flag==0) gs_ide37 (); else gs_ide33 (); if ((layer_ranking==1)&&(layout_flag!=TREE_LAYOUT)) simplex_ranking(); if (edge_label_phase == 1) gs_ide2 (); /*;anchor_edges();
+gs_ide29 ();;*/ if ((fine_tune_layout==1)&&(layer_ranking==0)) gs_ide52 (); if (maxdepth+2 > gs_ide42 ) { if (layer) free(layer); /*;g==3) gs_ide46 ();
 =0) gs_ide37 ();;*/ layer = (DEPTH *)malloc((maxdepth+2)*sizeof(struct depth_entry)); if (!layer) Fatal_error("memory exhausted",""); /*;else gs_ide33 ();
 e_label_phase == 1) gs_ide2 ();;*/ gs_ide42 = maxdepth+2;
 #ifdef DEBUG
@@ -456,78 +456,253 @@ node = labellist; while (node) { if ( !(( node )->markiert) /*;0 (node);
 ;*/ ) assert((0)); node = (( node )->next) /*;};*/ ; }
 #endif
 }
+/*  Stack of the depth first searches
+ *  ---------------------------------
+ *  The depth first searches of this file were recursions along the
+ *  edges, that overflow the C stack on long chains of nodes. Now, they
+ *  keep their own stack of frames. A frame remembers the state of the
+ *  search at a node: the son visited from here, the actual edge and
+ *  what to visit next. Searches may be nested (gs_ide7 is called
+ *  while the search of gs_ide41 is active), thus the frames are 
+ *  addressed by their index and each search uses the part of the
+ *  stack above the frames that exist at its start. 
+ *  dfs_edges is a second stack for the edges of the actual pass of
+ *  a backwards search. 
+ */
+
+typedef struct dfs_frame {
+	GNODE	node;		/* the node of this frame                 */
+	GNODE	son;		/* the node visited from here, or NULL    */
+	ADJEDGE	edge;		/* the actual edge                        */
+	int	state;		/* what to visit next                     */
+	int	priority;	/* priority of the edges of the pass      */
+	long	elo;		/* first entry of the pass in dfs_edges   */
+	long	epos;		/* actual entry of the pass in dfs_edges  */
+} *DFSFRAME;
+
+static DFSFRAME dfs_stack     = NULL;
+static long     dfs_stacksize = 0L;
+static long     dfs_top       = 0L;
+
+static ADJEDGE *dfs_edges     = NULL;
+static long     dfs_edgesize  = 0L;
+static long     dfs_etop      = 0L;
+
+
+/*  Push a frame for node
+ *  ---------------------
+ */
+
 #ifdef ANSI_C
-static void gs_ide20 (GNODE node)
+static void dfs_push(GNODE node)
 #else
-static void gs_ide20 (node) GNODE node;
-#endif
-{ GNODE kn; ADJEDGE edge; int priority; assert((node)); ; if ((( node )->markiert) /*;
-{;*/ ) return; (( node )->markiert) /*;n;;*/ = 1; (( node )->dfsnum) /*;
-ADJ+D/+ edge;;*/ = gs_ide0 ++; if ((( node )->level) /*;ority;;*/ >=0) gs_ide1 = (( node )->level) /*;
-ority;;*/ ; (( node )->tiefe) /*;;;*/ = gs_ide1 ; maxdepth = (gs_ide1 >maxdepth) ? gs_ide1 : maxdepth; /*;;
-node )->markiert) /+;R/SC;yy+NT ) retur;*/ if ((( node )->connection) /*;node )->markiert) /+;R/SC;yy+NT ) retur;
-*/ ) { if ((( (( node )->connection) /*;kiert) /+;R/SC;yy+NT = 1;;*/ )->target) /*;
-kiert) /+;R/SC;yy+NT = 1;;*/ )  gs_ide20 ((( (( node )->connection) /*;
-;R/SC;yy+NT = gs_ide0 ++;;*/ )->target) /*;;R/SC;yy+NT = gs_ide0 ++;
-;*/ ); if ((( (( node )->connection) /*;C;yy+NT >=0) gs_ide1 = (( node )->level;
-*/ )->target2) /*;C;yy+NT >=0) gs_ide1 = (( node )->level;*/ )  gs_ide20 ((( (( node )->connection) /*;
-s_ide1 ;;*/ )->target2) /*;s_ide1 ;;*/ ); } priority = 1; while (priority>-1) { /*;->connection) /+;R/SC;yy+NT )->target)
->connection) /+;R/SC;yy+NT )->target) /;*/ priority = -1; edge = (( node )->succ) /*;/+;R/SC;yy+NT )->target2) /+;
-R/SC;yy+NT;*/ ; while (edge) { assert((((( (( edge )->kante) /*;};*/ )->start) /*;
-};*/ ) /*;};*/ ==node)); kn = ((( (( edge )->kante) /*;y = 1;;*/ )->end) /*;
-y = 1;;*/ ) /*;y = 1;;*/ ; if ((!(( kn )->markiert) /*;y>-1) {;*/ ) && ((( (( edge )->kante) /*;
-y>-1) {;*/ )->priority) /*;y>-1) {;*/ >priority))  priority = (( (( edge )->kante) /*;
-priority = -1;;*/ )->priority) /*;priority = -1;;*/ ; edge = (( edge )->next) /*;
-(( node )->succ) /+;R/SC;yy+NT ;;*/ ; } if (priority== -1) break; edge = (( node )->succ) /*;
-+;R/SC;yy+NT )->end) /+;R/SC;yy+NT ) /+;*/ ; while (edge) { if ((( (( edge )->kante) /*;
-iority = (( (( edge )->kante) /+;R/SC;y;*/ )->priority) /*;iority = (( (( edge )->kante) /+;
-R/SC;y;*/ !=priority) { edge = (( edge )->next) /*; edge )->next) /+;
-R/SC;yy+NT ;;*/ ; continue; } assert((((( (( edge )->kante) /*; )->succ) /+;
-R/SC;yy+NT ;;*/ )->start) /*; )->succ) /+;R/SC;yy+NT ;;*/ ) /*; )->succ) /+;
-R/SC;yy+NT ;;*/ ==node)); kn = ((( (( edge )->kante) /*;while (edge) {
-;*/ )->end) /*;while (edge) {;*/ ) /*;while (edge) {;*/ ; if ( !(( kn )->markiert) /*;
-(( edge )->kante) /+;R/SC;yy+NT )->prio;*/ ) { gs_ide1 ++; gs_ide20 (kn); /*;continue;
-};*/ gs_ide1 = (( node )->tiefe) /*;};*/ ; } else {  if (kn == node) ((( (( edge )->kante) /*;
-rt) /+;R/SC;yy+NT ) {;*/ )->kantenart) /*;rt) /+;R/SC;yy+NT ) {;*/ ) /*;
-rt) /+;R/SC;yy+NT ) {;*/ = 'S'; } edge = (( edge )->next) /*;0 (kn);
-;*/ ; } }  }
+static void dfs_push(node)
+GNODE node;
+#endif
+{
+	DFSFRAME f;
+
+	if (dfs_top >= dfs_stacksize) {
+		dfs_stacksize = (dfs_stacksize ? 2L*dfs_stacksize : 1024L);
+		f = (DFSFRAME)realloc(dfs_stack,
+				dfs_stacksize*sizeof(struct dfs_frame));
+		if (!f) Fatal_error("memory exhausted","");
+		dfs_stack = f;
+	}
+	f = &dfs_stack[dfs_top++];
+	f->node     = node;
+	f->son      = NULL;
+	f->edge     = NULL;
+	f->state    = 0;
+	f->priority = -1;
+	f->elo      = f->epos = dfs_etop;
+}
+
+
+/*  Push an edge onto dfs_edges
+ *  ---------------------------
+ */
+
 #ifdef ANSI_C
-static void gs_ide5 (GNODE node)
+static void dfs_push_edge(ADJEDGE edge)
+#else
+static void dfs_push_edge(edge)
+ADJEDGE edge;
+#endif
+{
+	ADJEDGE *h;
+
+	if (dfs_etop >= dfs_edgesize) {
+		dfs_edgesize = (dfs_edgesize ? 2L*dfs_edgesize : 1024L);
+		h = (ADJEDGE *)realloc(dfs_edges, dfs_edgesize*sizeof(ADJEDGE));
+		if (!h) Fatal_error("memory exhausted","");
+		dfs_edges = h;
+	}
+	dfs_edges[dfs_etop++] = edge;
+}
+
+
+/*  Depth first search for the depth of nodes
+ *  -----------------------------------------
+ *  Visit node: the depth gs_ide1 is increased for each edge of the
+ *  search. The targets of the connections of a node are visited first,
+ *  then the successors, in passes from the highest to the lowest 
+ *  priority of the edges. gs_ide20 visits the successors of each pass
+ *  in the order of the adjacency list, gs_ide5 in the reverse order.
+ */
+
+#ifdef ANSI_C
+static void dfs_visit(GNODE node)
 #else
-static void gs_ide5 (node) GNODE node;
-#endif
-{ GNODE kn; ADJEDGE edge; int priority; assert((node)); ; if ((( node )->markiert) /*;
-{;*/ ) return; (( node )->markiert) /*;n;;*/ = 1; (( node )->dfsnum) /*;
-ADJ+D/+ edge;;*/ = gs_ide0 ++; if ((( node )->level) /*;ority;;*/ >=0) gs_ide1 = (( node )->level) /*;
-ority;;*/ ; (( node )->tiefe) /*;;;*/ = gs_ide1 ; maxdepth = (gs_ide1 >maxdepth) ? gs_ide1 : maxdepth; /*;;
-node )->markiert) /+;R/SC;yy+NT ) retur;*/ if ((( node )->connection) /*;node )->markiert) /+;R/SC;yy+NT ) retur;
-*/ ) { if ((( (( node )->connection) /*;kiert) /+;R/SC;yy+NT = 1;;*/ )->target) /*;
-kiert) /+;R/SC;yy+NT = 1;;*/ )  gs_ide5 ((( (( node )->connection) /*;
-;R/SC;yy+NT = gs_ide0 ++;;*/ )->target) /*;;R/SC;yy+NT = gs_ide0 ++;
-;*/ ); if ((( (( node )->connection) /*;C;yy+NT >=0) gs_ide1 = (( node )->level;
-*/ )->target2) /*;C;yy+NT >=0) gs_ide1 = (( node )->level;*/ )  gs_ide5 ((( (( node )->connection) /*;
-s_ide1 ;;*/ )->target2) /*;s_ide1 ;;*/ ); } priority = 1; while (priority>-1) { /*;->connection) /+;R/SC;yy+NT )->target)
-connection) /+;R/SC;yy+NT )->target) /+;*/ priority = -1; edge = (( node )->succ) /*;/+;R/SC;yy+NT )->target2) /+;
-R/SC;yy+NT;*/ ; while (edge) { assert((((( (( edge )->kante) /*;};*/ )->start) /*;
-};*/ ) /*;};*/ ==node)); kn = ((( (( edge )->kante) /*;y = 1;;*/ )->end) /*;
-y = 1;;*/ ) /*;y = 1;;*/ ; if ((!(( kn )->markiert) /*;y>-1) {;*/ ) && ((( (( edge )->kante) /*;
-y>-1) {;*/ )->priority) /*;y>-1) {;*/ >priority))  priority = (( (( edge )->kante) /*;
-priority = -1;;*/ )->priority) /*;priority = -1;;*/ ; edge = (( edge )->next) /*;
-(( node )->succ) /+;R/SC;yy+NT ;;*/ ; } if (priority== -1) break; gs_ide43 ((( node )->succ) /*;
-+;R/SC;yy+NT )->end) /+;R/SC;yy+NT ) /+;*/ ,node,priority); } }
+static void dfs_visit(node)
+GNODE node;
+#endif
+{
+	NMARK(node) = 1;
+	NDFS(node)  = gs_ide0++;
+	if (NLEVEL(node)>=0) gs_ide1 = NLEVEL(node);
+	NTIEFE(node) = gs_ide1;
+	maxdepth = (gs_ide1>maxdepth) ? gs_ide1 : maxdepth;
+	dfs_push(node);
+}
+
 #ifdef ANSI_C
-static void gs_ide43 ( ADJEDGE edge, GNODE node, int priority)
+static void dfs_depth(GNODE node, int backwards)
 #else
-static void gs_ide43 (edge,node,priority) ADJEDGE edge; GNODE node; int priority; /*;ADJ+D/+ edge,
-ode,;*/
-#endif
-{ GNODE kn; ; if (!edge) return; gs_ide43 ((( edge )->next) /*;ode;;
-*/ ,node,priority); if ((( (( edge )->kante) /*;int priority;;*/ )->priority) /*;
-int priority;;*/ !=priority) return; kn = ((( (( edge )->kante) /*;{
-;*/ )->end) /*;{;*/ ) /*;{;*/ ; if ( !(( kn )->markiert) /*;n;;*/ ) { /*;;
-ge) return;;*/  gs_ide1 ++; gs_ide5 (kn); gs_ide1 = (( node )->tiefe) /*;dge )->next) /+;
-R/SC;yy+NT ,node,priori;*/ ; } else {  if (kn == node) ((( (( edge )->kante) /*;
-+NT ) {;*/ )->kantenart) /*;+NT ) {;*/ ) /*;+NT ) {;*/ = 'S'; } } static GNLIST gs_ide54 ; /*;e )->tiefe) /+;R/SC;yy+NT ;
+static void dfs_depth(node, backwards)
+GNODE node;
+int backwards;
+#endif
+{
+	DFSFRAME f;
+	GNODE kn;
+	ADJEDGE edge;
+	CONNECT c;
+	int priority;
+	long base;
+
+	assert((node));
+	if (NMARK(node)) return;
+
+	base = dfs_top;
+	dfs_visit(node);
+	while (dfs_top > base) {
+		f = &dfs_stack[dfs_top-1];
+		node = f->node;
+
+		/* back from the visit of a son of a pass */
+
+		if (f->son) {
+			f->son = NULL;
+			if (f->state==3) gs_ide1 = NTIEFE(node);
+		}
+
+		/* state 0 and 1: the targets of the connection */
+
+		kn = NULL;
+		c  = NCONNECT(node);
+		if (f->state==0) {
+			f->state = 1;
+			if (c) kn = CTARGET(c);
+		}
+		else if (f->state==1) {
+			f->state = 2;
+			if (c) kn = CTARGET2(c);
+		}
+		if (kn) {
+			f->son = kn;
+			if (!NMARK(kn)) dfs_visit(kn);
+			continue;
+		}
+		if (f->state<2) continue;
+
+		/* state 2: start a pass with the highest priority of the
+		 * edges to unvisited successors. 
+		 */
+
+		if (f->state==2) {
+			priority = -1;
+			edge = NSUCC(node);
+			while (edge) {
+				assert((ESTART(AKANTE(edge))==node));
+				kn = EEND(AKANTE(edge));
+				if ((!NMARK(kn)) && (EPRIO(AKANTE(edge))>priority))
+					priority = EPRIO(AKANTE(edge));
+				edge = ANEXT(edge);
+			}
+			if (priority == -1) {
+				dfs_top--;
+				continue;
+			}
+			f->priority = priority;
+			f->state    = 3;
+			if (backwards) {
+				f->elo = dfs_etop;
+				edge = NSUCC(node);
+				while (edge) {
+					dfs_push_edge(edge);
+					edge = ANEXT(edge);
+				}
+				f->epos = dfs_etop;
+			}
+			else f->edge = NSUCC(node);
+		}
+
+		/* state 3: the next successor of the pass */
+
+		kn = NULL;
+		while (1) {
+			if (backwards) {
+				if (f->epos <= f->elo) break;
+				edge = dfs_edges[--(f->epos)];
+			}
+			else {
+				if (!f->edge) break;
+				edge = f->edge;
+				f->edge = ANEXT(edge);
+			}
+			if (EPRIO(AKANTE(edge))!=f->priority) continue;
+			kn = EEND(AKANTE(edge));
+			if (!NMARK(kn)) break;
+			if (kn == node) EART(AKANTE(edge)) = 'S';
+			kn = NULL;
+		}
+		if (kn) {
+			gs_ide1++;
+			f->son = kn;
+			dfs_visit(kn);
+			continue;
+		}
+
+		/* end of the pass */
+
+		if (backwards) dfs_etop = f->elo;
+		f->state = 2;
+	}
+}
+
+
+#ifdef ANSI_C
+static void gs_ide20 (GNODE node)
+#else
+static void gs_ide20 (node)
+GNODE node;
+#endif
+{
+	dfs_depth(node, 0);
+}
+
+
+#ifdef ANSI_C
+static void gs_ide5 (GNODE node)
+#else
+static void gs_ide5 (node)
+GNODE node;
+#endif
+{
+	dfs_depth(node, 1);
+}
+static GNLIST gs_ide54 ; /*;e )->tiefe) /+;R/SC;yy+NT ;
 };*/   static GNLIST gs_ide53 ;
 #ifdef ANSI_C
 static void gs_ide4 (GNODE v)
@@ -683,101 +858,270 @@ PRINTF("\n");
 open_scc_list = NULL; mydfsnum = 0; gs_wait_message('p'); v = gs_ide23 (nlist); /*;= (( h )->next) /+;R/SC;yy+NT ;
 };*/ while (v) { gs_ide41 (v,&mydfsnum,&open_scc_list); v = gs_ide23 (nlist); /*;= NULL;
 mydfsnum = 0;;*/ } }
+/*  Depth first search for the strongly connected components
+ *  ---------------------------------------------------------
+ *  gs_ide41 visits all nodes reachable from node along the connections
+ *  and backwards along the predecessor edges, numbers them (NDFS) and
+ *  calculates the lowpoints (NLOWPT). NOPENSCC is set as long as a node
+ *  is in the list of open SCCs. When a node is the root of a SCC, the
+ *  SCC is closed by close_scc. The search uses the stack of frames
+ *  dfs_stack. close_scc may start a new search on the nodes of the
+ *  SCC (gs_ide7), on top of the actual frames.
+ */
+
+
+/*  Start the visit of a node: number it, open its SCC and push
+ *  a frame.
+ */
+
 #ifdef ANSI_C
-static void gs_ide41 (GNODE node, long *dfsnum, GNLIST *open_sccp)
+static void scc_visit(GNODE node, long *dfsnum, GNLIST *open_sccp)
 #else
-static void gs_ide41 (node, dfsnum, open_sccp) GNODE node; long *dfsnum; /*;nlist);
-};*/ GNLIST *open_sccp;
-#endif
-{ GNODE kn; GNLIST h; GNLIST closed_scc_list; ADJEDGE edge; int mylevel; /*;ccp;
-{;*/ GNODE actrev; int degree; int minindeg; int maxoutdeg; int maxpreindeg; /*;ADJ+D/+ edge;
-evel;;*/ int minlevel; assert((node)); ; if ((( node )->markiert) /*;int minindeg;
-;*/ ) return; (( node )->markiert) /*;outdeg;;*/ = 1; (( node )->weightp) /*;
-g;;*/ = 1L; (( node )->dfsnum) /*;int minlevel;;*/ = *dfsnum; (( node )->weights) /*;
-(node));;*/ = *dfsnum; (*dfsnum)++; gs_ide3 (node, open_sccp); if ((( node )->connection) /*;
-kiert) /+;R/SC;yy+NT = 1;;*/ ) { if ((( (( node )->connection) /*;+;
-R/SC;yy+NT = 1L;;*/ )->target) /*;+;R/SC;yy+NT = 1L;;*/ ) { kn = (( (( node )->connection) /*;
-y+NT = *dfsnum;;*/ )->target) /*;y+NT = *dfsnum;;*/ ; gs_ide41 (kn,dfsnum,open_sccp); /*; *dfsnum;
-dfsnum)++;;*/ if (((( kn )->weightp) /*;dfsnum)++;;*/ ) && ((( kn )->weights) /*;dfsnum)++;
-;*/ <(( node )->weights) /*;dfsnum)++;;*/ ))  (( node )->weights) /*;
-node, open_sccp);;*/ = (( kn )->weights) /*;node, open_sccp);;*/ ; } /*;ction) /+;R/SC;yy+NT )->target) /+;R/SC
-/+;R/SC;yy+NT )->target) /+;R/SC;yy+NT;*/  if ((( (( node )->connection) /*;ction) /+;R/SC;yy+NT )->target) /+;
-R/SC;*/ )->target2) /*;ction) /+;R/SC;yy+NT )->target) /+;R/SC;*/ ) { /*; /+;R/SC;yy+NT )->target) /+;R/SC;yy+NT
-gs_ide41 (kn,dfsnum,open_sccp);;*/  kn = (( (( node )->connection) /*; /+;R/SC;yy+NT )->target) /+;R/SC;
-yy+NT;*/ )->target2) /*; /+;R/SC;yy+NT )->target) /+;R/SC;yy+NT;*/ ; /*;gs_ide41 (kn,dfsnum,open_sccp);
-kn )->weightp) /+;R/SC;yy+NT ) && ((( ;*/  gs_ide41 (kn,dfsnum,open_sccp); if (((( kn )->weightp) /*; kn )->weightp) /+;
-R/SC;yy+NT ) && ((( ;*/ ) && ((( kn )->weights) /*; kn )->weightp) /+;
-R/SC;yy+NT ) && ((( ;*/ <(( node )->weights) /*; kn )->weightp) /+;R/SC;
-yy+NT ) && ((( ;*/ ))  (( node )->weights) /*;ghts) /+;R/SC;yy+NT = (( kn )->weights);
-*/ = (( kn )->weights) /*;ghts) /+;R/SC;yy+NT = (( kn )->weights);*/ ; /*;}
-(( node )->connection) /+;R/SC;yy+NT )-;*/  } } edge = (( node )->pred) /*;e )->connection) /+;R/SC;yy+NT )->targe;
-*/ ; while (edge) { assert((((( (( edge )->kante) /*;SC;yy+NT ) && ((( kn )->weights) /+;
-R/S;*/ )->end) /*;SC;yy+NT ) && ((( kn )->weights) /+;R/S;*/ ) /*;SC;
-yy+NT ) && ((( kn )->weights) /+;R/S;*/ ==node)); kn = ((( (( edge )->kante) /*;
-(( kn )->weights) /+;R/SC;yy+NT ;;*/ )->start) /*; (( kn )->weights) /+;
-R/SC;yy+NT ;;*/ ) /*; (( kn )->weights) /+;R/SC;yy+NT ;;*/ ; if ((( kn )->tiefe) /*;
-};*/ ==0) { gs_ide41 (kn,dfsnum,open_sccp); if (((( kn )->weightp) /*;
-(( node )->pred) /+;R/SC;yy+NT ;;*/ ) && ((( kn )->weights) /*;(( node )->pred) /+;
-R/SC;yy+NT ;;*/ <(( node )->weights) /*;(( node )->pred) /+;R/SC;yy+NT ;
-;*/ ))  (( node )->weights) /*;;*/ = (( kn )->weights) /*;;*/ ; } edge = (( edge )->next) /*;
-+;R/SC;yy+NT )->start) /+;R/SC;yy+NT ) ;*/ ; } if ((( node )->weights) /*;
-_ide41 (kn,dfsnum,open_sccp);;*/ == (( node )->dfsnum) /*;_ide41 (kn,dfsnum,open_sccp);
-;*/ ) { h = closed_scc_list = *open_sccp; assert((h)); kn = (( h )->node) /*;
-};*/ ; while (kn!=node) { (( kn )->weightp) /*;};*/ = 0L; h = (( h )->next) /*;
-node )->weights) /+;R/SC;yy+NT == (( no;*/ ; assert((h)); kn = (( h )->node) /*;
-assert((h));;*/ ; } assert((kn==node)); (( node )->weightp) /*;R/SC;
-yy+NT = 0L;;*/ = 0L; *open_sccp = (( h )->next) /*;+NT ;;*/ ; (( h )->next) /*;
-assert((h));;*/ = 0;
-#ifdef SCCDEBUG
-PRINTF("Test SCC:\n"); h = closed_scc_list; while (h) { kn = (( h )->node) /*;
-ghtp) /+;R/SC;yy+NT = 0L;;*/ ; PRINTF("[%ld|%s] ", kn,((( kn )->title) /*;
-next) /+;R/SC;yy+NT ;;*/ ?(( kn )->title) /*;next) /+;R/SC;yy+NT ;;*/ :"null")); /*;next) /+;R/SC;yy+NT ;
-= 0;;*/ h = (( h )->next) /*;= 0;;*/ ; }
-#endif
-minlevel = -1; h = closed_scc_list; while (h) { node = (( h )->node) /*;
-s]  , kn,((( kn )->title) /+;R/SC;yy+NT;*/ ; edge = (( node )->pred) /*;
-R/SC;yy+NT ;;*/ ; while (edge) { kn = ((( (( edge )->kante) /*;l = -1;
-;*/ )->start) /*;l = -1;;*/ ) /*;l = -1;;*/ ; mylevel = (( kn )->tiefe) /*;
-_list;;*/ ;  if (mylevel > minlevel) minlevel = mylevel; edge = (( edge )->next) /*;
-(( h )->node) /+;R/SC;yy+NT ;;*/ ; } h = (( h )->next) /*;while (edge) {
-;*/ ; }
+static void scc_visit(node, dfsnum, open_sccp)
+GNODE node;
+long *dfsnum;
+GNLIST *open_sccp;
+#endif
+{
+	NMARK(node)    = 1;
+	NOPENSCC(node) = 1L;
+	NDFS(node)     = *dfsnum;
+	NLOWPT(node)   = *dfsnum;
+	(*dfsnum)++;
+	gs_ide3(node, open_sccp);
+	dfs_push(node);
+}
+
+
+/*  Close the SCC of root node
+ *  --------------------------
+ *  The nodes of the SCC are the open nodes up to node. If the SCC is
+ *  a single node or needs no reversion, the nodes get their depth.
+ *  Otherwise, we revert the edges of one node of the SCC and analyze
+ *  the SCC again.
+ */
+
+#ifdef ANSI_C
+static void close_scc(GNODE node, GNLIST *open_sccp)
+#else
+static void close_scc(node, open_sccp)
+GNODE node;
+GNLIST *open_sccp;
+#endif
+{
+	GNODE kn;
+	GNLIST h;
+	GNLIST closed_scc_list;
+	ADJEDGE edge;
+	int mylevel;
+	GNODE actrev;
+	int degree;
+	int minindeg;
+	int maxoutdeg;
+	int maxpreindeg;
+	int minlevel;
+
+	h = closed_scc_list = *open_sccp;
+	assert((h));
+	kn = GNNODE(h);
+	while (kn!=node) {
+		NOPENSCC(kn) = 0L;
+		h = GNNEXT(h);
+		assert((h));
+		kn = GNNODE(h);
+	}
+	assert((kn==node));
+	NOPENSCC(node) = 0L;
+	*open_sccp = GNNEXT(h);
+	GNNEXT(h) = NULL;
+
 #ifdef SCCDEBUG
-PRINTF(" minlevel: %d\n",minlevel);
+	PRINTF("Test SCC:\n");
+	h = closed_scc_list;
+	while (h) {
+		kn = GNNODE(h);
+		PRINTF("[%ld|%s] ", kn,(NTITLE(kn)?NTITLE(kn):"null"));
+		h = GNNEXT(h);
+	}
 #endif
-assert((closed_scc_list)); degree = gs_ide12 (closed_scc_list); if (degree) { /*;}
-h )->next) /+;R/SC;yy+NT ;;*/
+
+	minlevel = -1;
+	h = closed_scc_list;
+	while (h) {
+		node = GNNODE(h);
+		edge = NPRED(node);
+		while (edge) {
+			kn = ESTART(AKANTE(edge));
+			mylevel = NTIEFE(kn);
+			if (mylevel > minlevel) minlevel = mylevel;
+			edge = ANEXT(edge);
+		}
+		h = GNNEXT(h);
+	}
+
 #ifdef SCCDEBUG
-PRINTF("Next complete SCC:\n");
+	PRINTF(" minlevel: %d\n",minlevel);
 #endif
-minlevel++; kn = gs_ide23 (&closed_scc_list); while (kn) { if ((( kn )->level) /*;
-osed_scc_list);;*/ >=0) (( kn )->tiefe) /*;osed_scc_list);;*/ = (( kn )->level) /*;
-osed_scc_list);;*/ ; else (( kn )->tiefe) /*;if (degree) {;*/ = minlevel; /*;if (degree) {
-Next complete SCC:zn );;*/ maxdepth = ((( kn )->tiefe) /*; Next complete SCC:zn );;*/ >maxdepth) ?  /*; Next complete SCC:zn );
-minlevel++;;*/ (( kn )->tiefe) /*;minlevel++;;*/ : maxdepth;
+
+	assert((closed_scc_list));
+	degree = gs_ide12(closed_scc_list);
+	if (degree) {
 #ifdef SCCDEBUG
-PRINTF("[%ld|%s] (%d) (max %d)\n", kn, ((( kn )->title) /*;while (kn) {
-;*/ ?(( kn )->title) /*;while (kn) {;*/ :"null"), (( kn )->tiefe) /*;
-kn )->level) /+;R/SC;yy+NT >=0) (( kn );*/ , maxdepth);
-#endif
-kn = gs_ide23 (&closed_scc_list); } return; } h = closed_scc_list; while (h) { /*;tiefe) /+;R/SC;yy+NT , maxdepth);
-closed_scc_list);;*/ (( (( h )->node) /*;closed_scc_list);;*/ )->tiefe) /*;closed_scc_list);
-;*/ = MAXINT; h = (( h )->next) /*;};*/ ; } actrev = (( closed_scc_list )->node) /*;
-};*/ ; minindeg = MAXINT; maxoutdeg = 0; maxpreindeg = 0; h = closed_scc_list; /*;xt) /+;R/SC;yy+NT ;
-};*/ while (h) { node = (( h )->node) /*;= (( closed_scc_list )->node) /+;
-R/SC;y;*/ ; degree = gs_ide39 (node, NULL, 1);  if (degree < minindeg) { /*;maxoutdeg = 0;
-ndeg = 0;;*/ minindeg = degree; actrev = node; h = (( h )->next) /*;while (h) {;*/ ; /*;while (h) {
-(( h )->node) /+;R/SC;yy+NT ;;*/ continue; } else if (degree > minindeg) { h = (( h )->next) /*;minindeg = degree;
-;*/ ; continue; } degree = gs_ide38 (node, NULL);  if (degree > maxoutdeg) { /*;}
-(degree > minindeg) {;*/ maxoutdeg = degree; actrev = node; h = (( h )->next) /*;continue;;*/ ; /*;}
-= gs_ide38 (node, NULL); ;*/  continue; } else if (degree < maxoutdeg) { h = (( h )->next) /*;maxoutdeg = degree;
-;*/ ; continue; } degree = gs_ide40 (node, NULL);  if (degree > maxpreindeg) { /*;}
-(degree < maxoutdeg) {;*/ maxpreindeg = degree; actrev = node; } h = (( h )->next) /*;};*/ ; }
+		PRINTF("Next complete SCC:\n");
+#endif
+		minlevel++;
+		kn = gs_ide23(&closed_scc_list);
+		while (kn) {
+			if (NLEVEL(kn)>=0) NTIEFE(kn) = NLEVEL(kn);
+			else NTIEFE(kn) = minlevel;
+			maxdepth = (NTIEFE(kn)>maxdepth) ? NTIEFE(kn) : maxdepth;
 #ifdef SCCDEBUG
-PRINTF("Revert Preds on [%d|%s] %d %d %d\n", actrev, ((( actrev )->title) /*;
-;*/ ?(( actrev )->title) /*;;*/ :"null"), minindeg, maxoutdeg, maxpreindeg); /*;actrev = node;
-};*/
+			PRINTF("[%ld|%s] (%d) (max %d)\n", kn,
+				(NTITLE(kn)?NTITLE(kn):"null"),
+				NTIEFE(kn), maxdepth);
+#endif
+			kn = gs_ide23(&closed_scc_list);
+		}
+		return;
+	}
+
+	h = closed_scc_list;
+	while (h) {
+		NTIEFE(GNNODE(h)) = MAXINT;
+		h = GNNEXT(h);
+	}
+
+	actrev = GNNODE(closed_scc_list);
+	minindeg = MAXINT;
+	maxoutdeg = 0;
+	maxpreindeg = 0;
+	h = closed_scc_list;
+	while (h) {
+		node = GNNODE(h);
+		degree = gs_ide39(node, NULL, 1);
+		if (degree < minindeg) {
+			minindeg = degree;
+			actrev = node;
+			h = GNNEXT(h);
+			continue;
+		}
+		else if (degree > minindeg) {
+			h = GNNEXT(h);
+			continue;
+		}
+		degree = gs_ide38(node, NULL);
+		if (degree > maxoutdeg) {
+			maxoutdeg = degree;
+			actrev = node;
+			h = GNNEXT(h);
+			continue;
+		}
+		else if (degree < maxoutdeg) {
+			h = GNNEXT(h);
+			continue;
+		}
+		degree = gs_ide40(node, NULL);
+		if (degree > maxpreindeg) {
+			maxpreindeg = degree;
+			actrev = node;
+		}
+		h = GNNEXT(h);
+	}
+
+#ifdef SCCDEBUG
+	PRINTF("Revert Preds on [%d|%s] %d %d %d\n", actrev,
+		(NTITLE(actrev)?NTITLE(actrev):"null"),
+		minindeg, maxoutdeg, maxpreindeg);
 #endif
-gs_ide36 (actrev, NULL); gs_ide7 (&closed_scc_list); } }
+
+	gs_ide36(actrev, NULL);
+	gs_ide7(&closed_scc_list);
+}
+
+
+/*  The search itself
+ *  -----------------
+ */
+
+#ifdef ANSI_C
+static void gs_ide41 (GNODE node, long *dfsnum, GNLIST *open_sccp)
+#else
+static void gs_ide41 (node, dfsnum, open_sccp)
+GNODE node;
+long *dfsnum;
+GNLIST *open_sccp;
+#endif
+{
+	DFSFRAME f;
+	GNODE kn;
+	CONNECT c;
+	long base;
+
+	assert((node));
+	if (NMARK(node)) return;
+
+	base = dfs_top;
+	scc_visit(node, dfsnum, open_sccp);
+	while (dfs_top > base) {
+		f = &dfs_stack[dfs_top-1];
+		node = f->node;
+
+		/* back from the visit of a son: update the lowpoint */
+
+		kn = f->son;
+		if (kn) {
+			f->son = NULL;
+			if (NOPENSCC(kn) && (NLOWPT(kn)<NLOWPT(node)))
+				NLOWPT(node) = NLOWPT(kn);
+			if (f->state==3) f->edge = ANEXT(f->edge);
+		}
+
+		/* look for the next son: state 0 is the connection target,
+		 * state 1 the second connection target, state 2 and 3 are
+		 * the predecessors that have no depth yet.
+		 */
+
+		kn = NULL;
+		c = NCONNECT(node);
+		switch (f->state) {
+		case 0:
+			f->state = 1;
+			if (c) kn = CTARGET(c);
+			break;
+		case 1:
+			f->state = 2;
+			if (c) kn = CTARGET2(c);
+			break;
+		case 2:
+			f->state = 3;
+			f->edge  = NPRED(node);
+			break;
+		}
+		if (f->state==3) {
+			while (f->edge) {
+				assert((EEND(AKANTE(f->edge))==node));
+				kn = ESTART(AKANTE(f->edge));
+				if (NTIEFE(kn)==0) break;
+				kn = NULL;
+				f->edge = ANEXT(f->edge);
+			}
+		}
+
+		if (kn) {
+			f->son = kn;
+			if (!NMARK(kn)) scc_visit(kn, dfsnum, open_sccp);
+			continue;
+		}
+		if (f->state==3) {
+
+			/* all sons visited */
+
+			dfs_top--;
+			if (NLOWPT(node) == NDFS(node))
+				close_scc(node, open_sccp);
+		}
+	}
+}
 #ifdef ANSI_C
 static int gs_ide12 (GNLIST nlist)
 #else
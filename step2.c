@@ -55,6 +55,7 @@ static char *gs_ide530 ="$Id: step2.c,v 3.12 1995/02/08 11:11:14 sander Exp $";
 #include "steps.h"
 #include "timelim.h"
 #include "timing.h"
+#include "profile.h"
 #undef CHECK_CROSSING  
 #ifndef ANSI_C
 #ifndef const
@@ -62,7 +63,7 @@ static char *gs_ide530 ="$Id: step2.c,v 3.12 1995/02/08 11:11:14 sander Exp $";
 #endif
 #endif
 #ifdef OWN_QUICKSORT
-#define quicksort_sort_array(x) { if (x) { gs_ide559  = 211; gs_ide549 (0,x-1);} }
+#define quicksort_sort_array(x) { if (x) ld_sort_bary(gs_ide577 ,x); }
 #else
 #ifdef ANSI_C
 #define quicksort_sort_array(x) { if (x) qsort(gs_ide577 ,x, 	   sizeof(GNODE),(int (*) (const void *, const void *))gs_ide514 ); }
@@ -103,9 +104,6 @@ c void gs_ide541 _PP((int i,int dir));;*/ static int gs_ide515 _PP((const GNODE
 int gs_ide515 _PP((const /N;D+ *a, cons;*/ static void gs_ide566 _PP((GNODE v,GNODE w)); static void gs_ide560 _PP((void)); /*;_ide518 _PP((D+PTH *l1, D+PTH *l2));
 _PP((void));;*/ static void gs_ide576 _PP((GNODE v)); static int gs_ide516 _PP((const GEDGE *a, const GEDGE *b)); /*;nt level, /N;D+ node));
 l, /N;D+ node));;*/   static int gs_ide517 _PP((const GEDGE *a, const GEDGE *b)); 
-#ifdef OWN_QUICKSORT
-static void gs_ide549 _PP((int l,int r)); static int gs_ide559 = 211;
-#endif
 static DEPTH *gs_ide580 =NULL;  static int gs_ide574 = 0;  int max_nodes_per_layer; /*;t /+D/+ *a, const /+D/+ *b)); 
 *a, const /+D/+ *b)); ;*/ int nr_crossings; static GNODE *gs_ide504 = NULL; static GEDGE *gs_ide505 = NULL; /*;gs_ide559 = 211;
 de580 =NULL; ;*/ static int gs_ide572 = 0; static GNODE *gs_ide577 = NULL; static int gs_ide573 = 0; /*;int max_nodes_per_layer;
@@ -133,9 +131,9 @@ de572 ) {;*/ Fatal_error("memory exhausted",""); gs_ide572 = i+2;
 PRINTF("Sizeof table `adjarray[12]': %ld Bytes\n", (i+2)*sizeof(GNODE)); /*;izeof(/N;D+));
 _ide505 = (/+D/+ *)malloc((i+2)*sizeof(;*/ 
 #endif
-} gs_ide581 (); gs_ide556 (); gs_ide582 (); gs_ide511 (); for (i=0; i<=maxdepth+1; /*;N;D+));
+} build_layer_data(gs_ide580 ); gs_ide581 (); gs_ide556 (); gs_ide582 (); if (incremental_layout || warm_start_active()) { seed_layer_order(gs_ide580 ); gs_ide518 (layer,gs_ide580 ); } gs_ide511 (); for (i=0; i<=maxdepth+1; /*;N;D+));
 };*/  i++) (( layer[i] ).cross) /*;};*/ = (( gs_ide580 [i] ).cross) /*;};
-*/ ; nr_crossings = gs_ide528 ();
+*/ ; nr_crossings = gs_ide528 (); prof_set(PROF_CROSSINGS_BEFORE,(long)nr_crossings);
 #ifdef CHECK_CROSSING
 PRINTF("Start: nr_crossings %d \n",nr_crossings); 
 #endif
@@ -148,18 +146,18 @@ break;;*/ nr_crossings = old_nr_crossings+1;  }
 PRINTF("After barycentering: nr_crossings %d \n",nr_crossings); 
 #endif
 old_nr_crossings = nr_crossings; if (old_nr_crossings>0) gs_ide542 (0); /*;50 ++;
-<min_baryiterations) ;*/ gs_wait_message('b'); gs_ide532 (); gs_wait_message('b'); if (old_nr_crossings>0) gs_ide542 (1); /*; After barycentering: nr_crossings %d z
+<min_baryiterations) ;*/ gs_wait_message('b'); invalidate_layer_data(); if (incremental_layout) remember_layer_order(gs_ide580 ); gs_ide532 (); gs_wait_message('b'); if (old_nr_crossings>0) gs_ide542 (1); /*; After barycentering: nr_crossings %d z
 gs = nr_crossings;;*/ 
 #ifdef CHECK_CROSSING
 gs_ide511 (); nr_crossings = gs_ide528 (); PRINTF("After local optimization: nr_crossings %d \n",nr_crossings); /*;gs_wait_message('b');
 32 ();;*/  
 #endif
-if (local_unwind && (old_nr_crossings>0)) gs_ide543 (); gs_ide511 (); /*;0) gs_ide542 (1);
+if (local_unwind && (old_nr_crossings>0)) gs_ide543 (); warm_start_restore(gs_ide580 ); gs_ide511 (); /*;0) gs_ide542 (1);
 gs_ide511 ();;*/  nr_crossings = gs_ide528 ();
 #ifdef CHECK_CROSSING
 PRINTF("Final: nr_crossings %d \n",nr_crossings); 
 #endif
-gs_ide518 (layer,gs_ide580 );  gs_ide560 (); stop_time("step2_main"); /*;gs_ide511 ();
+gs_ide518 (layer,gs_ide580 );  gs_ide560 (); prof_set(PROF_CROSSINGS_AFTER,(long)nr_crossings); prof_set(PROF_BARY_ITERATIONS,(long)gs_ide550 ); stop_time("step2_main"); /*;gs_ide511 ();
 sings = gs_ide528 ();;*/  }
 #ifdef ANSI_C
 static void gs_ide519 (void)
@@ -272,22 +270,69 @@ R/SC;yy+NT ==0));;*/ ; j = 0; while (li) { gs_ide577 [j++] = (( li )->node) /*;
 };*/ ; li = (( li )->next) /*;};*/ ; } quicksort_sort_array((( layer[i] ).anz) /*;
 580 [i] ).succlist) /+;R/SC;yy+NT ;;*/ ); gs_ide509 (i); } gs_ide518 (layer,gs_ide580 ); /*;] = (( li )->node) /+;R/SC;yy+NT ;
 +;R/SC;yy+NT ;;*/   }
+/*  Mark a connected component
+ *  --------------------------
+ *  All nodes of the component of node get the same bary value i.
+ *  The component is traversed with an explicit stack of nodes,
+ *  because a recursion along the edges overflows the C stack on
+ *  long chains of nodes.
+ */
+
+static GNODE *comp_stack     = NULL;
+static long   comp_stacksize = 0L;
+static long   comp_top       = 0L;
+
+#ifdef ANSI_C
+static void comp_push(GNODE node)
+#else
+static void comp_push(node)
+GNODE node;
+#endif
+{
+	GNODE *h;
+
+	if (NBARY(node)) return;
+	if (comp_top >= comp_stacksize) {
+		comp_stacksize = (comp_stacksize ? 2L*comp_stacksize : 1024L);
+		h = (GNODE *)realloc(comp_stack, comp_stacksize*sizeof(GNODE));
+		if (!h) Fatal_error("memory exhausted","");
+		comp_stack = h;
+	}
+	comp_stack[comp_top++] = node;
+}
+
 #ifdef ANSI_C
 static void gs_ide546 (GNODE node,int i)
 #else
-static void gs_ide546 (node, i) GNODE node; int i;
+static void gs_ide546 (node, i)
+GNODE node;
+int i;
 #endif
-{ ADJEDGE e; ; if ((( node )->bary) /*;_ide546 (node, i);*/ ) return; /*;/N;D+ node;
-int i;;*/  if ((( node )->nhorder) /*;/N;D+ node;;*/ >=0)  (( node )->bary) /*;
-int i;;*/ = (double)i*(double)(gs_ide547 +1) +(double)(( node )->nhorder) /*;
-{;*/ ; else (( node )->bary) /*; e;;*/ = (double)i*(double)(gs_ide547 +1); /*; e;
-;;*/ e = (( node )->succ) /*;;;*/ ; while (e) { gs_ide546 (((( (( e )->kante) /*;
->nhorder) /+;R/SC;yy+NT >=0) ;*/ )->end) /*;>nhorder) /+;R/SC;yy+NT >=0) ;
-*/ ) /*;>nhorder) /+;R/SC;yy+NT >=0) ;*/ ,i); e = (( e )->next) /*;/SC;
-yy+NT = (double)i*(double)(gs_ide547 ;*/ ; } e = (( node )->pred) /*; = (double)i*(double)(gs_ide547 +1);
-;*/ ; while (e) { gs_ide546 (((( (( e )->kante) /*; {;*/ )->start) /*;
-{;*/ ) /*; {;*/ ,i); e = (( e )->next) /*;( e )->kante) /+;R/SC;yy+NT )->end) /+;
-;*/ ; } }
+{
+	ADJEDGE e;
+
+	comp_top = 0L;
+	comp_push(node);
+	while (comp_top) {
+		node = comp_stack[--comp_top];
+		if (NBARY(node)) continue;
+		if (NHORDER(node)>=0)
+			NBARY(node) = (double)i*(double)(gs_ide547+1)
+				      + (double)NHORDER(node);
+		else	NBARY(node) = (double)i*(double)(gs_ide547+1);
+
+		e = NSUCC(node);
+		while (e) {
+			comp_push(EEND(AKANTE(e)));
+			e = ANEXT(e);
+		}
+		e = NPRED(node);
+		while (e) {
+			comp_push(ESTART(AKANTE(e)));
+			e = ANEXT(e);
+		}
+	}
+}
 #ifdef ANSI_C
 static int gs_ide528 (void)
 #else
@@ -322,8 +367,7 @@ while (vl1) {;*/ ; vl2 = (( vl2 )->next) /*;l1 )->node) /+;R/SC;yy+NT )->tmpadj)
 */ ; } i = 1; vl1 = (( gs_ide580 [level] ).succlist) /*;( gs_ide580 [level+1] ).succlist) /+;
 R/;*/ ; while (vl1) { (( (( vl1 )->node) /*;l2 )->node) /+;R/SC;yy+NT )->tmpadj) /+;
 */ )->Vpointer) /*;l2 )->node) /+;R/SC;yy+NT )->tmpadj) /+;*/ = NULL; /*;->next) /+;R/SC;yy+NT ;
-};*/  (( (( vl1 )->node) /*;->next) /+;R/SC;yy+NT ;;*/ )->position) /*;->next) /+;
-R/SC;yy+NT ;;*/ = i; a = (( (( vl1 )->node) /*;};*/ )->succ) /*;};*/ ; /*;i = 1;
+};*/  set_position((( vl1 )->node), i); a = (( (( vl1 )->node) /*;};*/ )->succ) /*;};*/ ; /*;i = 1;
 ( gs_ide580 [level] ).succlist) /+;R/SC;*/  while (a) { assert(((( ((( (( a )->kante) /*;( gs_ide580 [level] ).succlist) /+;
 R/SC;*/ )->end) /*;( gs_ide580 [level] ).succlist) /+;R/SC;*/ ) /*;( gs_ide580 [level] ).succlist) /+;
 R/SC;*/ )->tmpadj) /*;( gs_ide580 [level] ).succlist) /+;R/SC;*/ )); /*;while (vl1) {
@@ -341,7 +385,7 @@ R/SC;yy+NT )->position) /+;R/SC;*/ ; } vl1 = (( vl1 )->next) /*;while (a) {
 ;*/ ; i = i+2; } i = 2; vl2 = (( gs_ide580 [level+1] ).succlist) /*;
 +NT ;;*/ ; while (vl2) { (( (( vl2 )->node) /*;( vl1 )->next) /+;R/SC;
 yy+NT ;;*/ )->Vpointer) /*;( vl1 )->next) /+;R/SC;yy+NT ;;*/ = NULL; /*;i = i+2;
-};*/  (( (( vl2 )->node) /*;i = i+2;;*/ )->position) /*;i = i+2;;*/ = i; a = (( (( vl2 )->node) /*;
+};*/  set_position((( vl2 )->node), i); a = (( (( vl2 )->node) /*;
 };*/ )->pred) /*;};*/ ; while (a) { assert(((( ((( (( a )->kante) /*;
 ( gs_ide580 [level+1] ).succlist) /+;R/;*/ )->start) /*;( gs_ide580 [level+1] ).succlist) /+;
 R/;*/ ) /*;( gs_ide580 [level+1] ).succlist) /+;R/;*/ )->tmpadj) /*;
@@ -356,7 +400,7 @@ R/SC;yy+NT )->Vpointer) ;*/ )->tmpadj) /*;l2 )->node) /+;R/SC;yy+NT )->Vpointer)
 R/SC;yy+NT )->Vpointer) ;*/ )->tmpadj) /*;l2 )->node) /+;R/SC;yy+NT )->Vpointer) ;
 */ )->next) /*;l2 )->node) /+;R/SC;yy+NT )->Vpointer) ;*/ ; a = (( a )->next) /*;
 ode) /+;R/SC;yy+NT )->position) /+;R/SC;*/ ; } vl2 = (( vl2 )->next) /*;
-while (a) {;*/ ; i = i+2; } gs_ide551 = 0; gs_ide575 = gs_ide571 = 0; /*;}
+while (a) {;*/ ; i = i+2; } if (crossing_counter) return(bilayer_crossings(gs_ide580 [level].succlist, gs_ide580 [level+1].succlist)); gs_ide551 = 0; gs_ide575 = gs_ide571 = 0; /*;}
 ( vl2 )->next) /+;R/SC;yy+NT ;;*/  gs_ide544 = gs_ide545 = NULL; gs_ide584 = gs_ide585 = NULL; vl1 = (( gs_ide580 [level] ).succlist) /*;
 i = i+2;;*/ ; vl2 = (( gs_ide580 [level+1] ).succlist) /*;};*/ ; while ((vl1)||(vl2)) { /*;51 = 0;
 _ide571 = 0;;*/ if (vl1) { gs_ide527 ((( vl1 )->node) /*; = NULL;;*/ ); vl1 = (( vl1 )->next) /*;
@@ -442,10 +486,9 @@ static void gs_ide557 (int level)
 static void gs_ide557 (level) int level;
 #endif
 { int i; GNLIST vl; ; if (level>0) { i = 1; vl = (( gs_ide580 [level-1] ).succlist) /*;
-{;*/ ; while (vl) { (( (( vl )->node) /*;vl;;*/ )->position) /*;vl;;
-*/ = i++; vl = (( vl )->next) /*;;;*/ ; } } if (level<=maxdepth) { i = 1; /*;while (vl) {
+{;*/ ; while (vl) { set_position((( vl )->node), i++); vl = (( vl )->next) /*;;;*/ ; } } if (level<=maxdepth) { i = 1; /*;while (vl) {
 l )->node) /+;R/SC;yy+NT )->position) /;*/ vl = (( gs_ide580 [level+1] ).succlist) /*;l )->node) /+;R/SC;yy+NT )->position) /;
-*/ ; while (vl) { (( (( vl )->node) /*;};*/ )->position) /*;};*/ = i++; /*;}
+*/ ; while (vl) { set_position((( vl )->node), i++); /*;}
 };*/ vl = (( vl )->next) /*;};*/ ; } } }
 #ifdef ANSI_C
 static int gs_ide525 (GNODE C, GNODE D)
@@ -483,7 +526,7 @@ static int gs_ide540 (int level,int nearedges)
 static int gs_ide540 (level, nearedges) int level; int nearedges;
 #endif
 { int changed, possible; GNLIST vl1, vl2; GNODE n1,n2; ; assert((level>=0)); /*;redges;
-{;*/ assert((level<=maxdepth+1)); gs_ide557 (level); changed = 0; vl1 = NULL; /*;/N;D+ n1,n2;
+{;*/ assert((level<=maxdepth+1)); if (layer_is_frozen(level)) return(0); gs_ide557 (level); changed = 0; vl1 = NULL; /*;/N;D+ n1,n2;
 ;;*/ vl2 = (( gs_ide580 [level] ).succlist) /*;;;*/ ; while (vl2) { n2 = (( vl2 )->node) /*;
 =maxdepth+1));;*/ ; if (vl1) { n1 = (( vl1 )->node) /*; = 0;;*/ ; possible = 1; /*;vl1 = NULL;
 ( gs_ide580 [level] ).succlist) /+;R/SC;*/ if (nearedges) { if (((( n1 )->connection) /*;while (vl2) {;*/ )||((( n2 )->connection) /*;
@@ -505,8 +548,7 @@ static void gs_ide558 (void)
 static void gs_ide558 ()
 #endif
 { GNLIST h1; int i,j; ; for (i=0; i<=maxdepth+1; i++) {  h1 = (( gs_ide580 [i] ).succlist) /*;
-_ide558 ();*/ ; j = 0; while (h1) { (( (( h1 )->node) /*;int i,j;;*/ )->position) /*;
-int i,j;;*/ = j++; h1 = (( h1 )->next) /*;;;*/ ; } } }
+_ide558 ();*/ ; j = 0; while (h1) { set_position((( h1 )->node), j++); h1 = (( h1 )->next) /*;;;*/ ; } } }
 #ifdef ANSI_C
 static int gs_ide535 (GNODE v)
 #else
@@ -547,9 +589,7 @@ n) /+;R/SC;yy+NT - (( v2 )->position) /;*/ if ((( vl3 )->node) /*;n) /+;R/SC;yy+
 if (d1*d1!=1) return;;*/ if ((( vl3 )->node) /*;if (d1*d1!=1) return;;*/ ==v2) vl2 = vl3; vl3 = (( vl3 )->next) /*;
 ((( v1 )->tiefe) /+;R/SC;yy+NT ==(( v2 ;*/ ; } assert((vl1)); assert((vl2)); /*;while (vl3) {
 vl3 )->node) /+;R/SC;yy+NT ==v1) vl1 = ;*/ (( vl1 )->node) /*;vl3 )->node) /+;R/SC;yy+NT ==v1) vl1 = ;*/ = v2; (( vl2 )->node) /*;
-node) /+;R/SC;yy+NT ==v2) vl2 = vl3;;*/ = v1;  h = (( v1 )->position) /*;
-/+;R/SC;yy+NT ;;*/ ;  (( v1 )->position) /*;};*/ = (( v2 )->position) /*;
-};*/ ; (( v2 )->position) /*;(vl1));;*/ = h;  if (dir=='S') { n1 = ((( (( (( v1 )->succ) /*;
+node) /+;R/SC;yy+NT ==v2) vl2 = vl3;;*/ = v1;  h = (( v1 )->position); set_position(v1,(( v2 )->position)); set_position(v2,h);  if (dir=='S') { n1 = ((( (( (( v1 )->succ) /*;
 SC;yy+NT = v2;;*/ )->kante) /*;SC;yy+NT = v2;;*/ )->end) /*;SC;yy+NT = v2;
 ;*/ ) /*;SC;yy+NT = v2;;*/ ; n2 = ((( (( (( v2 )->succ) /*;T = v1; ;
 */ )->kante) /*;T = v1; ;*/ )->end) /*;T = v1; ;*/ ) /*;T = v1; ;*/ ; /*;T ; 
@@ -674,15 +714,15 @@ static int gs_ide561 (int i)
 #else
 static int gs_ide561 (i) int i;
 #endif
-{ int c; int j; ; assert((i>=0)); assert((i<=maxdepth));  gs_ide541 (i+1,'d'); /*;{
-int c;;*/ switch (crossing_heuristics) { case 0: for (j=0; j<(( layer[i+1] ).anz) /*;
+{ int c; int j; ; if (layer_is_frozen(i+1)) return(0); assert((i>=0)); assert((i<=maxdepth));  gs_ide541 (i+1,'d'); /*;{
+int c;;*/ switch (crossing_heuristics) { case 0: if (ld_parallel((( layer[i+1] ).anz))) ld_weights(gs_ide577, (( layer[i+1] ).anz), LD_PREDBARY, LD_NOWEIGHT); else for (j=0; j<(( layer[i+1] ).anz) /*;
 int j;;*/ ; j++) (( gs_ide577 [j] )->bary) /*;;;*/ = gs_ide554 (gs_ide577 [j]); /*;;
-(i>=0));;*/ break; case 1: for (j=0; j<(( layer[i+1] ).anz) /*;depth)); ;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-gs_ide541 (i+1,'d');;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: for (j=0; /*;=0; j<(( layer[i+1] ).anz) /+;R/SC;yy+N
+(i>=0));;*/ break; case 1: if (ld_parallel((( layer[i+1] ).anz))) ld_weights(gs_ide577, (( layer[i+1] ).anz), LD_PREDMEDIAN, LD_NOWEIGHT); else for (j=0; j<(( layer[i+1] ).anz) /*;depth)); ;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
+gs_ide541 (i+1,'d');;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: if (ld_parallel((( layer[i+1] ).anz))) ld_weights(gs_ide577, (( layer[i+1] ).anz), LD_PREDBARY, LD_PREDMEDIAN); else for (j=0; /*;=0; j<(( layer[i+1] ).anz) /+;R/SC;yy+N
 ary) /+;R/SC;yy+NT = gs_ide554 (gs_ide5;*/  j<(( layer[i+1] ).anz) /*;=0; j<(( layer[i+1] ).anz) /+;R/SC;yy+N;*/ ; /*;=0; j<(( layer[i+1] ).anz) /+;R/SC;yy+N
 ary) /+;R/SC;yy+NT = gs_ide554 (gs_ide5;*/  j++) (( gs_ide577 [j] )->bary) /*;ary) /+;R/SC;yy+NT = gs_ide554 (gs_ide5;
 */ = gs_ide554 (gs_ide577 [j]) + gs_ide555 (gs_ide577 [j])/10000.0; break; /*; for (j=0; j<(( layer[i+1] ).anz) /+;R/
-j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;*/ case 3: for (j=0; j<(( layer[i+1] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;
+j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;*/ case 3: if (ld_parallel((( layer[i+1] ).anz))) ld_weights(gs_ide577, (( layer[i+1] ).anz), LD_PREDMEDIAN, LD_PREDBARY); else for (j=0; j<(( layer[i+1] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;
 */ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide555 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i+1] ).anz) /+;R/;*/ + gs_ide554 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i+1] ).anz) /*;
 break;;*/ ); gs_ide570 (i+1);  gs_ide509 (i+1); if ((( layer[i+1] ).resort_necessary) /*;
@@ -695,15 +735,15 @@ static int gs_ide564 (int i)
 #else
 static int gs_ide564 (i) int i;
 #endif
-{ int c; int j; ; assert((i>=0)); assert((i<=maxdepth));  gs_ide541 (i,'u'); /*;{
-int c;;*/ switch (crossing_heuristics) { case 0: for (j=0; j<(( layer[i] ).anz) /*;
+{ int c; int j; ; if (layer_is_frozen(i)) return(0); assert((i>=0)); assert((i<=maxdepth));  gs_ide541 (i,'u'); /*;{
+int c;;*/ switch (crossing_heuristics) { case 0: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCBARY, LD_NOWEIGHT); else for (j=0; j<(( layer[i] ).anz) /*;
 int j;;*/ ; j++) (( gs_ide577 [j] )->bary) /*;;;*/ = gs_ide578 (gs_ide577 [j]); /*;;
-(i>=0));;*/ break; case 1: for (j=0; j<(( layer[i] ).anz) /*;depth)); ;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-gs_ide541 (i,'u');;*/ = gs_ide579 (gs_ide577 [j]); break; case 2: for (j=0; /*;=0; j<(( layer[i] ).anz) /+;R/SC;yy+NT 
+(i>=0));;*/ break; case 1: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCMEDIAN, LD_NOWEIGHT); else for (j=0; j<(( layer[i] ).anz) /*;depth)); ;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
+gs_ide541 (i,'u');;*/ = gs_ide579 (gs_ide577 [j]); break; case 2: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCBARY, LD_SUCCMEDIAN); else for (j=0; /*;=0; j<(( layer[i] ).anz) /+;R/SC;yy+NT 
 ary) /+;R/SC;yy+NT = gs_ide578 (gs_ide5;*/  j<(( layer[i] ).anz) /*;=0; j<(( layer[i] ).anz) /+;R/SC;yy+NT ;*/ ; /*;=0; j<(( layer[i] ).anz) /+;R/SC;yy+NT 
 ary) /+;R/SC;yy+NT = gs_ide578 (gs_ide5;*/  j++) (( gs_ide577 [j] )->bary) /*;ary) /+;R/SC;yy+NT = gs_ide578 (gs_ide5;
 */ = gs_ide578 (gs_ide577 [j]) + gs_ide579 (gs_ide577 [j])/10000.0; break; /*; for (j=0; j<(( layer[i] ).anz) /+;R/SC
-j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;*/ case 3: for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;
+j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;*/ case 3: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCMEDIAN, LD_SUCCBARY); else for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;
 */ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide579 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ + gs_ide578 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i] ).anz) /*;
 break;;*/ ); gs_ide570 (i);  gs_ide509 (i); if ((( layer[i] ).resort_necessary) /*;
@@ -717,15 +757,15 @@ static void gs_ide502 (void)
 static void gs_ide502 ()
 #endif
 { int i,j; int cross; ; gs_wait_message('B'); if (gs_ide553 <= maxdepth) /*;_ide502 ()
-{;*/ for (i=gs_ide553 ; i<=maxdepth; i++) { if (G_timelimit>0) if (test_timelimit(60)) { /*;int cross;
+{;*/ for (i=gs_ide553 ; i<=maxdepth; i++) { if (layer_is_frozen(i)) continue; if (G_timelimit>0) if (test_timelimit(60)) { /*;int cross;
 ;;*/ gs_wait_message('t'); break; } gs_ide541 (i,'u'); switch (crossing_heuristics) { /*;if (/_timelimit>0)
-t_timelimit(60)) {;*/ case 0: for (j=0; j<(( layer[i] ).anz) /*;t_timelimit(60)) {;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-e('t');;*/ = gs_ide578 (gs_ide577 [j]); break; case 1: for (j=0; j<(( layer[i] ).anz) /*;
+t_timelimit(60)) {;*/ case 0: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCBARY, LD_NOWEIGHT); else for (j=0; j<(( layer[i] ).anz) /*;t_timelimit(60)) {;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
+e('t');;*/ = gs_ide578 (gs_ide577 [j]); break; case 1: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCMEDIAN, LD_NOWEIGHT); else for (j=0; j<(( layer[i] ).anz) /*;
 };*/ ; j++) (( gs_ide577 [j] )->bary) /*;41 (i,'u');;*/ = gs_ide579 (gs_ide577 [j]); /*;41 (i,'u');
-ng_heuristics) {;*/ break; case 2: for (j=0; j<(( layer[i] ).anz) /*;( layer[i] ).anz) /+;
+ng_heuristics) {;*/ break; case 2: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCBARY, LD_SUCCMEDIAN); else for (j=0; j<(( layer[i] ).anz) /*;( layer[i] ).anz) /+;
 R/SC;yy+NT ; j++);*/ ; j++) (( gs_ide577 [j] )->bary) /*;;R/SC;yy+NT = gs_ide578 (gs_ide577 [j]);
 */ = gs_ide578 (gs_ide577 [j]) + gs_ide579 (gs_ide577 [j])/10000.0; break; /*; for (j=0; j<(( layer[i] ).anz) /+;R/SC
-j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;*/ case 3: for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;
+j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;*/ case 3: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCMEDIAN, LD_SUCCBARY); else for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide579 (;
 */ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide579 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ + gs_ide578 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i] ).anz) /*;
 break;;*/ ); if (gs_ide520 ((( layer[i] ).anz) /*; for (j=0; j<(( layer[i] ).anz) /+;
@@ -738,16 +778,15 @@ layer[i] ).resort_necessary) /+;R/SC;yy;*/
 j = gs_ide528 (); gs_ide511 (); assert((j==gs_ide528 ())); PRINTF("Phase2_down: nr_crossings old: %d new: %d\n",nr_crossings,j); /*;gs_ide563 (i);
 gs_ide528 ();;*/  
 #endif
-gs_ide553 = i+1; return;  }  } } for (i=0; (i<gs_ide553 ) && (i<=maxdepth); /*;nr_crossings old: %d new: %dzn ,nr_cros
-gs_ide553 = i+1;;*/  i++) { if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;} 
-};*/ break; } gs_ide541 (i,'u'); switch (crossing_heuristics) { case 0: for (j=0; /*;)) {
+gs_ide553 = i+1; return;  }  } } for (i=0; (i<gs_ide553 ) && (i<=maxdepth);    i++) { if (layer_is_frozen(i)) continue; if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;} 
+};*/ break; } gs_ide541 (i,'u'); switch (crossing_heuristics) { case 0: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_NOWEIGHT); else for (j=0; /*;)) {
 gs_wait_message('t');;*/  j<(( layer[i] ).anz) /*;)) {;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-gs_wait_message('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: for (j=0; /*;}
+gs_wait_message('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDMEDIAN, LD_NOWEIGHT); else for (j=0; /*;}
 41 (i,'u');;*/  j<(( layer[i] ).anz) /*;};*/ ; j++) (( gs_ide577 [j] )->bary) /*;41 (i,'u');
-;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: for (j=0; j<(( layer[i] ).anz) /*;
+;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_PREDMEDIAN); else for (j=0; j<(( layer[i] ).anz) /*;
 ( layer[i] ).anz) /+;R/SC;yy+NT ; j++);*/ ; j++) (( gs_ide577 [j] )->bary) /*;
 ;R/SC;yy+NT = gs_ide554 (gs_ide577 [j]);*/ = gs_ide554 (gs_ide577 [j]) + gs_ide555 (gs_ide577 [j])/10000.0; /*;break;
-for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ break; case 3: for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;
+for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ break; case 3: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDMEDIAN, LD_PREDBARY); else for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;
 yy+NT = gs_ide555 (;*/ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide555 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ + gs_ide554 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i] ).anz) /*;
 break;;*/ ); if (gs_ide520 ((( layer[i] ).anz) /*; for (j=0; j<(( layer[i] ).anz) /+;
@@ -771,16 +810,15 @@ static void gs_ide503 (void)
 #else
 static void gs_ide503 ()
 #endif
-{ int i,j; int cross; ; gs_wait_message('B'); if (gs_ide553 > 0) for (i=gs_ide553 ; /*;{
-;;*/  i>0; i--) { if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;;
-_message('B');;*/ break; } gs_ide541 (i,'d'); switch (crossing_heuristics) { case 0: for (j=0; /*;t_timelimit(60)) {
+{ int i,j; int cross; ; gs_wait_message('B'); if (gs_ide553 > 0) for (i=gs_ide553 ;    i>0; i--) { if (layer_is_frozen(i)) continue; if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;;
+_message('B');;*/ break; } gs_ide541 (i,'d'); switch (crossing_heuristics) { case 0: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_NOWEIGHT); else for (j=0; /*;t_timelimit(60)) {
 e('t');;*/  j<(( layer[i] ).anz) /*;t_timelimit(60)) {;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-e('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: for (j=0; j<(( layer[i] ).anz) /*;
+e('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDMEDIAN, LD_NOWEIGHT); else for (j=0; j<(( layer[i] ).anz) /*;
 };*/ ; j++) (( gs_ide577 [j] )->bary) /*;41 (i,'d');;*/ = gs_ide555 (gs_ide577 [j]); /*;41 (i,'d');
-ng_heuristics) {;*/ break; case 2: for (j=0; j<(( layer[i] ).anz) /*;( layer[i] ).anz) /+;
+ng_heuristics) {;*/ break; case 2: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_PREDMEDIAN); else for (j=0; j<(( layer[i] ).anz) /*;( layer[i] ).anz) /+;
 R/SC;yy+NT ; j++);*/ ; j++) (( gs_ide577 [j] )->bary) /*;;R/SC;yy+NT = gs_ide554 (gs_ide577 [j]);
 */ = gs_ide554 (gs_ide577 [j]) + gs_ide555 (gs_ide577 [j])/10000.0; break; /*; for (j=0; j<(( layer[i] ).anz) /+;R/SC
-j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;*/ case 3: for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;
+j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;*/ case 3: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_SUCCMEDIAN, LD_PREDBARY); else for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;yy+NT = gs_ide555 (;
 */ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide579 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ + gs_ide554 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i] ).anz) /*;
 break;;*/ ); if (gs_ide520 ((( layer[i] ).anz) /*; for (j=0; j<(( layer[i] ).anz) /+;
@@ -793,16 +831,15 @@ layer[i] ).resort_necessary) /+;R/SC;yy;*/
 j = gs_ide528 (); gs_ide511 (); assert((j==gs_ide528 ())); PRINTF("Phase2_up: nr_crossings old: %d new: %d\n",nr_crossings,j); /*;gs_ide562 (i);
 gs_ide528 ();;*/  
 #endif
-gs_ide553 = i-1; return;  }  } } for (i=maxdepth+1; (i>gs_ide553 ) && (i>0); /*;_crossings old: %d new: %dzn ,nr_crossi
-gs_ide553 = i-1;;*/  i--) { if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;} 
-};*/ break; } gs_ide541 (i,'d'); switch (crossing_heuristics) { case 0: for (j=0; /*;)) {
+gs_ide553 = i-1; return;  }  } } for (i=maxdepth+1; (i>gs_ide553 ) && (i>0);    i--) { if (layer_is_frozen(i)) continue; if (G_timelimit>0) if (test_timelimit(60)) { gs_wait_message('t'); /*;} 
+};*/ break; } gs_ide541 (i,'d'); switch (crossing_heuristics) { case 0: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_NOWEIGHT); else for (j=0; /*;)) {
 gs_wait_message('t');;*/  j<(( layer[i] ).anz) /*;)) {;*/ ; j++) (( gs_ide577 [j] )->bary) /*;
-gs_wait_message('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: for (j=0; /*;}
+gs_wait_message('t');;*/ = gs_ide554 (gs_ide577 [j]); break; case 1: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDMEDIAN, LD_NOWEIGHT); else for (j=0; /*;}
 41 (i,'d');;*/  j<(( layer[i] ).anz) /*;};*/ ; j++) (( gs_ide577 [j] )->bary) /*;41 (i,'d');
-;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: for (j=0; j<(( layer[i] ).anz) /*;
+;*/ = gs_ide555 (gs_ide577 [j]); break; case 2: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDBARY, LD_PREDMEDIAN); else for (j=0; j<(( layer[i] ).anz) /*;
 ( layer[i] ).anz) /+;R/SC;yy+NT ; j++);*/ ; j++) (( gs_ide577 [j] )->bary) /*;
 ;R/SC;yy+NT = gs_ide554 (gs_ide577 [j]);*/ = gs_ide554 (gs_ide577 [j]) + gs_ide555 (gs_ide577 [j])/10000.0; /*;break;
-for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ break; case 3: for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;
+for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ break; case 3: if (ld_parallel((( layer[i] ).anz))) ld_weights(gs_ide577, (( layer[i] ).anz), LD_PREDMEDIAN, LD_PREDBARY); else for (j=0; j<(( layer[i] ).anz) /*;j] )->bary) /+;R/SC;
 yy+NT = gs_ide555 (;*/ ; j++) (( gs_ide577 [j] )->bary) /*;break;;*/ = gs_ide555 (gs_ide577 [j]) /*;break;
 for (j=0; j<(( layer[i] ).anz) /+;R/SC;*/ + gs_ide554 (gs_ide577 [j])/10000.0; break; } quicksort_sort_array((( layer[i] ).anz) /*;
 break;;*/ ); if (gs_ide520 ((( layer[i] ).anz) /*; for (j=0; j<(( layer[i] ).anz) /+;
@@ -858,7 +895,7 @@ static double gs_ide578 (GNODE node)
 #else
 static double gs_ide578 (node) GNODE node;
 #endif
-{ int Sum; ADJEDGE w; assert((node)); ; if ((( node )->outdegree) /*;
+{ int Sum; ADJEDGE w; if (layer_data_valid) return(ld_succbary(node)); assert((node)); ; if ((( node )->outdegree) /*;
 /N;D+ node;;*/ ==0) return(0.0); Sum = 0; w = (( node )->succ) /*;;;
 */ ; while (w) { Sum += (256 * (( ((( (( w )->kante) /*;(node));;*/ )->end) /*;
 (node));;*/ ) /*;(node));;*/ )->position) /*;(node));;*/ ); Sum -= (( (( w )->kante) /*;
@@ -870,7 +907,7 @@ static double gs_ide554 (GNODE node)
 #else
 static double gs_ide554 (node) GNODE node;
 #endif
-{ int Sum; ADJEDGE w; assert((node)); ; if ((( node )->indegree) /*;
+{ int Sum; ADJEDGE w; if (layer_data_valid) return(ld_predbary(node)); assert((node)); ; if ((( node )->indegree) /*;
 /N;D+ node;;*/ ==0) return(0.0); Sum = 0; w = (( node )->pred) /*;;;
 */ ; while (w) { Sum += (256 * (( ((( (( w )->kante) /*;(node));;*/ )->start) /*;
 (node));;*/ ) /*;(node));;*/ )->position) /*;(node));;*/ ); Sum += (( (( w )->kante) /*;
@@ -882,7 +919,7 @@ static double gs_ide579 (GNODE node)
 #else
 static double gs_ide579 (node) GNODE node;
 #endif
-{ int i, leftpart, rightpart; ADJEDGE w; assert((node)); ; switch ((( node )->outdegree) /*;
+{ int i, leftpart, rightpart; ADJEDGE w; if (layer_data_valid) return(ld_succmedian(node)); assert((node)); ; switch ((( node )->outdegree) /*;
 /N;D+ node;;*/ ) { case 0: return(0.0); case 1: return((double) (( ((( (( (( node )->succ) /*;
 leftpart, rightpart;;*/ )->kante) /*;leftpart, rightpart;;*/ )->end) /*;
 leftpart, rightpart;;*/ ) /*;leftpart, rightpart;;*/ )->position) /*;
@@ -911,7 +948,7 @@ static double gs_ide555 (GNODE node)
 #else
 static double gs_ide555 (node) GNODE node;
 #endif
-{ int i, leftpart, rightpart; ADJEDGE w; assert((node)); ; switch ((( node )->indegree) /*;
+{ int i, leftpart, rightpart; ADJEDGE w; if (layer_data_valid) return(ld_predmedian(node)); assert((node)); ; switch ((( node )->indegree) /*;
 /N;D+ node;;*/ ) { case 0: return(0.0); case 1: return((double) (( ((( (( (( node )->pred) /*;
 leftpart, rightpart;;*/ )->kante) /*;leftpart, rightpart;;*/ )->start) /*;
 leftpart, rightpart;;*/ ) /*;leftpart, rightpart;;*/ )->position) /*;
@@ -953,24 +990,6 @@ static int gs_ide515 (a,b) GNODE *a; GNODE *b;
 {  if ((( *a )->position) /*;};*/ > (( *b )->position) /*;};*/ ) return(1); /*;}
 int gs_ide515 (const /N;D+ *a, const /N;*/ if ((( *a )->position) /*;int gs_ide515 (const /N;D+ *a, const /N;*/ < (( *b )->position) /*;
 int gs_ide515 (const /N;D+ *a, const /N;*/ ) return(-1); return(0); }
-#ifdef OWN_QUICKSORT
-#define exchange(a,b) { t=a; a=b; b=t; }
-#ifdef ANSI_C
-static void gs_ide549 (int l, int r)
-#else
-static void gs_ide549 (l, r) int l, r;
-#endif
-{ int i, j, k; GNODE v, t; k = r-l; if (k>5) {  j = l + (gs_ide559 % k); /*;int l, r;
-{;*/   gs_ide559 = (gs_ide559 + 10891) % MAXINT; exchange(gs_ide577 [l],gs_ide577 [j]); /*;j, k;
-/N;D+ v, t;;*/   } v=gs_ide577 [l]; i=l; j=r+1; if ((( v )->bary) /*;if (k>5) { ;*/ ==0.0) j=l+k/2; /*;if (k>5) { 
-(gs_ide559 % k); ;*/   else { while (i<j) { do j--; while ( ((( gs_ide577 [j] )->bary) /*;
-],gs_ide577 [j]); ;*/ !=0.0) &&((( gs_ide577 [j] )->bary) /*;};*/ >(( v )->bary) /*;
-};*/ )); do i++; while ((i<=j)&&((( gs_ide577 [i] )->bary) /*;e577 [l];
-i=l; j=r+1;;*/ !=0.0)  &&((( gs_ide577 [i] )->bary) /*;ry) /+;R/SC;
-yy+NT ==0.0) j=l+k*2; ;*/ <(( v )->bary) /*;ry) /+;R/SC;yy+NT ==0.0) j=l+k*2;
-;*/ )); if (i<j) exchange(gs_ide577 [j],gs_ide577 [i]);  }; } exchange(gs_ide577 [l],gs_ide577 [j]); /*;->bary) /+;R/SC;yy+NT >(( v )->bary) /+
-s_ide577 [i] )->bary) /+;R/SC;yy+NT !=0;*/   if (l<j-1) gs_ide549 (l,j-1); if (j+1<r) gs_ide549 (j+1,r); }
-#endif
 #ifdef ANSI_C
 static void gs_ide541 (int i,int dir)
 #else
@@ -980,8 +999,7 @@ static void gs_ide541 (i,dir) int i; int dir;
 {;*/  j = 0; while (hn) { gs_ide577 [j++] = (( hn )->node) /*;int j;;*/ ; /*;hn;
 ;;*/  hn = (( hn )->next) /*;hn;;*/ ; } if (dir=='d') { assert((i>0)); hn = (( gs_ide580 [i-1] ).succlist) /*;
 hn) {;*/ ; } else { assert((i<maxdepth+1)); hn = (( gs_ide580 [i+1] ).succlist) /*;
-=='d') {;*/ ; } j = 1; while (hn) { (( (( hn )->node) /*;else {;*/ )->position) /*;
-else {;*/ = j++; hn = (( hn )->next) /*;(i<maxdepth+1));;*/ ; } }
+=='d') {;*/ ; } j = 1; while (hn) { set_position((( hn )->node), j++); hn = (( hn )->next) /*;(i<maxdepth+1));;*/ ; } }
 #ifdef ANSI_C
 static void gs_ide509 (int i)
 #else
@@ -1147,8 +1165,7 @@ static void gs_ide560 (void)
 static void gs_ide560 ()
 #endif
 { GNLIST h1,h2; int i,j,k; ; for (i=0; i<=maxdepth+1; i++) {  h1 = (( layer[i] ).succlist) /*;
-_ide560 ();*/ ; j = 0; while (h1) { (( (( h1 )->node) /*;int i,j,k;;
-*/ )->position) /*;int i,j,k;;*/ = j++; h1 = (( h1 )->next) /*;;;*/ ; /*;0; i<=maxdepth+1; i++) { 
+_ide560 ();*/ ; j = 0; while (h1) { set_position((( h1 )->node), j++); h1 = (( h1 )->next) /*;;;*/ ; /*;0; i<=maxdepth+1; i++) { 
 i] ).succlist) /+;R/SC;yy+NT ;;*/  } } for (i=0; i<=maxdepth+1; i++) {  h1 = (( layer[i] ).succlist) /*;
 h1) {;*/ ; (( layer[i] ).predlist) /*;de) /+;R/SC;yy+NT )->position) /+;
 R/SC;;*/ = NULL; k = 0; while (h1) { k++; h2 = tmpnodelist_alloc(); (( h2 )->next) /*;
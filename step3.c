@@ -101,8 +101,8 @@ if (gs_ide1013 ) { gs_ide1013 = 0; PRINTF("Enter ` ` into the drawwindow\n"); /*
 ime();;*/ display_part(); return; }
 #endif
 calc_all_ports(0); calc_all_node_sizes(); gs_ide1017 (); gs_ide1001 (); /*;;
-return;;*/ alloc_levelshift(); gs_ide1022 (); gs_ide1021 (); if (straight_phase==1) gs_ide1048 (); /*;sizes();
-gs_ide1017 ();;*/ gs_ide1043 (); gs_ide1045 ();  gs_ide1041 (); calc_all_ports(1); stop_time("step3_main"); /*;021 ();
+return;;*/ alloc_levelshift(); if (coord_engine==1) bk_coordinates(); else { warm_start_place(); gs_ide1022 (); gs_ide1021 (); } if (straight_phase==1) gs_ide1048 (); /*;sizes();
+gs_ide1017 ();;*/ gs_ide1043 (); gs_ide1045 ();  if (near_edge_compaction) gs_ide1041 (); calc_all_ports(1); stop_time("step3_main"); /*;021 ();
 hase==1) gs_ide1048 ();;*/ }
 #ifdef ANSI_C
 void alloc_levelshift(void)
@@ -291,34 +291,81 @@ node )->connection) /+;R/SC;yy+NT )->t;*/ ; } e = (( node )->pred) /*;
 };*/ ; while (e) { gs_ide1044 (((( (( e )->kante) /*;while (e) {;*/ )->start) /*;
 while (e) {;*/ ) /*;while (e) {;*/ ,i); e = (( e )->next) /*;044 (((( (( e )->kante) /+;
 R/SC;yy+NT );*/ ; } }
+/*  Right border of a connected component
+ *  -------------------------------------
+ *  All nodes of the component of node are marked (NMARK 2), and
+ *  gs_ide1015 becomes the maximal right border of these nodes.
+ *  The component is traversed with an explicit stack of nodes,
+ *  because a recursion along the edges overflows the C stack on
+ *  long chains of nodes.
+ */
+
+static GNODE *comp_stack     = NULL;
+static long   comp_stacksize = 0L;
+static long   comp_top       = 0L;
+
+#ifdef ANSI_C
+static void comp_push(GNODE node)
+#else
+static void comp_push(node)
+GNODE node;
+#endif
+{
+	GNODE *h;
+
+	if (NMARK(node)==2) return;
+	if (comp_top >= comp_stacksize) {
+		comp_stacksize = (comp_stacksize ? 2L*comp_stacksize : 1024L);
+		h = (GNODE *)realloc(comp_stack, comp_stacksize*sizeof(GNODE));
+		if (!h) Fatal_error("memory exhausted","");
+		comp_stack = h;
+	}
+	comp_stack[comp_top++] = node;
+}
+
 #ifdef ANSI_C
 static void gs_ide1027 (GNODE node)
 #else
-static void gs_ide1027 (node) GNODE node;
+static void gs_ide1027 (node)
+GNODE node;
 #endif
-{ ADJEDGE e; ; if ((( node )->markiert) /*;void gs_ide1027 (/N;D+ node);
-*/ ==2) return; (( node )->markiert) /*;_ide1027 (node);*/ = 2; if ((( node )->xloc) /*;
-/N;D+ node;;*/ +(( node )->width) /*;/N;D+ node;;*/ >gs_ide1015 )  gs_ide1015 = (( node )->xloc) /*;
-{;*/ +(( node )->width) /*;{;*/ ; if ((( node )->connection) /*; e;;
-*/ ) { if ((( (( node )->connection) /*;;;*/ )->target) /*;;;*/ ) gs_ide1027 ((( (( node )->connection) /*;
-node )->markiert) /+;R/SC;yy+NT ==2) re;*/ )->target) /*;node )->markiert) /+;
-R/SC;yy+NT ==2) re;*/ ); if ((( (( node )->connection) /*;kiert) /+;
-R/SC;yy+NT = 2;;*/ )->target2) /*;kiert) /+;R/SC;yy+NT = 2;;*/ ) gs_ide1027 ((( (( node )->connection) /*;
-/+;R/SC;yy+NT +(( node )->width) /+;R/S;*/ )->target2) /*;/+;R/SC;yy+NT +(( node )->width) /+;
-R/S;*/ ); } e = (( node )->succ) /*;yy+NT ) {;*/ ; while (e) { gs_ide1027 (((( (( e )->kante) /*;
-7 ((( (( node )->connection) /+;R/SC;yy;*/ )->end) /*;7 ((( (( node )->connection) /+;
-R/SC;yy;*/ ) /*;7 ((( (( node )->connection) /+;R/SC;yy;*/ ); e = (( e )->next) /*;
-->connection) /+;R/SC;yy+NT )->target2);*/ ; } e = (( node )->pred) /*;
-};*/ ; while (e) { gs_ide1027 (((( (( e )->kante) /*;while (e) {;*/ )->start) /*;
-while (e) {;*/ ) /*;while (e) {;*/ ); e = (( e )->next) /*;027 (((( (( e )->kante) /+;
-R/SC;yy+NT );*/ ; } }
+{
+	ADJEDGE e;
+
+	comp_top = 0L;
+	comp_push(node);
+	while (comp_top) {
+		node = comp_stack[--comp_top];
+		if (NMARK(node)==2) continue;
+		NMARK(node) = 2;
+		if (NX(node)+NWIDTH(node)>gs_ide1015)
+			gs_ide1015 = NX(node)+NWIDTH(node);
+
+		if (NCONNECT(node)) {
+			if (CTARGET(NCONNECT(node)))
+				comp_push(CTARGET(NCONNECT(node)));
+			if (CTARGET2(NCONNECT(node)))
+				comp_push(CTARGET2(NCONNECT(node)));
+		}
+		e = NSUCC(node);
+		while (e) {
+			comp_push(EEND(AKANTE(e)));
+			e = ANEXT(e);
+		}
+		e = NPRED(node);
+		while (e) {
+			comp_push(ESTART(AKANTE(e)));
+			e = ANEXT(e);
+		}
+	}
+}
 #ifdef ANSI_C
 static void gs_ide1041 (void)
 #else
 static void gs_ide1041 ()
 #endif
 { GNLIST li; int i; int weight, found; GNODE node; CONNECT c; ; for (i=0; /*;li;
-int i;;*/  i<=maxdepth+1; i++) { li = (( layer[i] ).succlist) /*;int i;;*/ ; while (li) { /*;ght, found;
+int i;;*/  i<=maxdepth+1; i++) { if (G_timelimit>0) if (test_timelimit(95)) { gs_wait_message('t'); return; } li = (( layer[i] ).succlist) /*;int i;;*/ ; while (li) { /*;ght, found;
 /N;D+ node;;*/ weight = 0; node = (( li )->node) /*; c;;*/ ; c = (( node )->connection) /*;
 ;;*/ ; found = 0; if (c) { if ((( c )->target) /*;while (li) {;*/ ) { /*;= 0;
 ->node) /+;R/SC;yy+NT ;;*/   if ((( (( c )->target) /*;= 0;;*/ )->xloc) /*;= 0;;*/ <(( node )->xloc) /*;
@@ -474,7 +521,7 @@ static int gs_ide1036 (int i,int dir)
 #else
 static int gs_ide1036 (i,dir) int i; int dir;
 #endif
-{ GNLIST li; int j; int sign; ; assert((i<=maxdepth)); gs_ide1040 (i); /*;li;
+{ GNLIST li; int j; int sign; ; assert((i<=maxdepth)); if (layer_is_placed(i)) return(0); gs_ide1040 (i); /*;li;
 int j;;*/  li = (( layer[i] ).succlist) /*;li;;*/ ; j = 0;  sign = 1; while (li) { /*;;
 (i<=maxdepth));;*/ gs_ide1025 [j] = gs_ide1035 ((( li )->node) /*;(i<=maxdepth));;*/ ); /*;;
 cclist) /+;R/SC;yy+NT ;;*/   if ((sign<0) && (gs_ide1025 [j]>=0)) gs_ide1026 [j]=1;  else gs_ide1026 [j]= MAXINT; /*;cclist) /+;R/SC;yy+NT ;
@@ -489,7 +536,7 @@ static int gs_ide1034 (int i,int dir)
 #else
 static int gs_ide1034 (i,dir) int i; int dir;
 #endif
-{ GNLIST li; int j; int sign; ; assert((i>0)); gs_ide1040 (i); li = (( layer[i] ).succlist) /*;
+{ GNLIST li; int j; int sign; ; assert((i>0)); if (layer_is_placed(i)) return(0); gs_ide1040 (i); li = (( layer[i] ).succlist) /*;
 li;;*/ ; j = 0;  sign = 1; while (li) { gs_ide1025 [j] = gs_ide1033 ((( li )->node) /*;
 (i>0));;*/ );  if ((sign<0) && (gs_ide1025 [j]>=0)) gs_ide1026 [j]=1; /*;cclist) /+;R/SC;yy+NT ;
 j = 0; ;*/   else gs_ide1026 [j]= MAXINT; if (gs_ide1025 [j]<0) sign = -1; else sign = 1; /*;j = 0; 
@@ -504,7 +551,7 @@ static int gs_ide1032 (int i,int dir)
 #else
 static int gs_ide1032 (i,dir) int i; int dir;
 #endif
-{ GNLIST li, li1; int j; int sign; GNODE lnode, node, rnode; ; assert((i<=maxdepth)); /*;{
+{ GNLIST li, li1; int j; int sign; GNODE lnode, node, rnode; ; assert((i<=maxdepth)); if (layer_is_placed(i)) return(0); /*;{
 li, li1;;*/ gs_ide1040 (i); li = (( layer[i] ).succlist) /*;int j;;*/ ; j = 0;  sign = 1; /*;ode, rnode;
 ;;*/ lnode = NULL; while (li) { node = (( li )->node) /*;;;*/ ; if ((( node )->width) /*;
 cclist) /+;R/SC;yy+NT ;;*/ ==0) { li1 = (( li )->next) /*;j = 0; ;*/ ; /*;1;
@@ -590,7 +637,7 @@ static int gs_ide1005 (int i)
 static int gs_ide1005 (i) int i;
 #endif
 { GNLIST li; int j, k, changed; int ldiff, rdiff; int smove, pmove; GNODE v,w,oldv; /*;int i;
-{;*/ int dist; ; assert((i>=0));
+{;*/ int dist; ; assert((i>=0)); if (layer_is_placed(i)) return(0);
 #ifdef DRAWDEBUG
 #ifdef NEVER
 PRINTF("Before correct priority nodes line %d\n", i); PRINTF("Enter CR into the text window\n"); /*;ve, pmove;
@@ -916,7 +963,7 @@ static int gs_ide1000 (int i)
 static int gs_ide1000 (i) int i;
 #endif
 { GNLIST li, li1; int j; int changed; int dir; GNODE lnode, node, rnode; /*;int i;
-{;*/ ; gs_ide1040 (i); li = (( layer[i] ).succlist) /*;int j;;*/ ; j = 0; /*;int dir;
+{;*/ ; if (layer_is_placed(i)) return(0); gs_ide1040 (i); li = (( layer[i] ).succlist) /*;int j;;*/ ; j = 0; /*;int dir;
 node, node, rnode;;*/   dir = 0; lnode = NULL; while (li) { node = (( li )->node) /*;040 (i);
 ;*/ ; if ((( node )->width) /*;i] ).succlist) /+;R/SC;yy+NT ;;*/ ==0) { /*;i] ).succlist) /+;R/SC;yy+NT ;
 j = 0; ;*/ li1 = (( li )->next) /*;j = 0; ;*/ ; rnode = NULL; while (li1) { if ((( (( li1 )->node) /*;
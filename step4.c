@@ -318,6 +318,29 @@ yy+NT ;;*/ } gs_ide1515 (i, maxrow, topbendp, botbendp); } gs_ide1515 (maxdepth+
 int gs_ide1535 ; ;*/   static DLLIST gs_ide1527 = NULL;  static DLLIST gs_ide1538 = NULL; /*; ; 
 static int gs_ide1531 ; ;*/   static DLLIST gs_ide1539 = NULL;  static int gs_ide1540 ; static int gs_ide1528 ; /*;int gs_ide1530 ; 
 gs_ide1526 = NULL; ;*/ 
+/*  Active horizontal segments of a channel
+ *  ---------------------------------------
+ *  The sweep over a channel keeps the horizontal segments that are
+ *  currently open in two lists: gs_ide1526 for the edges that run
+ *  to the right, gs_ide1538 for the edges that run to the left.
+ *  DNX is the right end of a segment, DINFO its row. A new segment
+ *  gets a row above the rows of all open segments of its list, thus
+ *  the rows increase along a list, and the highest row is that of
+ *  the last cell.
+ *  At each event, the segments whose right end is passed are closed.
+ *  For channels with hundreds of parallel edges, scanning the whole
+ *  list for them at each event was quadratic. Instead, each list has
+ *  a binary heap of its cells, ordered by DNX, such that closing a
+ *  segment costs a logarithmic time.
+ */
+
+static struct seg_heap {
+	DLLIST	*cell;		/* the cells, heap ordered by DNX */
+	int	top;		/* number of cells                */
+	int	size;		/* allocated size                 */
+} gs_rsegs = { NULL, 0, 0 }, gs_lsegs = { NULL, 0, 0 };
+
+
 #ifdef ANSI_C
 static int gs_ide1516 (int level)
 #else
@@ -325,7 +348,7 @@ static int gs_ide1516 (level) int level;
 #endif
 { GNLIST li1, li2; ADJEDGE a1, a2; ; assert((level>=0)); assert((level<=maxdepth)); /*;int level;
 {;*/   gs_ide1536 = gs_ide1535 = 0; gs_ide1529 = gs_ide1531 = 0; gs_ide1526 = gs_ide1527 = NULL; /*;;
-;;*/ gs_ide1538 = gs_ide1539 = NULL; gs_ide1530 = 0; gs_ide1540 = -1; gs_ide1528 = -1; /*;35 = 0;
+;;*/ gs_ide1538 = gs_ide1539 = NULL; gs_rsegs.top = gs_lsegs.top = 0; gs_ide1530 = 0; gs_ide1540 = -1; gs_ide1528 = -1; /*;35 = 0;
 ;*/ li1 = (( layer[level] ).succlist) /*;;*/ ; li2 = (( layer[level+1] ).succlist) /*;
 gs_ide1526 = gs_ide1527 = NULL;;*/ ; a1 = NULL; while (li1 && (!a1)) { /*;gs_ide1540 = -1;
 528 = -1;;*/  a1 = (( (( li1 )->node) /*;gs_ide1540 = -1;;*/ )->succ) /*;gs_ide1540 = -1;
@@ -351,88 +374,240 @@ yy+NT ;;*/ ;  } } if (!a2) {  if (li2) li2 = (( li2 )->next) /*;{;*/ ; /*;{
 /SC;yy+NT )->succ) /+;R/SC;yy+NT ;;*/   while (li2 && (!a2)) { a2 = (( (( li2 )->node) /*;/SC;yy+NT ; ;*/ )->pred) /*;
 /SC;yy+NT ; ;*/ ; if (!a2) li2 = (( li2 )->next) /*;};*/ ;  } } } return(gs_ide1530 ); /*;{
 /SC;yy+NT )->pred) /+;R/SC;yy+NT ;;*/ }
+/*  Insert a cell into the heap of a list / remove the cell with the
+ *  smallest right end
+ *  ---------------------------------------------------------------
+ */
+
+#ifdef ANSI_C
+static void seg_push(struct seg_heap *h, DLLIST d)
+#else
+static void seg_push(h, d)
+struct seg_heap *h;
+DLLIST d;
+#endif
+{
+	DLLIST	*c;
+	int	i, j;
+
+	if (h->top >= h->size) {
+		h->size = (h->size ? 2*h->size : 256);
+		c = (DLLIST *)realloc(h->cell, h->size*sizeof(DLLIST));
+		if (!c) Fatal_error("memory exhausted","");
+		h->cell = c;
+	}
+	i = h->top++;
+	while (i > 0) {
+		j = (i-1)/2;
+		if (DNX(h->cell[j]) <= DNX(d)) break;
+		h->cell[i] = h->cell[j];
+		i = j;
+	}
+	h->cell[i] = d;
+}
+
+
+#ifdef ANSI_C
+static DLLIST seg_pop(struct seg_heap *h)
+#else
+static DLLIST seg_pop(h)
+struct seg_heap *h;
+#endif
+{
+	DLLIST	d, last;
+	int	i, j;
+
+	assert((h->top > 0));
+	d = h->cell[0];
+	last = h->cell[--h->top];
+	i = 0;
+	for (;;) {
+		j = 2*i+1;
+		if (j >= h->top) break;
+		if ((j+1 < h->top) && (DNX(h->cell[j+1]) < DNX(h->cell[j]))) j++;
+		if (DNX(last) <= DNX(h->cell[j])) break;
+		h->cell[i] = h->cell[j];
+		i = j;
+	}
+	if (h->top) h->cell[i] = last;
+	return(d);
+}
+
+
+/*  Sweep events of a channel
+ *  -------------------------
+ *  gs_ide1518 is the event of a source port at xpos: the segments of
+ *  the edges that leave there to the right are opened, and the left
+ *  running segments that end before xpos are closed. gs_ide1517 is the
+ *  symmetric event of a target port.
+ */
+
 #ifdef ANSI_C
 static void gs_ide1518 (GNODE v, int xpos)
 #else
-static void gs_ide1518 (v, xpos) GNODE v; int xpos;
+static void gs_ide1518 (v, xpos)
+GNODE v;
+int xpos;
 #endif
-{ ADJEDGE a; GEDGE ee; DLLIST n,m; int k; ; assert((v)); k = gs_ide1531 + gs_ide1529 ; /*; a;
-/+D/+ ee;;*/ if (k>gs_ide1530 ) gs_ide1530 = k; if (xpos<=gs_ide1540 ) return; gs_ide1540 = xpos; /*;int k;
-;;*/ a = (( v )->succ) /*;;;*/ ; while (a) { ee = (( a )->kante) /*; + gs_ide1529 ;
-;*/ ; if (((( ee )->sxloc) /*;_ide1530 = k;;*/ ==xpos) && ((( ee )->exloc) /*;
-_ide1530 = k;;*/ > (( ee )->sxloc) /*;_ide1530 = k;;*/ )) { gs_ide1500 (ee,((( (( a )->kante) /*;
-n;;*/ )->end) /*;n;;*/ ) /*;n;;*/ ); } a = (( a )->next) /*;v )->succ) /+;
-R/SC;yy+NT ;;*/ ; } k = gs_ide1531 + gs_ide1529 ; if (k>gs_ide1530 ) gs_ide1530 = k; /*;sxloc) /+;R/SC;yy+NT ==xpos) && ((( ee 
-a )->kante) /+;R/SC;yy+NT )->end) /+;R;*/ n = gs_ide1538 ; while (n) { m = (( n )->succ) /*;a )->next) /+;R/SC;
-yy+NT ;;*/ ; if ((( n )->dlx) /*;};*/ <= xpos) gs_ide1514 (n); n = m; /*;30 ) gs_ide1530 = k;
-n = gs_ide1538 ;;*/  } gs_ide1531 = 0; n = gs_ide1538 ; while (n) { if ((( n )->dlinfo) /*;
-/SC;yy+NT <= xpos) gs_ide1514 (n);;*/ > gs_ide1531 ) gs_ide1531 = (( n )->dlinfo) /*;
-/SC;yy+NT <= xpos) gs_ide1514 (n);;*/ ; n = (( n )->succ) /*;n = m;;
-*/ ; } }
+{
+	ADJEDGE a;
+	GEDGE ee;
+	int k;
+
+	assert((v));
+	k = gs_ide1531 + gs_ide1529;
+	if (k>gs_ide1530) gs_ide1530 = k;
+	if (xpos<=gs_ide1540) return;
+	gs_ide1540 = xpos;
+
+	a = NSUCC(v);
+	while (a) {
+		ee = AKANTE(a);
+		if ((ESTARTX(ee)==xpos) && (EENDX(ee)>ESTARTX(ee)))
+			gs_ide1500(ee, EEND(ee));
+		a = ANEXT(a);
+	}
+	k = gs_ide1531 + gs_ide1529;
+	if (k>gs_ide1530) gs_ide1530 = k;
+
+	while (gs_lsegs.top && (DNX(gs_lsegs.cell[0]) <= xpos))
+		gs_ide1514(seg_pop(&gs_lsegs));
+	gs_ide1531 = (gs_ide1539 ? DINFO(gs_ide1539) : 0);
+}
+
+
 #ifdef ANSI_C
-static void gs_ide1517 (GNODE v,int xpos)
+static void gs_ide1517 (GNODE v, int xpos)
 #else
-static void gs_ide1517 (v, xpos) GNODE v; int xpos;
+static void gs_ide1517 (v, xpos)
+GNODE v;
+int xpos;
 #endif
-{ ADJEDGE a; GEDGE ee; DLLIST n,m; int k; ; assert((v)); k = gs_ide1531 + gs_ide1529 ; /*; a;
-/+D/+ ee;;*/ if (k>gs_ide1530 ) gs_ide1530 = k; if (xpos<=gs_ide1528 ) return; gs_ide1528 = xpos; /*;int k;
-;;*/ a = (( v )->pred) /*;;;*/ ; while (a) { ee = (( a )->kante) /*; + gs_ide1529 ;
-;*/ ; if (((( ee )->exloc) /*;_ide1530 = k;;*/ ==xpos) && ((( ee )->exloc) /*;
-_ide1530 = k;;*/ <= (( ee )->sxloc) /*;_ide1530 = k;;*/ )) { gs_ide1501 (ee,((( (( a )->kante) /*;
-n;;*/ )->start) /*;n;;*/ ) /*;n;;*/ ); } a = (( a )->next) /*;v )->pred) /+;
-R/SC;yy+NT ;;*/ ; } k = gs_ide1531 + gs_ide1529 ; if (k>gs_ide1530 ) gs_ide1530 = k; /*;exloc) /+;R/SC;yy+NT ==xpos) && ((( ee 
-a )->kante) /+;R/SC;yy+NT )->start) /+;*/ n = gs_ide1526 ; while (n) { m = (( n )->succ) /*;a )->next) /+;R/SC;
-yy+NT ;;*/ ; if ((( n )->dlx) /*;};*/ <= xpos) gs_ide1513 (n); n = m; /*;30 ) gs_ide1530 = k;
-n = gs_ide1526 ;;*/  } gs_ide1529 = 0; n = gs_ide1526 ; while (n) { if ((( n )->dlinfo) /*;
-/SC;yy+NT <= xpos) gs_ide1513 (n);;*/ > gs_ide1529 ) gs_ide1529 = (( n )->dlinfo) /*;
-/SC;yy+NT <= xpos) gs_ide1513 (n);;*/ ; n = (( n )->succ) /*;n = m;;
-*/ ; } }
+{
+	ADJEDGE a;
+	GEDGE ee;
+	int k;
+
+	assert((v));
+	k = gs_ide1531 + gs_ide1529;
+	if (k>gs_ide1530) gs_ide1530 = k;
+	if (xpos<=gs_ide1528) return;
+	gs_ide1528 = xpos;
+
+	a = NPRED(v);
+	while (a) {
+		ee = AKANTE(a);
+		if ((EENDX(ee)==xpos) && (EENDX(ee)<=ESTARTX(ee)))
+			gs_ide1501(ee, ESTART(ee));
+		a = ANEXT(a);
+	}
+	k = gs_ide1531 + gs_ide1529;
+	if (k>gs_ide1530) gs_ide1530 = k;
+
+	while (gs_rsegs.top && (DNX(gs_rsegs.cell[0]) <= xpos))
+		gs_ide1513(seg_pop(&gs_rsegs));
+	gs_ide1529 = (gs_ide1527 ? DINFO(gs_ide1527) : 0);
+}
+
+
+/*  Open a left running segment
+ *  ---------------------------
+ */
+
 #ifdef ANSI_C
 static void gs_ide1501 (GEDGE e, GNODE n)
 #else
-static void gs_ide1501 (e, n) GEDGE e; GNODE n;
+static void gs_ide1501 (e, n)
+GEDGE e;
+GNODE n;
 #endif
-{ DLLIST d; assert((n)); ; d = dllist_alloc(n,gs_ide1539 ); if (!gs_ide1538 ) gs_ide1538 = d; /*;;
-{;*/ if (gs_ide1539 ) (( gs_ide1539 )->succ) /*;{;*/ = d; gs_ide1539 = d; /*;assert((n));
-;;*/  gs_ide1536 ++; if ((( e )->sxloc) /*;;;*/ !=(( e )->exloc) /*;;;*/ ) gs_ide1531 ++; /*;;
-ist_alloc(n,gs_ide1539 );;*/ (( d )->dlinfo) /*;ist_alloc(n,gs_ide1539 );;*/ = gs_ide1531 ; (( e )->btyloc) /*;
-8 ) gs_ide1538 = d;;*/ = gs_ide1531 ; (( d )->dlx) /*;s_ide1539 )->succ) /+;
-R/SC;yy+NT = d;;*/ = (( e )->sxloc) /*;s_ide1539 )->succ) /+;R/SC;yy+NT = d;
-;*/ ;  }
+{
+	DLLIST d;
+
+	assert((n));
+	d = dllist_alloc(n, gs_ide1539);
+	if (!gs_ide1538) gs_ide1538 = d;
+	if (gs_ide1539) DSUCC(gs_ide1539) = d;
+	gs_ide1539 = d;
+	gs_ide1536++;
+	if (ESTARTX(e)!=EENDX(e)) gs_ide1531++;
+	DINFO(d) = gs_ide1531;
+	ETBENDY(e) = gs_ide1531;
+	DNX(d) = ESTARTX(e);
+	seg_push(&gs_lsegs, d);
+}
+
+
+/*  Open a right running segment
+ *  ----------------------------
+ */
+
 #ifdef ANSI_C
 static void gs_ide1500 (GEDGE e, GNODE n)
 #else
-static void gs_ide1500 (e, n) GEDGE e; GNODE n;
+static void gs_ide1500 (e, n)
+GEDGE e;
+GNODE n;
 #endif
-{ DLLIST d; assert((n)); ; d = dllist_alloc(n,gs_ide1527 ); if (!gs_ide1526 ) gs_ide1526 = d; /*;;
-{;*/ if (gs_ide1527 ) (( gs_ide1527 )->succ) /*;{;*/ = d; gs_ide1527 = d; /*;assert((n));
-;;*/  gs_ide1535 ++; if ((( e )->sxloc) /*;;;*/ !=(( e )->exloc) /*;;;*/ ) gs_ide1529 ++; /*;;
-ist_alloc(n,gs_ide1527 );;*/ (( d )->dlinfo) /*;ist_alloc(n,gs_ide1527 );;*/ = gs_ide1529 ; (( e )->btyloc) /*;
-6 ) gs_ide1526 = d;;*/ = gs_ide1529 ; (( d )->dlx) /*;s_ide1527 )->succ) /+;
-R/SC;yy+NT = d;;*/ = (( e )->exloc) /*;s_ide1527 )->succ) /+;R/SC;yy+NT = d;
-;*/ ;  }
+{
+	DLLIST d;
+
+	assert((n));
+	d = dllist_alloc(n, gs_ide1527);
+	if (!gs_ide1526) gs_ide1526 = d;
+	if (gs_ide1527) DSUCC(gs_ide1527) = d;
+	gs_ide1527 = d;
+	gs_ide1535++;
+	if (ESTARTX(e)!=EENDX(e)) gs_ide1529++;
+	DINFO(d) = gs_ide1529;
+	ETBENDY(e) = gs_ide1529;
+	DNX(d) = EENDX(e);
+	seg_push(&gs_rsegs, d);
+}
+
+
+/*  Close a left running segment
+ *  ----------------------------
+ */
+
 #ifdef ANSI_C
 static void gs_ide1514 (DLLIST x)
 #else
-static void gs_ide1514 (x) DLLIST x;
+static void gs_ide1514 (x)
+DLLIST x;
 #endif
-{ assert((x)); assert(((( x )->node) /*;};*/ )); ; if ((( x )->pred) /*;
-_ide1514 (x);*/ ) (( (( x )->pred) /*;_ide1514 (x);*/ )->succ) /*;_ide1514 (x);
-*/ = (( x )->succ) /*;_ide1514 (x);*/ ; else gs_ide1538 = (( x )->succ) /*;
-DLLIST x;;*/ ; if ((( x )->succ) /*;{;*/ ) (( (( x )->succ) /*;{;*/ )->pred) /*;
-{;*/ = (( x )->pred) /*;{;*/ ; else gs_ide1539 = (( x )->pred) /*;(x));
-;*/ ; dllist_free(x); gs_ide1536 --; }
+{
+	assert((x));
+	assert((DNODE(x)));
+	if (DPRED(x)) DSUCC(DPRED(x)) = DSUCC(x);
+	else gs_ide1538 = DSUCC(x);
+	if (DSUCC(x)) DPRED(DSUCC(x)) = DPRED(x);
+	else gs_ide1539 = DPRED(x);
+	dllist_free(x);
+	gs_ide1536--;
+}
+
+
+/*  Close a right running segment
+ *  -----------------------------
+ */
+
 #ifdef ANSI_C
 static void gs_ide1513 (DLLIST x)
 #else
-static void gs_ide1513 (x) DLLIST x;
+static void gs_ide1513 (x)
+DLLIST x;
 #endif
-{ assert((x)); assert(((( x )->node) /*;};*/ )); ; if ((( x )->pred) /*;
-_ide1513 (x);*/ ) (( (( x )->pred) /*;_ide1513 (x);*/ )->succ) /*;_ide1513 (x);
-*/ = (( x )->succ) /*;_ide1513 (x);*/ ; else gs_ide1526 = (( x )->succ) /*;
-DLLIST x;;*/ ; if ((( x )->succ) /*;{;*/ ) (( (( x )->succ) /*;{;*/ )->pred) /*;
-{;*/ = (( x )->pred) /*;{;*/ ; else gs_ide1527 = (( x )->pred) /*;(x));
-;*/ ; dllist_free(x); gs_ide1535 --; }
+{
+	assert((x));
+	assert((DNODE(x)));
+	if (DPRED(x)) DSUCC(DPRED(x)) = DSUCC(x);
+	else gs_ide1526 = DSUCC(x);
+	if (DSUCC(x)) DPRED(DSUCC(x)) = DPRED(x);
+	else gs_ide1527 = DPRED(x);
+	dllist_free(x);
+	gs_ide1535--;
+}
 #ifdef ANSI_C
 static void gs_ide1515 (int level, int maxr, int miny, int maxy)
 #else
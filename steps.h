@@ -97,6 +97,10 @@ extern	int    	maxdepth;
 extern int     max_nodes_per_layer;
 extern int     nr_crossings;
 
+/* from layerdata.c */
+extern int     layer_data_valid;
+extern int     *layer_pos;
+
 /* from step3.c */
 extern GNLIST *tpred_connection1;
 extern GNLIST *tpred_connection2;
@@ -154,11 +158,56 @@ void    db_output_layer		_PP((int i));
 int 	db_check_proper     	_PP((GNODE v,int level));
 #endif
 
+/* from layerdata.c */
+void	build_layer_data	_PP((DEPTH *l));
+void	invalidate_layer_data	_PP((void));
+double	ld_predbary		_PP((GNODE node));
+double	ld_succbary		_PP((GNODE node));
+double	ld_predmedian		_PP((GNODE node));
+double	ld_succmedian		_PP((GNODE node));
+void	ld_sort_bary		_PP((GNODE *a, int n));
+int	ld_parallel		_PP((int n));
+void	ld_weights		_PP((GNODE *a, int n, int w1, int w2));
+
+/* The weights for ld_weights */
+#define LD_NOWEIGHT	(-1)
+#define LD_PREDBARY	0
+#define LD_SUCCBARY	1
+#define LD_PREDMEDIAN	2
+#define LD_SUCCMEDIAN	3
+int	bilayer_crossings	_PP((GNLIST upper, GNLIST lower));
+
+/* from ranking.c */
+void	simplex_ranking		_PP((void));
+
+/* from incrlayout.c */
+void	remember_layer_order	_PP((DEPTH *l));
+void	seed_layer_order	_PP((DEPTH *l));
+int	layer_is_frozen		_PP((int i));
+void	warm_start_seed		_PP((void));
+void	warm_start_unseed	_PP((void));
+int	warm_start_active	_PP((void));
+void	warm_start_restore	_PP((DEPTH *l));
+int	warm_start_missed	_PP((void));
+void	warm_start_place	_PP((void));
+int	layer_is_placed		_PP((int i));
+void	warm_start_reset	_PP((void));
+void	warm_start_store	_PP((void));
+
+/* Set the position of a node in step2. The copy in the layer data
+ * must be updated, too.
+ */
+#define set_position(v,p) { NPOS(v) = (p); \
+		if (layer_data_valid) layer_pos[NSLOT(v)] = NPOS(v); }
+
 /* from step3.c */
 void    step3_main              _PP((void));
 void    calc_all_node_sizes     _PP((void));
 void 	alloc_levelshift	_PP((void));
 
+/* from bkplace.c */
+void	bk_coordinates		_PP((void));
+
 
 /* from step4.c */
 void    step4_main              _PP((void));
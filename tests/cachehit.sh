@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# cachehit.sh <vcgbatch> [n]
+#
+# Lays out a random graph of n nodes (default 1000) twice with -cache.
+# The second run replays the cache entry. It must report the same
+# numbers of nodes, dummy nodes, edge segments and crossings, and write
+# the same layout as the first run, up to the names of the internal
+# nodes. The graph has back edges, parallel edges and edges between
+# nodes of the same level.
+#
+
+vcgbatch=${1:?usage: cachehit.sh <vcgbatch> [n]}
+n=${2:-1000}
+tmp=${TMPDIR:-/tmp}/cachehit.$$
+fail=0
+
+mkdir -p "$tmp/cache" "$tmp/1" "$tmp/2" || exit 1
+trap 'rm -rf "$tmp"' 0
+
+awk -v n="$n" 'BEGIN {
+	s = 12345;
+	print "graph: {";
+	for (i=0; i<n; i++) print "node: { title: \"n" i "\" }";
+	for (i=1; i<n; i++) {
+		s = (s*1103515245 + 12345) % 2147483648;
+		print "edge: { sourcename: \"n" int(s/65536)%i "\" targetname: \"n" i "\" }";
+		if (s%5 == 0) print "edge: { sourcename: \"n" i "\" targetname: \"n" int(s/256)%i "\" }";
+		if (s%7 == 0) print "edge: { sourcename: \"n" int(s/65536)%i "\" targetname: \"n" i "\" }";
+	}
+	print "}";
+}' > "$tmp/g.gdl"
+
+for r in 1 2; do
+	if ! "$vcgbatch" -cache "$tmp/cache" -layoutdir "$tmp/$r" "$tmp/g.gdl" \
+	       > "$tmp/log$r" 2>&1; then
+		echo "FAIL  run $r"
+		cat "$tmp/log$r"
+		exit 1
+	fi
+	sed -n 's/^.*g.gdl: \([^;]*\).*$/\1/p' "$tmp/log$r" > "$tmp/stat$r"
+	sed 's/_int[a-z0-9]*_[0-9]*//g' "$tmp/$r/g.gdl.layout" | sort \
+		> "$tmp/lay$r"
+done
+
+if [ "$(ls "$tmp/cache" | wc -l)" -ne 1 ]; then
+	echo "FAIL  cache entry not written"; fail=1
+elif ! cmp -s "$tmp/stat1" "$tmp/stat2"; then
+	echo "FAIL  statistics: $(cat "$tmp/stat1") / $(cat "$tmp/stat2")"
+	fail=1
+elif ! cmp -s "$tmp/lay1" "$tmp/lay2"; then
+	echo "FAIL  layout of the hit differs"; fail=1
+else
+	echo "ok    cache hit $n: $(cat "$tmp/stat2")"
+fi
+exit $fail
@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# deepchain.sh <vcgbatch> [n]
+#
+# Lays out a chain of n nodes (default 1000000) with the stack limited
+# to 8 MB, the usual default on Linux. Each depth first search of
+# step1 recursed once per node before, which overflowed the stack far
+# below this size (-d maxdepth already at 200000 nodes).
+#
+# The chain is laid out open and closed to a cycle (one strongly
+# connected component), each with the default layout algorithm and
+# with -d maxdepth. A run fails if vcgbatch does not exit with 0 or
+# does not write the layout.
+#
+
+vcgbatch=${1:?usage: deepchain.sh <vcgbatch> [n]}
+n=${2:-1000000}
+dir=$(dirname "$0")
+tmp=${TMPDIR:-/tmp}/deepchain.$$
+fail=0
+
+mkdir -p "$tmp" || exit 1
+trap 'rm -rf "$tmp"' 0
+
+sh "$dir/genchain.sh" "$n"       > "$tmp/chain.gdl"
+sh "$dir/genchain.sh" "$n" cycle > "$tmp/cycle.gdl"
+
+for g in chain cycle; do
+	for opt in "" "-d maxdepth"; do
+		rm -f "$tmp/$g.gdl.layout"
+		if (ulimit -s 8192 && "$vcgbatch" -layoutdir "$tmp" $opt \
+		      "$tmp/$g.gdl" > "$tmp/log" 2>&1) \
+		   && [ -s "$tmp/$g.gdl.layout" ]; then
+			echo "ok    $g $n ${opt:-default}"
+		else
+			echo "FAIL  $g $n ${opt:-default}"
+			cat "$tmp/log"
+			fail=1
+		fi
+	done
+done
+exit $fail
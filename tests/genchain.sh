@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# genchain.sh <n> [cycle]
+#
+# Writes a GDL graph to stdout that is a chain of <n> nodes
+# 0 -> 1 -> ... -> n-1. With "cycle", the edge n-1 -> 0 closes the
+# chain to one strongly connected component of n nodes.
+#
+# The depth of the chain is the recursion depth the depth first
+# searches of step1 had before they used explicit stacks.
+#
+
+n=${1:-1000000}
+cycle=${2:-}
+
+awk -v n="$n" -v cycle="$cycle" 'BEGIN {
+	print "graph: {"
+	for (i = 0; i < n; i++)
+		printf("node: { title: \"%d\" }\n", i)
+	for (i = 0; i + 1 < n; i++)
+		printf("edge: { sourcename: \"%d\" targetname: \"%d\" }\n", i, i+1)
+	if (cycle == "cycle")
+		printf("edge: { sourcename: \"%d\" targetname: \"0\" }\n", n-1)
+	print "}"
+}'
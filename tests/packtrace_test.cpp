@@ -0,0 +1,273 @@
+/*
+
+    Test of the packed trace events (PTT_READ_TRACE_PACKED)
+
+    idadbg.h is included as by the PIN tool, but without pin.H: the
+    two types it takes from PIN are defined here. The coding functions
+    use nothing else of PIN or IDA.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned long long ADDRINT;
+typedef unsigned int OS_THREAD_ID;
+
+#include "../idadbg.h"
+
+static int nfailed = 0;
+
+#define CHECK(cond)                                                   \
+  do                                                                  \
+  {                                                                   \
+    if ( !(cond) )                                                    \
+    {                                                                 \
+      fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+      nfailed++;                                                      \
+    }                                                                 \
+  } while ( 0 )
+
+//--------------------------------------------------------------------------
+// xorshift64*, thus the batches are the same on every run
+static uint64 rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64 rnd(void)
+{
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64 rnd(uint64 n)
+{
+  return rnd() % n;
+}
+
+static idatrace_data_t events[TRACE_EVENTS_SIZE];
+static idatrace_data_t decoded[TRACE_EVENTS_SIZE];
+static uchar buf[TRACE_EVENTS_SIZE * TRACE_PACKED_EVENT_MAX];
+
+//--------------------------------------------------------------------------
+// the next ea: mostly small steps, sometimes jumps anywhere or to the
+// ends of the address space
+static uint64 next_ea(uint64 ea)
+{
+  switch ( rnd(8) )
+  {
+    case 0:  return rnd();                  // large jump
+    case 1:  return rnd(16);                // near 0
+    case 2:  return ~uint64(0) - rnd(16);   // near ~0
+    case 3:  return ea - rnd(64);           // backward, may wrap
+    default: return ea + 1 + rnd(15);       // next instruction
+  }
+}
+
+static uint64 next_reg(uint64 r)
+{
+  switch ( rnd(10) )
+  {
+    case 0:  return rnd();
+    case 1:  return ~uint64(0);
+    case 2:  return r - rnd(256);
+    case 3:  return r + rnd(256);
+    default: return r;                      // unchanged
+  }
+}
+
+//--------------------------------------------------------------------------
+// n events of up to nthreads threads, in runs of random length
+static void make_batch(size_t n, int nthreads, bool with_regs)
+{
+  uint64 ea = rnd();
+  idapin_registers_t regs;
+  init_trace_regs(&regs, ea);
+  OS_THREAD_ID tid = OS_THREAD_ID(rnd());
+  for ( size_t i = 0; i < n; i++ )
+  {
+    if ( nthreads > 1 && rnd(6) == 0 )
+      tid = OS_THREAD_ID(1000 + rnd(nthreads));
+    ea = next_ea(ea);
+    idatrace_data_t &ev = events[i];
+    memset(&ev, 0, sizeof(ev));
+    ev.ea = ea;
+    ev.tid = tid;
+    ev.type = uint32(rnd(tev_max));
+    if ( with_regs )
+    {
+      uint64 *r = (uint64 *)&regs;
+      for ( size_t j = 0; j < TRACE_NREGS; j++ )
+        r[j] = next_reg(r[j]);
+      regs.eip = ea;
+      ev.registers = regs;
+    }
+    else
+    {
+      init_trace_regs(&ev.registers, ea);
+    }
+  }
+}
+
+static bool same_event(const idatrace_data_t &a, const idatrace_data_t &b)
+{
+  return a.ea == b.ea
+      && a.tid == b.tid
+      && a.type == b.type
+      && memcmp(&a.registers, &b.registers, sizeof(a.registers)) == 0;
+}
+
+//--------------------------------------------------------------------------
+static void test_round_trip(size_t n, int nthreads, bool with_regs)
+{
+  make_batch(n, nthreads, with_regs);
+  size_t size = pack_trace_events(buf, events, n, with_regs);
+  CHECK(size <= n * TRACE_PACKED_EVENT_MAX);
+  int got = unpack_trace_events(decoded, TRACE_EVENTS_SIZE, buf, size, with_regs);
+  CHECK(got == int(n));
+  for ( size_t i = 0; got == int(n) && i < n; i++ )
+  {
+    if ( !same_event(events[i], decoded[i]) )
+    {
+      fprintf(stderr, "event %u of %u differs (threads %d, regs %d)\n",
+              unsigned(i), unsigned(n), nthreads, with_regs);
+      nfailed++;
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+// Every event in its own run, every delta as large as possible: each
+// event must still fit into TRACE_PACKED_EVENT_MAX bytes.
+static void test_event_max(bool with_regs)
+{
+  const size_t n = TRACE_EVENTS_SIZE;
+  for ( size_t i = 0; i < n; i++ )
+  {
+    idatrace_data_t &ev = events[i];
+    ev.ea = (i & 1) != 0 ? 0 : uint64(1) << 63;
+    ev.tid = OS_THREAD_ID(0xFFFFFFFF - (i & 1));
+    ev.type = 0xFF;
+    uint64 *r = (uint64 *)&ev.registers;
+    for ( size_t j = 0; j < TRACE_NREGS; j++ )
+      r[j] = ~uint64(0) >> 1;   // furthest from BADADDR, the start value
+    if ( !with_regs )
+      init_trace_regs(&ev.registers, ev.ea);
+  }
+  size_t size = pack_trace_events(buf, events, n, with_regs);
+  CHECK(size <= n * TRACE_PACKED_EVENT_MAX);
+  for ( size_t i = 1; i <= 3; i++ )
+    CHECK(pack_trace_events(buf, events, i, with_regs) <= i * TRACE_PACKED_EVENT_MAX);
+  int got = unpack_trace_events(decoded, n, buf, size, with_regs);
+  CHECK(got == int(n));
+  if ( got == int(n) )
+    CHECK(same_event(events[n-1], decoded[n-1]));
+}
+
+//--------------------------------------------------------------------------
+// A truncated buffer is malformed unless it ends exactly after a run;
+// then it gives the events before that point, fewer than the count of
+// idatrace_packed_t.
+static void test_truncated(bool with_regs)
+{
+  const size_t n = 200;
+  make_batch(n, 3, with_regs);
+  size_t size = pack_trace_events(buf, events, n, with_regs);
+
+  // the sizes of the prefixes that end after a run
+  static size_t run_end[TRACE_EVENTS_SIZE+1];
+  static size_t run_events[TRACE_EVENTS_SIZE+1];
+  static uchar prefix[TRACE_EVENTS_SIZE * TRACE_PACKED_EVENT_MAX];
+  size_t nruns = 0;
+  for ( size_t i = 1; i <= n; i++ )
+  {
+    if ( i == n || events[i].tid != events[i-1].tid )
+    {
+      run_end[nruns] = pack_trace_events(prefix, events, i, with_regs);
+      run_events[nruns] = i;
+      nruns++;
+    }
+  }
+  CHECK(nruns > 1 && run_end[nruns-1] == size);
+
+  size_t r = 0;
+  for ( size_t len = 1; len < size; len++ )
+  {
+    int got = unpack_trace_events(decoded, n, buf, len, with_regs);
+    while ( r < nruns && run_end[r] < len )
+      r++;
+    if ( r < nruns && run_end[r] == len )
+      CHECK(got == int(run_events[r]));
+    else
+      CHECK(got == -1);
+  }
+  CHECK(unpack_trace_events(decoded, n, buf, 0, with_regs) == 0);
+}
+
+//--------------------------------------------------------------------------
+// More events than the caller has room for
+static void test_over_count(bool with_regs)
+{
+  const size_t n = 100;
+  make_batch(n, 2, with_regs);
+  size_t size = pack_trace_events(buf, events, n, with_regs);
+  CHECK(unpack_trace_events(decoded, n, buf, size, with_regs) == int(n));
+  CHECK(unpack_trace_events(decoded, n-1, buf, size, with_regs) == -1);
+  CHECK(unpack_trace_events(decoded, 0, buf, size, with_regs) == -1);
+
+  // a run header with a count far beyond maxn
+  uchar *p = pack_uvarint(buf, 1234);
+  p = pack_uvarint(p, uint64(1) << 40);
+  *p++ = tev_insn;
+  p = pack_svarint(p, 0x1000);
+  CHECK(unpack_trace_events(decoded, n, buf, p - buf, with_regs) == -1);
+}
+
+//--------------------------------------------------------------------------
+static void test_malformed(void)
+{
+  // a varint with more than 64 bits
+  memset(buf, 0x80, 11);
+  buf[11] = 0;
+  CHECK(unpack_trace_events(decoded, 1, buf, 12, false) == -1);
+
+  // a register mask with bits beyond the last register
+  uchar *p = pack_uvarint(buf, 1);
+  p = pack_uvarint(p, 1);
+  *p++ = tev_insn;
+  p = pack_svarint(p, 0x1000);
+  p = pack_uvarint(p, uint64(1) << TRACE_NREGS);
+  CHECK(unpack_trace_events(decoded, 1, buf, p - buf, true) == -1);
+}
+
+//--------------------------------------------------------------------------
+int main(void)
+{
+  for ( int regs = 0; regs <= 1; regs++ )
+  {
+    bool with_regs = regs != 0;
+    test_round_trip(0, 1, with_regs);
+    test_round_trip(1, 1, with_regs);
+    for ( int i = 0; i < 200; i++ )
+    {
+      size_t n = size_t(1 + rnd(TRACE_EVENTS_SIZE));
+      test_round_trip(n, 1, with_regs);
+      test_round_trip(n, 1 + int(rnd(8)), with_regs);
+    }
+    test_round_trip(TRACE_EVENTS_SIZE, 64, with_regs);
+    test_event_max(with_regs);
+    test_truncated(with_regs);
+    test_over_count(with_regs);
+  }
+  test_malformed();
+
+  if ( nfailed != 0 )
+  {
+    printf("packtrace_test: %d checks failed\n", nfailed);
+    return 1;
+  }
+  printf("packtrace_test: ok\n");
+  return 0;
+}
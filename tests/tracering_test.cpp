@@ -0,0 +1,265 @@
+/*
+
+    Test of the trace rings of the application threads (idadbg_ring.h)
+
+    The rings use nothing of PIN but ATOMIC::OPS, PIN_Yield and the
+    CONTEXT of the registers: these are defined here by the GCC atomic
+    builtins and pthreads. The rest of the trace buffer (the quota of
+    instrumenter_t::tracebuf_is_full, the TLS of the threads) needs the
+    PIN kit and is not tested here.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+typedef unsigned long long ADDRINT;
+typedef unsigned int OS_THREAD_ID;
+
+#include "../idadbg.h"
+
+enum BARRIER_LD { BARRIER_LD_NEXT };
+enum BARRIER_ST { BARRIER_ST_PREV };
+enum BARRIER_CS { BARRIER_CS_NEXT };
+
+// as ATOMIC::OPS of PIN; Increment returns the previous value
+namespace ATOMIC
+{
+  struct OPS
+  {
+    template <typename T>
+    static T Load(volatile const T *p, BARRIER_LD = BARRIER_LD_NEXT)
+    {
+      return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+    template <typename T>
+    static void Store(volatile T *p, T v, BARRIER_ST = BARRIER_ST_PREV)
+    {
+      __atomic_store_n(p, v, __ATOMIC_RELEASE);
+    }
+    template <typename T>
+    static T Increment(volatile T *p, T inc, BARRIER_CS = BARRIER_CS_NEXT)
+    {
+      __atomic_fetch_add(&increments, 1, __ATOMIC_RELAXED);
+      return __atomic_fetch_add(p, inc, __ATOMIC_SEQ_CST);
+    }
+    static volatile long increments;
+  };
+  volatile long OPS::increments = 0;
+}
+
+struct CONTEXT
+{
+  ADDRINT ip;
+};
+
+static void PIN_Yield()
+{
+  sched_yield();
+}
+
+#include "../idadbg_ring.h"
+
+volatile uint64 trc_ring_t::seq_counter = 0;
+
+static inline void get_context_regs(const CONTEXT *ctx, idapin_registers_t *regs)
+{
+  init_trace_regs(regs, ctx->ip);
+  regs->eax = ~ctx->ip;
+}
+
+static int nfailed = 0;
+
+#define CHECK(cond)                                                   \
+  do                                                                  \
+  {                                                                   \
+    if ( !(cond) )                                                    \
+    {                                                                 \
+      fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+      nfailed++;                                                      \
+    }                                                                 \
+  } while ( 0 )
+
+static idatrace_events_t out;
+
+//--------------------------------------------------------------------------
+// the rings are sized from the trace buffer size
+static void test_capacity(void)
+{
+  trc_ring_t r1(1, 1);
+  CHECK(r1.capacity() == 16);
+  trc_ring_t r2(1, 1000);
+  CHECK(r2.capacity() == 1024);
+  trc_ring_t r3(1, 1024);
+  CHECK(r3.capacity() == 1024);
+  trc_ring_t r4(1, 1000000);
+  CHECK(r4.capacity() == 0x10000);
+
+  // a full ring refuses the event
+  for ( uint32 i = 0; i < r1.capacity(); i++ )
+    CHECK(r1.push(i, tev_insn, NULL));
+  CHECK(!r1.push(16, tev_insn, NULL));
+  CHECK(r1.size() == 16);
+  idatrace_data_t ev;
+  CHECK(r1.pop(&ev) && ev.ea == 0);
+  CHECK(r1.push(16, tev_insn, NULL));
+  r1.clear();
+  CHECK(r1.size() == 0 && !r1.pop(&ev));
+}
+
+//--------------------------------------------------------------------------
+// the registers come back only for the events that recorded them
+static void test_regs(void)
+{
+  trc_ring_t r(7, 64);
+  CONTEXT ctx;
+  ctx.ip = 0x1234;
+  CHECK(r.push(0x1000, tev_insn, NULL));
+  CHECK(r.push(0x1234, tev_call, &ctx));
+  idatrace_data_t ev;
+  CHECK(r.pop(&ev));
+  CHECK(ev.ea == 0x1000 && ev.tid == 7 && ev.type == tev_insn);
+  CHECK(ev.registers.eip == 0x1000 && ev.registers.eax == ~uint64(0));
+  CHECK(r.pop(&ev));
+  CHECK(ev.ea == 0x1234 && ev.type == tev_call);
+  CHECK(ev.registers.eax == ~uint64(0x1234));
+}
+
+//--------------------------------------------------------------------------
+// A thread that runs alone takes one number only. If two threads
+// alternate, an event comes before the events of the other thread that
+// were recorded earlier by less than SEQ_BATCH events.
+static void test_order(void)
+{
+  trc_ring_t a(1, 1024);
+  trc_ring_t b(2, 1024);
+  std::vector<trc_ring_t *> rings;
+  rings.push_back(&a);
+  rings.push_back(&b);
+  uint64 read_seq = trc_ring_t::next_seq();
+  long incr0 = ATOMIC::OPS::increments;
+
+  for ( int i = 0; i < 500; i++ )
+    CHECK(a.push(i, tev_insn, NULL));
+  CHECK(ATOMIC::OPS::increments == incr0 + 1);
+  CHECK(trc_ring_t::merge(rings, &read_seq, &out) == 500);
+  for ( uint32 i = 0; i < out.size; i++ )
+    CHECK(out.trace[i].ea == ADDRINT(i) && out.trace[i].tid == 1);
+
+  // A 40, B 40, A 40: at most SEQ_BATCH of the last ones of A pass B
+  const int N = 40;
+  for ( int i = 0; i < N; i++ )
+    CHECK(a.push(1000 + i, tev_insn, NULL));
+  for ( int i = 0; i < N; i++ )
+    CHECK(b.push(2000 + i, tev_insn, NULL));
+  for ( int i = 0; i < N; i++ )
+    CHECK(a.push(3000 + i, tev_insn, NULL));
+  CHECK(trc_ring_t::merge(rings, &read_seq, &out) == 3 * N);
+  int first_b = -1;
+  int early = 0;
+  ADDRINT prev_a = 0;
+  ADDRINT prev_b = 0;
+  for ( uint32 i = 0; i < out.size; i++ )
+  {
+    const idatrace_data_t &ev = out.trace[i];
+    if ( ev.tid == 2 )
+    {
+      CHECK(ev.ea == (prev_b == 0 ? 2000 : prev_b + 1));
+      prev_b = ev.ea;
+      if ( first_b < 0 )
+        first_b = int(i);
+    }
+    else
+    {
+      CHECK(prev_a == 0 || ev.ea > prev_a);
+      prev_a = ev.ea;
+      if ( first_b < 0 && ev.ea >= 3000 )
+        early++;
+    }
+  }
+  CHECK(first_b >= N);
+  CHECK(early <= int(trc_ring_t::SEQ_BATCH));
+  CHECK(!a.peek_seq(&read_seq) && !b.peek_seq(&read_seq));
+}
+
+//--------------------------------------------------------------------------
+// threads that record at the same time
+enum { NTHREADS = 8, NEVENTS = 200000 };
+
+static void *producer(void *ud)
+{
+  trc_ring_t *r = (trc_ring_t *)ud;
+  CONTEXT ctx;
+  for ( int i = 0; i < NEVENTS; i++ )
+  {
+    ctx.ip = i;
+    while ( !r->push(i, tev_insn, (i & 7) == 0 ? &ctx : NULL) )
+      PIN_Yield();
+  }
+  return NULL;
+}
+
+static void test_threads(void)
+{
+  std::vector<trc_ring_t *> rings;
+  pthread_t threads[NTHREADS];
+  for ( int t = 0; t < NTHREADS; t++ )
+    rings.push_back(new trc_ring_t(100 + t, 4096));
+  uint64 read_seq = trc_ring_t::next_seq();
+  long incr0 = ATOMIC::OPS::increments;
+  for ( int t = 0; t < NTHREADS; t++ )
+    pthread_create(&threads[t], NULL, producer, rings[t]);
+
+  int next_ea[NTHREADS] = { 0 };
+  long total = 0;
+  bool ok = true;
+  while ( ok && total < long(NTHREADS) * NEVENTS )
+  {
+    int n = trc_ring_t::merge(rings, &read_seq, &out);
+    for ( int i = 0; i < n; i++ )
+    {
+      const idatrace_data_t &ev = out.trace[i];
+      int t = int(ev.tid) - 100;
+      if ( t < 0 || t >= NTHREADS || ev.ea != ADDRINT(next_ea[t]) )
+      {
+        ok = false;
+        break;
+      }
+      if ( (ev.ea & 7) == 0 && ev.registers.eax != ~ev.ea )
+        ok = false;
+      next_ea[t]++;
+    }
+    total += n;
+    if ( n == 0 )
+      PIN_Yield();
+  }
+  for ( int t = 0; t < NTHREADS; t++ )
+    pthread_join(threads[t], NULL);
+  CHECK(ok);
+  CHECK(total == long(NTHREADS) * NEVENTS);
+  long incr = ATOMIC::OPS::increments - incr0;
+  CHECK(incr <= total / trc_ring_t::SEQ_BATCH + NTHREADS);
+  printf("tracering: %d threads, %ld events, %ld counter increments\n",
+         NTHREADS, total, incr);
+  for ( int t = 0; t < NTHREADS; t++ )
+    delete rings[t];
+}
+
+//--------------------------------------------------------------------------
+int main(void)
+{
+  test_capacity();
+  test_regs();
+  test_order();
+  test_threads();
+  if ( nfailed != 0 )
+  {
+    fprintf(stderr, "tracering: %d check(s) failed\n", nfailed);
+    return 1;
+  }
+  printf("tracering: ok\n");
+  return 0;
+}
@@ -66,6 +66,12 @@
 void    init_timelimit    _PP((int x));
 void    free_timelimit    _PP((void));
 int     test_timelimit    _PP((int perc));
+int     timelimit_exceeded _PP((void));
+
+void    anytime_begin     _PP((void));
+int     anytime_refine    _PP((void));
+int     anytime_pending   _PP((void));
+void    anytime_interrupt _PP((void));
 
 
 /*--------------------------------------------------------------------*/
@@ -78,6 +78,20 @@
 #ifndef TIMING_H
 #define TIMING_H
 
+#ifdef PHASE_TIMING
+
+/*  Phase timing for the batch driver and the GUI.
+ *  Each stop_time(x) closes the phase opened by the last start_time()
+ *  and records the elapsed wall and CPU time under the name x.
+ *  See profile.c.
+ */
+
+#include "profile.h"
+
+#define start_time()	phase_start_time()
+#define stop_time(x)	phase_stop_time(x)
+
+#else
 #ifndef CHECK_TIMING
 #define start_time() /**/
 #define stop_time(x) /**/
@@ -182,6 +196,7 @@ char *x;
 }
 
 #endif /* CHECK_TIMING */
+#endif /* PHASE_TIMING */
 
 #endif /* TIMING_H */
 
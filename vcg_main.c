@@ -136,10 +136,14 @@
 #include "fisheye.h"
 #include "steps.h"
 #include "timelim.h"
+#include "spatial.h"
+#include "gdlmap.h"
+#include "layoutcache.h"
 #include "main.h"
 #include "options.h"
 #include "grprint.h"
 #include "timing.h"
+#include "profile.h"
 
 #ifdef X11
 
@@ -261,16 +265,7 @@ int vcg_main(int argc, char *argv[]) {
 	if (i==800)         print_basic_help(); /* and exit */
 	if (filename[i]==0) print_basic_help(); /* and exit */
 
-	if (fastflag) {
-		min_baryiterations = 0;
-		max_baryiterations = 2;
-		min_mediumshifts = 0;
-		max_mediumshifts = 2;
-		min_centershifts = 0;
-		max_centershifts = 2;
-		max_edgebendings = 2;
-		max_straighttune = 2;
-	}
+	if (fastflag) set_fast_layout();
 
 	parse_part();
 	visualize_part();
@@ -281,6 +276,25 @@ int vcg_main(int argc, char *argv[]) {
 }
 
 
+/*--------------------------------------------------------------------*/
+
+/*  Fast layout
+ *  ===========
+ *  Option -fast: limit the iterations of all layout phases.
+ */
+
+void set_fast_layout(void) {
+	min_baryiterations = 0;
+	max_baryiterations = 2;
+	min_mediumshifts = 0;
+	max_mediumshifts = 2;
+	min_centershifts = 0;
+	max_centershifts = 2;
+	max_edgebendings = 2;
+	max_straighttune = 2;
+}
+
+
 /*--------------------------------------------------------------------*/
 
 /* Check whether file is writable
@@ -329,6 +343,7 @@ void Fatal_error(char *x,char *y) {
 void	parse_part(void) {
 	int 	errs,i;
 
+	prof_begin(PROF_GRAPH);
 	start_time();
 	debugmessage("parse_part","");
 
@@ -338,19 +353,27 @@ void	parse_part(void) {
 	for (i=0; i<3; i++) info_names[i]=NULL;
 
 	free_memory();
+	unmap_input_file();
 	yyin = NULL;
 
 	if ( strcmp(Dataname,"-")==0 ) yyin = stdin;
 	else {
 	 	yyin = fopen(Dataname,"r");
 		if (yyin == NULL) Fatal_error("Cannot open",Dataname);
+		(void)map_input_file(yyin);
                 save_input_file_contents(yyin);
        	}
 
+	/* With -cache, a known graph is parsed with its final layout */
+
+	yyin = layout_cache_open(yyin);
+	warm_start_reset();
+
 	free_timelimit();
 	if (G_timelimit>0) init_timelimit(G_timelimit);
         errs = parse();
 
+	unmap_input_file();
         if ((yyin)&&(yyin!=stdin)) fclose(yyin);
 
         if (errs>0)
@@ -459,6 +482,11 @@ void	visualize_part(void) {
         V_ymin = V_ymin_initial;
         V_ymax = V_ymin + (long)(G_ymax + COFFSET);
 
+	/* With -anytime, this is the fast layout of level 0. The caller
+	 * refines it by anytime_refine.
+	 */
+
+	if ((anytime_layout)&&(!layout_cache_loaded())) anytime_begin();
 	relayout();
 }
 
@@ -470,6 +498,7 @@ void	visualize_part(void) {
 
 void relayout(void) {
 	debugmessage("relayout","");
+	prof_begin(PROF_LAYOUT);
         start_time();
 
 	if (G_timelimit>0) init_timelimit(G_timelimit);
@@ -501,7 +530,9 @@ void relayout(void) {
 
 		/* Calculate new layout */
 
+		warm_start_seed();
                 step1_main();
+		warm_start_unseed();
 		if (nr_errors!=0) Fatal_error("Wrong specification","");
 
 		/* step1_main calls tree_main, if TREE_LAYOUT.
@@ -510,6 +541,13 @@ void relayout(void) {
 		if (layout_flag != TREE_LAYOUT) {
                 	step2_main();
 			if (nr_errors!=0) Fatal_error("Wrong specification","");
+
+			/* The cache entry does not fit (see incrlayout.c) */
+
+			if (warm_start_missed()) {
+				relayout();
+				return;
+			}
                 	step3_main();
 			if (nr_errors!=0) Fatal_error("Wrong specification","");
 		}
@@ -523,7 +561,11 @@ void relayout(void) {
 
 		prepare_nodes();
 	}
+	build_spatial_index();
+	layout_cache_store();
+	warm_start_store();
 	free_timelimit();
+	prof_count_layout();
 }
 
 /*--------------------------------------------------------------------*/
@@ -542,10 +584,20 @@ void setScreenSpecifics(void) 	/* this sets G_width, G_height */
 {
 }
 
+/* The GUI handles its events here while an anytime level is being
+ * calculated, see timelim.c.
+ */
+
+static void (*wait_cb)(int code);
+
+void set_wait_callback(void (*_wait_cb)(int code))
+{
+  wait_cb = _wait_cb;
+}
+
 void gs_wait_message(int code)
 {
-  // process code and return
-  (void)code;
+  if ( wait_cb != NULL ) wait_cb(code);
 }
 
 /*--------------------------------------------------------------------*/
@@ -554,6 +606,17 @@ static void (*rectangle_cb)(long x,long y,int w,int h,int color, void *painter);
 static void (*polygon_cb)(struct Point *hp, int j, int color, void *painter);
 static void *painter;
 
+/* In the fisheye views, a line longer than 50 pixels on the screen is
+ * drawn as polyline through the points d/7 (d = 1..6) of the segment.
+ * The points are transformed together by fe_g_to_s_n.
+ * The segments of an edge, and the strokes of characters, mostly start
+ * where the previous line ended. Thus the last end point is kept. It
+ * is valid during one draw_graph, while the fisheye does not change.
+ */
+
+static int last_valid = 0;
+static int last_gx, last_gy, last_sx, last_sy;
+
 void gs_line(int fx,int fy,int tx,int ty,int color)
 {
   int x1 = fx - V_xmin;
@@ -562,27 +625,86 @@ void gs_line(int fx,int fy,int tx,int ty,int color)
   int y2 = ty - V_ymin;
   if ( fisheye_view != 0 )
   {
-    int d = 1;
-    fe_g_to_s(fx, fy, &x1, &y1);
-    fe_g_to_s(tx, ty, &x2, &y2);
-    while ( (x1-x2)*(x1-x2)+(y1-y2)*(y1-y2) > 50*50)
+    long gx[6], gy[6];
+    int sx[6], sy[6];
+    int d;
+    if ( last_valid && fx == last_gx && fy == last_gy )
+    {
+      x1 = last_sx; y1 = last_sy;
+      fe_g_to_s(tx, ty, &x2, &y2);
+    }
+    else
     {
-      int x3, y3;
-      int hx = fx + d * (tx-fx)/7;
-      int hy = fy + d * (ty-fy)/7;
-      fe_g_to_s(hx,hy,&x3,&y3);
-      line_cb(x1, y1, x3, y3, color, painter);
-      x1 = x3;
-      y1 = y3;
-      d++;
+      gx[0] = fx; gy[0] = fy;
+      gx[1] = tx; gy[1] = ty;
+      fe_g_to_s_n(gx, gy, sx, sy, 2);
+      x1 = sx[0]; y1 = sy[0];
+      x2 = sx[1]; y2 = sy[1];
+    }
+    last_valid = 1;
+    last_gx = tx; last_gy = ty;
+    last_sx = x2; last_sy = y2;
+    if ( (x1-x2)*(x1-x2)+(y1-y2)*(y1-y2) > 50*50 )
+    {
+      for ( d=1; d < 7; d++ )
+      {
+        gx[d-1] = fx + d * (tx-fx)/7;
+        gy[d-1] = fy + d * (ty-fy)/7;
+      }
+      fe_g_to_s_n(gx, gy, sx, sy, 6);
+      d = 0;
+      while ( (x1-x2)*(x1-x2)+(y1-y2)*(y1-y2) > 50*50 )
+      {
+        int x3 = d < 6 ? sx[d] : x2;
+        int y3 = d < 6 ? sy[d] : y2;
+        line_cb(x1, y1, x3, y3, color, painter);
+        x1 = x3;
+        y1 = y3;
+        d++;
+      }
     }
   }
   line_cb(x1, y1, x2, y2, color, painter);
 }
 
+/* One side of a rectangle in the polar fisheye views: from the last
+ * point hp[j-1], i.e. (x,y) in the graph, to the screen point (ex,ey),
+ * i.e. (x+dx,y+dy). As for gs_line, the points d/7 of the side are
+ * added while the last point is more than 50 pixels away, but hp gets
+ * at most jmax+1 points. Returns the new number of points.
+ */
+
+static int fe_rectangle_side(struct Point *hp, int j, int jmax,
+                             long x, long y, int dx, int dy, int ex, int ey)
+{
+  long gx[6], gy[6];
+  int sx[6], sy[6];
+  int x1 = hp[j-1].x;
+  int y1 = hp[j-1].y;
+  int d;
+
+  if ( (ex-x1)*(ex-x1)+(ey-y1)*(ey-y1) <= 50*50 ) return j;
+  for ( d=1; d < 7; d++ )
+  {
+    gx[d-1] = x + d * dx/7;
+    gy[d-1] = y + d * dy/7;
+  }
+  fe_g_to_s_n(gx, gy, sx, sy, 6);
+  d = 0;
+  while ( (ex-x1)*(ex-x1)+(ey-y1)*(ey-y1) > 50*50 )
+  {
+    x1 = hp[j].x = d < 6 ? sx[d] : ex;
+    y1 = hp[j++].y = d < 6 ? sy[d] : ey;
+    d++;
+    if ( j > jmax ) break;
+  }
+  return j;
+}
+
 void gs_rectangle(long x,long y,int w,int h,int color)
 {
-  int x2, y2, hx, hy, j, d;
+  long gx[4], gy[4];
+  int sx[4], sy[4], j;
   struct Point hp[29];
 
   int x1 = x - V_xmin;
@@ -593,73 +715,34 @@ void gs_rectangle(long x,long y,int w,int h,int color)
     {
       case FPSCF_VIEW:
       case PSCF_VIEW:
-    	j = 0;
-    	fe_g_to_s(x, y, &x1, &y1);
-    	fe_g_to_s(x, y+h, &x2, &y2);
-    	hp[j].x = x1;
-    	hp[j++].y = y1;
-    	d = 1;
-    	while ( (x2-x1)*(x2-x1)+(y2-y1)*(y2-y1) > 50*50 )
-        {
-    	  hx = x;
-    	  hy = y + d * h/7;
-    	  fe_g_to_s(hx, hy, &x1, &y1);
-    	  hp[j].x = x1;
-    	  hp[j++].y = y1;
-    	  d++;
-    	  if ( j > 7 ) break;
-    	}
-    	x1 = hp[j].x = x2;
-    	y1 = hp[j++].y = y2;
-    	fe_g_to_s(x+w,y+h,&x2,&y2);
-    	d = 1;
-    	while ( (x2-x1)*(x2-x1)+(y2-y1)*(y2-y1) > 50*50 )
-        {
-    	  hx = x + d * w/7;
-    	  hy = y + h;
-    	  fe_g_to_s(hx, hy, &x1, &y1);
-    	  hp[j].x = x1;
-    	  hp[j++].y = y1;
-    	  d++;
-    	  if ( j > 14 ) break;
-    	}
-    	x1 = hp[j].x = x2;
-    	y1 = hp[j++].y = y2;
-    	fe_g_to_s(x+w,y,&x2,&y2);
-    	d = 1;
-    	while ( (x2-x1)*(x2-x1)+(y2-y1)*(y2-y1) > 50*50 )
-        {
-    	  hx = x + w;
-    	  hy = y + h - d * h/7;
-    	  fe_g_to_s(hx, hy, &x1, &y1);
-    	  hp[j].x = x1;
-    	  hp[j++].y = y1;
-    	  d++;
-    	  if ( j > 21 ) break;
-    	}
-    	x1 = hp[j].x = x2;
-    	y1 = hp[j++].y = y2;
-    	x2 = hp[0].x;
-    	y2 = hp[0].y;
-    	d = 1;
-    	while ( (x2-x1)*(x2-x1)+(y2-y1)*(y2-y1) > 50*50 )
-        {
-    	  hx = x + w - d * w/7;
-    	  hy = y;
-    	  fe_g_to_s(hx, hy, &x1, &y1);
-    	  hp[j].x = x1;
-    	  hp[j++].y = y1;
-    	  d++;
-    	  if ( j > 28 ) break;
-    	}
+    	gx[0] = x;   gy[0] = y;
+    	gx[1] = x;   gy[1] = y+h;
+    	gx[2] = x+w; gy[2] = y+h;
+    	gx[3] = x+w; gy[3] = y;
+    	fe_g_to_s_n(gx, gy, sx, sy, 4);
+    	hp[0].x = sx[0];
+    	hp[0].y = sy[0];
+    	j = fe_rectangle_side(hp, 1, 7, x, y, 0, h, sx[1], sy[1]);
+    	hp[j].x = sx[1];
+    	hp[j++].y = sy[1];
+    	j = fe_rectangle_side(hp, j, 14, x, y+h, w, 0, sx[2], sy[2]);
+    	hp[j].x = sx[2];
+    	hp[j++].y = sy[2];
+    	j = fe_rectangle_side(hp, j, 21, x+w, y+h, 0, -h, sx[3], sy[3]);
+    	hp[j].x = sx[3];
+    	hp[j++].y = sy[3];
+    	j = fe_rectangle_side(hp, j, 28, x+w, y, -w, 0, sx[0], sy[0]);
         polygon_cb(hp, j, color, painter);
     	return;
     case FCSCF_VIEW:
     case CSCF_VIEW:
-    	fe_g_to_s(x,y,&x1,&y1);
-    	fe_g_to_s(x+w,y+h,&x2,&y2);
-    	w = x2-x1;
-    	h = y2-y1;
+    	gx[0] = x;   gy[0] = y;
+    	gx[1] = x+w; gy[1] = y+h;
+    	fe_g_to_s_n(gx, gy, sx, sy, 2);
+    	x1 = sx[0];
+    	y1 = sy[0];
+    	w = sx[1]-x1;
+    	h = sy[1]-y1;
     	if ( (w<=0) && (h<=0) ) return;
     	if ( w<=0 ) w = 1;
     	if ( h<=0 ) h = 1;
@@ -699,6 +782,7 @@ void draw_graph(void (*_line_cb)(int x1,int y1,int x2,int y2,int color, void *pa
   rectangle_cb = _rectangle_cb;
   polygon_cb = _polygon_cb;
   painter = _painter;
+  last_valid = 0;
   draw_main();
 }
 
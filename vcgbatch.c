@@ -0,0 +1,566 @@
+/*--------------------------------------------------------------------*/
+/*                                                                    */
+/*              VCG : Visualization of Compiler Graphs                */
+/*              --------------------------------------                */
+/*                                                                    */
+/*   file:         vcgbatch.c                                         */
+/*   description:  Headless batch layout driver                       */
+/*   status:       in work                                            */
+/*                                                                    */
+/*--------------------------------------------------------------------*/
+
+/*
+ *  This program and documentation is free software; you can redistribute
+ *  it under the terms of the  GNU General Public License as published by
+ *  the  Free Software Foundation;  either version 2  of the License,  or
+ *  (at your option) any later version.
+ */
+
+/************************************************************************
+ * The batch driver lays out many GDL files in one process without
+ * the Qt user interface. For each input file, it runs
+ *
+ *    parse_part -> step0_main -> folding -> step1_main ... step4_main
+ *
+ * and writes the layout as annotated VCG file by print_graph.
+ * The memory of the previous graph is reused, because parse_part
+ * starts with free_memory.
+ *
+ * The layout phases are timed by the start_time/stop_time markers
+ * (see timing.h and profile.c, compiled with PHASE_TIMING). For each
+ * graph, one line with the wall time per phase is printed, and a
+ * summary at the end.
+ *
+ * Usage:  vcgbatch [-j <n>] [-layoutdir <dir>] [-nolayout] [-arenastat]
+ *                  [-profile <file>] [-binlayout] [-outbench <n>]
+ *                  [vcg options] files...
+ *
+ * All VCG layout options are accepted. As with -multi, an option
+ * applies to all files that follow it. -arenastat prints the counters
+ * of the allocation arenas (see alloc.c) after each graph. -profile
+ * appends the profile of each graph as one line of JSON to the file:
+ * wall and CPU time per phase, the counters of the layout and the
+ * bytes of the memory pools (see prof_json in profile.c).
+ * With -pbmoutput or -ppmoutput <file>, the drawing of the graph is
+ * also written as bitmap (see print_bitmap_file in grprint2.c).
+ * -binlayout writes the compact binary dump <file>.blayout instead of
+ * the annotated VCG file (see print_graph_binary in grprint.c).
+ * -outbench <n> is a micro-benchmark of the output: the layout of each
+ * graph is written n times through plain stdio, as before outbuf.c,
+ * n times by the buffered writer and n times as binary dump, and the
+ * best times are printed.
+ *
+ * The layout engine keeps its state in global variables (nodelist,
+ * layer, maxdepth, the hash table of step0, the free lists of alloc.c,
+ * and many more inside the steps), thus one address space can lay out
+ * only one graph at a time. With -j <n>, the driver forks n worker
+ * processes instead. Each worker has its own copy of the global state.
+ * All workers scan the same argument list, such that the options are
+ * applied in the same way, and claim the next file from a counter in
+ * shared memory. A worker that got small graphs simply takes more of
+ * them. At the end, the workers report their phase times to the parent
+ * through the shared memory, and the parent prints the summary.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+
+#ifndef _MSC_VER
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "globals.h"
+#include "alloc.h"
+#include "main.h"
+#include "options.h"
+#include "steps.h"
+#include "grprint.h"
+#include "timelim.h"
+#include "timing.h"
+#include "profile.h"
+#include "outbuf.h"
+
+#ifndef PHASE_TIMING
+#error vcgbatch.c must be compiled with PHASE_TIMING
+#endif
+
+
+/* Prototypes
+ * ==========
+ */
+
+void error			_PP((const char *format, ...));
+void save_input_file_contents	_PP((FILE *fp));
+
+static void   report_phases	_PP((char *fname, int ok));
+static int    layout_one_file	_PP((char *outdir, int nolayout));
+static int    strip_batch_options _PP((int argc, char *argv[],
+					char **outdir, int *nolayout, int *jobs,
+					char **proffile));
+static long   claim_file	_PP((void));
+static void   layout_files	_PP((int argc, char *argv[],
+					char *outdir, int nolayout));
+static void   print_summary	_PP((void));
+static void   output_benchmark	_PP((char *outname));
+#ifndef _MSC_VER
+static int    run_workers	_PP((int jobs, int argc, char *argv[],
+					char *outdir, int nolayout));
+#endif
+
+
+/* Global variables
+ * ================
+ */
+
+/*  Error recovery: a fatal error aborts the current graph only.
+ */
+
+static jmp_buf	graph_env;
+static int	in_graph = 0;
+
+/*  Print the arena counters after each graph (-arenastat).
+ */
+
+static int	arenastat = 0;
+
+/*  Write the binary dump instead of the VCG file (-binlayout), and the
+ *  number of repetitions of the output benchmark (-outbench).
+ */
+
+static int	binlayout = 0;
+static int	outbench  = 0;
+
+/*  The file of the JSON profiles (-profile), or NULL.
+ *  The lines are written at once, such that the lines of concurrent
+ *  workers do not interleave.
+ */
+
+#define PROFLINELEN 16384
+
+static FILE	*prof_file = NULL;
+
+/*  Number of files laid out by this process, and how many of them failed.
+ */
+
+static int	nr_files  = 0;
+static int	nr_failed = 0;
+
+/*  Shared memory of the worker processes (-j <n>), or NULL.
+ *  The phase names are string literals: after fork, their addresses
+ *  are the same in all processes.
+ */
+
+#define MAXWORKERS 64
+#define MAXPHASES  16
+
+static struct batch_shared {
+	long	next_file;		/* number of the next unclaimed file */
+	struct worker_result {
+		int	files;		/* files laid out by this worker */
+		int	failed;		/* files that failed		 */
+		int	nr_phases;
+		char	*names[MAXPHASES];
+		double	totals[MAXPHASES];
+	} result[MAXWORKERS];
+} *shared = NULL;
+
+
+/*--------------------------------------------------------------------*/
+/*  Phase timing                                                      */
+/*--------------------------------------------------------------------*/
+
+/*  Print the phase times of the current graph
+ *  ------------------------------------------
+ *  and append its profile to the file of -profile. Each line is
+ *  written at once, such that the lines of concurrent workers do not
+ *  interleave.
+ */
+
+static void report_phases(char *fname, int ok)
+{
+	char line[2048];
+	double sum, t;
+	int i, len;
+
+	sum = 0.0;
+	SPRINTF(line, "%.1000s:", fname);
+	len = strlen(line);
+	if (ok) SPRINTF(line+len, " %d nodes, %d dummy nodes, %d edge segments, %d crossings;",
+			st_nr_vis_nodes, st_nr_vis_dummies, st_nr_vis_edges, nr_crossings);
+	else	SPRINTF(line+len, " failed;");
+	len += strlen(line+len);
+	for (i=0; i<prof_nr_phases(); i++) {
+		t = prof_phase_wall(i);
+		SPRINTF(line+len, " %.40s %.3f", prof_phase_name(i), t);
+		len += strlen(line+len);
+		sum += t;
+	}
+	SPRINTF(line+len, " total %.3f\n", sum);
+	len += strlen(line+len);
+	(void)fwrite(line, 1, (size_t)len, stdout);
+	FFLUSH(stdout);
+
+	if (prof_file) {
+		static char profline[PROFLINELEN];
+
+		len = prof_json(profline, PROFLINELEN, fname, ok);
+		(void)fwrite(profline, 1, (size_t)len, prof_file);
+		FFLUSH(prof_file);
+	}
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Device dependent functions                                        */
+/*--------------------------------------------------------------------*/
+
+/*  Fatal errors
+ *  ------------
+ *  Inside a layout, we give up the graph and continue with the next.
+ */
+
+void error(const char *format, ...)
+{
+	va_list va;
+
+	va_start(va, format);
+	(void)vfprintf(stderr, format, va);
+	va_end(va);
+	FPRINTF(stderr, "\n");
+	if (in_graph) longjmp(graph_env, 1);
+	exit(-1);
+}
+
+
+/*  The input file is not kept: there is no "Save As" in batch mode.
+ */
+
+void save_input_file_contents(FILE *fp)
+{
+	(void)fp;
+}
+
+
+/*--------------------------------------------------------------------*/
+/*  Batch layout                                                      */
+/*--------------------------------------------------------------------*/
+
+/*  Layout the file Dataname
+ *  ------------------------
+ *  Returns 1 on success.
+ */
+
+static int layout_one_file(char *outdir, int nolayout)
+{
+	static char outname[1024];
+	char *base, *c;
+
+	strncpy(filename, Dataname, 800);
+	filename[800] = 0;
+
+	in_graph = 1;
+	if (setjmp(graph_env)) {
+		in_graph = 0;
+		report_phases(Dataname, 0);
+		return(0);
+	}
+
+	parse_part();
+	visualize_part();
+	while (anytime_refine()) ;	/* -anytime: up to the last level */
+	in_graph = 0;
+
+	if (!nolayout) {
+		if (outdir) {
+			base = Dataname;
+			for (c=Dataname; *c; c++)
+				if ((*c=='/')||(*c=='\\')) base = c+1;
+			SPRINTF(outname, "%.500s/%.500s.%s", outdir, base,
+				(binlayout ? "blayout" : "layout"));
+		}
+		else	SPRINTF(outname, "%.1000s.%s", Dataname,
+				(binlayout ? "blayout" : "layout"));
+
+		start_time();
+		(void)remove(outname);
+		if (!(binlayout ? print_graph_binary(outname)
+				: print_graph(outname)))
+			FPRINTF(stderr, "Cannot write %s\n", outname);
+		stop_time("output");
+		if (outbench > 0) output_benchmark(outname);
+	}
+	if ((exfile)&&((extype==1)||(extype==2))) {
+		start_time();
+		(void)remove(exfilename);
+		if (!print_bitmap_file(exfilename))
+			FPRINTF(stderr, "Cannot write %s\n", exfilename);
+		stop_time("bitmap");
+	}
+	report_phases(Dataname, 1);
+	if (arenastat) {
+		print_arena_statistics();
+		FFLUSH(stdout);
+	}
+	return(1);
+}
+
+
+/*  Claim the next file
+ *  -------------------
+ *  Returns the number of the next file this process has to lay out.
+ *  Files are numbered in the order of the argument list.
+ */
+
+static long claim_file(void)
+{
+	static long next = 0;
+
+#ifndef _MSC_VER
+	if (shared) return(__sync_fetch_and_add(&shared->next_file, 1L));
+#endif
+	return(next++);
+}
+
+
+/*  Layout all files of the argument list
+ *  -------------------------------------
+ *  Dataname is the first file. All files are scanned, but only the
+ *  claimed ones are laid out.
+ */
+
+static void layout_files(int argc, char *argv[], char *outdir, int nolayout)
+{
+	long	fileno, claimed;
+
+	fileno  = 0;
+	claimed = claim_file();
+	while (Dataname[0]) {
+		if (fileno == claimed) {
+			nr_files++;
+			if (!layout_one_file(outdir, nolayout)) nr_failed++;
+			claimed = claim_file();
+		}
+		fileno++;
+		if (!scanOptions(argc, argv)) print_basic_help(); /* and exit */
+	}
+}
+
+
+/*  Benchmark of the output
+ *  -----------------------
+ *  Writes the actual layout outbench times in each form into a scratch
+ *  file next to outname, and prints the best time and the throughput.
+ */
+
+static void output_benchmark(char *outname)
+{
+	static char benchname[1100];
+	static char *kind[3] = { "stdio", "buffered", "binary" };
+	double	t, best[3];
+	long	size[3];
+	int	k, i;
+	FILE	*f;
+
+	SPRINTF(benchname, "%.1000s.bench", outname);
+	for (k=0; k<3; k++) {
+		best[k] = -1.0;
+		ob_unbuffered = (k==0);
+		for (i=0; i<outbench; i++) {
+			(void)remove(benchname);
+			t = prof_wall_clock();
+			if (k<2) (void)print_graph(benchname);
+			else	 (void)print_graph_binary(benchname);
+			t = prof_wall_clock() - t;
+			if ((best[k]<0.0)||(t<best[k])) best[k] = t;
+		}
+		size[k] = 0;
+		f = fopen(benchname, "rb");
+		if (f) {
+			if (fseek(f, 0L, SEEK_END)==0) size[k] = ftell(f);
+			fclose(f);
+		}
+	}
+	ob_unbuffered = 0;
+	(void)remove(benchname);
+
+	PRINTF("%s: output", Dataname);
+	for (k=0; k<3; k++)
+		PRINTF(" %s %.3f s %ld bytes %.1f MB/s", kind[k], best[k],
+			size[k], (best[k]>0.0) ? size[k]/best[k]/1.0e6 : 0.0);
+	PRINTF("\n");
+}
+
+
+/*  Print the summary
+ *  -----------------
+ */
+
+static void print_summary(void)
+{
+	int i;
+
+	PRINTF("%d files, %d failed;", nr_files, nr_failed);
+	for (i=0; i<prof_nr_phases(); i++)
+		PRINTF(" %s %.3f", prof_phase_name(i), prof_phase_total(i));
+	PRINTF("\n");
+}
+
+
+#ifndef _MSC_VER
+
+/*  Layout by worker processes
+ *  --------------------------
+ *  Forks jobs workers that share the files. The results of the workers
+ *  are collected into the phase table and the counters of the parent.
+ *  Returns 0 if the workers could not be started.
+ */
+
+static int run_workers(int jobs, int argc, char *argv[],
+			char *outdir, int nolayout)
+{
+	struct worker_result *r;
+	pid_t	pid;
+	int	w, i, started, status;
+
+	shared = (struct batch_shared *)mmap(NULL, sizeof(struct batch_shared),
+			PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if (shared == (struct batch_shared *)MAP_FAILED) {
+		shared = NULL;
+		return(0);
+	}
+	memset(shared, 0, sizeof(struct batch_shared));
+
+	FFLUSH(stdout);
+	FFLUSH(stderr);
+	for (started=0; started<jobs; started++) {
+		pid = fork();
+		if (pid < 0) break;
+		if (pid == 0) {
+			layout_files(argc, argv, outdir, nolayout);
+			r = &(shared->result[started]);
+			r->files     = nr_files;
+			r->failed    = nr_failed;
+			r->nr_phases = prof_nr_phases();
+			if (r->nr_phases > MAXPHASES) r->nr_phases = MAXPHASES;
+			for (i=0; i<r->nr_phases; i++) {
+				r->names[i]  = prof_phase_name(i);
+				r->totals[i] = prof_phase_total(i);
+			}
+			FFLUSH(stdout);
+			_exit(0);
+		}
+	}
+	if (started == 0) {
+		(void)munmap((void *)shared, sizeof(struct batch_shared));
+		shared = NULL;
+		return(0);
+	}
+
+	/* A worker that crashed did not report its files. */
+	while (wait(&status) > 0) {
+		if (!WIFEXITED(status) || (WEXITSTATUS(status)!=0)) {
+			FPRINTF(stderr, "A worker process terminated abnormally\n");
+			nr_failed++;
+		}
+	}
+	for (w=0; w<started; w++) {
+		r = &(shared->result[w]);
+		nr_files  += r->files;
+		nr_failed += r->failed;
+		for (i=0; i<r->nr_phases; i++)
+			prof_add_total(r->names[i], r->totals[i]);
+	}
+	return(1);
+}
+
+#endif /* _MSC_VER */
+
+
+/*  Remove the options of the batch driver from argv
+ *  ------------------------------------------------
+ *  The remaining arguments are given to scanOptions. Returns the new argc.
+ */
+
+static int strip_batch_options(int argc, char *argv[],
+				char **outdir, int *nolayout, int *jobs,
+				char **proffile)
+{
+	int i, j;
+
+	for (i=j=1; i<argc; i++) {
+		if ((strcmp(argv[i], "-layoutdir")==0) && (i+1<argc))
+			*outdir = argv[++i];
+		else if (strcmp(argv[i], "-nolayout")==0)
+			*nolayout = 1;
+		else if (strcmp(argv[i], "-arenastat")==0)
+			arenastat = 1;
+		else if ((strcmp(argv[i], "-j")==0) && (i+1<argc))
+			*jobs = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-profile")==0) && (i+1<argc))
+			*proffile = argv[++i];
+		else if (strcmp(argv[i], "-binlayout")==0)
+			binlayout = 1;
+		else if ((strcmp(argv[i], "-outbench")==0) && (i+1<argc))
+			outbench = atoi(argv[++i]);
+		else	argv[j++] = argv[i];
+	}
+	argv[j] = NULL;
+	return(j);
+}
+
+
+/*  The main program
+ *  ================
+ */
+
+int main(int argc, char *argv[])
+{
+	char	*outdir, *proffile;
+	int	nolayout, jobs;
+
+	outdir   = NULL;
+	proffile = NULL;
+	nolayout = 0;
+	jobs     = 1;
+	argc = strip_batch_options(argc, argv, &outdir, &nolayout, &jobs,
+				   &proffile);
+
+	if (argc <= 1) {
+		PRINTF("Usage: %s [-j <n>] [-layoutdir <dir>] [-nolayout] [-arenastat]\n",
+			argv[0]);
+		PRINTF("       [-profile <file>] [-binlayout] [-outbench <n>]\n");
+		PRINTF("       [options] files...\n");
+		return(1);
+	}
+	if (proffile) {
+		prof_file = fopen(proffile, "a");
+		if (!prof_file) {
+			FPRINTF(stderr, "Cannot open %s\n", proffile);
+			return(1);
+		}
+		(void)setvbuf(prof_file, NULL, _IOFBF, PROFLINELEN);
+	}
+	if (jobs < 1) jobs = 1;
+	if (jobs > MAXWORKERS) jobs = MAXWORKERS;
+
+	G_xmax = G_ymax = -1;
+	if (!scanOptions(argc, argv)) print_basic_help(); /* and exit */
+	print_version_copyright();
+	print_help();
+	if (!Dataname[0]) print_basic_help(); /* and exit */
+	if (fastflag) set_fast_layout();
+
+#ifndef _MSC_VER
+	if ((jobs <= 1) || !run_workers(jobs, argc, argv, outdir, nolayout))
+#endif
+		layout_files(argc, argv, outdir, nolayout);
+
+	print_summary();
+	return(nr_failed ? 2 : 0);
+}
@@ -0,0 +1,77 @@
+include(qtvars.pri)
+
+# headless batch layout driver: no Qt libraries are linked
+
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+QT -= core gui
+
+macx:INCLUDEPATH += /usr/include/malloc
+
+# destination directory and name
+
+DESTDIR=.
+TARGET = vcgbatch
+
+# compilation flags
+
+DEFINES += PHASE_TIMING
+
+# since we can not modify some source files, just suppress warnings
+win32: {
+  CFLAGS+=-wd4013 -wd4090
+  QMAKE_CFLAGS += $${CFLAGS}
+}
+else: {
+  CFLAGS+=-Wall \
+          -fdiagnostics-show-option \
+          -Wno-format \
+          -Wno-parentheses \
+          -Wno-sign-compare \
+          -Wno-uninitialized \
+          -Wno-unused-variable \
+          -Wno-unused-function
+  QMAKE_CFLAGS_WARN_ON += $${CFLAGS}
+  LIBS += -lm -lpthread
+}
+
+#
+# project files
+#
+
+HEADERS       += alloc.h drawstr.h grammar.h timelim.h \
+                 draw.h fisheye.h grprint.h options.h timing.h ytab.h \
+                 drawchr.h folding.h infobox.h \
+                 drawlib.h globals.h main.h gdlmap.h layoutcache.h outbuf.h profile.h spatial.h steps.h usrsignal.h
+SOURCES       += vcgbatch.c \
+               alloc.c \
+               bkplace.c \
+               draw_wrapper.c \
+               fisheye.c \
+               gdlmap.c \
+               folding.c \
+               grprint.c \
+               grprint2.c \
+               grprintstr.c \
+               incrlayout.c \
+               infobox.c \
+               layerdata.c \
+               layoutcache.c \
+               lexyy.c \
+               spatial.c \
+               vcg_main.c \
+               options.c \
+               outbuf.c \
+               prepare.c \
+               profile.c \
+               ranking.c \
+               step0.c \
+               step1.c \
+               step2.c \
+               step3.c \
+               step4.c \
+               timelim.c \
+               tree.c \
+               usrsignal.c \
+               ytab.c
@@ -15,6 +15,8 @@ RESOURCES += wingraph.qrc
 
 # compilation flags
 
+DEFINES += PHASE_TIMING
+
 # since we can not modify some source files, just suppress warnings
 win32: {
   CFLAGS+=-wd4013 -wd4090
@@ -32,6 +34,7 @@ else: {
           -Wno-unused-function
   QMAKE_CXXFLAGS_WARN_ON += $${CFLAGS}
   QMAKE_CFLAGS_WARN_ON += $${CFLAGS}
+  LIBS += -lpthread
 }
 
 #
@@ -44,25 +47,34 @@ HEADERS       += mainwindow.h \
                   alloc.h drawstr.h grammar.h timelim.h \
                   draw.h fisheye.h grprint.h options.h timing.h ytab.h \
                   drawchr.h folding.h infobox.h \
-                  drawlib.h globals.h main.h steps.h usrsignal.h \
+                  drawlib.h globals.h main.h gdlmap.h layoutcache.h outbuf.h profile.h spatial.h steps.h usrsignal.h \
                   grprintpagesdlg.h
 SOURCES       += wingraph32.cpp \
                 mainwindow.cpp \
                alloc.c \
+               bkplace.c \
                draw.c \
                drawlib.c \
                drawstr.c \
                draw_wrapper.c \
                fisheye.c \
+               gdlmap.c \
                folding.c \
                grprint.c \
                grprint2.c \
                grprintstr.c \
+               incrlayout.c \
                infobox.c \
+               layerdata.c \
+               layoutcache.c \
                lexyy.c \
+               spatial.c \
                vcg_main.c \
                options.c \
+               outbuf.c \
                prepare.c \
+               profile.c \
+               ranking.c \
                step0.c \
                step1.c \
                step2.c \